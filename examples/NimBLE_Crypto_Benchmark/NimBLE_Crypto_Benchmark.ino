@@ -0,0 +1,80 @@
+/**
+ * NimBLE_Crypto_Benchmark Demo:
+ *
+ * Demonstrates installing a custom Security Manager crypto provider and
+ * compares it with the built-in implementation using the host microbenchmark.
+ *
+ * The example provider caches the expanded AES key schedule, which pays off
+ * when the same key is used repeatedly such as when resolving private
+ * addresses against a stored IRK. Members left as nullptr use the built-in
+ * implementation, so a provider only needs to supply the primitives it
+ * accelerates (e.g. a hardware AES or P-256 engine).
+ */
+
+#include <Arduino.h>
+#include <NimBLEDevice.h>
+#include "nimble/ext/tinycrypt/include/tinycrypt/aes.h"
+#include "nimble/ext/tinycrypt/include/tinycrypt/constants.h"
+
+static const unsigned int AES_ITERATIONS = 2000;
+static const unsigned int ECC_ITERATIONS = 4;
+
+static uint8_t                 cachedKey[16];
+static bool                    cachedKeyValid = false;
+static tc_aes_key_sched_struct cachedSched;
+
+/** AES-128 block encryption, reusing the key schedule while the key is unchanged. */
+static int cachedAesEncrypt(const uint8_t* key, const uint8_t* in, uint8_t* out) {
+    if (!cachedKeyValid || memcmp(cachedKey, key, sizeof(cachedKey)) != 0) {
+        if (tc_aes128_set_encrypt_key(&cachedSched, key) == TC_CRYPTO_FAIL) {
+            cachedKeyValid = false;
+            return -1;
+        }
+        memcpy(cachedKey, key, sizeof(cachedKey));
+        cachedKeyValid = true;
+    }
+
+    return tc_aes_encrypt(out, in, &cachedSched) == TC_CRYPTO_FAIL ? -1 : 0;
+}
+
+static const struct ble_sm_crypto_provider cachedAesProvider = {
+    "cached-aes",     // name
+    cachedAesEncrypt, // aes_encrypt
+    nullptr,          // aes_cmac, use built-in
+    nullptr,          // p256_gen_key_pair, use built-in
+    nullptr,          // p256_dhkey, use built-in
+};
+
+void printResult(const char* name, const struct ble_sm_crypto_bench_result& res) {
+    Serial.printf("%-12s encrypt: %5lu us, cmac: %5lu us, keygen: %7lu us, dhkey: %7lu us\n",
+                  name,
+                  (unsigned long)res.aes_encrypt_us,
+                  (unsigned long)res.aes_cmac_us,
+                  (unsigned long)res.p256_key_pair_us,
+                  (unsigned long)res.p256_dhkey_us);
+}
+
+void setup() {
+    Serial.begin(115200);
+    Serial.println("Starting NimBLE Crypto Benchmark");
+
+    NimBLEDevice::init("");
+
+    struct ble_sm_crypto_bench_result res;
+    if (ble_sm_crypto_bench(nullptr, AES_ITERATIONS, ECC_ITERATIONS, &res) == 0) {
+        printResult("built-in", res);
+    }
+
+    if (ble_sm_crypto_bench(&cachedAesProvider, AES_ITERATIONS, ECC_ITERATIONS, &res) == 0) {
+        printResult(cachedAesProvider.name, res);
+    }
+
+    /** Use the provider for pairing and address resolution from now on */
+    if (ble_sm_crypto_set_provider(&cachedAesProvider) == 0) {
+        Serial.printf("Crypto provider set to %s\n", ble_sm_crypto_get_provider()->name);
+    }
+}
+
+void loop() {
+    delay(1000);
+}
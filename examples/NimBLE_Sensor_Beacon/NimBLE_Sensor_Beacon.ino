@@ -0,0 +1,61 @@
+/**
+ * NimBLE_Sensor_Beacon Demo:
+ *
+ * Broadcasts a temperature reading and a counter every 100ms with a payload
+ * laid out at compile time with NimBLEAdvPayload. Each update only stores the
+ * changed bytes and sends the payload to the controller while advertising
+ * continues, unchanged payloads are not sent at all.
+ *
+ * NimBLEAdvPayload requires C++14 or later.
+ */
+
+#include <Arduino.h>
+#include <NimBLEDevice.h>
+
+static constexpr auto beacon = NimBLEAdvPayload<>{}
+                                   .addFlags(BLE_HS_ADV_F_DISC_GEN | BLE_HS_ADV_F_BREDR_UNSUP)
+                                   .addName("NimBLE-Sensor")
+                                   .addServiceData16<int16_t>(0x181A, 0) // Environmental sensing
+                                   .addManufacturerData<uint16_t>(0xFFFF, 0); // Test company ID
+
+/** Handles to the values that change, found at compile time */
+static constexpr auto temperature = beacon.serviceDataValue<int16_t>(0x181A);
+static constexpr auto counter     = beacon.manufacturerValue<uint16_t>();
+
+/** The copy of the payload in RAM that is updated */
+static auto payload = beacon;
+
+void setup() {
+    Serial.begin(115200);
+    NimBLEDevice::init("");
+
+#if MYNEWT_VAL(BLE_EXT_ADV)
+    /** With extended advertising enabled the payload is sent with a non-connectable legacy instance */
+    NimBLEExtAdvertisement adv;
+    adv.setLegacyAdvertising(true);
+    adv.setConnectable(false);
+
+    NimBLEExtAdvertising* pAdvertising = NimBLEDevice::getAdvertising();
+    pAdvertising->setInstanceData(0, adv);
+    pAdvertising->updateInstanceData(0, payload.data(), payload.size());
+    pAdvertising->start(0);
+#else
+    NimBLEAdvertising* pAdvertising = NimBLEDevice::getAdvertising();
+    pAdvertising->setConnectableMode(BLE_GAP_CONN_MODE_NON);
+    pAdvertising->setAdvertisementData(payload.data(), payload.size());
+    pAdvertising->start();
+#endif
+}
+
+void loop() {
+    /** Temperature in 0.01 degrees, a real sensor would be read here */
+    temperature.set(payload, static_cast<int16_t>(2150 + random(-50, 50)));
+    counter.set(payload, counter.get(payload) + 1);
+
+#if MYNEWT_VAL(BLE_EXT_ADV)
+    NimBLEDevice::getAdvertising()->updateInstanceData(0, payload.data(), payload.size());
+#else
+    NimBLEDevice::getAdvertising()->setAdvertisementData(payload.data(), payload.size());
+#endif
+    delay(100);
+}
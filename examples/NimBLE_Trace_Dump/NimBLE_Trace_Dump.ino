@@ -0,0 +1,71 @@
+/**
+ * NimBLE_Trace_Dump Demo:
+ *
+ * Runs a simple GATT server with the host binary trace enabled and prints the
+ * trace ring as hex lines when a character is received on the serial port.
+ *
+ * Requires `#define MYNEWT_VAL_BLE_HS_TRACE 1` in nimconfig.h or the build flags.
+ *
+ * Capture the serial output to a file and decode it on the PC with:
+ *   python3 extras/nimble_trace_decode.py --timeline capture.log
+ */
+
+#include <Arduino.h>
+#include <NimBLEDevice.h>
+
+/** Application records can be added with IDs from BLE_HS_TRACE_ID_USER */
+static const uint8_t TRACE_ID_VALUE_UPDATED = BLE_HS_TRACE_ID_USER;
+
+static NimBLECharacteristic* pCounterChr = nullptr;
+static uint32_t              counter     = 0;
+
+/** Prints each chunk of the dump as one hex line */
+static int writeHex(const void* data, size_t len, void* arg) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    Serial.print("TRACE:");
+    for (size_t i = 0; i < len; i++) {
+        Serial.printf("%02x", p[i]);
+    }
+    Serial.println();
+    return 0;
+}
+
+void setup() {
+    Serial.begin(115200);
+    Serial.println("Starting NimBLE Trace Dump");
+
+    NimBLEDevice::init("NimBLE-Trace");
+
+    NimBLEServer*  pServer  = NimBLEDevice::createServer();
+    NimBLEService* pService = pServer->createService("BAAD");
+    pCounterChr = pService->createCharacteristic("F00D", NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::NOTIFY);
+    pCounterChr->setValue(counter);
+    pService->start();
+
+    NimBLEAdvertising* pAdvertising = NimBLEDevice::getAdvertising();
+    pAdvertising->setName("NimBLE-Trace");
+    pAdvertising->addServiceUUID(pService->getUUID());
+    pAdvertising->start();
+
+    Serial.println("Send any character to dump the trace");
+}
+
+void loop() {
+    if (Serial.available()) {
+        while (Serial.available()) {
+            Serial.read();
+        }
+
+        Serial.println("TRACE BEGIN");
+        if (ble_hs_trace_dump(writeHex, nullptr) != 0) {
+            Serial.println("Trace not enabled, set MYNEWT_VAL_BLE_HS_TRACE to 1");
+        }
+        Serial.println("TRACE END");
+    }
+
+    delay(1000);
+    counter++;
+    pCounterChr->setValue(counter);
+    pCounterChr->notify();
+    ble_hs_trace(TRACE_ID_VALUE_UPDATED, BLE_HS_CONN_HANDLE_NONE, counter, 0);
+}
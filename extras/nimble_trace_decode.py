@@ -0,0 +1,235 @@
+#!/usr/bin/env python3
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Decode a NimBLE host binary trace (BLE_HS_TRACE) into a timeline and
+per-operation latencies.
+
+The input is either the raw output of ble_hs_trace_dump() or a serial log
+containing the dump as hex lines prefixed with "TRACE:", as printed by the
+NimBLE_Trace_Dump example.
+
+    nimble_trace_decode.py [--timeline] [--conn HANDLE] FILE
+"""
+
+import argparse
+import binascii
+import struct
+import sys
+from collections import defaultdict
+
+MAGIC = 0x5254424E
+HDR = struct.Struct("<IBBHI")
+REC = struct.Struct("<IHBBII")
+CONN_NONE = 0xFFFF
+
+ID_GAP_EVENT = 1
+ID_ATT_RX = 2
+ID_ATT_TX = 3
+ID_NOTIFY_TX = 4
+ID_L2CAP_CREDITS_RX = 5
+ID_L2CAP_CREDITS_TX = 6
+ID_L2CAP_STALLED = 7
+ID_MBUF_ALLOC_FAIL = 8
+ID_USER = 0x80
+
+ID_NAMES = {
+    ID_GAP_EVENT: "GAP",
+    ID_ATT_RX: "ATT RX",
+    ID_ATT_TX: "ATT TX",
+    ID_NOTIFY_TX: "NOTIFY TX",
+    ID_L2CAP_CREDITS_RX: "CREDITS RX",
+    ID_L2CAP_CREDITS_TX: "CREDITS TX",
+    ID_L2CAP_STALLED: "COC STALLED",
+    ID_MBUF_ALLOC_FAIL: "MBUF FAIL",
+}
+
+GAP_EVENTS = [
+    "CONNECT", "DISCONNECT", None, "CONN_UPDATE", "CONN_UPDATE_REQ",
+    "L2CAP_UPDATE_REQ", "TERM_FAILURE", "DISC", "DISC_COMPLETE",
+    "ADV_COMPLETE", "ENC_CHANGE", "PASSKEY_ACTION", "NOTIFY_RX", "NOTIFY_TX",
+    "SUBSCRIBE", "MTU", "IDENTITY_RESOLVED", "REPEAT_PAIRING",
+    "PHY_UPDATE_COMPLETE", "EXT_DISC", "PERIODIC_SYNC", "PERIODIC_REPORT",
+    "PERIODIC_SYNC_LOST", "SCAN_REQ_RCVD", "PERIODIC_TRANSFER",
+    "PATHLOSS_THRESHOLD", "TRANSMIT_POWER", "PAIRING_COMPLETE",
+    "SUBRATE_CHANGE", "UNHANDLED_HCI_EVENT", "BIGINFO_REPORT",
+]
+
+ATT_OPS = {
+    0x01: "ERROR_RSP",
+    0x02: "MTU_REQ", 0x03: "MTU_RSP",
+    0x04: "FIND_INFO_REQ", 0x05: "FIND_INFO_RSP",
+    0x06: "FIND_TYPE_VALUE_REQ", 0x07: "FIND_TYPE_VALUE_RSP",
+    0x08: "READ_TYPE_REQ", 0x09: "READ_TYPE_RSP",
+    0x0A: "READ_REQ", 0x0B: "READ_RSP",
+    0x0C: "READ_BLOB_REQ", 0x0D: "READ_BLOB_RSP",
+    0x0E: "READ_MULT_REQ", 0x0F: "READ_MULT_RSP",
+    0x10: "READ_GROUP_TYPE_REQ", 0x11: "READ_GROUP_TYPE_RSP",
+    0x12: "WRITE_REQ", 0x13: "WRITE_RSP",
+    0x16: "PREP_WRITE_REQ", 0x17: "PREP_WRITE_RSP",
+    0x18: "EXEC_WRITE_REQ", 0x19: "EXEC_WRITE_RSP",
+    0x1B: "NOTIFY", 0x1D: "INDICATE", 0x1E: "CONFIRM",
+    0x20: "READ_MULT_VAR_REQ", 0x21: "READ_MULT_VAR_RSP",
+    0x23: "NOTIFY_MULTI",
+    0x52: "WRITE_CMD", 0xD2: "SIGNED_WRITE_CMD",
+}
+
+# Request opcode -> response opcode; an error response also completes it.
+ATT_RSP = {op: op + 1 for op in (0x02, 0x04, 0x06, 0x08, 0x0A, 0x0C, 0x0E,
+                                 0x10, 0x12, 0x16, 0x18, 0x20)}
+ATT_RSP[0x1D] = 0x1E
+
+
+def load(path):
+    with open(path, "rb") as f:
+        data = f.read()
+
+    if len(data) >= 4 and struct.unpack_from("<I", data)[0] == MAGIC:
+        return data
+
+    # Serial log with hex lines
+    out = bytearray()
+    for line in data.decode("ascii", "replace").splitlines():
+        idx = line.find("TRACE:")
+        if idx >= 0:
+            out += binascii.unhexlify(line[idx + 6:].strip())
+    return bytes(out)
+
+
+def parse(data):
+    if len(data) < HDR.size:
+        sys.exit("no trace found")
+
+    magic, version, rec_size, count, lost = HDR.unpack_from(data)
+    if magic != MAGIC:
+        sys.exit("bad magic 0x%08x" % magic)
+    if version != 1 or rec_size != REC.size:
+        sys.exit("unsupported trace version %d, record size %d" % (version, rec_size))
+
+    recs = []
+    wrap = 0
+    last = None
+    off = HDR.size
+    for _ in range(count):
+        if off + REC.size > len(data):
+            print("warning: trace truncated", file=sys.stderr)
+            break
+        t, conn, rid, _, a0, a1 = REC.unpack_from(data, off)
+        off += REC.size
+
+        # Unwrap the 32 bit microsecond clock
+        if last is not None and t < last and last - t > 0x80000000:
+            wrap += 1 << 32
+        last = t
+        recs.append((t + wrap, conn, rid, a0, a1))
+
+    return recs, lost
+
+
+def describe(rid, a0, a1):
+    if rid == ID_GAP_EVENT:
+        name = GAP_EVENTS[a0] if a0 < len(GAP_EVENTS) and GAP_EVENTS[a0] else str(a0)
+        return "%s arg=%d" % (name, a1)
+    if rid in (ID_ATT_RX, ID_ATT_TX):
+        return "%s len=%d" % (ATT_OPS.get(a0, "0x%02x" % a0), a1)
+    if rid == ID_NOTIFY_TX:
+        kind = "indication" if a0 >> 16 else "notification"
+        return "%s handle=0x%04x status=%d" % (kind, a0 & 0xFFFF, a1)
+    if rid in (ID_L2CAP_CREDITS_RX, ID_L2CAP_CREDITS_TX):
+        return "cid=0x%04x credits=%d" % (a0, a1)
+    if rid == ID_L2CAP_STALLED:
+        return "cid=0x%04x left=%d" % (a0, a1)
+    if rid == ID_MBUF_ALLOC_FAIL:
+        return "leading_space=%d" % a0
+    return "arg0=0x%08x arg1=0x%08x" % (a0, a1)
+
+
+def timeline(recs):
+    t0 = recs[0][0]
+    for t, conn, rid, a0, a1 in recs:
+        name = ID_NAMES.get(rid, "USER %d" % (rid - ID_USER) if rid >= ID_USER else "ID %d" % rid)
+        conn_s = "-" if conn == CONN_NONE else "%d" % conn
+        print("%12.3f ms  conn %-4s %-12s %s" % ((t - t0) / 1000.0, conn_s, name, describe(rid, a0, a1)))
+
+
+def latencies(recs):
+    pending = {}
+    results = defaultdict(list)
+
+    for t, conn, rid, a0, a1 in recs:
+        if rid not in (ID_ATT_RX, ID_ATT_TX):
+            if rid == ID_L2CAP_STALLED:
+                pending[(conn, "stall", a0)] = (t, "COC stall cid 0x%04x" % a0)
+            elif rid == ID_L2CAP_CREDITS_RX:
+                start = pending.pop((conn, "stall", a0), None)
+                if start:
+                    results[start[1]].append(t - start[0])
+            elif rid == ID_GAP_EVENT and a0 == 1:
+                # Disconnected, drop what is outstanding on the connection
+                for key in [k for k in pending if k[0] == conn]:
+                    del pending[key]
+            continue
+
+        # The side sending a request is waiting for the other side
+        local = "client" if rid == ID_ATT_TX else "server"
+        if a0 in ATT_RSP:
+            # Indications are outstanding independently of requests
+            if a0 == 0x1D:
+                local = "server" if rid == ID_ATT_TX else "client"
+            pending[(conn, rid, a0 == 0x1D)] = (t, a0, local)
+            continue
+
+        key = (conn, ID_ATT_RX if rid == ID_ATT_TX else ID_ATT_TX, a0 == 0x1E)
+        start = pending.get(key)
+        if start and (ATT_RSP[start[1]] == a0 or a0 == 0x01):
+            del pending[key]
+            label = "%s %s" % (start[2], ATT_OPS[start[1]])
+            if a0 == 0x01:
+                label += " (error)"
+            results[label].append(t - start[0])
+
+    if not results:
+        print("no request/response pairs found")
+        return
+
+    print("%-36s %6s %10s %10s %10s %10s" % ("operation", "count", "min us", "avg us", "p95 us", "max us"))
+    for label in sorted(results):
+        v = sorted(results[label])
+        p95 = v[min(len(v) - 1, (len(v) * 95) // 100)]
+        print("%-36s %6d %10d %10d %10d %10d" % (label, len(v), v[0], sum(v) // len(v), p95, v[-1]))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("file", help="binary dump or serial log")
+    ap.add_argument("--timeline", action="store_true", help="print every record")
+    ap.add_argument("--conn", type=int, help="only records of this connection handle")
+    args = ap.parse_args()
+
+    recs, lost = parse(load(args.file))
+    if args.conn is not None:
+        recs = [r for r in recs if r[1] in (args.conn, CONN_NONE)]
+
+    print("%d records, %d lost before the dump" % (len(recs), lost))
+    if not recs:
+        return
+
+    if args.timeline:
+        timeline(recs)
+        print()
+
+    latencies(recs)
+
+
+if __name__ == "__main__":
+    main()
@@ -214,6 +214,30 @@ std::string NimBLEAddress::toString() const {
     return std::string(*this);
 } // toString
 
+/**
+ * @brief Write the string representation of the address into a buffer without allocating.
+ * @param [in] buf The buffer to write to, 18 bytes is enough for any address.
+ * @param [in] len The size of the buffer, the output is truncated and null terminated if it does not fit.
+ * @return The length of the full string, excluding the null terminator.
+ */
+size_t NimBLEAddress::format(char* buf, size_t len) const {
+    int n = snprintf(buf,
+                     len,
+                     NIMBLE_CPP_ADDR_FMT,
+                     this->val[5],
+                     NIMBLE_CPP_ADDR_DELIMITER,
+                     this->val[4],
+                     NIMBLE_CPP_ADDR_DELIMITER,
+                     this->val[3],
+                     NIMBLE_CPP_ADDR_DELIMITER,
+                     this->val[2],
+                     NIMBLE_CPP_ADDR_DELIMITER,
+                     this->val[1],
+                     NIMBLE_CPP_ADDR_DELIMITER,
+                     this->val[0]);
+    return n < 0 ? 0 : n;
+} // format
+
 /**
  * @brief Reverse the byte order of the address.
  * @return A reference to this address.
@@ -247,20 +271,7 @@ bool NimBLEAddress::operator!=(const NimBLEAddress& rhs) const {
  */
 NimBLEAddress::operator std::string() const {
     char buffer[18];
-    snprintf(buffer,
-             sizeof(buffer),
-             NIMBLE_CPP_ADDR_FMT,
-             this->val[5],
-             NIMBLE_CPP_ADDR_DELIMITER,
-             this->val[4],
-             NIMBLE_CPP_ADDR_DELIMITER,
-             this->val[3],
-             NIMBLE_CPP_ADDR_DELIMITER,
-             this->val[2],
-             NIMBLE_CPP_ADDR_DELIMITER,
-             this->val[1],
-             NIMBLE_CPP_ADDR_DELIMITER,
-             this->val[0]);
+    format(buffer, sizeof(buffer));
     return std::string{buffer};
 } // operator std::string
 
@@ -58,6 +58,7 @@ class NimBLEAddress : private ble_addr_t {
     bool                 equals(const NimBLEAddress& otherAddress) const;
     const ble_addr_t*    getBase() const;
     std::string          toString() const;
+    size_t               format(char* buf, size_t len) const;
     uint8_t              getType() const;
     const uint8_t*       getVal() const;
     const NimBLEAddress& reverseByteOrder();
@@ -0,0 +1,322 @@
+/*
+ * Copyright 2020-2025 Ryan Powell <ryan@nable-embedded.io> and
+ * esp-nimble-cpp, NimBLE-Arduino contributors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NIMBLE_CPP_ADV_PAYLOAD_H_
+#define NIMBLE_CPP_ADV_PAYLOAD_H_
+
+#include "syscfg/syscfg.h"
+#if CONFIG_BT_NIMBLE_ENABLED && MYNEWT_VAL(BLE_ROLE_BROADCASTER)
+
+# if __cplusplus < 201402L
+#  error "NimBLEAdvPayload requires C++14 or later"
+# endif
+
+# ifdef USING_NIMBLE_ARDUINO_HEADERS
+#  include "nimble/nimble/host/include/host/ble_gap.h"
+#  include "nimble/nimble/host/include/host/ble_hs_adv.h"
+# else
+#  include "host/ble_gap.h"
+#  include "host/ble_hs_adv.h"
+# endif
+
+# include <cstddef>
+# include <cstdint>
+# include <type_traits>
+
+# if MYNEWT_VAL(BLE_EXT_ADV)
+#  define NIMBLE_CPP_ADV_PAYLOAD_MAX MYNEWT_VAL(BLE_EXT_ADV_MAX_SIZE)
+# else
+#  define NIMBLE_CPP_ADV_PAYLOAD_MAX BLE_HS_ADV_MAX_SZ
+# endif
+
+template <size_t N>
+class NimBLEAdvPayload;
+
+/**
+ * @brief A typed handle to a value inside a NimBLEAdvPayload.
+ * @details Obtained at compile time from the payload, updating the value is a few byte stores into the
+ * payload copy held in RAM. Values are stored little endian.
+ */
+template <typename T>
+class NimBLEAdvPayloadField {
+  public:
+    constexpr explicit NimBLEAdvPayloadField(size_t offset) : m_offset{offset} {}
+
+    /**
+     * @brief Write the value into a payload.
+     * @param [in] payload The payload built with the same layout the handle was obtained from.
+     * @param [in] value The value to write.
+     */
+    template <size_t N>
+    void set(NimBLEAdvPayload<N>& payload, T value) const {
+        static_assert(sizeof(T) <= N, "Field does not fit in payload");
+        NimBLEAdvPayload<N>::putValue(&payload.m_data[m_offset], value);
+    }
+
+    /**
+     * @brief Read the value from a payload.
+     * @param [in] payload The payload built with the same layout the handle was obtained from.
+     * @return The value.
+     */
+    template <size_t N>
+    constexpr T get(const NimBLEAdvPayload<N>& payload) const {
+        static_assert(sizeof(T) <= N, "Field does not fit in payload");
+        return NimBLEAdvPayload<N>::template getValue<T>(&payload.m_data[m_offset]);
+    }
+
+    /**
+     * @brief Get the offset of the value in the payload.
+     */
+    constexpr size_t getOffset() const { return m_offset; }
+
+  private:
+    size_t m_offset;
+};
+
+/**
+ * @brief An advertisement payload laid out at compile time.
+ * @details Each add method returns a new, larger payload so a complete advertisement can be declared as a
+ * constexpr object and placed in flash. Handles to the values that change are found at compile time,
+ * a copy of the payload in RAM is then updated with byte stores and sent with
+ * NimBLEAdvertising::setAdvertisementData(const uint8_t*, size_t) or
+ * NimBLEExtAdvertising::updateInstanceData(uint8_t, const uint8_t*, size_t, bool).
+ * Requires C++14 or later, NimBLEDevice.h only includes it when the compiler supports it.
+ *
+ * Example:
+ * @code
+ * static constexpr auto beacon = NimBLEAdvPayload<>{}
+ *                                    .addFlags(BLE_HS_ADV_F_DISC_GEN | BLE_HS_ADV_F_BREDR_UNSUP)
+ *                                    .addName("Sensor")
+ *                                    .addServiceData16<int16_t>(0x181A, 0);
+ * static constexpr auto temperature = beacon.serviceDataValue<int16_t>(0x181A);
+ * static auto           payload     = beacon;
+ *
+ * temperature.set(payload, readTemperature());
+ * NimBLEDevice::getAdvertising()->setAdvertisementData(payload.data(), payload.size());
+ * @endcode
+ */
+template <size_t N = 0>
+class NimBLEAdvPayload {
+    static_assert(N <= NIMBLE_CPP_ADV_PAYLOAD_MAX, "Advertisement payload too large");
+
+  public:
+    constexpr NimBLEAdvPayload() : m_data{} {}
+
+    /**
+     * @brief Add the advertising flags.
+     * @param [in] flags The flags, BLE_HS_ADV_F_* values.
+     */
+    constexpr NimBLEAdvPayload<N + 3> addFlags(uint8_t flags) const {
+        const uint8_t field[] = {2, BLE_HS_ADV_TYPE_FLAGS, flags};
+        return append(field);
+    }
+
+    /**
+     * @brief Add the device name.
+     * @param [in] name The name as a string literal.
+     * @param [in] isComplete True for the complete name, false for a shortened name.
+     */
+    template <size_t L>
+    constexpr NimBLEAdvPayload<N + L + 1> addName(const char (&name)[L], bool isComplete = true) const {
+        uint8_t field[L + 1]{};
+        field[0] = L;
+        field[1] = isComplete ? BLE_HS_ADV_TYPE_COMP_NAME : BLE_HS_ADV_TYPE_INCOMP_NAME;
+        for (size_t i = 0; i < L - 1; i++) {
+            field[i + 2] = static_cast<uint8_t>(name[i]);
+        }
+        return append(field);
+    }
+
+    /**
+     * @brief Add the appearance.
+     * @param [in] appearance The appearance of the device.
+     */
+    constexpr NimBLEAdvPayload<N + 4> addAppearance(uint16_t appearance) const {
+        uint8_t field[4]{3, BLE_HS_ADV_TYPE_APPEARANCE};
+        putValue(&field[2], appearance);
+        return append(field);
+    }
+
+    /**
+     * @brief Add the transmission power level.
+     * @param [in] dbm The power level in dBm.
+     */
+    constexpr NimBLEAdvPayload<N + 3> addTxPower(int8_t dbm) const {
+        uint8_t field[3]{2, BLE_HS_ADV_TYPE_TX_PWR_LVL};
+        putValue(&field[2], dbm);
+        return append(field);
+    }
+
+    /**
+     * @brief Add a complete list of one 16 bit service UUID.
+     * @param [in] uuid The 16 bit service UUID.
+     */
+    constexpr NimBLEAdvPayload<N + 4> addServiceUUID16(uint16_t uuid) const {
+        uint8_t field[4]{3, BLE_HS_ADV_TYPE_COMP_UUIDS16};
+        putValue(&field[2], uuid);
+        return append(field);
+    }
+
+    /**
+     * @brief Add service data for a 16 bit service UUID.
+     * @tparam T The integer or enum type of the data, use serviceDataValue() to get a handle to it.
+     * @param [in] uuid The 16 bit service UUID.
+     * @param [in] value The initial value of the data.
+     */
+    template <typename T>
+    constexpr NimBLEAdvPayload<N + 4 + sizeof(T)> addServiceData16(uint16_t uuid, T value) const {
+        uint8_t field[4 + sizeof(T)]{3 + sizeof(T), BLE_HS_ADV_TYPE_SVC_DATA_UUID16};
+        putValue(&field[2], uuid);
+        putValue(&field[4], value);
+        return append(field);
+    }
+
+    /**
+     * @brief Add manufacturer data.
+     * @tparam T The integer or enum type of the data following the company identifier, use
+     * manufacturerValue() to get a handle to it.
+     * @param [in] companyId The company identifier.
+     * @param [in] value The initial value of the data.
+     */
+    template <typename T>
+    constexpr NimBLEAdvPayload<N + 4 + sizeof(T)> addManufacturerData(uint16_t companyId, T value) const {
+        uint8_t field[4 + sizeof(T)]{3 + sizeof(T), BLE_HS_ADV_TYPE_MFG_DATA};
+        putValue(&field[2], companyId);
+        putValue(&field[4], value);
+        return append(field);
+    }
+
+    /**
+     * @brief Add a field of any type.
+     * @param [in] type The advertisement data type, BLE_HS_ADV_TYPE_* values.
+     * @param [in] data The content of the field.
+     */
+    template <size_t L>
+    constexpr NimBLEAdvPayload<N + L + 2> addData(uint8_t type, const uint8_t (&data)[L]) const {
+        uint8_t field[L + 2]{L + 1, type};
+        for (size_t i = 0; i < L; i++) {
+            field[i + 2] = data[i];
+        }
+        return append(field);
+    }
+
+    /**
+     * @brief Get a handle to a value in a field.
+     * @tparam T The integer or enum type of the value.
+     * @param [in] type The advertisement data type of the field.
+     * @param [in] offset The offset of the value from the start of the field content.
+     * @param [in] index The occurrence of the field when the type is used more than once.
+     * @return The handle, evaluating this in a constant expression fails to compile if the field is not found.
+     */
+    template <typename T>
+    constexpr NimBLEAdvPayloadField<T> field(uint8_t type, size_t offset = 0, uint8_t index = 0) const {
+        for (size_t pos = 0; pos + 1 < N && m_data[pos] > 0; pos += m_data[pos] + 1) {
+            if (m_data[pos + 1] == type && index-- == 0) {
+                if (offset + sizeof(T) > m_data[pos] - 1u) {
+                    break;
+                }
+                return NimBLEAdvPayloadField<T>{pos + 2 + offset};
+            }
+        }
+
+        return fieldNotFound<T>();
+    }
+
+    /**
+     * @brief Get a handle to the value following the company identifier of the manufacturer data.
+     * @tparam T The type used with addManufacturerData().
+     */
+    template <typename T>
+    constexpr NimBLEAdvPayloadField<T> manufacturerValue() const {
+        return field<T>(BLE_HS_ADV_TYPE_MFG_DATA, 2);
+    }
+
+    /**
+     * @brief Get a handle to the service data of a 16 bit service UUID.
+     * @tparam T The type used with addServiceData16().
+     * @param [in] uuid The 16 bit service UUID.
+     */
+    template <typename T>
+    constexpr NimBLEAdvPayloadField<T> serviceDataValue(uint16_t uuid) const {
+        for (size_t pos = 0; pos + 1 < N && m_data[pos] > 0; pos += m_data[pos] + 1) {
+            if (m_data[pos + 1] == BLE_HS_ADV_TYPE_SVC_DATA_UUID16 && m_data[pos] >= 3 + sizeof(T) &&
+                getValue<uint16_t>(&m_data[pos + 2]) == uuid) {
+                return NimBLEAdvPayloadField<T>{pos + 4};
+            }
+        }
+
+        return fieldNotFound<T>();
+    }
+
+    /**
+     * @brief Get a pointer to the payload.
+     */
+    constexpr const uint8_t* data() const { return m_data; }
+
+    /**
+     * @brief Get the size of the payload.
+     */
+    static constexpr size_t size() { return N; }
+
+  private:
+    template <size_t>
+    friend class NimBLEAdvPayload;
+    template <typename>
+    friend class NimBLEAdvPayloadField;
+
+    template <size_t L>
+    constexpr NimBLEAdvPayload<N + L> append(const uint8_t (&field)[L]) const {
+        NimBLEAdvPayload<N + L> out{};
+        for (size_t i = 0; i < N; i++) {
+            out.m_data[i] = m_data[i];
+        }
+        for (size_t i = 0; i < L; i++) {
+            out.m_data[N + i] = field[i];
+        }
+        return out;
+    }
+
+    template <typename T>
+    static constexpr void putValue(uint8_t* dst, T value) {
+        static_assert(std::is_integral<T>::value || std::is_enum<T>::value, "Only integer and enum values supported");
+        uint64_t bits = static_cast<uint64_t>(value);
+        for (size_t i = 0; i < sizeof(T); i++) {
+            dst[i] = static_cast<uint8_t>(bits >> (8 * i));
+        }
+    }
+
+    template <typename T>
+    static constexpr T getValue(const uint8_t* src) {
+        static_assert(std::is_integral<T>::value || std::is_enum<T>::value, "Only integer and enum values supported");
+        uint64_t bits = 0;
+        for (size_t i = 0; i < sizeof(T); i++) {
+            bits |= static_cast<uint64_t>(src[i]) << (8 * i);
+        }
+        return static_cast<T>(bits);
+    }
+
+    // Not constexpr, so a lookup that fails during constant evaluation does not compile.
+    template <typename T>
+    static NimBLEAdvPayloadField<T> fieldNotFound() {
+        return NimBLEAdvPayloadField<T>{0};
+    }
+
+    uint8_t m_data[N > 0 ? N : 1];
+};
+
+#endif // CONFIG_BT_NIMBLE_ENABLED && MYNEWT_VAL(BLE_ROLE_BROADCASTER)
+#endif // NIMBLE_CPP_ADV_PAYLOAD_H_
@@ -23,9 +23,163 @@
 # include "NimBLELog.h"
 
 # include <climits>
+# include <cinttypes>
+# include <cstring>
 
 static const char* LOG_TAG = "NimBLEAdvertisedDevice";
 
+/**
+ * @brief Writes text, JSON or CBOR into a caller supplied buffer without allocating.
+ * @details Output that does not fit is counted but not written so the caller can find the size needed.
+ * CBOR maps and arrays are written with indefinite lengths so nothing has to be counted in advance.
+ */
+class NimBLEAdvWriter {
+  public:
+    NimBLEAdvWriter(uint8_t* buf, size_t len, bool cbor) : m_buf{buf}, m_len{len}, m_cbor{cbor} {}
+
+    void put(uint8_t c) {
+        if (m_pos < m_len) {
+            m_buf[m_pos] = c;
+        }
+        m_pos++;
+    }
+
+    void put(const void* data, size_t len) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < len; i++) {
+            put(bytes[i]);
+        }
+    }
+
+    void put(const char* str) { put(str, strlen(str)); }
+
+    void hex(const uint8_t* data, size_t len) {
+        constexpr char hexmap[] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'};
+        for (size_t i = 0; i < len; i++) {
+            put(hexmap[data[i] >> 4]);
+            put(hexmap[data[i] & 0x0F]);
+        }
+    }
+
+    void beginMap() { begin(0xbf, '{'); }
+    void endMap() { end(0xff, '}'); }
+    void beginArray() { begin(0x9f, '['); }
+    void endArray() { end(0xff, ']'); }
+
+    void key(const char* name) {
+        text(name, strlen(name));
+        if (!m_cbor) {
+            put(':');
+        }
+        m_comma = false;
+    }
+
+    void value(int32_t val) {
+        separate();
+        if (m_cbor) {
+            val < 0 ? head(1, -1 - val) : head(0, val);
+        } else {
+            char num[12];
+            put(num, snprintf(num, sizeof(num), "%" PRId32, val));
+        }
+        m_comma = true;
+    }
+
+    void text(const char* str, size_t len) {
+        separate();
+        if (m_cbor) {
+            head(3, len);
+            put(str, len);
+        } else {
+            put('"');
+            for (size_t i = 0; i < len; i++) {
+                uint8_t c = str[i];
+                if (c == '"' || c == '\\') {
+                    put('\\');
+                    put(c);
+                } else if (c < 0x20) {
+                    char esc[7];
+                    put(esc, snprintf(esc, sizeof(esc), "\\u%04x", c));
+                } else {
+                    put(c);
+                }
+            }
+            put('"');
+        }
+        m_comma = true;
+    }
+
+    void bytes(const uint8_t* data, size_t len) {
+        separate();
+        if (m_cbor) {
+            head(2, len);
+            put(data, len);
+        } else {
+            put('"');
+            hex(data, len);
+            put('"');
+        }
+        m_comma = true;
+    }
+
+    /**
+     * @brief Null terminate the text written so far, truncating it if the buffer is full.
+     * @return The length of the full output, excluding the null terminator.
+     */
+    size_t terminate() {
+        if (m_len > 0) {
+            m_buf[m_pos < m_len ? m_pos : m_len - 1] = '\0';
+        }
+        return m_pos;
+    }
+
+    size_t size() const { return m_pos; }
+
+  private:
+    void separate() {
+        if (!m_cbor && m_comma) {
+            put(',');
+        }
+    }
+
+    void begin(uint8_t cborByte, char jsonChar) {
+        separate();
+        put(m_cbor ? cborByte : jsonChar);
+        m_comma = false;
+    }
+
+    void end(uint8_t cborByte, char jsonChar) {
+        put(m_cbor ? cborByte : jsonChar);
+        m_comma = true;
+    }
+
+    void head(uint8_t major, uint32_t val) {
+        major <<= 5;
+        if (val < 24) {
+            put(major | val);
+        } else if (val <= UINT8_MAX) {
+            put(major | 24);
+            put(val);
+        } else if (val <= UINT16_MAX) {
+            put(major | 25);
+            put(val >> 8);
+            put(val);
+        } else {
+            put(major | 26);
+            put(val >> 24);
+            put(val >> 16);
+            put(val >> 8);
+            put(val);
+        }
+    }
+
+    uint8_t* m_buf;
+    size_t   m_len;
+    size_t   m_pos{0};
+    bool     m_cbor;
+    bool     m_comma{false};
+};
+
 /**
  * @brief Constructor
  * @param [in] event The advertisement event data.
@@ -710,44 +864,222 @@ uint8_t NimBLEAdvertisedDevice::findAdvField(uint8_t type, uint8_t index, size_t
  * @return A string representation of this device.
  */
 std::string NimBLEAdvertisedDevice::toString() const {
-    std::string res = "Name: " + getName() + ", Address: " + getAddress().toString();
+    std::string res;
+    res.resize(format(nullptr, 0));
+    format(&res[0], res.size() + 1);
+    return res;
+} // toString
+
+/**
+ * @brief Write the string representation of this device into a buffer without allocating.
+ * @param [in] buf The buffer to write to.
+ * @param [in] len The size of the buffer, the output is truncated and null terminated if it does not fit.
+ * @return The length of the full string, excluding the null terminator.
+ * @details Produces the same text as toString().
+ */
+size_t NimBLEAdvertisedDevice::format(char* buf, size_t len) const {
+    NimBLEAdvWriter w{reinterpret_cast<uint8_t*>(buf), len, false};
+    char            str[BLE_UUID_STR_LEN];
+    size_t          data_loc;
+
+    w.put("Name: ");
+    if (findAdvField(BLE_HS_ADV_TYPE_COMP_NAME, 0, &data_loc) > 0) {
+        const ble_hs_adv_field* field = reinterpret_cast<const ble_hs_adv_field*>(&m_payload[data_loc]);
+        if (field->length > 1) {
+            w.put(field->value, field->length - 1);
+        }
+    }
+
+    w.put(", Address: ");
+    w.put(str, m_address.format(str, sizeof(str)));
 
     if (haveAppearance()) {
-        char val[6];
-        snprintf(val, sizeof(val), "%d", getAppearance());
-        res += ", appearance: ";
-        res += val;
+        snprintf(str, sizeof(str), ", appearance: %d", getAppearance());
+        w.put(str);
     }
 
-    if (haveManufacturerData()) {
-        auto mfgData  = getManufacturerData();
-        res          += ", manufacturer data: ";
-        res += NimBLEUtils::dataToHexString(reinterpret_cast<const uint8_t*>(mfgData.data()), mfgData.length());
+    if (findAdvField(BLE_HS_ADV_TYPE_MFG_DATA, 0, &data_loc) > 0) {
+        const ble_hs_adv_field* field = reinterpret_cast<const ble_hs_adv_field*>(&m_payload[data_loc]);
+        w.put(", manufacturer data: ");
+        if (field->length > 1) {
+            w.hex(field->value, field->length - 1);
+        }
     }
 
     if (haveServiceUUID()) {
-        res += ", serviceUUID: " + getServiceUUID().toString();
+        w.put(", serviceUUID: ");
+        w.put(str, getServiceUUID().format(str, sizeof(str)));
     }
 
     if (haveTXPower()) {
-        char val[5];
-        snprintf(val, sizeof(val), "%d", getTXPower());
-        res += ", txPower: ";
-        res += val;
+        snprintf(str, sizeof(str), ", txPower: %d", getTXPower());
+        w.put(str);
     }
 
     if (haveServiceData()) {
-        uint8_t count  = getServiceDataCount();
-        res           += "\nService Data:";
+        uint8_t count = getServiceDataCount();
+        w.put("\nService Data:");
         for (uint8_t i = 0; i < count; i++) {
-            res += "\nUUID: " + std::string(getServiceDataUUID(i));
-            res += ", Data: " + getServiceData(i);
+            uint8_t bytes;
+            data_loc = findServiceData(i, &bytes);
+            if (data_loc == ULONG_MAX) {
+                break;
+            }
+
+            const ble_hs_adv_field* field = reinterpret_cast<const ble_hs_adv_field*>(&m_payload[data_loc]);
+            w.put("\nUUID: ");
+            if (field->length >= bytes) {
+                w.put(str, NimBLEUUID(field->value, bytes).format(str, sizeof(str)));
+            }
+
+            w.put(", Data: ");
+            if (field->length > bytes) {
+                w.put(field->value + bytes, field->length - bytes - 1);
+            }
         }
     }
 
-    return res;
+    return w.terminate();
+} // format
 
-} // toString
+/**
+ * @brief Serialize this device as a JSON object into a buffer without allocating.
+ * @param [in] buf The buffer to write to.
+ * @param [in] len The size of the buffer, the output is truncated and null terminated if it does not fit.
+ * @return The length of the full JSON text excluding the null terminator, if this is not less
+ * than len the output was truncated.
+ * @details The object has the members "address", "addressType", "advType" and "rssi" and, when advertised,
+ * "name", "txPower", "appearance", "manufacturerData" (array of hex strings), "serviceUUIDs" (array of strings)
+ * and "serviceData" (array of objects with "uuid" and "data" as a hex string).
+ */
+size_t NimBLEAdvertisedDevice::toJSON(char* buf, size_t len) const {
+    return serialize(reinterpret_cast<uint8_t*>(buf), len, false);
+} // toJSON
+
+/**
+ * @brief Serialize this device as a CBOR map into a buffer without allocating.
+ * @param [in] buf The buffer to write to.
+ * @param [in] len The size of the buffer.
+ * @return The length of the full CBOR encoding, if this is greater than len the output was truncated.
+ * @details The map has the same keys as toJSON() with binary data encoded as byte strings.
+ */
+size_t NimBLEAdvertisedDevice::toCBOR(uint8_t* buf, size_t len) const {
+    return serialize(buf, len, true);
+} // toCBOR
+
+/**
+ * @brief Serialize this device by walking the raw advertisement payload.
+ * @param [in] buf The buffer to write to.
+ * @param [in] len The size of the buffer.
+ * @param [in] cbor True to write CBOR, false to write null terminated JSON.
+ * @return The length of the full output, excluding the JSON null terminator.
+ */
+size_t NimBLEAdvertisedDevice::serialize(uint8_t* buf, size_t len, bool cbor) const {
+    NimBLEAdvWriter w{buf, len, cbor};
+    char            str[BLE_UUID_STR_LEN];
+    size_t          data_loc;
+
+    w.beginMap();
+    w.key("address");
+    w.text(str, m_address.format(str, sizeof(str)));
+    w.key("addressType");
+    w.value(m_address.getType());
+    w.key("advType");
+    w.value(m_advType);
+    w.key("rssi");
+    w.value(m_rssi);
+
+    if (findAdvField(BLE_HS_ADV_TYPE_COMP_NAME, 0, &data_loc) > 0) {
+        const ble_hs_adv_field* field = reinterpret_cast<const ble_hs_adv_field*>(&m_payload[data_loc]);
+        if (field->length > 1) {
+            w.key("name");
+            w.text(reinterpret_cast<const char*>(field->value), field->length - 1);
+        }
+    }
+
+    if (haveTXPower()) {
+        w.key("txPower");
+        w.value(getTXPower());
+    }
+
+    if (haveAppearance()) {
+        w.key("appearance");
+        w.value(getAppearance());
+    }
+
+    for (uint8_t group = 0; group < 3; group++) {
+        bool open = false;
+        for (size_t pos = 0; pos + 1 < m_payload.size() && m_payload[pos] > 0; pos += 1 + m_payload[pos]) {
+            if (pos + 1 + m_payload[pos] > m_payload.size()) {
+                break;
+            }
+
+            const ble_hs_adv_field* field = reinterpret_cast<const ble_hs_adv_field*>(&m_payload[pos]);
+            const uint8_t*          data  = field->value;
+            size_t                  size  = field->length - 1;
+            uint8_t                 bytes = 0;
+
+            if (group == 0 && field->type == BLE_HS_ADV_TYPE_MFG_DATA) {
+                if (!open) {
+                    w.key("manufacturerData");
+                    w.beginArray();
+                    open = true;
+                }
+                w.bytes(data, size);
+            } else if (group == 1 && field->type >= BLE_HS_ADV_TYPE_INCOMP_UUIDS16 &&
+                       field->type <= BLE_HS_ADV_TYPE_COMP_UUIDS128) {
+                bytes = field->type < BLE_HS_ADV_TYPE_INCOMP_UUIDS32    ? 2
+                        : field->type < BLE_HS_ADV_TYPE_INCOMP_UUIDS128 ? 4
+                                                                        : 16;
+                if (!open) {
+                    w.key("serviceUUIDs");
+                    w.beginArray();
+                    open = true;
+                }
+                for (size_t i = 0; i + bytes <= size; i += bytes) {
+                    w.text(str, NimBLEUUID(data + i, bytes).format(str, sizeof(str)));
+                }
+            } else if (group == 2) {
+                switch (field->type) {
+                    case BLE_HS_ADV_TYPE_SVC_DATA_UUID16:
+                        bytes = 2;
+                        break;
+                    case BLE_HS_ADV_TYPE_SVC_DATA_UUID32:
+                        bytes = 4;
+                        break;
+                    case BLE_HS_ADV_TYPE_SVC_DATA_UUID128:
+                        bytes = 16;
+                        break;
+                    default:
+                        continue;
+                }
+
+                if (size < bytes) {
+                    continue;
+                }
+
+                if (!open) {
+                    w.key("serviceData");
+                    w.beginArray();
+                    open = true;
+                }
+                w.beginMap();
+                w.key("uuid");
+                w.text(str, NimBLEUUID(data, bytes).format(str, sizeof(str)));
+                w.key("data");
+                w.bytes(data + bytes, size - bytes);
+                w.endMap();
+            }
+        }
+
+        if (open) {
+            w.endArray();
+        }
+    }
+
+    w.endMap();
+    return cbor ? w.size() : w.terminate();
+} // serialize
 
 /**
  * @brief Get the length of the advertisement data in the payload.
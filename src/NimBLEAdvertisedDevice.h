@@ -84,6 +84,9 @@ class NimBLEAdvertisedDevice {
     bool                 haveURI() const;
     bool                 haveType(uint16_t type) const;
     std::string          toString() const;
+    size_t               format(char* buf, size_t len) const;
+    size_t               toJSON(char* buf, size_t len) const;
+    size_t               toCBOR(uint8_t* buf, size_t len) const;
     bool                 isConnectable() const;
     bool                 isScannable() const;
     bool                 isLegacyAdvertisement() const;
@@ -157,6 +160,7 @@ class NimBLEAdvertisedDevice {
     void    update(const ble_gap_event* event, uint8_t eventType);
     uint8_t findAdvField(uint8_t type, uint8_t index = 0, size_t* data_loc = nullptr) const;
     size_t  findServiceData(uint8_t index, uint8_t* bytes) const;
+    size_t  serialize(uint8_t* buf, size_t len, bool cbor) const;
 
     NimBLEAddress           m_address{};
     uint8_t                 m_advType{};
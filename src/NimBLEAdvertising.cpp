@@ -41,8 +41,12 @@ NimBLEAdvertising::NimBLEAdvertising()
       m_advCompCb{nullptr},
       m_slaveItvl{0},
       m_duration{BLE_HS_FOREVER},
+      m_advDataHash{0},
+      m_scanDataHash{0},
       m_scanResp{false},
-      m_advDataSet{false} {
+      m_advDataSet{false},
+      m_advHashValid{false},
+      m_scanHashValid{false} {
 # if !MYNEWT_VAL(BLE_ROLE_PERIPHERAL)
     m_advParams.conn_mode = BLE_GAP_CONN_MODE_NON;
 # else
@@ -277,7 +281,9 @@ bool NimBLEAdvertising::isAdvertising() {
  * we need clear the flag so it reloads it.
  */
 void NimBLEAdvertising::onHostSync() {
-    m_advDataSet = false;
+    m_advDataSet    = false;
+    m_advHashValid  = false;
+    m_scanHashValid = false;
     // If we were advertising forever, restart it now
     if (m_duration == 0) {
         start(m_duration);
@@ -327,16 +333,42 @@ int NimBLEAdvertising::handleGapEvent(struct ble_gap_event* event, void* arg) {
  * @brief Set the advertisement data that is to be broadcast in a regular advertisement.
  * @param [in] data The data to be broadcast.
  * @return True if the data was set successfully.
+ * @details This can be called while advertising, the new data is used from the next advertising event
+ * without stopping the advertiser. Nothing is sent to the controller if the payload has not changed since it
+ * was last set.
  */
 bool NimBLEAdvertising::setAdvertisementData(const NimBLEAdvertisementData& data) {
-    int rc = ble_gap_adv_set_data(&data.getPayload()[0], data.getPayload().size());
-    if (rc != 0) {
-        NIMBLE_LOGE(LOG_TAG, "ble_gap_adv_set_data: %d %s", rc, NimBLEUtils::returnCodeToString(rc));
-        return false;
+    return setAdvertisementData(data.m_payload.data(), data.m_payload.size());
+} // setAdvertisementData
+
+/**
+ * @brief Set the advertisement data from a raw payload, such as one built with NimBLEAdvPayload.
+ * @param [in] data A pointer to the payload.
+ * @param [in] length The length of the payload.
+ * @return True if the data was set successfully.
+ * @details This can be called while advertising. Nothing is sent to the controller if the payload has not
+ * changed since it was last set.
+ */
+bool NimBLEAdvertising::setAdvertisementData(const uint8_t* data, size_t length) {
+    uint32_t hash = NimBLEUtils::dataHash(data, length);
+    if (!m_advHashValid || hash != m_advDataHash) {
+        int rc = ble_gap_adv_set_data(data, length);
+        if (rc != 0) {
+            NIMBLE_LOGE(LOG_TAG, "ble_gap_adv_set_data: %d %s", rc, NimBLEUtils::returnCodeToString(rc));
+            m_advHashValid = false;
+            return false;
+        }
+
+        m_advDataHash  = hash;
+        m_advHashValid = true;
+    }
+
+    // Keep a copy in the member object in case this is custom, the capacity is reused after the first call.
+    if (data != m_advData.m_payload.data()) {
+        m_advData.m_payload.assign(data, data + length);
+        NIMBLE_LOGD(LOG_TAG, "setAdvertisementData: %s", m_advData.toString().c_str());
     }
 
-    NIMBLE_LOGD(LOG_TAG, "setAdvertisementData: %s", data.toString().c_str());
-    m_advData    = data; // make a copy in the member object in case this is custom.
     m_advDataSet = true; // Set the flag that indicates the data was set already so we don't set it again.
     return true;
 } // setAdvertisementData
@@ -355,16 +387,40 @@ const NimBLEAdvertisementData& NimBLEAdvertising::getAdvertisementData() {
  * @return True if the data was set successfully.
  * @details The scan response data is sent in response to a scan request from a peer device.
  * If this is set without setting the advertisement data when advertising starts this may be overwritten.
+ * Like setAdvertisementData() this does not stop advertising and skips the controller if the payload is unchanged.
  */
 bool NimBLEAdvertising::setScanResponseData(const NimBLEAdvertisementData& data) {
-    int rc = ble_gap_adv_rsp_set_data(&data.getPayload()[0], data.getPayload().size());
-    if (rc != 0) {
-        NIMBLE_LOGE(LOG_TAG, "ble_gap_adv_rsp_set_data: %d %s", rc, NimBLEUtils::returnCodeToString(rc));
-        return false;
+    return setScanResponseData(data.m_payload.data(), data.m_payload.size());
+} // setScanResponseData
+
+/**
+ * @brief Set the scan response data from a raw payload, such as one built with NimBLEAdvPayload.
+ * @param [in] data A pointer to the payload.
+ * @param [in] length The length of the payload.
+ * @return True if the data was set successfully.
+ * @details This can be called while advertising. Nothing is sent to the controller if the payload has not
+ * changed since it was last set.
+ */
+bool NimBLEAdvertising::setScanResponseData(const uint8_t* data, size_t length) {
+    uint32_t hash = NimBLEUtils::dataHash(data, length);
+    if (!m_scanHashValid || hash != m_scanDataHash) {
+        int rc = ble_gap_adv_rsp_set_data(data, length);
+        if (rc != 0) {
+            NIMBLE_LOGE(LOG_TAG, "ble_gap_adv_rsp_set_data: %d %s", rc, NimBLEUtils::returnCodeToString(rc));
+            m_scanHashValid = false;
+            return false;
+        }
+
+        m_scanDataHash  = hash;
+        m_scanHashValid = true;
+    }
+
+    // Copy the data into the member object in case this is custom.
+    if (data != m_scanData.m_payload.data()) {
+        m_scanData.m_payload.assign(data, data + length);
+        NIMBLE_LOGD(LOG_TAG, "setScanResponseData: %s", m_scanData.toString().c_str());
     }
 
-    NIMBLE_LOGD(LOG_TAG, "setScanResponseData: %s", data.toString().c_str());
-    m_scanData = data; // copy the data into the member object in case this is custom.
     return true;
 } // setScanResponseData
 
@@ -391,12 +447,13 @@ void NimBLEAdvertising::clearData() {
  * For instance allows refreshing manufacturer data dynamically.
  *
  * @return True if the data was set successfully.
- * @details If scan response is enabled it will be refreshed as well.
+ * @details If scan response is enabled it will be refreshed as well. Only the payloads that changed since
+ * they were last sent are passed to the controller, so this can be called after every change to the data.
  */
 bool NimBLEAdvertising::refreshAdvertisingData() {
     bool success = setAdvertisementData(m_advData);
     if (m_scanResp) {
-        success = setScanResponseData(m_scanData);
+        success = setScanResponseData(m_scanData) && success;
     }
 
     return success;
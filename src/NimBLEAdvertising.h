@@ -66,6 +66,8 @@ class NimBLEAdvertising {
 
     bool                           setAdvertisementData(const NimBLEAdvertisementData& advertisementData);
     bool                           setScanResponseData(const NimBLEAdvertisementData& advertisementData);
+    bool                           setAdvertisementData(const uint8_t* data, size_t length);
+    bool                           setScanResponseData(const uint8_t* data, size_t length);
     const NimBLEAdvertisementData& getAdvertisementData();
     const NimBLEAdvertisementData& getScanData();
     void                           clearData();
@@ -101,8 +103,12 @@ class NimBLEAdvertising {
     advCompleteCB_t         m_advCompCb;
     uint8_t                 m_slaveItvl[4];
     uint32_t                m_duration;
+    uint32_t                m_advDataHash;
+    uint32_t                m_scanDataHash;
     bool                    m_scanResp : 1;
     bool                    m_advDataSet : 1;
+    bool                    m_advHashValid : 1;
+    bool                    m_scanHashValid : 1;
 };
 
 #endif // (CONFIG_BT_NIMBLE_ENABLED && MYNEWT_VAL(BLE_ROLE_BROADCASTER) && !MYNEWT_VAL(BLE_EXT_ADV)) || defined(_DOXYGEN_)
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2020-2025 Ryan Powell <ryan@nable-embedded.io> and
+ * esp-nimble-cpp, NimBLE-Arduino contributors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NIMBLE_CPP_ATTRIBUTE_INDEX_H_
+#define NIMBLE_CPP_ATTRIBUTE_INDEX_H_
+
+#include "syscfg/syscfg.h"
+#if CONFIG_BT_NIMBLE_ENABLED && (MYNEWT_VAL(BLE_ROLE_PERIPHERAL) || MYNEWT_VAL(BLE_ROLE_CENTRAL))
+
+# include "NimBLEUUID.h"
+# include <vector>
+
+/**
+ * @brief A hashed index from UUID and instance to the attributes held in a vector.
+ * @details The index is an open addressing table of positions in the vector, it does not own the
+ * attributes and must be updated whenever the vector changes. Entries are inserted in vector order so
+ * the Nth match along a probe sequence is the Nth attribute with that UUID in the vector.
+ *
+ * Vectors with fewer than NIMBLE_CPP_ATT_HASH_INDEX attributes are not indexed and are searched linearly,
+ * setting it to 0 disables the index.
+ */
+template <typename T>
+class NimBLEAttributeIndex {
+  public:
+    /**
+     * @brief Rebuild the index, call after any change to the vector.
+     * @param [in] vec The vector of attributes to index.
+     */
+    void update(const std::vector<T*>& vec) {
+# if MYNEWT_VAL(NIMBLE_CPP_ATT_HASH_INDEX)
+        if (vec.size() < MYNEWT_VAL(NIMBLE_CPP_ATT_HASH_INDEX) || vec.size() >= UINT16_MAX) {
+            std::vector<uint16_t>{}.swap(m_slots);
+            return;
+        }
+
+        // At most half full so probe sequences stay short.
+        size_t size = 4;
+        while (size < vec.size() * 2) {
+            size <<= 1;
+        }
+
+        m_slots.assign(size, 0);
+        const size_t mask = size - 1;
+        for (size_t i = 0; i < vec.size(); i++) {
+            size_t slot = vec[i]->getUUID().hash() & mask;
+            while (m_slots[slot] != 0) {
+                slot = (slot + 1) & mask;
+            }
+            m_slots[slot] = static_cast<uint16_t>(i + 1);
+        }
+# endif
+    }
+
+    /**
+     * @brief Find an attribute.
+     * @param [in] vec The vector of attributes the index was last updated with.
+     * @param [in] uuid The UUID of the attribute.
+     * @param [in] instance The index of the attribute to return when several have the same UUID.
+     * @return A pointer to the attribute or nullptr if not found.
+     */
+    T* find(const std::vector<T*>& vec, const NimBLEUUID& uuid, uint16_t instance = 0) const {
+        uint16_t position = 0;
+# if MYNEWT_VAL(NIMBLE_CPP_ATT_HASH_INDEX)
+        if (!m_slots.empty()) {
+            const size_t mask = m_slots.size() - 1;
+            for (size_t slot = uuid.hash() & mask; m_slots[slot] != 0; slot = (slot + 1) & mask) {
+                if (m_slots[slot] > vec.size()) {
+                    continue; // stale index, the vector changed without an update
+                }
+
+                T* attr = vec[m_slots[slot] - 1];
+                if (attr->getUUID() == uuid) {
+                    if (position == instance) {
+                        return attr;
+                    }
+                    position++;
+                }
+            }
+            return nullptr;
+        }
+# endif
+
+        for (const auto& attr : vec) {
+            if (attr->getUUID() == uuid) {
+                if (position == instance) {
+                    return attr;
+                }
+                position++;
+            }
+        }
+
+        return nullptr;
+    }
+
+  private:
+# if MYNEWT_VAL(NIMBLE_CPP_ATT_HASH_INDEX)
+    std::vector<uint16_t> m_slots{};
+# endif
+};
+
+#endif // CONFIG_BT_NIMBLE_ENABLED && (MYNEWT_VAL(BLE_ROLE_PERIPHERAL) || MYNEWT_VAL(BLE_ROLE_CENTRAL))
+#endif // NIMBLE_CPP_ATTRIBUTE_INDEX_H_
@@ -16,11 +16,19 @@
  */
 
 #include "NimBLEBeacon.h"
-#if CONFIG_BT_NIMBLE_ENABLED && MYNEWT_VAL(BLE_ROLE_BROADCASTER)
+#if CONFIG_BT_NIMBLE_ENABLED && (MYNEWT_VAL(BLE_ROLE_BROADCASTER) || MYNEWT_VAL(BLE_ROLE_OBSERVER))
 
 # include "NimBLEUUID.h"
 # include "NimBLELog.h"
 
+# ifdef USING_NIMBLE_ARDUINO_HEADERS
+#  include "nimble/nimble/host/include/host/ble_hs_adv.h"
+# else
+#  include "host/ble_hs_adv.h"
+# endif
+
+# include <cstring>
+
 # define ENDIAN_CHANGE_U16(x) ((((x) & 0xFF00) >> 8) + (((x) & 0xFF) << 8))
 
 static const char* LOG_TAG = "NimBLEBeacon";
@@ -94,6 +102,35 @@ void NimBLEBeacon::setData(const NimBLEBeacon::BeaconData& data) {
     m_beaconData = data;
 } // setData
 
+/**
+ * @brief Decode an iBeacon frame directly from a raw advertising payload.
+ * @param [in] payload A pointer to the advertising payload (AD structures).
+ * @param [in] length The length of the payload.
+ * @param [out] data A pointer to a BeaconData struct to receive the frame, in the same format as setData().
+ * @return True if the payload contains an iBeacon frame.
+ * @details This does not allocate, it can be used on the raw data of a scan report.
+ */
+bool NimBLEBeacon::decode(const uint8_t* payload, size_t length, BeaconData* data) {
+    size_t pos = 0;
+    while (pos + 1 < length) {
+        const uint8_t fieldLen = payload[pos];
+        if (fieldLen == 0 || pos + 1 + fieldLen > length) {
+            break;
+        }
+
+        const uint8_t* field = &payload[pos + 1];
+        if (field[0] == BLE_HS_ADV_TYPE_MFG_DATA && fieldLen - 1 == sizeof(BeaconData) && field[1] == 0x4C &&
+            field[2] == 0x00 && field[3] == 0x02 && field[4] == 0x15) {
+            memcpy(data, field + 1, sizeof(BeaconData));
+            return true;
+        }
+
+        pos += fieldLen + 1;
+    }
+
+    return false;
+} // decode
+
 /**
  * @brief Set the major value.
  * @param [in] major The major value.
@@ -137,4 +174,4 @@ void NimBLEBeacon::setSignalPower(int8_t signalPower) {
     m_beaconData.signalPower = signalPower;
 } // setSignalPower
 
-#endif // CONFIG_BT_NIMBLE_ENABLED && MYNEWT_VAL(BLE_ROLE_BROADCASTER)
+#endif // CONFIG_BT_NIMBLE_ENABLED && (MYNEWT_VAL(BLE_ROLE_BROADCASTER) || MYNEWT_VAL(BLE_ROLE_OBSERVER))
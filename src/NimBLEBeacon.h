@@ -19,11 +19,12 @@
 #define NIMBLE_CPP_BEACON_H_
 
 #include "syscfg/syscfg.h"
-#if CONFIG_BT_NIMBLE_ENABLED && MYNEWT_VAL(BLE_ROLE_BROADCASTER)
+#if CONFIG_BT_NIMBLE_ENABLED && (MYNEWT_VAL(BLE_ROLE_BROADCASTER) || MYNEWT_VAL(BLE_ROLE_OBSERVER))
 
 class NimBLEUUID;
 
 # include <cstdint>
+# include <cstddef>
 # include <vector>
 
 /**
@@ -61,9 +62,11 @@ class NimBLEBeacon {
     void              setProximityUUID(const NimBLEUUID& uuid);
     void              setSignalPower(int8_t signalPower);
 
+    static bool decode(const uint8_t* payload, size_t length, BeaconData* data);
+
   private:
     BeaconData m_beaconData;
 }; // NimBLEBeacon
 
-#endif // CONFIG_BT_NIMBLE_ENABLED && MYNEWT_VAL(BLE_ROLE_PERIPHERAL)
+#endif // CONFIG_BT_NIMBLE_ENABLED && (MYNEWT_VAL(BLE_ROLE_BROADCASTER) || MYNEWT_VAL(BLE_ROLE_OBSERVER))
 #endif // NIMBLE_CPP_BEACON_H_
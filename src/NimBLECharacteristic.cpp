@@ -129,6 +129,7 @@ void NimBLECharacteristic::addDescriptor(NimBLEDescriptor* pDescriptor) {
 
     if (!foundRemoved) {
         m_vDescriptors.push_back(pDescriptor);
+        m_dscIndex.update(m_vDescriptors);
     }
 
     pDescriptor->setCharacteristic(this);
@@ -150,6 +151,7 @@ void NimBLECharacteristic::removeDescriptor(NimBLEDescriptor* pDescriptor, bool
                 if ((*it) == pDescriptor) {
                     delete (*it);
                     m_vDescriptors.erase(it);
+                    m_dscIndex.update(m_vDescriptors);
                     break;
                 }
             }
@@ -179,16 +181,7 @@ NimBLEDescriptor* NimBLECharacteristic::getDescriptorByUUID(const char* uuid, ui
  * @return A pointer to the descriptor object or nullptr if not found.
  */
 NimBLEDescriptor* NimBLECharacteristic::getDescriptorByUUID(const NimBLEUUID& uuid, uint16_t index) const {
-    uint16_t position = 0;
-    for (const auto& dsc : m_vDescriptors) {
-        if (dsc->getUUID() == uuid) {
-            if (position == index) {
-                return dsc;
-            }
-            position++;
-        }
-    }
-    return nullptr;
+    return m_dscIndex.find(m_vDescriptors, uuid, index);
 } // getDescriptorByUUID
 
 /**
@@ -307,6 +300,16 @@ bool NimBLECharacteristic::sendValue(const uint8_t* value, size_t length, bool i
             om = ble_hs_mbuf_from_flat(value, length);
         }
 
+# if MYNEWT_VAL(BLE_HS_CONN_STATS)
+        if (retries < 10) {
+            ble_hs_conn_stats_notify_retry(ch);
+        }
+
+        if (!om && isNotification) {
+            ble_hs_conn_stats_notify_drop(ch);
+        }
+# endif
+
         if (!om) {
             rc = BLE_HS_ENOMEM;
             break;
@@ -28,6 +28,7 @@ class NimBLEDescriptor;
 class NimBLE2904;
 
 # include "NimBLELocalValueAttribute.h"
+# include "NimBLEAttributeIndex.h"
 
 # include <string>
 # include <vector>
@@ -301,10 +302,11 @@ class NimBLECharacteristic : public NimBLELocalValueAttribute {
     void         processSubRequest(NimBLEConnInfo& connInfo, uint8_t subVal) const;
     void         updatePeerStatus(const NimBLEConnInfo& peerInfo) const;
 
-    NimBLECharacteristicCallbacks* m_pCallbacks{nullptr};
-    NimBLEService*                 m_pService{nullptr};
-    std::vector<NimBLEDescriptor*> m_vDescriptors{};
-    mutable SubPeerArray           m_subPeers{};
+    NimBLECharacteristicCallbacks*         m_pCallbacks{nullptr};
+    NimBLEService*                         m_pService{nullptr};
+    std::vector<NimBLEDescriptor*>         m_vDescriptors{};
+    NimBLEAttributeIndex<NimBLEDescriptor> m_dscIndex{};
+    mutable SubPeerArray                   m_subPeers{};
 }; // NimBLECharacteristic
 
 /**
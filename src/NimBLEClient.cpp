@@ -120,6 +120,7 @@ void NimBLEClient::deleteServices() {
     }
 
     std::vector<NimBLERemoteService*>().swap(m_svcVec);
+    m_svcIndex.update(m_svcVec);
 } // deleteServices
 
 /**
@@ -133,6 +134,7 @@ size_t NimBLEClient::deleteService(const NimBLEUUID& uuid) {
         if ((*it)->getUUID() == uuid) {
             delete *it;
             m_svcVec.erase(it);
+            m_svcIndex.update(m_svcVec);
             break;
         }
     }
@@ -670,11 +672,10 @@ NimBLERemoteService* NimBLEClient::getService(const char* uuid) {
 NimBLERemoteService* NimBLEClient::getService(const NimBLEUUID& uuid) {
     NIMBLE_LOGD(LOG_TAG, ">> getService: uuid: %s", uuid.toString().c_str());
 
-    for (auto& it : m_svcVec) {
-        if (it->getUUID() == uuid) {
-            NIMBLE_LOGD(LOG_TAG, "<< getService: found the service with uuid: %s", uuid.toString().c_str());
-            return it;
-        }
+    NimBLERemoteService* pSvc = m_svcIndex.find(m_svcVec, uuid);
+    if (pSvc != nullptr) {
+        NIMBLE_LOGD(LOG_TAG, "<< getService: found the service with uuid: %s", uuid.toString().c_str());
+        return pSvc;
     }
 
     size_t prevSize = m_svcVec.size();
@@ -814,6 +815,7 @@ int NimBLEClient::serviceDiscoveredCB(uint16_t                     connHandle,
 
     if (error->status == BLE_HS_ENOTCONN) {
         NIMBLE_LOGE(LOG_TAG, "<< Service Discovered; Disconnected");
+        pClient->m_svcIndex.update(pClient->m_svcVec);
         NimBLEUtils::taskRelease(*pTaskData, error->status);
         return error->status;
     }
@@ -825,10 +827,12 @@ int NimBLEClient::serviceDiscoveredCB(uint16_t                     connHandle,
 
     if (error->status == 0) {
         // Found a service - add it to the vector
+        // The index is rebuilt once when discovery completes.
         pClient->m_svcVec.push_back(new NimBLERemoteService(pClient, service));
         return 0;
     }
 
+    pClient->m_svcIndex.update(pClient->m_svcVec);
     NimBLEUtils::taskRelease(*pTaskData, error->status);
     NIMBLE_LOGD(LOG_TAG, "<< Service Discovered");
     return error->status;
@@ -897,11 +901,7 @@ bool NimBLEClient::setValue(const NimBLEUUID&     serviceUUID,
 NimBLERemoteCharacteristic* NimBLEClient::getCharacteristic(uint16_t handle) {
     for (const auto& svc : m_svcVec) {
         if (svc->getStartHandle() <= handle && handle <= svc->getEndHandle()) {
-            for (const auto& chr : svc->m_vChars) {
-                if (chr->getHandle() == handle) {
-                    return chr;
-                }
-            }
+            return svc->getCharacteristicByHandle(handle);
         }
     }
 
@@ -1061,7 +1061,7 @@ int NimBLEClient::handleGapEvent(struct ble_gap_event* event, void* arg) {
 
             const int connEstablishFailReason = BLE_HS_HCI_ERR(BLE_ERR_CONN_ESTABLISHMENT);
             if (rc == connEstablishFailReason && pClient->m_connectFailRetryCount < pClient->m_config.connectFailRetries) {
-                pClient->m_connHandle = BLE_HS_CONN_HANDLE_NONE;
+                NimBLEDevice::setClientConnHandle(pClient, BLE_HS_CONN_HANDLE_NONE);
                 ++pClient->m_connectFailRetryCount;
                 pClient->m_connStatus = CONNECTING;
                 NIMBLE_LOGW(LOG_TAG,
@@ -1084,7 +1084,7 @@ int NimBLEClient::handleGapEvent(struct ble_gap_event* event, void* arg) {
                 pClient->m_pClientCallbacks->onDisconnect(pClient, rc);
             }
 
-            pClient->m_connHandle = BLE_HS_CONN_HANDLE_NONE;
+            NimBLEDevice::setClientConnHandle(pClient, BLE_HS_CONN_HANDLE_NONE);
             pClient->m_connStatus = DISCONNECTED;
 
             if (pClient->m_config.deleteOnDisconnect ||
@@ -1115,8 +1115,8 @@ int NimBLEClient::handleGapEvent(struct ble_gap_event* event, void* arg) {
 
             if (rc == 0) {
                 pClient->m_connStatus             = CONNECTED;
-                pClient->m_connHandle             = event->connect.conn_handle;
                 pClient->m_connectCallbackPending = true;
+                NimBLEDevice::setClientConnHandle(pClient, event->connect.conn_handle);
 
                 ble_gap_conn_desc desc;
                 if (ble_gap_conn_find(event->connect.conn_handle, &desc) == 0) {
@@ -1133,8 +1133,8 @@ int NimBLEClient::handleGapEvent(struct ble_gap_event* event, void* arg) {
                 return 0;
             } else {
                 pClient->m_connStatus             = DISCONNECTED;
-                pClient->m_connHandle             = BLE_HS_CONN_HANDLE_NONE;
                 pClient->m_connectCallbackPending = false;
+                NimBLEDevice::setClientConnHandle(pClient, BLE_HS_CONN_HANDLE_NONE);
                 ble_npl_callout_stop(&pClient->m_connectEstablishedTimer);
 
                 if (pClient->m_config.asyncConnect) {
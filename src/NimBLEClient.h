@@ -29,6 +29,7 @@
 
 # include "NimBLEAddress.h"
 # include "NimBLEUtils.h"
+# include "NimBLEAttributeIndex.h"
 
 # include <stdint.h>
 # include <vector>
@@ -152,20 +153,21 @@ class NimBLEClient {
                                     const struct ble_gatt_svc*   service,
                                     void*                        arg);
 
-    NimBLEAddress                     m_peerAddress;
-    mutable int                       m_lastErr;
-    int32_t                           m_connectTimeout;
-    mutable NimBLEUtils::TaskData*    m_pTaskData;
-    std::vector<NimBLERemoteService*> m_svcVec;
-    NimBLEClientCallbacks*            m_pClientCallbacks;
-    uint16_t                          m_connHandle;
-    uint8_t                           m_terminateFailCount;
-    mutable uint8_t                   m_asyncSecureAttempt;
-    Config                            m_config;
-    ConnStatus                        m_connStatus;
-    ble_npl_callout                   m_connectEstablishedTimer{};
-    bool                              m_connectCallbackPending;
-    uint8_t                           m_connectFailRetryCount;
+    NimBLEAddress                             m_peerAddress;
+    mutable int                               m_lastErr;
+    int32_t                                   m_connectTimeout;
+    mutable NimBLEUtils::TaskData*            m_pTaskData;
+    std::vector<NimBLERemoteService*>         m_svcVec;
+    NimBLEAttributeIndex<NimBLERemoteService> m_svcIndex{};
+    NimBLEClientCallbacks*                    m_pClientCallbacks;
+    uint16_t                                  m_connHandle;
+    uint8_t                                   m_terminateFailCount;
+    mutable uint8_t                           m_asyncSecureAttempt;
+    Config                                    m_config;
+    ConnStatus                                m_connStatus;
+    ble_npl_callout                           m_connectEstablishedTimer{};
+    bool                                      m_connectCallbackPending;
+    uint8_t                                   m_connectFailRetryCount;
 
 # if MYNEWT_VAL(BLE_EXT_ADV)
     uint8_t m_phyMask;
@@ -20,6 +20,7 @@
 
 #ifdef USING_NIMBLE_ARDUINO_HEADERS
 # include "nimble/nimble/host/include/host/ble_gap.h"
+# include "nimble/nimble/host/include/host/ble_hs_conn_stats.h"
 #else
 # include "host/ble_gap.h"
 #endif
@@ -71,6 +72,28 @@ class NimBLEConnInfo {
     /** @brief Gets the key size used to encrypt the connection */
     uint8_t getSecKeySize() const { return m_desc.sec_state.key_size; }
 
+#if MYNEWT_VAL(BLE_HS_CONN_STATS)
+    /**
+     * @brief Get the traffic and latency counters of this connection.
+     * @param [out] stats The counters are written here.
+     * @return True on success, false if the connection is no longer open.
+     */
+    bool getStats(ble_hs_conn_stats* stats) const { return getStats(m_desc.conn_handle, stats); }
+
+    /** @brief Clear the traffic and latency counters of this connection, returns false if it is no longer open */
+    bool resetStats() const { return ble_hs_conn_stats_reset(m_desc.conn_handle) == 0; }
+
+    /**
+     * @brief Get the traffic and latency counters of any open connection.
+     * @param [in] connHandle The connection handle.
+     * @param [out] stats The counters are written here.
+     * @return True on success, false if the connection is not open.
+     */
+    static bool getStats(uint16_t connHandle, ble_hs_conn_stats* stats) {
+        return ble_hs_conn_stats_get(connHandle, stats) == 0;
+    }
+#endif
+
     /** @brief Get a string representation of the connection info, useful for debugging */
     std::string toString() const {
         std::string str;
@@ -61,9 +61,17 @@
 
 # include "NimBLELog.h"
 
+# if MYNEWT_VAL(NIMBLE_CPP_AIRTIME_BUDGET)
+#  include <algorithm>
+# endif
+
 static const char* LOG_TAG = "NimBLEDevice";
 
 extern "C" void ble_store_config_init(void);
+# ifdef USING_NIMBLE_ARDUINO_HEADERS
+extern "C" int  ble_store_config_flush(void);
+extern "C" void ble_store_config_deinit(void);
+# endif
 
 /**
  * Singletons for the NimBLEDevice.
@@ -91,12 +99,14 @@ NimBLEAdvertising* NimBLEDevice::m_bleAdvertising = nullptr;
 # endif
 
 # if MYNEWT_VAL(BLE_ROLE_CENTRAL)
-std::array<NimBLEClient*, MYNEWT_VAL(BLE_MAX_CONNECTIONS)> NimBLEDevice::m_pClients{};
+std::array<NimBLEClient*, MYNEWT_VAL(BLE_MAX_CONNECTIONS)>     NimBLEDevice::m_pClients{};
+std::array<NimBLEClient*, MYNEWT_VAL(BLE_MAX_CONNECTIONS) + 1> NimBLEDevice::m_pClientsByHandle{};
 # endif
 
 bool                       NimBLEDevice::m_initialized{false};
 uint32_t                   NimBLEDevice::m_passkey{123456};
 bool                       NimBLEDevice::m_synced{false};
+void*                      NimBLEDevice::m_hostTask{nullptr};
 ble_gap_event_listener     NimBLEDevice::m_listener{};
 std::vector<NimBLEAddress> NimBLEDevice::m_whiteList{};
 uint8_t                    NimBLEDevice::m_ownAddrType{BLE_OWN_ADDR_PUBLIC};
@@ -113,6 +123,13 @@ extern "C" int ble_vhci_disc_duplicate_mode_enable(int mode);
 #  endif
 # endif
 
+# if MYNEWT_VAL(NIMBLE_CPP_AIRTIME_BUDGET)
+NimBLEDevice::AirtimeBudget NimBLEDevice::m_airtimeBudget{};
+NimBLEDevice::AirtimeParams NimBLEDevice::m_airtimeParams{};
+ble_npl_callout             NimBLEDevice::m_airtimeTimer{};
+bool                        NimBLEDevice::m_airtimeTimerInitialized{false};
+# endif
+
 /* -------------------------------------------------------------------------- */
 /*                              SERVER FUNCTIONS                              */
 /* -------------------------------------------------------------------------- */
@@ -373,6 +390,7 @@ bool NimBLEDevice::deleteClient(NimBLEClient* pClient) {
                     break;
                 }
             } else {
+                setClientConnHandle(clt, BLE_HS_CONN_HANDLE_NONE);
                 delete clt;
                 clt = nullptr;
             }
@@ -405,6 +423,14 @@ size_t NimBLEDevice::getCreatedClientCount() {
  * @return A pointer to the client object with the specified connection handle or nullptr.
  */
 NimBLEClient* NimBLEDevice::getClientByHandle(uint16_t connHandle) {
+    if (connHandle != BLE_HS_CONN_HANDLE_NONE) {
+        NimBLEClient* pClient = m_pClientsByHandle[connHandle % m_pClientsByHandle.size()];
+        if (pClient == nullptr || pClient->m_connHandle == connHandle) {
+            return pClient;
+        }
+    }
+
+    // Slot shared with another handle, fall back to a scan.
     for (const auto clt : m_pClients) {
         if (clt != nullptr && clt->getConnHandle() == connHandle) {
             return clt;
@@ -414,6 +440,38 @@ NimBLEClient* NimBLEDevice::getClientByHandle(uint16_t connHandle) {
     return nullptr;
 } // getClientByHandle
 
+/**
+ * @brief Set the connection handle of a client and keep the handle lookup table up to date.
+ * @param [in] pClient A pointer to the client object.
+ * @param [in] connHandle The new connection handle, BLE_HS_CONN_HANDLE_NONE when disconnected.
+ * @details Controllers assign connection handles starting from 0 or 1 so indexing the table by the handle
+ * modulo one more than the maximum number of connections gives each connection its own slot.
+ * When a slot is already in use the client is found by the scan in getClientByHandle.
+ */
+void NimBLEDevice::setClientConnHandle(NimBLEClient* pClient, uint16_t connHandle) {
+    const size_t tblSize = m_pClientsByHandle.size();
+
+    if (pClient->m_connHandle != BLE_HS_CONN_HANDLE_NONE) {
+        const size_t oldSlot = pClient->m_connHandle % tblSize;
+        if (m_pClientsByHandle[oldSlot] == pClient) {
+            m_pClientsByHandle[oldSlot] = nullptr;
+            for (const auto clt : m_pClients) {
+                if (clt != nullptr && clt != pClient && clt->m_connHandle != BLE_HS_CONN_HANDLE_NONE &&
+                    clt->m_connHandle % tblSize == oldSlot) {
+                    m_pClientsByHandle[oldSlot] = clt;
+                    break;
+                }
+            }
+        }
+    }
+
+    pClient->m_connHandle = connHandle;
+
+    if (connHandle != BLE_HS_CONN_HANDLE_NONE && m_pClientsByHandle[connHandle % tblSize] == nullptr) {
+        m_pClientsByHandle[connHandle % tblSize] = pClient;
+    }
+} // setClientConnHandle
+
 /**
  * @brief Get a reference to a client by peer address.
  * @param [in] addr The address of the peer to search for.
@@ -650,7 +708,15 @@ bool NimBLEDevice::deleteAllBonds() {
  * @returns True on success.
  */
 bool NimBLEDevice::deleteBond(const NimBLEAddress& address) {
-    return ble_gap_unpair(address.getBase()) == 0;
+    if (ble_gap_unpair(address.getBase()) != 0) {
+        return false;
+    }
+
+#  ifdef USING_NIMBLE_ARDUINO_HEADERS
+    // Commit the deleted subscriptions now rather than waiting for the store flush timer.
+    ble_store_config_flush();
+#  endif
+    return true;
 }
 
 /**
@@ -815,6 +881,397 @@ bool NimBLEDevice::setDefaultPhy(uint8_t txPhyMask, uint8_t rxPhyMask) {
     return rc == 0;
 }
 
+# if MYNEWT_VAL(OS_MEMPOOL_STATS)
+/**
+ * @brief Get the usage statistics of the host memory pools.
+ * @return A vector with the statistics of each mbuf, transport and L2CAP pool.
+ * @details The occupancy is sampled every OS_MEMPOOL_STATS_SAMPLE_MS milliseconds while the host is running
+ * and is averaged over the samples taken since the last call to resetMemPoolStats().
+ */
+std::vector<NimBLEDevice::MemPoolStats> NimBLEDevice::getMemPoolStats() {
+    std::vector<MemPoolStats> poolStats;
+    os_mempool_stats          stats;
+
+    for (int i = 0; os_mempool_stats_get(i, &stats) == 0; i++) {
+        MemPoolStats ps;
+        ps.name          = stats.oms_name;
+        ps.blockSize     = stats.oms_block_size;
+        ps.total         = stats.oms_num_blocks;
+        ps.free          = stats.oms_num_free;
+        ps.minFree       = stats.oms_min_free;
+        ps.allocFailures = stats.oms_alloc_fail;
+        if (stats.oms_samples > 0 && stats.oms_num_blocks > 0) {
+            ps.avgOccupancy =
+                static_cast<float>(stats.oms_used_sum) / stats.oms_samples / stats.oms_num_blocks;
+        }
+
+        poolStats.push_back(ps);
+    }
+
+    return poolStats;
+} // getMemPoolStats
+
+/**
+ * @brief Reset the allocation failure counts, minimum free block counts and occupancy averages of the host memory pools.
+ */
+void NimBLEDevice::resetMemPoolStats() {
+    os_mempool_stats_reset();
+} // resetMemPoolStats
+# endif
+
+# if MYNEWT_VAL(NIMBLE_CPP_AIRTIME_BUDGET)
+/*
+ * Airtime model for the 1M PHY without data length extension, each packet costs its bytes on air
+ * plus the empty acknowledgement and two inter frame spaces.
+ */
+static constexpr uint32_t airtimePktsPerEvent = 4;    // packets expected in each connection event
+static constexpr uint32_t airtimeAdvEventUs   = 1500; // three advertising PDUs and a scan response
+static constexpr uint32_t airtimeGuardUs      = 1250; // left free before the next connection event
+static constexpr uint32_t airtimeMarginPermil = 100;  // never scheduled, absorbs retransmissions
+static constexpr uint8_t  airtimeMaxBackoff   = 3;    // maximum number of times the scan duty is halved
+
+/**
+ * @brief Airtime coordinator state of a connection.
+ */
+struct NimBLEAirtimeConn {
+    uint16_t connHandle{BLE_HS_CONN_HANDLE_NONE};
+    uint16_t interval{0}; // last interval requested in 1.25ms units, 0 = none requested yet
+    bool     present{false};
+    bool     measured{false};
+    bool     congested{false};
+    uint32_t rate{0};       // measured throughput in bytes per second
+    uint32_t bytes{0};      // counters at the previous update
+    uint32_t pdus{0};
+    uint32_t congestion{0};
+};
+
+static NimBLEAirtimeConn airtimeConns[MYNEWT_VAL(BLE_MAX_CONNECTIONS)];
+# if MYNEWT_VAL(BLE_HS_CONN_STATS)
+static ble_npl_time_t    airtimeLastUpdate{0};
+# endif
+static uint16_t          airtimePayload{20}; // average ATT PDU size seen on the connections
+static uint8_t           airtimeBackoff{0};  // times the scan duty is halved while connections are congested
+
+/**
+ * @brief Get the radio time of a connection event.
+ * @param [in] payload The ATT PDU size in bytes.
+ * @return The duration of the event in microseconds.
+ */
+static uint32_t airtimeConnEventUs(uint32_t payload) {
+    // L2CAP and LL headers, MIC, preamble, access address and CRC around the payload.
+    return airtimePktsPerEvent * ((payload + 14) * 8 + 80 + 2 * 150);
+} // airtimeConnEventUs
+
+/**
+ * @brief Get the connection interval that sustains the throughput of the budget on every connection.
+ * @param [in] budget The airtime budget.
+ * @param [in] connCount The number of connections sharing the radio.
+ * @param [in] payload The ATT PDU size in bytes.
+ * @return The interval in 1.25ms units, 0 if the budget has no throughput target.
+ */
+static uint16_t airtimeConnInterval(const NimBLEDevice::AirtimeBudget& budget, uint8_t connCount, uint16_t payload) {
+    if (budget.connThroughput == 0) {
+        return 0;
+    }
+
+    uint64_t intervalUs = static_cast<uint64_t>(airtimePktsPerEvent) * payload * 1000000 / budget.connThroughput;
+    // The events of all connections must fit in the interval.
+    intervalUs = std::max<uint64_t>(intervalUs, connCount * airtimeConnEventUs(payload) + airtimeGuardUs);
+    return std::min<uint64_t>(std::max<uint64_t>(intervalUs / 1250, BLE_HCI_CONN_ITVL_MIN), BLE_HCI_CONN_ITVL_MAX);
+} // airtimeConnInterval
+
+/**
+ * @brief Get the supervision timeout for a connection interval.
+ * @param [in] interval The connection interval in 1.25ms units.
+ * @return Six intervals and at least one second, in 10ms units.
+ */
+static uint16_t airtimeSupervisionTimeout(uint16_t interval) {
+    return std::min<uint32_t>(std::max<uint32_t>(interval * 6 * 125 / 1000, 100), BLE_HCI_CONN_SPVN_TIMEOUT_MAX);
+} // airtimeSupervisionTimeout
+
+/**
+ * @brief Derive the radio parameters from an airtime budget.
+ * @param [in] budget The airtime budget.
+ * @param [in] connCount The number of connections sharing the radio.
+ * @param [in] connInterval The shortest connection interval in use in 1.25ms units, 0 if none.
+ * @param [in] payload The average ATT PDU size in bytes.
+ * @param [in] backoff The number of times to halve the scan duty.
+ * @return The derived parameters, those of roles without a budget are 0.
+ */
+static NimBLEDevice::AirtimeParams airtimeDerive(const NimBLEDevice::AirtimeBudget& budget,
+                                                 uint8_t                            connCount,
+                                                 uint16_t                           connInterval,
+                                                 uint16_t                           payload,
+                                                 uint8_t                            backoff) {
+    NimBLEDevice::AirtimeParams params{};
+    params.connCount    = connCount;
+    params.connInterval = airtimeConnInterval(budget, connCount, payload);
+    if (params.connInterval > 0) {
+        params.supervisionTimeout = airtimeSupervisionTimeout(params.connInterval);
+    }
+
+    const uint32_t eventUs    = airtimeConnEventUs(payload);
+    const uint32_t intervalUs = connInterval * 1250;
+    uint32_t       used       = 0; // permille of the radio time taken by connections and advertising
+    if (connCount > 0 && intervalUs > 0) {
+        used += static_cast<uint64_t>(connCount) * eventUs * 1000 / intervalUs;
+    }
+
+    if (budget.advIntervalMs > 0) {
+        used += airtimeAdvEventUs / budget.advIntervalMs;
+        uint32_t advInterval  = std::max<uint32_t>(budget.advIntervalMs * 8 / 5, BLE_HCI_ADV_ITVL_MIN);
+        params.advIntervalMin = std::min<uint32_t>(advInterval, BLE_HCI_ADV_ITVL_MAX);
+        // Give the controller room to move the advertising events clear of the connection events.
+        uint32_t spread       = intervalUs > 0 ? intervalUs / 2 / 625 : params.advIntervalMin / 10;
+        params.advIntervalMax =
+            std::min<uint32_t>(params.advIntervalMin + std::max<uint32_t>(spread, 16), BLE_HCI_ADV_ITVL_MAX);
+    }
+
+    if (budget.scanDutyPct > 0) {
+        uint32_t room = used + airtimeMarginPermil < 1000 ? 1000 - used - airtimeMarginPermil : 0;
+        uint32_t duty = std::min<uint32_t>(std::min<uint32_t>(budget.scanDutyPct, 100) * 10, room) >> backoff;
+        duty          = std::max<uint32_t>(duty, 10);
+
+        uint64_t windowUs;
+        uint64_t scanIntervalUs;
+        if (connCount > 0 && intervalUs > 0) {
+            // Fit each window in the gap between the connection events of one interval.
+            uint32_t busyUs = connCount * eventUs + airtimeGuardUs;
+            windowUs        = std::max<uint32_t>(intervalUs > busyUs ? intervalUs - busyUs : 0, 2500);
+            scanIntervalUs  = windowUs * 1000 / duty;
+        } else {
+            scanIntervalUs = 100000;
+            windowUs       = scanIntervalUs * duty / 1000;
+        }
+
+        params.scanInterval =
+            std::min<uint64_t>(std::max<uint64_t>(scanIntervalUs / 625, BLE_HCI_SCAN_ITVL_MIN), BLE_HCI_SCAN_ITVL_MAX);
+        params.scanWindow =
+            std::min<uint64_t>(std::max<uint64_t>(windowUs / 625, BLE_HCI_SCAN_WINDOW_MIN), params.scanInterval);
+        params.scanDutyPct = params.scanWindow * 100 / params.scanInterval;
+    }
+
+    return params;
+} // airtimeDerive
+
+/**
+ * @brief Mark a connection as present in the airtime state, adding it if new.
+ */
+static int airtimeConnCb(uint16_t connHandle, void* arg) {
+    NimBLEAirtimeConn* freeConn = nullptr;
+    for (auto& conn : airtimeConns) {
+        if (conn.connHandle == connHandle) {
+            conn.present = true;
+            return 0;
+        }
+
+        if (freeConn == nullptr && conn.connHandle == BLE_HS_CONN_HANDLE_NONE) {
+            freeConn = &conn;
+        }
+    }
+
+    if (freeConn != nullptr) {
+        *freeConn            = NimBLEAirtimeConn{};
+        freeConn->connHandle = connHandle;
+        freeConn->present    = true;
+    }
+
+    return 0;
+} // airtimeConnCb
+
+/**
+ * @brief Set the share of the radio time given to scanning, advertising and connections.
+ * @param [in] budget The airtime budget, a role set to 0 keeps its current parameters.
+ * @details The parameters are derived on the host task now and every NIMBLE_CPP_AIRTIME_PERIOD_MS after.
+ * Scan and advertising parameters are applied when scanning or advertising is next started, connections
+ * are updated while connected. When BLE_HS_CONN_STATS is enabled the interval of a connection that drops
+ * notifications or stalls below the throughput target is shortened and the scan duty is reduced until the
+ * congestion clears.
+ * @note Extended advertising instances are not changed, use getAirtimeParams() when configuring them.
+ */
+void NimBLEDevice::setAirtimeBudget(const AirtimeBudget& budget) {
+    ble_npl_hw_enter_critical();
+    m_airtimeBudget = budget;
+    ble_npl_hw_exit_critical(0);
+
+    if (m_synced) {
+        startAirtimeTimer();
+    }
+} // setAirtimeBudget
+
+/**
+ * @brief Get the airtime budget.
+ * @return The budget last set by setAirtimeBudget().
+ */
+NimBLEDevice::AirtimeBudget NimBLEDevice::getAirtimeBudget() {
+    ble_npl_hw_enter_critical();
+    AirtimeBudget budget = m_airtimeBudget;
+    ble_npl_hw_exit_critical(0);
+    return budget;
+} // getAirtimeBudget
+
+/**
+ * @brief Get the radio parameters derived from the airtime budget at the last update.
+ * @return The derived parameters, all 0 before the first update.
+ */
+NimBLEDevice::AirtimeParams NimBLEDevice::getAirtimeParams() {
+    ble_npl_hw_enter_critical();
+    AirtimeParams params = m_airtimeParams;
+    ble_npl_hw_exit_critical(0);
+    return params;
+} // getAirtimeParams
+
+/**
+ * @brief Schedule an update of the airtime parameters on the host task, which then repeats periodically.
+ */
+void NimBLEDevice::startAirtimeTimer() {
+    if (m_airtimeTimerInitialized) {
+        ble_npl_callout_reset(&m_airtimeTimer, 1);
+    }
+} // startAirtimeTimer
+
+/**
+ * @brief Periodic airtime update, runs in the host task.
+ */
+void NimBLEDevice::airtimeTimerCb(ble_npl_event* event) {
+    if (!m_synced) {
+        return;
+    }
+
+    updateAirtime();
+
+    AirtimeBudget budget = getAirtimeBudget();
+    if (budget.scanDutyPct || budget.advIntervalMs || budget.connThroughput) {
+        ble_npl_callout_reset(&m_airtimeTimer, ble_npl_time_ms_to_ticks32(MYNEWT_VAL(NIMBLE_CPP_AIRTIME_PERIOD_MS)));
+    }
+} // airtimeTimerCb
+
+/**
+ * @brief Measure the connections, retune their intervals and derive the scan and advertising parameters.
+ */
+void NimBLEDevice::updateAirtime() {
+    const AirtimeBudget budget = getAirtimeBudget();
+
+    for (auto& conn : airtimeConns) {
+        conn.present = false;
+    }
+    ble_gap_conn_foreach_handle(airtimeConnCb, nullptr);
+
+# if MYNEWT_VAL(BLE_HS_CONN_STATS)
+    ble_npl_time_t now       = ble_npl_time_get();
+    uint32_t       elapsedMs = ble_npl_time_ticks_to_ms32(now - airtimeLastUpdate);
+    airtimeLastUpdate        = now;
+# endif
+
+    uint8_t  connCount  = 0;
+    bool     congested  = false;
+    uint32_t totalBytes = 0;
+    uint32_t totalPdus  = 0;
+    for (auto& conn : airtimeConns) {
+        if (!conn.present) {
+            conn = NimBLEAirtimeConn{};
+            continue;
+        }
+
+        connCount++;
+        conn.congested = false;
+# if MYNEWT_VAL(BLE_HS_CONN_STATS)
+        ble_hs_conn_stats stats;
+        if (ble_hs_conn_stats_get(conn.connHandle, &stats) != 0) {
+            continue;
+        }
+
+        uint32_t bytes      = stats.att_tx_bytes + stats.att_rx_bytes;
+        uint32_t pdus       = stats.att_tx_pdus + stats.att_rx_pdus;
+        uint32_t congestion = stats.notify_drop + stats.notify_retry + stats.l2cap_stalls;
+        if (conn.measured && elapsedMs > 0) {
+            totalBytes     += bytes - conn.bytes;
+            totalPdus      += pdus - conn.pdus;
+            conn.rate       = static_cast<uint64_t>(bytes - conn.bytes) * 1000 / elapsedMs;
+            conn.congested  = congestion != conn.congestion;
+            congested      |= conn.congested;
+        }
+
+        conn.bytes      = bytes;
+        conn.pdus       = pdus;
+        conn.congestion = congestion;
+        conn.measured   = true;
+# endif
+    }
+
+    if (totalPdus > 0) {
+        // Follow the traffic slowly so a single burst does not swing the intervals.
+        uint32_t payload = std::min<uint32_t>(std::max<uint32_t>(totalBytes / totalPdus, 1), BLE_ATT_MTU_MAX);
+        airtimePayload   = (airtimePayload * 3 + payload) / 4;
+    }
+
+    if (congested) {
+        airtimeBackoff = std::min<uint8_t>(airtimeBackoff + 1, airtimeMaxBackoff);
+    } else if (airtimeBackoff > 0) {
+        airtimeBackoff--;
+    }
+
+    const uint16_t nominal  = airtimeConnInterval(budget, connCount, airtimePayload);
+    uint16_t       shortest = 0;
+    for (auto& conn : airtimeConns) {
+        if (conn.connHandle == BLE_HS_CONN_HANDLE_NONE) {
+            continue;
+        }
+
+        if (nominal > 0) {
+            uint16_t interval = nominal;
+            if (conn.interval > 0 && conn.congested && conn.rate < budget.connThroughput) {
+                // Falling behind, give the connection more events.
+                interval = std::max<uint16_t>(conn.interval * 3 / 4, BLE_HCI_CONN_ITVL_MIN);
+            } else if (conn.interval > 0 && conn.interval < nominal) {
+                // Congestion cleared, hand the time back gradually.
+                interval = std::min<uint16_t>(conn.interval + std::max<uint16_t>(conn.interval / 4, 1), nominal);
+            }
+
+            if (interval != conn.interval) {
+                ble_gap_upd_params params{};
+                params.itvl_min            = interval;
+                params.itvl_max            = interval;
+                params.latency             = 0;
+                params.supervision_timeout = airtimeSupervisionTimeout(interval);
+                int rc                     = ble_gap_update_params(conn.connHandle, &params);
+                if (rc == 0) {
+                    conn.interval = interval;
+                } else {
+                    NIMBLE_LOGD(LOG_TAG, "Airtime connection update failed; handle=%d rc=%d", conn.connHandle, rc);
+                }
+            }
+        }
+
+        ble_gap_conn_desc desc;
+        if (ble_gap_conn_find(conn.connHandle, &desc) == 0 && (shortest == 0 || desc.conn_itvl < shortest)) {
+            shortest = desc.conn_itvl;
+        }
+    }
+
+    AirtimeParams params = airtimeDerive(budget, connCount, shortest, airtimePayload, airtimeBackoff);
+    ble_npl_hw_enter_critical();
+    m_airtimeParams = params;
+    ble_npl_hw_exit_critical(0);
+
+# if MYNEWT_VAL(BLE_ROLE_OBSERVER)
+    // Applied when scanning is next started, a running scan is not interrupted.
+    if (m_pScan != nullptr && params.scanInterval > 0) {
+        m_pScan->m_scanParams.itvl   = params.scanInterval;
+        m_pScan->m_scanParams.window = params.scanWindow;
+    }
+# endif
+
+# if MYNEWT_VAL(BLE_ROLE_BROADCASTER) && !MYNEWT_VAL(BLE_EXT_ADV)
+    // Applied when advertising is next started.
+    if (m_bleAdvertising != nullptr && params.advIntervalMin > 0) {
+        m_bleAdvertising->m_advParams.itvl_min = params.advIntervalMin;
+        m_bleAdvertising->m_advParams.itvl_max = params.advIntervalMax;
+    }
+# endif
+} // updateAirtime
+# endif
+
 /**
  * @brief Host reset, we pass the message so we don't make calls until re-synced.
  * @param [in] reason The reason code for the reset.
@@ -875,6 +1332,13 @@ void NimBLEDevice::onSync(void) {
             m_bleAdvertising->onHostSync();
         }
 # endif
+
+# if MYNEWT_VAL(NIMBLE_CPP_AIRTIME_BUDGET)
+        AirtimeBudget budget = getAirtimeBudget();
+        if (budget.scanDutyPct || budget.advIntervalMs || budget.connThroughput) {
+            startAirtimeTimer();
+        }
+# endif
     }
 } // onSync
 
@@ -883,10 +1347,20 @@ void NimBLEDevice::onSync(void) {
  */
 void NimBLEDevice::host_task(void* param) {
     NIMBLE_LOGI(LOG_TAG, "NimBLE Started!");
+    m_hostTask = ble_npl_get_current_task_id();
     nimble_port_run(); // This function will return only when nimble_port_stop() is executed
+    m_hostTask = nullptr;
     nimble_port_freertos_deinit();
 } // host_task
 
+/**
+ * @brief Check if the calling task is the host task, where the stack events and callbacks are run.
+ * @return True if called from the host task.
+ */
+bool NimBLEDevice::isHostTask() {
+    return m_hostTask != nullptr && ble_npl_get_current_task_id() == m_hostTask;
+} // isHostTask
+
 /**
  * @brief Initialize the BLE environment.
  * @param [in] deviceName The device name of the device.
@@ -985,6 +1459,11 @@ bool NimBLEDevice::init(const std::string& deviceName) {
 # endif
         nimble_port_init();
 
+# if MYNEWT_VAL(NIMBLE_CPP_AIRTIME_BUDGET)
+        m_airtimeTimerInitialized =
+            ble_npl_callout_init(&m_airtimeTimer, nimble_port_get_dflt_eventq(), airtimeTimerCb, nullptr) == 0;
+# endif
+
         // Setup callbacks for host events
         ble_hs_cfg.reset_cb        = NimBLEDevice::onReset;
         ble_hs_cfg.sync_cb         = NimBLEDevice::onSync;
@@ -1009,6 +1488,10 @@ bool NimBLEDevice::init(const std::string& deviceName) {
         nimble_port_freertos_init(NimBLEDevice::host_task);
     }
 
+# if MYNEWT_VAL(NIMBLE_CPP_LOG_DEFERRED)
+    NimBLELog::startTask();
+# endif
+
     // Wait for host and controller to sync before returning and accepting new tasks
     while (!m_synced) {
         ble_npl_time_delay(1);
@@ -1035,6 +1518,15 @@ bool NimBLEDevice::deinit(bool clearAll) {
             if (NimBLEDevice::m_pScan != nullptr) {
                 NimBLEDevice::m_pScan->onHostDeinit();
             }
+# endif
+# if MYNEWT_VAL(NIMBLE_CPP_AIRTIME_BUDGET)
+            if (m_airtimeTimerInitialized) {
+                ble_npl_callout_deinit(&m_airtimeTimer);
+                m_airtimeTimerInitialized = false;
+            }
+# endif
+# ifdef USING_NIMBLE_ARDUINO_HEADERS
+            ble_store_config_deinit();
 # endif
             nimble_port_deinit();
 # ifndef USING_NIMBLE_ARDUINO_HEADERS
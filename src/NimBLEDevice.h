@@ -151,10 +151,58 @@ class NimBLEDevice {
     static void          onReset(int reason);
     static void          onSync(void);
     static void          host_task(void* param);
+    static bool          isHostTask();
     static int           getPower(NimBLETxPowerType type = NimBLETxPowerType::All);
     static bool          setPower(int8_t dbm, NimBLETxPowerType type = NimBLETxPowerType::All);
     static bool          setDefaultPhy(uint8_t txPhyMask, uint8_t rxPhyMask);
 
+# if MYNEWT_VAL(OS_MEMPOOL_STATS)
+    /**
+     * @brief Usage statistics of a host memory pool.
+     */
+    struct MemPoolStats {
+        const char* name{nullptr};
+        uint32_t    blockSize{0};     // size of each block in bytes
+        uint16_t    total{0};         // number of blocks in the pool
+        uint16_t    free{0};          // number of blocks currently free
+        uint16_t    minFree{0};       // lowest number of free blocks since the last reset
+        uint32_t    allocFailures{0}; // allocations that failed because the pool was empty
+        float       avgOccupancy{0};  // time averaged fraction of blocks in use, 0.0 - 1.0
+    };
+
+    static std::vector<MemPoolStats> getMemPoolStats();
+    static void                      resetMemPoolStats();
+# endif
+
+# if MYNEWT_VAL(NIMBLE_CPP_AIRTIME_BUDGET)
+    /**
+     * @brief Share of the radio time given to each role, 0 leaves the parameters of that role unchanged.
+     */
+    struct AirtimeBudget {
+        uint8_t  scanDutyPct{0};    // percentage of the radio time to spend scanning, 1 - 100
+        uint16_t advIntervalMs{0};  // advertising interval in milliseconds
+        uint32_t connThroughput{0}; // throughput to sustain on each connection in bytes per second
+    };
+
+    /**
+     * @brief Radio parameters derived from the airtime budget.
+     */
+    struct AirtimeParams {
+        uint16_t scanInterval{0};       // 0.625ms units
+        uint16_t scanWindow{0};         // 0.625ms units
+        uint16_t advIntervalMin{0};     // 0.625ms units
+        uint16_t advIntervalMax{0};     // 0.625ms units
+        uint16_t connInterval{0};       // nominal connection interval, 1.25ms units
+        uint16_t supervisionTimeout{0}; // 10ms units
+        uint8_t  scanDutyPct{0};        // scan duty left after the connections and advertising are served
+        uint8_t  connCount{0};          // number of connections the parameters were derived for
+    };
+
+    static void          setAirtimeBudget(const AirtimeBudget& budget);
+    static AirtimeBudget getAirtimeBudget();
+    static AirtimeParams getAirtimeParams();
+# endif
+
 # ifdef ESP_PLATFORM
 #  ifndef CONFIG_IDF_TARGET_ESP32P4
     static esp_power_level_t getPowerLevel(esp_ble_power_type_t powerType = ESP_BLE_PWR_TYPE_DEFAULT);
@@ -215,6 +263,7 @@ class NimBLEDevice {
 
   private:
     static bool                       m_synced;
+    static void*                      m_hostTask;
     static bool                       m_initialized;
     static uint32_t                   m_passkey;
     static ble_gap_event_listener     m_listener;
@@ -223,6 +272,16 @@ class NimBLEDevice {
     static NimBLEDeviceCallbacks*     m_pDeviceCallbacks;
     static NimBLEDeviceCallbacks      defaultDeviceCallbacks;
 
+# if MYNEWT_VAL(NIMBLE_CPP_AIRTIME_BUDGET)
+    static AirtimeBudget   m_airtimeBudget;
+    static AirtimeParams   m_airtimeParams;
+    static ble_npl_callout m_airtimeTimer;
+    static bool            m_airtimeTimerInitialized;
+    static void            airtimeTimerCb(ble_npl_event* event);
+    static void            startAirtimeTimer();
+    static void            updateAirtime();
+# endif
+
 # if MYNEWT_VAL(BLE_ROLE_OBSERVER)
     static NimBLEScan* m_pScan;
 # endif
@@ -243,7 +302,9 @@ class NimBLEDevice {
 # endif
 
 # if MYNEWT_VAL(BLE_ROLE_CENTRAL)
-    static std::array<NimBLEClient*, MYNEWT_VAL(BLE_MAX_CONNECTIONS)> m_pClients;
+    static std::array<NimBLEClient*, MYNEWT_VAL(BLE_MAX_CONNECTIONS)>     m_pClients;
+    static std::array<NimBLEClient*, MYNEWT_VAL(BLE_MAX_CONNECTIONS) + 1> m_pClientsByHandle;
+    static void setClientConnHandle(NimBLEClient* pClient, uint16_t connHandle);
 # endif
 
 # ifdef ESP_PLATFORM
@@ -304,6 +365,9 @@ class NimBLEDevice {
 #  else
 #   include "NimBLEAdvertising.h"
 #  endif
+#  if __cplusplus >= 201402L
+#   include "NimBLEAdvPayload.h"
+#  endif
 # endif
 
 # if MYNEWT_VAL(BLE_ROLE_CENTRAL) || MYNEWT_VAL(BLE_ROLE_PERIPHERAL)
@@ -16,11 +16,19 @@
  */
 
 #include "NimBLEEddystoneTLM.h"
-#if CONFIG_BT_NIMBLE_ENABLED && MYNEWT_VAL(BLE_ROLE_BROADCASTER)
+#if CONFIG_BT_NIMBLE_ENABLED && (MYNEWT_VAL(BLE_ROLE_BROADCASTER) || MYNEWT_VAL(BLE_ROLE_OBSERVER))
 
 # include "NimBLEUUID.h"
 # include "NimBLELog.h"
 
+# ifdef USING_NIMBLE_ARDUINO_HEADERS
+#  include "nimble/nimble/host/include/host/ble_hs_adv.h"
+# else
+#  include "host/ble_hs_adv.h"
+# endif
+
+# include <cstring>
+
 # define ENDIAN_CHANGE_U16(x) ((((x) & 0xFF00) >> 8) + (((x) & 0xFF) << 8))
 # define ENDIAN_CHANGE_U32(x) \
      ((((x) & 0xFF000000) >> 24) + (((x) & 0x00FF0000) >> 8)) + ((((x) & 0xFF00) << 8) + (((x) & 0xFF) << 24))
@@ -157,6 +165,36 @@ void NimBLEEddystoneTLM::setData(const uint8_t* data, uint8_t length) {
     memcpy(&m_eddystoneData, data, length);
 } // setData
 
+/**
+ * @brief Decode an Eddystone TLM frame directly from a raw advertising payload.
+ * @param [in] payload A pointer to the advertising payload (AD structures).
+ * @param [in] length The length of the payload.
+ * @param [out] data A pointer to a BeaconData struct to receive the frame, in the same format as setData().
+ * @return True if the payload contains an Eddystone TLM frame.
+ * @details This does not allocate, it can be used on the raw data of a scan report.
+ */
+bool NimBLEEddystoneTLM::decode(const uint8_t* payload, size_t length, BeaconData* data) {
+    size_t pos = 0;
+    while (pos + 1 < length) {
+        const uint8_t fieldLen = payload[pos];
+        if (fieldLen == 0 || pos + 1 + fieldLen > length) {
+            break;
+        }
+
+        // Service data, 16 bit UUID 0xFEAA (little endian) followed by the TLM frame.
+        const uint8_t* field = &payload[pos + 1];
+        if (field[0] == BLE_HS_ADV_TYPE_SVC_DATA_UUID16 && fieldLen - 3 == sizeof(BeaconData) && field[1] == 0xAA &&
+            field[2] == 0xFE && field[3] == EDDYSTONE_TLM_FRAME_TYPE) {
+            memcpy(data, field + 3, sizeof(BeaconData));
+            return true;
+        }
+
+        pos += fieldLen + 1;
+    }
+
+    return false;
+} // decode
+
 /**
  * @brief Set the raw data for the beacon advertisement.
  * @param [in] data The raw data to advertise.
@@ -217,4 +255,4 @@ void NimBLEEddystoneTLM::setTime(uint32_t tmil) {
     m_eddystoneData.tmil = ENDIAN_CHANGE_U32(tmil);
 } // setTime
 
-#endif // CONFIG_BT_NIMBLE_ENABLED && MYNEWT_VAL(BLE_ROLE_BROADCASTER)
+#endif // CONFIG_BT_NIMBLE_ENABLED && (MYNEWT_VAL(BLE_ROLE_BROADCASTER) || MYNEWT_VAL(BLE_ROLE_OBSERVER))
@@ -19,7 +19,7 @@
 #define NIMBLE_CPP_EDDYSTONETLM_H_
 
 #include "syscfg/syscfg.h"
-#if CONFIG_BT_NIMBLE_ENABLED && MYNEWT_VAL(BLE_ROLE_BROADCASTER)
+#if CONFIG_BT_NIMBLE_ENABLED && (MYNEWT_VAL(BLE_ROLE_BROADCASTER) || MYNEWT_VAL(BLE_ROLE_OBSERVER))
 
 class NimBLEUUID;
 
@@ -60,11 +60,13 @@ class NimBLEEddystoneTLM {
     void             setCount(uint32_t advCount);
     void             setTime(uint32_t tmil);
 
+    static bool decode(const uint8_t* payload, size_t length, BeaconData* data);
+
   private:
     uint16_t   beaconUUID{0xFEAA};
     BeaconData m_eddystoneData;
 
 }; // NimBLEEddystoneTLM
 
-#endif // CONFIG_BT_NIMBLE_ENABLED && MYNEWT_VAL(BLE_ROLE_BROADCASTER)
+#endif // CONFIG_BT_NIMBLE_ENABLED && (MYNEWT_VAL(BLE_ROLE_BROADCASTER) || MYNEWT_VAL(BLE_ROLE_OBSERVER))
 #endif // NIMBLE_CPP_EDDYSTONETLM_H_
@@ -24,11 +24,19 @@
 #  include "services/gap/ble_svc_gap.h"
 # endif
 
+# ifdef USING_NIMBLE_ARDUINO_HEADERS
+#  include "nimble/porting/nimble/include/nimble/nimble_port.h"
+# else
+#  include "nimble/nimble_port.h"
+# endif
+
 # include "NimBLEDevice.h"
 # include "NimBLEServer.h"
 # include "NimBLEUtils.h"
 # include "NimBLELog.h"
 
+# include <algorithm>
+
 static NimBLEExtAdvertisingCallbacks defaultCallbacks;
 static const char*                   LOG_TAG = "NimBLEExtAdvertising";
 
@@ -38,36 +46,51 @@ static const char*                   LOG_TAG = "NimBLEExtAdvertising";
 NimBLEExtAdvertising::NimBLEExtAdvertising()
     : m_deleteCallbacks{false},
       m_pCallbacks{&defaultCallbacks},
-      m_advStatus(MYNEWT_VAL(BLE_MULTI_ADV_INSTANCES) + 1, false) {}
+      m_advStatus(MYNEWT_VAL(BLE_MULTI_ADV_INSTANCES) + 1, false),
+      m_advDataHash(MYNEWT_VAL(BLE_MULTI_ADV_INSTANCES) + 1, 0),
+      m_scanDataHash(MYNEWT_VAL(BLE_MULTI_ADV_INSTANCES) + 1, 0) {}
 
 /**
  * @brief Destructor: deletes callback instances if requested.
  */
 NimBLEExtAdvertising::~NimBLEExtAdvertising() {
+    if (m_rotating) {
+        ble_npl_eventq_remove(nimble_port_get_dflt_eventq(), &m_rotationEvent);
+        ble_npl_event_deinit(&m_rotationEvent);
+    }
+
     if (m_deleteCallbacks) {
         delete m_pCallbacks;
     }
 }
 
 /**
- * @brief Register the extended advertisement data.
- * @param [in] instId The extended advertisement instance ID to assign to this data.
- * @param [in] adv The extended advertisement instance with the data to set.
- * @return True if advertising started successfully.
+ * @brief Apply the parameter rules required by the controller to the advertisement parameters.
+ * @param [in] params The advertisement parameters to adjust.
+ * @param [in] sid The advertising set ID to use.
  */
-bool NimBLEExtAdvertising::setInstanceData(uint8_t instId, NimBLEExtAdvertisement& adv) {
-    adv.m_params.sid = instId;
+static void prepareParams(ble_gap_ext_adv_params& params, uint8_t sid) {
+    params.sid = sid;
 
     // Legacy advertising as connectable requires the scannable flag also.
-    if (adv.m_params.legacy_pdu && adv.m_params.connectable) {
-        adv.m_params.scannable = true;
+    if (params.legacy_pdu && params.connectable) {
+        params.scannable = true;
     }
 
     // If connectable or not scannable disable the callback for scan response requests
-    if (adv.m_params.connectable || !adv.m_params.scannable) {
-        adv.m_params.scan_req_notif = false;
+    if (params.connectable || !params.scannable) {
+        params.scan_req_notif = false;
     }
+} // prepareParams
 
+/**
+ * @brief Configure an advertising instance with the provided parameters.
+ * @param [in] instId The extended advertisement instance ID to configure.
+ * @param [in] params The advertisement parameters.
+ * @param [in] addr The address to advertise with, if null the default address is used.
+ * @return True if successful.
+ */
+bool NimBLEExtAdvertising::configureInstance(uint8_t instId, ble_gap_ext_adv_params& params, const NimBLEAddress& addr) {
 # if MYNEWT_VAL(BLE_ROLE_PERIPHERAL)
     NimBLEServer* pServer = NimBLEDevice::getServer();
     if (pServer != nullptr) {
@@ -76,12 +99,12 @@ bool NimBLEExtAdvertising::setInstanceData(uint8_t instId, NimBLEExtAdvertisemen
 
     int rc = ble_gap_ext_adv_configure(
         instId,
-        &adv.m_params,
+        &params,
         NULL,
         (pServer != nullptr) ? NimBLEServer::handleGapEvent : NimBLEExtAdvertising::handleGapEvent,
         NULL);
 # else
-    int rc = ble_gap_ext_adv_configure(instId, &adv.m_params, NULL, NimBLEExtAdvertising::handleGapEvent, NULL);
+    int rc = ble_gap_ext_adv_configure(instId, &params, NULL, NimBLEExtAdvertising::handleGapEvent, NULL);
 # endif
 
     if (rc != 0) {
@@ -89,20 +112,63 @@ bool NimBLEExtAdvertising::setInstanceData(uint8_t instId, NimBLEExtAdvertisemen
         return false;
     }
 
-    os_mbuf* buf;
-    buf = os_msys_get_pkthdr(adv.m_payload.size(), 0);
+    if (!addr.isNull()) {
+        rc = ble_gap_ext_adv_set_addr(instId, addr.getBase());
+        if (rc != 0) {
+            NIMBLE_LOGE(LOG_TAG, "Error setting advertisement address: rc = %d %s", rc, NimBLEUtils::returnCodeToString(rc));
+            return false;
+        }
+    }
+
+    return true;
+} // configureInstance
+
+/**
+ * @brief Copy an advertisement payload into a new mbuf.
+ * @param [in] data A pointer to the payload.
+ * @param [in] length The length of the payload.
+ * @return A pointer to the mbuf or nullptr on failure.
+ */
+static os_mbuf* makePayloadBuf(const uint8_t* data, size_t length) {
+    os_mbuf* buf = os_msys_get_pkthdr(length, 0);
     if (!buf) {
         NIMBLE_LOGE(LOG_TAG, "Data buffer allocation failed");
-        return false;
+        return nullptr;
     }
 
-    rc = os_mbuf_append(buf, &adv.m_payload[0], adv.m_payload.size());
+    int rc = os_mbuf_append(buf, data, length);
     if (rc != 0) {
         NIMBLE_LOGE(LOG_TAG, "Unable to copy data: rc = %d %s", rc, NimBLEUtils::returnCodeToString(rc));
+        os_mbuf_free_chain(buf);
+        return nullptr;
+    }
+
+    return buf;
+} // makePayloadBuf
+
+/**
+ * @brief Send the advertisement or scan response payload of an instance to the controller.
+ * @param [in] instId The extended advertisement instance ID.
+ * @param [in] buf The mbuf containing the payload, this is consumed.
+ * @param [in] scanResponse True if the payload is scan response data.
+ * @return True if successful.
+ * @details This does not require the instance to be stopped.
+ */
+bool NimBLEExtAdvertising::setInstancePayload(uint8_t instId, os_mbuf* buf, bool scanResponse) {
+    if (instId >= m_advDataHash.size()) {
+        NIMBLE_LOGE(LOG_TAG, "Invalid instance ID: %u", instId);
+        os_mbuf_free_chain(buf);
+        return false;
+    }
+
+    // The content is not known here, updatePayload() records the hash once this succeeds.
+    (scanResponse ? m_scanDataHash : m_advDataHash)[instId] = 0;
+    if (buf == nullptr) {
         return false;
     }
 
-    if (adv.m_params.scannable && !adv.m_params.legacy_pdu) {
+    int rc;
+    if (scanResponse) {
         rc = ble_gap_ext_adv_rsp_set_data(instId, buf);
     } else {
         rc = ble_gap_ext_adv_set_data(instId, buf);
@@ -113,39 +179,105 @@ bool NimBLEExtAdvertising::setInstanceData(uint8_t instId, NimBLEExtAdvertisemen
         return false;
     }
 
-    if (!adv.m_advAddress.isNull()) {
-        rc = ble_gap_ext_adv_set_addr(instId, adv.m_advAddress.getBase());
+    return true;
+} // setInstancePayload
+
+/**
+ * @brief Send a payload to an instance unless it is the same as the one last sent.
+ * @param [in] instId The extended advertisement instance ID.
+ * @param [in] data A pointer to the payload.
+ * @param [in] length The length of the payload.
+ * @param [in] scanResponse True if the payload is scan response data.
+ * @return True if successful or the payload is unchanged.
+ */
+bool NimBLEExtAdvertising::updatePayload(uint8_t instId, const uint8_t* data, size_t length, bool scanResponse) {
+    if (instId >= m_advDataHash.size()) {
+        NIMBLE_LOGE(LOG_TAG, "Invalid instance ID: %u", instId);
+        return false;
     }
 
-    if (rc != 0) {
-        NIMBLE_LOGE(LOG_TAG, "Error setting advertisement address: rc = %d %s", rc, NimBLEUtils::returnCodeToString(rc));
+    uint32_t hash = NimBLEUtils::dataHash(data, length);
+    if (hash != 0 && hash == (scanResponse ? m_scanDataHash : m_advDataHash)[instId]) {
+        NIMBLE_LOGD(LOG_TAG, "Instance %u payload unchanged", instId);
+        return true;
+    }
+
+    if (!setInstancePayload(instId, makePayloadBuf(data, length), scanResponse)) {
         return false;
     }
 
+    (scanResponse ? m_scanDataHash : m_advDataHash)[instId] = hash;
     return true;
+} // updatePayload
+
+/**
+ * @brief Register the extended advertisement data.
+ * @param [in] instId The extended advertisement instance ID to assign to this data.
+ * @param [in] adv The extended advertisement instance with the data to set.
+ * @return True if advertising started successfully.
+ */
+bool NimBLEExtAdvertising::setInstanceData(uint8_t instId, NimBLEExtAdvertisement& adv) {
+    if (instId >= m_advDataHash.size()) {
+        NIMBLE_LOGE(LOG_TAG, "Invalid instance ID: %u", instId);
+        return false;
+    }
+
+    prepareParams(adv.m_params, instId);
+    m_advDataHash[instId]  = 0;
+    m_scanDataHash[instId] = 0;
+    if (!configureInstance(instId, adv.m_params, adv.m_advAddress)) {
+        return false;
+    }
+
+    return updatePayload(instId,
+                         adv.m_payload.data(),
+                         adv.m_payload.size(),
+                         adv.m_params.scannable && !adv.m_params.legacy_pdu);
 } // setInstanceData
 
 /**
  * @brief Set the scan response data for a legacy advertisement.
  * @param [in] instId The extended advertisement instance ID to assign to this data.
  * @param [in] data A reference to a NimBLEExtAdvertisement that contains the data.
+ * @details Nothing is sent to the controller if the data has not changed since it was last set.
  */
 bool NimBLEExtAdvertising::setScanResponseData(uint8_t instId, NimBLEExtAdvertisement& data) {
-    os_mbuf* buf = os_msys_get_pkthdr(data.m_payload.size(), 0);
-    if (!buf) {
-        NIMBLE_LOGE(LOG_TAG, "Data buffer allocation failed");
-        return false;
-    }
+    return updatePayload(instId, data.m_payload.data(), data.m_payload.size(), true);
+} // setScanResponseData
 
-    int rc = os_mbuf_append(buf, &data.m_payload[0], data.m_payload.size());
-    if (rc != 0) {
-        NIMBLE_LOGE(LOG_TAG, "Unable to copy scan data: rc = %d %s", rc, NimBLEUtils::returnCodeToString(rc));
+/**
+ * @brief Update the data of a configured instance without stopping it.
+ * @param [in] instId The extended advertisement instance ID to update.
+ * @param [in] adv The advertisement with the new data, only the payload is used.
+ * @return True if successful or the data has not changed since it was last set.
+ * @details Unlike setInstanceData() the instance is not reconfigured so this can be called while it is
+ * advertising, the new data is used from the next advertising event. The scannable and legacy settings of adv
+ * must match those the instance was configured with. Nothing is sent to the controller if the payload has not
+ * changed. Instances used by the rotation are updated with updateRotation() instead.
+ */
+bool NimBLEExtAdvertising::updateInstanceData(uint8_t instId, const NimBLEExtAdvertisement& adv) {
+    return updateInstanceData(instId,
+                              adv.m_payload.data(),
+                              adv.m_payload.size(),
+                              adv.m_params.scannable && !adv.m_params.legacy_pdu);
+} // updateInstanceData
+
+/**
+ * @brief Update the data of a configured instance from a raw payload, such as one built with NimBLEAdvPayload.
+ * @param [in] instId The extended advertisement instance ID to update.
+ * @param [in] data A pointer to the payload.
+ * @param [in] length The length of the payload.
+ * @param [in] scanResponse True if the instance is scannable, the data is then sent as the scan response.
+ * @return True if successful or the data has not changed since it was last set.
+ */
+bool NimBLEExtAdvertising::updateInstanceData(uint8_t instId, const uint8_t* data, size_t length, bool scanResponse) {
+    if (instId >= m_advStatus.size() || isRotationInstance(instId)) {
+        NIMBLE_LOGE(LOG_TAG, "Cannot update instance %u", instId);
         return false;
     }
 
-    rc = ble_gap_ext_adv_rsp_set_data(instId, buf);
-    return (rc == 0);
-} // setScanResponseData
+    return updatePayload(instId, data, length, scanResponse);
+} // updateInstanceData
 
 /**
  * @brief Start extended advertising.
@@ -180,6 +312,8 @@ bool NimBLEExtAdvertising::removeInstance(uint8_t instId) {
     if (stop(instId)) {
         int rc = ble_gap_ext_adv_remove(instId);
         if (rc == 0 || rc == BLE_HS_EALREADY) {
+            m_advDataHash[instId]  = 0;
+            m_scanDataHash[instId] = 0;
             return true;
         }
 
@@ -232,6 +366,9 @@ bool NimBLEExtAdvertising::stop() {
         for (auto status : m_advStatus) {
             status = false;
         }
+
+        std::fill(m_advDataHash.begin(), m_advDataHash.end(), 0);
+        std::fill(m_scanDataHash.begin(), m_scanDataHash.end(), 0);
         return true;
     }
 
@@ -277,6 +414,364 @@ bool NimBLEExtAdvertising::isAdvertising() {
     return false;
 } // isAdvertising
 
+/**
+ * @brief Add a logical advertisement to the rotation.
+ * @param [in] adv The advertisement to add, the data and parameters are copied.
+ * @param [in] weight The number of consecutive turns this advertisement is kept on air, minimum 1.
+ * @return The ID of the logical advertisement or -1 on failure.
+ * @details Any number of advertisements can be added, they are multiplexed onto the instances given to
+ * startRotation(). Each advertisement uses its ID (modulo 16) as the advertising set ID so scanners
+ * can tell them apart. While rotating, new advertisements can only reuse the slot of a removed one.
+ */
+int NimBLEExtAdvertising::addRotation(const NimBLEExtAdvertisement& adv, uint8_t weight) {
+    size_t advId = 0;
+    for (; advId < m_rotation.size(); advId++) {
+        if (!m_rotation[advId].inUse && m_rotation[advId].instId == 0xFF) {
+            break;
+        }
+    }
+
+    if (advId == m_rotation.size()) {
+        if (m_rotating) {
+            NIMBLE_LOGE(LOG_TAG, "Cannot grow the rotation while it is running");
+            return -1;
+        }
+
+        if (advId >= 0xFF) {
+            NIMBLE_LOGE(LOG_TAG, "Too many rotating advertisements");
+            return -1;
+        }
+
+        m_rotation.emplace_back();
+    }
+
+    // The slot is not visible to the host task until it is marked in use.
+    RotationEntry& entry = m_rotation[advId];
+    entry.payload        = adv.m_payload;
+    entry.params         = adv.m_params;
+    entry.address        = adv.m_advAddress;
+    entry.weight         = weight ? weight : 1;
+    entry.turnsLeft      = 0;
+    entry.reconfigure    = false;
+    entry.dataPending    = false;
+    entry.newPayload     = false;
+    std::vector<uint8_t>().swap(entry.nextPayload);
+    prepareParams(entry.params, advId & 0x0F);
+
+    ble_npl_hw_enter_critical();
+    entry.inUse = true;
+    ble_npl_hw_exit_critical(0);
+
+    return advId;
+} // addRotation
+
+/**
+ * @brief Update a logical advertisement in the rotation.
+ * @param [in] advId The ID of the advertisement returned by addRotation().
+ * @param [in] adv The new advertisement data and parameters.
+ * @return True if successful.
+ * @details If only the payload changed and the advertisement is on air the controller data is replaced
+ * without stopping the instance, otherwise the change is applied on the next turn of the advertisement.
+ */
+bool NimBLEExtAdvertising::updateRotation(uint8_t advId, const NimBLEExtAdvertisement& adv) {
+    if (advId >= m_rotation.size() || !m_rotation[advId].inUse) {
+        NIMBLE_LOGE(LOG_TAG, "Invalid rotation advertisement ID: %u", advId);
+        return false;
+    }
+
+    RotationEntry&         entry   = m_rotation[advId];
+    std::vector<uint8_t>   payload = adv.m_payload;
+    ble_gap_ext_adv_params params  = adv.m_params;
+    prepareParams(params, advId & 0x0F);
+
+    // Parameters are only written by the application so they can be compared without locking.
+    bool sameParams = memcmp(&params, &entry.params, sizeof(params)) == 0 && adv.m_advAddress == entry.address;
+
+    // The host task may be reading the current payload, so the new one is only swapped in by the host task.
+    ble_npl_hw_enter_critical();
+    entry.nextPayload.swap(payload);
+    entry.newPayload = true;
+    if (sameParams) {
+        entry.dataPending = true;
+    } else {
+        entry.params      = params;
+        entry.address     = adv.m_advAddress;
+        entry.reconfigure = true;
+    }
+    ble_npl_hw_exit_critical(0);
+
+    if (sameParams && m_rotating) {
+        ble_npl_eventq_put(nimble_port_get_dflt_eventq(), &m_rotationEvent);
+    }
+
+    return true;
+} // updateRotation
+
+/**
+ * @brief Remove a logical advertisement from the rotation.
+ * @param [in] advId The ID of the advertisement returned by addRotation().
+ * @return True if successful.
+ * @details If the advertisement is on air it is replaced at the end of its current turn.
+ */
+bool NimBLEExtAdvertising::removeRotation(uint8_t advId) {
+    if (advId >= m_rotation.size()) {
+        return false;
+    }
+
+    ble_npl_hw_enter_critical();
+    m_rotation[advId].inUse = false;
+    ble_npl_hw_exit_critical(0);
+    return true;
+} // removeRotation
+
+/**
+ * @brief Start multiplexing the logical advertisements onto a range of advertising instances.
+ * @param [in] firstInstId The first instance ID to use for the rotation.
+ * @param [in] numInstances The number of consecutive instances to use.
+ * @param [in] eventsPerTurn The number of advertising events in one turn, 1-255.
+ * @return True if the rotation was started.
+ * @details Each instance advertises one logical advertisement for eventsPerTurn events (times its weight),
+ * when the controller reports the turn complete the next waiting advertisement is loaded.
+ * The instances used for rotation should not be used with setInstanceData() or start() until stopRotation() is called.
+ */
+bool NimBLEExtAdvertising::startRotation(uint8_t firstInstId, uint8_t numInstances, uint8_t eventsPerTurn) {
+    if (m_rotating) {
+        return true;
+    }
+
+    if (numInstances == 0 || eventsPerTurn == 0 || firstInstId + numInstances > m_advStatus.size()) {
+        NIMBLE_LOGE(LOG_TAG, "Invalid rotation instances: %u-%u", firstInstId, firstInstId + numInstances - 1);
+        return false;
+    }
+
+    if (!NimBLEDevice::m_synced) {
+        NIMBLE_LOGE(LOG_TAG, "Host reset, wait for sync.");
+        return false;
+    }
+
+    for (uint8_t i = firstInstId; i < firstInstId + numInstances; i++) {
+        if (m_advStatus[i]) {
+            NIMBLE_LOGE(LOG_TAG, "Instance %u is already advertising", i);
+            return false;
+        }
+    }
+
+    for (auto& entry : m_rotation) {
+        entry.instId      = 0xFF;
+        entry.reconfigure = false;
+        entry.dataPending = false;
+    }
+
+    ble_npl_event_init(&m_rotationEvent, NimBLEExtAdvertising::rotationEventCb, this);
+    m_rotationFirstInst = firstInstId;
+    m_rotationNumInst   = numInstances;
+    m_rotationEvents    = eventsPerTurn;
+    m_rotationCursor    = 0;
+    m_rotating          = true;
+
+    // Instances are loaded in the host task so all rotation changes are serialized with the completion events.
+    ble_npl_eventq_put(nimble_port_get_dflt_eventq(), &m_rotationEvent);
+    return true;
+} // startRotation
+
+/**
+ * @brief Stop the advertising rotation and the instances it uses.
+ * @return True if successful.
+ */
+bool NimBLEExtAdvertising::stopRotation() {
+    if (!m_rotating) {
+        return true;
+    }
+
+    ble_npl_hw_enter_critical();
+    m_rotating = false;
+    ble_npl_hw_exit_critical(0);
+
+    ble_npl_eventq_remove(nimble_port_get_dflt_eventq(), &m_rotationEvent);
+    ble_npl_event_deinit(&m_rotationEvent);
+
+    bool ret = true;
+    for (uint8_t i = m_rotationFirstInst; i < m_rotationFirstInst + m_rotationNumInst; i++) {
+        ret = stop(i) && ret;
+    }
+
+    for (auto& entry : m_rotation) {
+        entry.instId = 0xFF;
+    }
+
+    return ret;
+} // stopRotation
+
+/**
+ * @brief Check if the advertising rotation is running.
+ * @return True if the rotation is running.
+ */
+bool NimBLEExtAdvertising::isRotating() const {
+    return m_rotating;
+} // isRotating
+
+/**
+ * @brief Check if an instance is managed by the advertising rotation.
+ * @param [in] instId The instance ID to check.
+ * @return True if the instance belongs to the running rotation.
+ */
+bool NimBLEExtAdvertising::isRotationInstance(uint8_t instId) const {
+    return m_rotating && instId >= m_rotationFirstInst && instId < m_rotationFirstInst + m_rotationNumInst;
+} // isRotationInstance
+
+/**
+ * @brief Load the next turn of an instance in the rotation, called from the host task.
+ * @param [in] instId The instance ID whose turn ended or that needs to be started.
+ * @details An advertisement is kept for as many turns as its weight, then the next advertisement that is
+ * not on air is loaded. If none are waiting the current advertisement continues.
+ */
+void NimBLEExtAdvertising::rotateInstance(uint8_t instId) {
+    RotationEntry* pEntry  = nullptr;
+    bool           restart = false;
+
+    ble_npl_hw_enter_critical();
+    RotationEntry* pCur = nullptr;
+    for (auto& entry : m_rotation) {
+        if (entry.instId == instId) {
+            pCur = &entry;
+            break;
+        }
+    }
+
+    if (pCur != nullptr && pCur->inUse && pCur->turnsLeft > 1 && !pCur->reconfigure) {
+        pCur->turnsLeft--;
+        pEntry  = pCur;
+        restart = true;
+    } else {
+        if (pCur != nullptr) {
+            pCur->instId = 0xFF;
+        }
+
+        const size_t count = m_rotation.size();
+        for (size_t n = 0; n < count; n++) {
+            const size_t i = (m_rotationCursor + n) % count;
+            if (&m_rotation[i] != pCur && m_rotation[i].inUse && m_rotation[i].instId == 0xFF) {
+                pEntry           = &m_rotation[i];
+                m_rotationCursor = (i + 1) % count;
+                break;
+            }
+        }
+
+        if (pEntry == nullptr && pCur != nullptr && pCur->inUse) {
+            pEntry  = pCur;
+            restart = !pCur->reconfigure;
+        }
+
+        if (pEntry != nullptr) {
+            pEntry->instId    = instId;
+            pEntry->turnsLeft = pEntry->weight;
+        }
+    }
+    ble_npl_hw_exit_critical(0);
+
+    if (pEntry == nullptr) {
+        NIMBLE_LOGD(LOG_TAG, "No advertisement for rotation instance %u", instId);
+        m_advStatus[instId] = false;
+        return;
+    }
+
+    if (!restart) {
+        ble_npl_hw_enter_critical();
+        ble_gap_ext_adv_params params  = pEntry->params;
+        NimBLEAddress          address = pEntry->address;
+        pEntry->reconfigure            = false;
+        pEntry->dataPending            = false;
+        takeRotationPayload(*pEntry);
+        ble_npl_hw_exit_critical(0);
+
+        os_mbuf* buf = makePayloadBuf(pEntry->payload.data(), pEntry->payload.size());
+
+        if (!configureInstance(instId, params, address) ||
+            !setInstancePayload(instId, buf, params.scannable && !params.legacy_pdu)) {
+            NIMBLE_LOGE(LOG_TAG, "Failed to load rotation instance %u", instId);
+            ble_npl_hw_enter_critical();
+            pEntry->instId = 0xFF;
+            ble_npl_hw_exit_critical(0);
+            m_advStatus[instId] = false;
+            return;
+        }
+    }
+
+    int rc = ble_gap_ext_adv_start(instId, 0, m_rotationEvents);
+    if (rc != 0 && rc != BLE_HS_EALREADY) {
+        NIMBLE_LOGE(LOG_TAG, "Error enabling rotation instance %u; rc=%d, %s", instId, rc, NimBLEUtils::returnCodeToString(rc));
+        ble_npl_hw_enter_critical();
+        pEntry->instId = 0xFF;
+        ble_npl_hw_exit_critical(0);
+        m_advStatus[instId] = false;
+        return;
+    }
+
+    m_advStatus[instId] = true;
+} // rotateInstance
+
+/**
+ * @brief Swap the latest payload of a rotation entry into the one read by the host task.
+ * @param [in] entry The rotation entry.
+ * @details Called from the host task inside a critical section, the mbuf is built from the payload afterwards
+ * without locking as the application only writes nextPayload.
+ */
+void NimBLEExtAdvertising::takeRotationPayload(RotationEntry& entry) {
+    if (entry.newPayload) {
+        entry.payload.swap(entry.nextPayload);
+        entry.newPayload = false;
+    }
+} // takeRotationPayload
+
+/**
+ * @brief Push updated payloads of the advertisements that are on air, called from the host task.
+ */
+void NimBLEExtAdvertising::pushRotationData() {
+    for (auto& entry : m_rotation) {
+        ble_npl_hw_enter_critical();
+        const uint8_t instId  = entry.instId;
+        const bool    pending = entry.inUse && entry.dataPending && instId != 0xFF && !entry.reconfigure;
+        bool          scanRsp = false;
+        if (pending) {
+            entry.dataPending = false;
+            scanRsp           = entry.params.scannable && !entry.params.legacy_pdu;
+            takeRotationPayload(entry);
+        }
+        ble_npl_hw_exit_critical(0);
+
+        if (!pending) {
+            continue;
+        }
+
+        os_mbuf* buf = makePayloadBuf(entry.payload.data(), entry.payload.size());
+
+        if (!setInstancePayload(instId, buf, scanRsp)) {
+            // Reload the advertisement on its next turn instead.
+            ble_npl_hw_enter_critical();
+            entry.reconfigure = true;
+            ble_npl_hw_exit_critical(0);
+        }
+    }
+} // pushRotationData
+
+/**
+ * @brief Event callback run in the host task to start idle rotation instances and apply payload updates.
+ */
+void NimBLEExtAdvertising::rotationEventCb(ble_npl_event* event) {
+    auto pAdv = static_cast<NimBLEExtAdvertising*>(ble_npl_event_get_arg(event));
+    if (pAdv == nullptr || !pAdv->m_rotating) {
+        return;
+    }
+
+    for (uint8_t i = pAdv->m_rotationFirstInst; i < pAdv->m_rotationFirstInst + pAdv->m_rotationNumInst; i++) {
+        if (!pAdv->m_advStatus[i]) {
+            pAdv->rotateInstance(i);
+        }
+    }
+
+    pAdv->pushRotationData();
+} // rotationEventCb
+
 /*
  * Host reset seems to clear advertising data,
  * we need clear the flag so it reloads it.
@@ -286,6 +781,17 @@ void NimBLEExtAdvertising::onHostSync() {
     for (auto status : m_advStatus) {
         status = false;
     }
+
+    std::fill(m_advDataHash.begin(), m_advDataHash.end(), 0);
+    std::fill(m_scanDataHash.begin(), m_scanDataHash.end(), 0);
+
+    if (m_rotating) {
+        for (auto& entry : m_rotation) {
+            entry.instId = 0xFF;
+        }
+
+        ble_npl_eventq_put(nimble_port_get_dflt_eventq(), &m_rotationEvent);
+    }
 } // onHostSync
 
 /**
@@ -312,6 +818,12 @@ int NimBLEExtAdvertising::handleGapEvent(ble_gap_event* event, void* arg) {
                 default:
                     break;
             }
+            if (pAdv->isRotationInstance(event->adv_complete.instance)) {
+                // End of a rotation turn, load the next advertisement.
+                pAdv->rotateInstance(event->adv_complete.instance);
+                break;
+            }
+
             pAdv->m_advStatus[event->adv_complete.instance] = false;
             pAdv->m_pCallbacks->onStopped(pAdv, event->adv_complete.reason, event->adv_complete.instance);
             break;
@@ -114,6 +114,8 @@ class NimBLEExtAdvertising {
     bool start(uint8_t instId, int duration = 0, int maxEvents = 0);
     bool setInstanceData(uint8_t instId, NimBLEExtAdvertisement& adv);
     bool setScanResponseData(uint8_t instId, NimBLEExtAdvertisement& data);
+    bool updateInstanceData(uint8_t instId, const NimBLEExtAdvertisement& adv);
+    bool updateInstanceData(uint8_t instId, const uint8_t* data, size_t length, bool scanResponse = false);
     bool removeInstance(uint8_t instId);
     bool removeAll();
     bool stop(uint8_t instId);
@@ -121,17 +123,57 @@ class NimBLEExtAdvertising {
     bool isActive(uint8_t instId);
     bool isAdvertising();
     void setCallbacks(NimBLEExtAdvertisingCallbacks* callbacks, bool deleteCallbacks = true);
+    int  addRotation(const NimBLEExtAdvertisement& adv, uint8_t weight = 1);
+    bool updateRotation(uint8_t advId, const NimBLEExtAdvertisement& adv);
+    bool removeRotation(uint8_t advId);
+    bool startRotation(uint8_t firstInstId, uint8_t numInstances, uint8_t eventsPerTurn = 10);
+    bool stopRotation();
+    bool isRotating() const;
 
   private:
     friend class NimBLEDevice;
     friend class NimBLEServer;
 
-    void       onHostSync();
-    static int handleGapEvent(struct ble_gap_event* event, void* arg);
+    /**
+     * @brief A logical advertisement multiplexed onto the rotation instances.
+     */
+    struct RotationEntry {
+        std::vector<uint8_t>   payload{};     // read by the host task without locking once in use
+        std::vector<uint8_t>   nextPayload{}; // updated payload, swapped into payload by the host task
+        ble_gap_ext_adv_params params{};
+        NimBLEAddress          address{};
+        uint8_t                weight{1};
+        uint8_t                turnsLeft{0};
+        uint8_t                instId{0xFF}; // instance currently carrying this entry, 0xFF if not on air
+        bool                   inUse{false};
+        bool                   reconfigure{false}; // parameters changed, configure before the next turn
+        bool                   dataPending{false}; // payload changed, push it to the instance while on air
+        bool                   newPayload{false};  // nextPayload holds a payload not yet swapped in
+    };
+
+    void        onHostSync();
+    static int  handleGapEvent(struct ble_gap_event* event, void* arg);
+    static void rotationEventCb(ble_npl_event* event);
+    bool        configureInstance(uint8_t instId, ble_gap_ext_adv_params& params, const NimBLEAddress& addr);
+    bool        setInstancePayload(uint8_t instId, os_mbuf* buf, bool scanResponse);
+    bool        updatePayload(uint8_t instId, const uint8_t* data, size_t length, bool scanResponse);
+    void        rotateInstance(uint8_t instId);
+    void        pushRotationData();
+    static void takeRotationPayload(RotationEntry& entry);
+    bool        isRotationInstance(uint8_t instId) const;
 
     bool                           m_deleteCallbacks;
     NimBLEExtAdvertisingCallbacks* m_pCallbacks;
     std::vector<bool>              m_advStatus;
+    std::vector<uint32_t>          m_advDataHash;  // hash of the payload last sent per instance, 0 if unknown
+    std::vector<uint32_t>          m_scanDataHash; // hash of the scan response last sent per instance, 0 if unknown
+    std::vector<RotationEntry>     m_rotation{};
+    ble_npl_event                  m_rotationEvent{};
+    uint8_t                        m_rotationFirstInst{0};
+    uint8_t                        m_rotationNumInst{0};
+    uint8_t                        m_rotationEvents{0};
+    uint8_t                        m_rotationCursor{0};
+    bool                           m_rotating{false};
 };
 
 /**
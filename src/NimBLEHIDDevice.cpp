@@ -18,9 +18,22 @@
 #include "NimBLEHIDDevice.h"
 #if CONFIG_BT_NIMBLE_ENABLED && MYNEWT_VAL(BLE_ROLE_BROADCASTER) && MYNEWT_VAL(BLE_ROLE_PERIPHERAL)
 
+# include "NimBLEDevice.h"
 # include "NimBLEServer.h"
 # include "NimBLEService.h"
 # include "NimBLE2904.h"
+# include "NimBLELog.h"
+
+# ifdef USING_NIMBLE_ARDUINO_HEADERS
+#  include "nimble/porting/nimble/include/nimble/nimble_port.h"
+# else
+#  include "nimble/nimble_port.h"
+# endif
+
+# include <algorithm>
+# include <cstring>
+
+static const char* LOG_TAG = "NimBLEHIDDevice";
 
 static constexpr uint16_t deviceInfoSvcUuid = 0x180a;
 static constexpr uint16_t hidSvcUuid        = 0x1812;
@@ -39,6 +52,8 @@ static constexpr uint16_t m_manufacturerChrUuid = 0x2a29;
 static constexpr uint16_t bootInputChrUuid      = 0x2a22;
 static constexpr uint16_t bootOutputChrUuid     = 0x2a32;
 
+static constexpr uint16_t fastConnItvl = 6; // 7.5ms in 1.25ms units
+
 /**
  * @brief Construct a default NimBLEHIDDevice object.
  * @param [in] server A pointer to the server instance this HID Device will use.
@@ -70,6 +85,13 @@ NimBLEHIDDevice::NimBLEHIDDevice(NimBLEServer* server) {
     m_protocolModeChr->setValue(static_cast<uint8_t>(0x01));
 } // NimBLEHIDDevice
 
+/**
+ * @brief Destructor, stops the report pipeline if it was started.
+ */
+NimBLEHIDDevice::~NimBLEHIDDevice() {
+    stopReportPipeline();
+} // ~NimBLEHIDDevice
+
 /**
  * @brief Set the report map data formatting information.
  * @param [in] map A pointer to an array with the values to set.
@@ -338,4 +360,381 @@ NimBLEService* NimBLEHIDDevice::getBatteryService() {
     return m_batterySvc;
 } // getBatteryService
 
+/**
+ * @brief Start the input report pipeline.
+ * @param [in] fastInterval If true, request a 7.5ms connection interval from connected hosts while
+ * input reports are being sent and restore the idle connection parameters afterwards.
+ * @param [in] idleTimeoutMs The time in milliseconds without new reports before the input is considered idle.
+ * @return True if the pipeline was started.
+ * @details The pipeline keeps the latest value of each input report and sends at most one notification
+ * per report for each connection interval, updates made between connection events are coalesced.
+ * All input report characteristics must be created with getInputReport() before calling this.
+ */
+bool NimBLEHIDDevice::startReportPipeline(bool fastInterval, uint32_t idleTimeoutMs) {
+    if (m_pipelineStarted) {
+        NIMBLE_LOGW(LOG_TAG, "Report pipeline already started");
+        return true;
+    }
+
+    m_reports.clear();
+    NimBLECharacteristic* pChr = m_hidSvc->getCharacteristic(inputReportChrUuid, 0);
+    for (uint16_t i = 1; pChr != nullptr; i++) {
+        NimBLEDescriptor* pDsc = pChr->getDescriptorByUUID(featureReportDscUuid);
+        if (pDsc != nullptr) {
+            NimBLEAttValue val = pDsc->getValue();
+            if (val.size() >= 2 && val.data()[1] == 0x01) {
+                ReportSlot slot{};
+                slot.chr      = pChr;
+                slot.reportId = val.data()[0];
+                m_reports.push_back(slot);
+            }
+        }
+        pChr = m_hidSvc->getCharacteristic(inputReportChrUuid, i);
+    }
+
+    if (m_reports.empty()) {
+        NIMBLE_LOGE(LOG_TAG, "No input reports, create them with getInputReport() first");
+        return false;
+    }
+
+    if (ble_npl_callout_init(&m_reportTimer, nimble_port_get_dflt_eventq(), NimBLEHIDDevice::reportTimerCb, this) != 0) {
+        NIMBLE_LOGE(LOG_TAG, "Failed to initialize report timer");
+        m_reports.clear();
+        return false;
+    }
+
+    int rc = ble_gap_event_listener_register(&m_listener, NimBLEHIDDevice::handleGapEvent, this);
+    if (rc != 0 && rc != BLE_HS_EALREADY) {
+        NIMBLE_LOGE(LOG_TAG, "ble_gap_event_listener_register: rc=%d %s", rc, NimBLEUtils::returnCodeToString(rc));
+        ble_npl_callout_deinit(&m_reportTimer);
+        m_reports.clear();
+        return false;
+    }
+
+    ble_npl_event_init(&m_reportEvent, NimBLEHIDDevice::reportEventCb, this);
+    m_idleTimeoutTicks = std::max<ble_npl_time_t>(ble_npl_time_ms_to_ticks32(idleTimeoutMs), 1);
+    m_fastInterval     = fastInterval;
+    m_fastRequested    = false;
+    m_reportsActive    = false;
+    m_pipelineStarted  = true;
+    return true;
+} // startReportPipeline
+
+/**
+ * @brief Stop the input report pipeline, pending reports are discarded.
+ * @details If a fast connection interval was requested the idle connection parameters are restored.
+ */
+void NimBLEHIDDevice::stopReportPipeline() {
+    if (!m_pipelineStarted) {
+        return;
+    }
+
+    ble_gap_event_listener_unregister(&m_listener);
+    ble_npl_callout_stop(&m_reportTimer);
+    ble_npl_callout_deinit(&m_reportTimer);
+    ble_npl_eventq_remove(nimble_port_get_dflt_eventq(), &m_reportEvent);
+    ble_npl_event_deinit(&m_reportEvent);
+
+    ble_npl_hw_enter_critical();
+    m_pipelineStarted = false;
+    m_reportsActive   = false;
+    ble_npl_hw_exit_critical(0);
+
+    if (m_fastRequested) {
+        requestConnParams(false);
+    }
+
+    m_reports.clear();
+} // stopReportPipeline
+
+/**
+ * @brief Queue an input report to be sent by the report pipeline.
+ * @param [in] reportId The input report ID.
+ * @param [in] data A pointer to the report data.
+ * @param [in] length The length of the report data.
+ * @return True if the report was queued.
+ * @details If a previous value of the same report has not been sent yet it is replaced by this one,
+ * only the latest state of each report is sent. This may be called from any task.
+ */
+bool NimBLEHIDDevice::sendInputReport(uint8_t reportId, const uint8_t* data, size_t length) {
+    if (!m_pipelineStarted) {
+        NIMBLE_LOGE(LOG_TAG, "Report pipeline not started");
+        return false;
+    }
+
+    if (length > sizeof(ReportSlot::data)) {
+        NIMBLE_LOGE(LOG_TAG, "Report length %zu exceeds max %zu", length, sizeof(ReportSlot::data));
+        return false;
+    }
+
+    for (auto& slot : m_reports) {
+        if (slot.reportId != reportId) {
+            continue;
+        }
+
+        const uint32_t       nowUs    = NimBLEUtils::getTimeUs();
+        const ble_npl_time_t nowTicks = ble_npl_time_get();
+        bool                 activate = false;
+
+        ble_npl_hw_enter_critical();
+        memcpy(slot.data, data, length);
+        slot.length = length;
+        if (slot.pending) {
+            slot.stats.coalesced++;
+        } else {
+            slot.pending        = true;
+            slot.pendingSinceUs = nowUs;
+        }
+        m_lastReportTicks = nowTicks;
+        activate          = !m_reportsActive;
+        m_reportsActive   = true;
+        ble_npl_hw_exit_critical(0);
+
+        if (activate) {
+            ble_npl_eventq_put(nimble_port_get_dflt_eventq(), &m_reportEvent);
+        }
+
+        return true;
+    }
+
+    NIMBLE_LOGE(LOG_TAG, "Input report %u not found", reportId);
+    return false;
+} // sendInputReport
+
+/**
+ * @brief Get the statistics of an input report sent through the report pipeline.
+ * @param [in] reportId The input report ID.
+ * @param [out] stats A pointer to a ReportStats struct to receive the statistics.
+ * @return True if the report was found.
+ */
+bool NimBLEHIDDevice::getReportStats(uint8_t reportId, ReportStats* stats) const {
+    for (const auto& slot : m_reports) {
+        if (slot.reportId != reportId) {
+            continue;
+        }
+
+        ble_npl_hw_enter_critical();
+        *stats              = slot.stats;
+        stats->avgLatencyUs = slot.stats.sent ? slot.totalLatencyUs / slot.stats.sent : 0;
+        ble_npl_hw_exit_critical(0);
+        return true;
+    }
+
+    return false;
+} // getReportStats
+
+/**
+ * @brief Reset the statistics of all input reports in the report pipeline.
+ */
+void NimBLEHIDDevice::resetReportStats() {
+    ble_npl_hw_enter_critical();
+    for (auto& slot : m_reports) {
+        slot.stats          = ReportStats{};
+        slot.totalLatencyUs = 0;
+    }
+    ble_npl_hw_exit_critical(0);
+} // resetReportStats
+
+/**
+ * @brief Set the connection parameters requested when input becomes idle after a fast interval was used.
+ * @param [in] minInterval The minimum connection interval in 1.25ms units.
+ * @param [in] maxInterval The maximum connection interval in 1.25ms units.
+ * @param [in] latency The peripheral latency in number of connection events.
+ */
+void NimBLEHIDDevice::setIdleConnParams(uint16_t minInterval, uint16_t maxInterval, uint16_t latency) {
+    m_idleItvlMin = minInterval;
+    m_idleItvlMax = maxInterval;
+    m_idleLatency = latency;
+} // setIdleConnParams
+
+/**
+ * @brief Event callback run in the host task when input becomes active.
+ */
+void NimBLEHIDDevice::reportEventCb(ble_npl_event* event) {
+    auto pDev = static_cast<NimBLEHIDDevice*>(ble_npl_event_get_arg(event));
+    if (pDev) {
+        pDev->activateReports();
+    }
+} // reportEventCb
+
+/**
+ * @brief Timer callback run in the host task once per connection interval while input is active.
+ */
+void NimBLEHIDDevice::reportTimerCb(ble_npl_event* event) {
+    auto pDev = static_cast<NimBLEHIDDevice*>(ble_npl_event_get_arg(event));
+    if (pDev) {
+        pDev->flushReports();
+    }
+} // reportTimerCb
+
+/**
+ * @brief Tracks connection interval changes so the report period follows the link.
+ */
+int NimBLEHIDDevice::handleGapEvent(ble_gap_event* event, void* arg) {
+    auto pDev = static_cast<NimBLEHIDDevice*>(arg);
+    switch (event->type) {
+        case BLE_GAP_EVENT_CONN_UPDATE:
+        case BLE_GAP_EVENT_DISCONNECT:
+            if (pDev->m_reportsActive) {
+                pDev->updateReportPeriod();
+            }
+            break;
+        default:
+            break;
+    }
+
+    return 0;
+} // handleGapEvent
+
+/**
+ * @brief Start sending reports after a period of inactivity.
+ * @details Sends the pending reports immediately so the first input after idle is not delayed,
+ * then lets the timer pace the following reports.
+ */
+void NimBLEHIDDevice::activateReports() {
+    if (!m_pipelineStarted) {
+        return;
+    }
+
+    updateReportPeriod();
+    if (m_fastInterval) {
+        requestConnParams(true);
+    }
+
+    flushReports();
+} // activateReports
+
+/**
+ * @brief Send one notification for each pending input report.
+ * @details Reports that could not be sent stay pending and are retried on the next connection interval.
+ * When no reports were pending for the idle timeout the timer is stopped.
+ */
+void NimBLEHIDDevice::flushReports() {
+    if (!m_pipelineStarted) {
+        return;
+    }
+
+    const bool connected = NimBLEDevice::getServer()->getConnectedCount() > 0;
+    bool       busy      = false;
+    uint8_t    buf[sizeof(ReportSlot::data)];
+
+    for (auto& slot : m_reports) {
+        ble_npl_hw_enter_critical();
+        if (!slot.pending) {
+            ble_npl_hw_exit_critical(0);
+            continue;
+        }
+
+        const uint16_t len     = slot.length;
+        const uint32_t sinceUs = slot.pendingSinceUs;
+        memcpy(buf, slot.data, len);
+        slot.pending = false;
+        ble_npl_hw_exit_critical(0);
+
+        if (!connected) {
+            slot.stats.dropped++;
+            continue;
+        }
+
+        busy = true;
+        if (slot.chr->notify(buf, len)) {
+            const uint32_t latency = NimBLEUtils::getTimeUs() - sinceUs;
+            slot.chr->setValue(buf, len);
+
+            ble_npl_hw_enter_critical();
+            slot.stats.sent++;
+            slot.stats.lastLatencyUs = latency;
+            slot.stats.minLatencyUs  = std::min(slot.stats.minLatencyUs, latency);
+            slot.stats.maxLatencyUs  = std::max(slot.stats.maxLatencyUs, latency);
+            slot.totalLatencyUs += latency;
+            ble_npl_hw_exit_critical(0);
+            continue;
+        }
+
+        // Keep the report pending with its original timestamp, a newer value may have been queued meanwhile.
+        ble_npl_hw_enter_critical();
+        slot.stats.failed++;
+        if (!slot.pending) {
+            memcpy(slot.data, buf, len);
+            slot.length  = len;
+            slot.pending = true;
+        }
+        slot.pendingSinceUs = sinceUs;
+        ble_npl_hw_exit_critical(0);
+    }
+
+    const ble_npl_time_t now  = ble_npl_time_get();
+    bool                 idle = false;
+    ble_npl_hw_enter_critical();
+    if (!connected || (!busy && (now - m_lastReportTicks) >= m_idleTimeoutTicks)) {
+        m_reportsActive = false;
+        idle            = true;
+    }
+    ble_npl_hw_exit_critical(0);
+
+    if (idle) {
+        ble_npl_callout_stop(&m_reportTimer);
+        if (m_fastRequested) {
+            requestConnParams(false);
+        }
+        return;
+    }
+
+    ble_npl_callout_reset(&m_reportTimer, m_reportPeriodTicks);
+} // flushReports
+
+/**
+ * @brief Set the report period to the longest connection interval of the connected hosts.
+ * @details This ensures that no host receives more than one notification per report in a connection event.
+ */
+void NimBLEHIDDevice::updateReportPeriod() {
+    uint16_t itvl = 0;
+    for (const auto& connHandle : NimBLEDevice::getServer()->getPeerDevices()) {
+        ble_gap_conn_desc desc;
+        if (ble_gap_conn_find(connHandle, &desc) == 0) {
+            itvl = std::max(itvl, desc.conn_itvl);
+        }
+    }
+
+    if (itvl == 0) {
+        itvl = fastConnItvl;
+    }
+
+    // Connection interval is in 1.25ms units, round up to the next millisecond.
+    m_reportPeriodTicks = std::max<ble_npl_time_t>(ble_npl_time_ms_to_ticks32((itvl * 5 + 3) / 4), 1);
+} // updateReportPeriod
+
+/**
+ * @brief Request the fast or idle connection parameters from the connected hosts.
+ * @param [in] fast If true request a 7.5ms interval, otherwise request the idle parameters.
+ */
+void NimBLEHIDDevice::requestConnParams(bool fast) {
+    NimBLEServer* pServer = NimBLEDevice::getServer();
+    for (const auto& connHandle : pServer->getPeerDevices()) {
+        ble_gap_conn_desc desc;
+        if (ble_gap_conn_find(connHandle, &desc) != 0 || desc.role != BLE_GAP_ROLE_SLAVE) {
+            continue;
+        }
+
+        if (fast) {
+            if (desc.conn_itvl > fastConnItvl) {
+                pServer->updateConnParams(connHandle, fastConnItvl, fastConnItvl, 0, desc.supervision_timeout);
+            }
+            continue;
+        }
+
+        if (desc.conn_itvl < m_idleItvlMin || desc.conn_itvl > m_idleItvlMax) {
+            // Supervision timeout (10ms units) must be larger than (1 + latency) * interval * 2.
+            uint16_t minTimeout = ((1 + m_idleLatency) * m_idleItvlMax) / 4 + 1;
+            pServer->updateConnParams(connHandle,
+                                      m_idleItvlMin,
+                                      m_idleItvlMax,
+                                      m_idleLatency,
+                                      std::max(desc.supervision_timeout, minTimeout));
+        }
+    }
+
+    m_fastRequested = fast;
+} // requestConnParams
+
 #endif // CONFIG_BT_NIMBLE_ENABLED && MYNEWT_VAL(BLE_ROLE_PERIPHERAL)
@@ -21,8 +21,28 @@
 #include "syscfg/syscfg.h"
 #if CONFIG_BT_NIMBLE_ENABLED && MYNEWT_VAL(BLE_ROLE_BROADCASTER) && MYNEWT_VAL(BLE_ROLE_PERIPHERAL)
 
+# ifdef USING_NIMBLE_ARDUINO_HEADERS
+#  include "nimble/nimble/host/include/host/ble_gap.h"
+# else
+#  include "host/ble_gap.h"
+# endif
+
+/****  FIX COMPILATION ****/
+# undef min
+# undef max
+/**************************/
+
 # include <stdint.h>
 # include <string>
+# include <vector>
+
+# ifndef MYNEWT_VAL_NIMBLE_CPP_HID_REPORT_MAX_LEN
+#  ifndef CONFIG_NIMBLE_CPP_HID_REPORT_MAX_LEN
+#   define MYNEWT_VAL_NIMBLE_CPP_HID_REPORT_MAX_LEN 64
+#  else
+#   define MYNEWT_VAL_NIMBLE_CPP_HID_REPORT_MAX_LEN CONFIG_NIMBLE_CPP_HID_REPORT_MAX_LEN
+#  endif
+# endif
 
 # define GENERIC_HID     0x03C0
 # define HID_KEYBOARD    0x03C1
@@ -46,7 +66,24 @@ class NimBLECharacteristic;
  */
 class NimBLEHIDDevice {
   public:
+    /**
+     * @brief Statistics for an input report sent through the report pipeline.
+     * @details Latency is measured from the first update of a pending report until the notification
+     * has been handed to the controller, in microseconds.
+     */
+    struct ReportStats {
+        uint32_t sent{0};         // notifications sent
+        uint32_t coalesced{0};    // updates merged into an already pending report
+        uint32_t failed{0};       // send attempts that failed and were retried
+        uint32_t dropped{0};      // pending reports discarded because no peer was connected
+        uint32_t lastLatencyUs{0};
+        uint32_t minLatencyUs{UINT32_MAX};
+        uint32_t maxLatencyUs{0};
+        uint32_t avgLatencyUs{0};
+    };
+
     NimBLEHIDDevice(NimBLEServer* server);
+    ~NimBLEHIDDevice();
 
     void                  setReportMap(uint8_t* map, uint16_t);
     void                  startServices() __attribute__((deprecated("Services are now started by the server when start() is called, " 
@@ -70,7 +107,33 @@ class NimBLEHIDDevice {
     NimBLEService*        getHidService();
     NimBLEService*        getBatteryService();
 
+    bool startReportPipeline(bool fastInterval = true, uint32_t idleTimeoutMs = 1000);
+    void stopReportPipeline();
+    bool sendInputReport(uint8_t reportId, const uint8_t* data, size_t length);
+    bool getReportStats(uint8_t reportId, ReportStats* stats) const;
+    void resetReportStats();
+    void setIdleConnParams(uint16_t minInterval, uint16_t maxInterval, uint16_t latency);
+
   private:
+    struct ReportSlot {
+        NimBLECharacteristic* chr{nullptr};
+        uint32_t              pendingSinceUs{0};
+        uint64_t              totalLatencyUs{0};
+        ReportStats           stats{};
+        uint16_t              length{0};
+        uint8_t               reportId{0};
+        bool                  pending{false};
+        uint8_t               data[MYNEWT_VAL(NIMBLE_CPP_HID_REPORT_MAX_LEN)];
+    };
+
+    static void reportEventCb(ble_npl_event* event);
+    static void reportTimerCb(ble_npl_event* event);
+    static int  handleGapEvent(ble_gap_event* event, void* arg);
+    void        activateReports();
+    void        flushReports();
+    void        updateReportPeriod();
+    void        requestConnParams(bool fast);
+
     NimBLEService* m_deviceInfoSvc{nullptr}; // 0x180a
     NimBLEService* m_hidSvc{nullptr};        // 0x1812
     NimBLEService* m_batterySvc{nullptr};    // 0x180f
@@ -83,6 +146,21 @@ class NimBLEHIDDevice {
     NimBLECharacteristic* m_protocolModeChr{nullptr}; // 0x2a4e
     NimBLECharacteristic* m_batteryLevelChr{nullptr}; // 0x2a19
 
+    std::vector<ReportSlot> m_reports{};
+    ble_npl_event           m_reportEvent{};
+    ble_npl_callout         m_reportTimer{};
+    ble_gap_event_listener  m_listener{};
+    ble_npl_time_t          m_reportPeriodTicks{0};
+    ble_npl_time_t          m_idleTimeoutTicks{0};
+    ble_npl_time_t          m_lastReportTicks{0};
+    uint16_t                m_idleItvlMin{24};
+    uint16_t                m_idleItvlMax{40};
+    uint16_t                m_idleLatency{0};
+    bool                    m_pipelineStarted{false};
+    bool                    m_reportsActive{false};
+    bool                    m_fastInterval{false};
+    bool                    m_fastRequested{false};
+
     NimBLECharacteristic* locateReportCharacteristicByIdAndType(uint8_t reportId, uint8_t reportType);
 };
 
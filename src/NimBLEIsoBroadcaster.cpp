@@ -0,0 +1,403 @@
+/*
+ * Copyright 2020-2025 Ryan Powell <ryan@nable-embedded.io> and
+ * esp-nimble-cpp, NimBLE-Arduino contributors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "NimBLEIsoBroadcaster.h"
+#if CONFIG_BT_NIMBLE_ENABLED && MYNEWT_VAL(BLE_ROLE_BROADCASTER) && MYNEWT_VAL(BLE_EXT_ADV) && \
+    MYNEWT_VAL(BLE_PERIODIC_ADV) && MYNEWT_VAL(BLE_ISO) && MYNEWT_VAL(BLE_ISO_BROADCAST_SOURCE)
+
+# ifdef USING_NIMBLE_ARDUINO_HEADERS
+#  include "nimble/nimble/host/include/host/ble_gap.h"
+# else
+#  include "host/ble_gap.h"
+# endif
+
+# include "NimBLEDevice.h"
+# include "NimBLEUtils.h"
+# include "NimBLELog.h"
+
+# include <cstdlib>
+# include <cstring>
+
+static NimBLEIsoBroadcasterCallbacks defaultCallbacks;
+static const char*                   LOG_TAG = "NimBLEIsoBroadcaster";
+
+static constexpr uint8_t codingFormatTransparent = 0x03;
+static constexpr uint32_t teardownTimeoutMs      = 2000;
+
+/**
+ * @brief Construct an ISO broadcaster.
+ * @param [in] pCallbacks A pointer to the callbacks, nullptr to use the default callbacks.
+ */
+NimBLEIsoBroadcaster::NimBLEIsoBroadcaster(NimBLEIsoBroadcasterCallbacks* pCallbacks)
+    : m_pCallbacks{pCallbacks ? pCallbacks : &defaultCallbacks} {}
+
+/**
+ * @brief Destructor, terminates the BIG if it is active or being created.
+ * @details Events of the BIG reference this instance, so unless called from the host task this waits for
+ * the terminate or failed create event before returning. The event callback of the BIG is then removed so
+ * no event can reach the freed instance.
+ */
+NimBLEIsoBroadcaster::~NimBLEIsoBroadcaster() {
+    if (m_bis != nullptr) {
+        if (!NimBLEDevice::isHostTask()) {
+            NimBLEUtils::TaskData taskData;
+            m_pTaskData = &taskData;
+            if (stop() && !NimBLEUtils::taskWait(taskData, teardownTimeoutMs)) {
+                NIMBLE_LOGW(LOG_TAG, "Timed out waiting for BIG termination");
+            }
+            m_pTaskData = nullptr;
+        } else {
+            stop();
+        }
+
+        ble_iso_big_cb_set(m_bigHandle, nullptr, nullptr);
+    }
+
+    releaseBis();
+}
+
+/**
+ * @brief Create a BIG on a periodic advertising instance.
+ * @param [in] advInstance The extended advertising instance to attach the BIG to. It must be configured
+ * with NimBLEExtAdvertising as non-connectable and non-scannable and advertising.
+ * Periodic advertising is enabled on the instance if it is not already.
+ * @param [in] numBis The number of streams in the group, up to BLE_ISO_MAX_BISES.
+ * @param [in] sduIntervalUs The interval between SDUs in microseconds.
+ * @param [in] maxSdu The maximum size of an SDU.
+ * @param [in] maxLatencyMs The maximum transport latency in milliseconds.
+ * @param [in] rtn The number of times each PDU is retransmitted.
+ * @param [in] phy The PHY to use, one of BLE_HCI_LE_PHY_1M_PREF_MASK, BLE_HCI_LE_PHY_2M_PREF_MASK, BLE_HCI_LE_PHY_CODED_PREF_MASK.
+ * @param [in] broadcastCode The 16 character broadcast code to encrypt the streams with, nullptr for no encryption.
+ * @return True if the BIG create procedure was started, NimBLEIsoBroadcasterCallbacks::onStarted is called when complete.
+ */
+bool NimBLEIsoBroadcaster::start(uint8_t     advInstance,
+                                 uint8_t     numBis,
+                                 uint32_t    sduIntervalUs,
+                                 uint16_t    maxSdu,
+                                 uint16_t    maxLatencyMs,
+                                 uint8_t     rtn,
+                                 uint8_t     phy,
+                                 const char* broadcastCode) {
+    if (m_active || m_bis != nullptr) {
+        NIMBLE_LOGE(LOG_TAG, "Broadcaster already started");
+        return false;
+    }
+
+    if (numBis == 0 || numBis > MYNEWT_VAL(BLE_ISO_MAX_BISES) || maxSdu == 0) {
+        NIMBLE_LOGE(LOG_TAG, "Invalid BIS count or SDU size");
+        return false;
+    }
+
+    ble_gap_periodic_adv_params perParams{};
+    int                         rc = ble_gap_periodic_adv_configure(advInstance, &perParams);
+    if (rc != 0) {
+        NIMBLE_LOGD(LOG_TAG, "ble_gap_periodic_adv_configure: rc=%d %s", rc, NimBLEUtils::returnCodeToString(rc));
+    }
+
+    ble_gap_periodic_adv_start_params startParams{};
+    rc = ble_gap_periodic_adv_start(advInstance, &startParams);
+    if (rc != 0 && rc != BLE_HS_EALREADY) {
+        NIMBLE_LOGE(LOG_TAG, "Failed to start periodic advertising: rc=%d %s", rc, NimBLEUtils::returnCodeToString(rc));
+        return false;
+    }
+
+    m_sduPool = static_cast<uint8_t*>(malloc(numBis * maxSdu));
+    m_bis     = new Bis[numBis];
+    if (m_sduPool == nullptr) {
+        NIMBLE_LOGE(LOG_TAG, "Failed to allocate SDU buffers");
+        releaseBis();
+        return false;
+    }
+
+    for (uint8_t i = 0; i < numBis; i++) {
+        m_bis[i].buf = m_sduPool + i * maxSdu;
+    }
+
+    m_numBis        = numBis;
+    m_maxSdu        = maxSdu;
+    m_sduIntervalUs = sduIntervalUs;
+
+    ble_iso_create_big_params createParams{};
+    createParams.adv_handle = advInstance;
+    createParams.bis_cnt    = numBis;
+    createParams.cb         = NimBLEIsoBroadcaster::handleIsoEvent;
+    createParams.cb_arg     = this;
+
+    ble_iso_big_params bigParams{};
+    bigParams.sdu_interval          = sduIntervalUs;
+    bigParams.max_sdu               = maxSdu;
+    bigParams.max_transport_latency = maxLatencyMs;
+    bigParams.rtn                   = rtn;
+    bigParams.phy                   = phy;
+    bigParams.packing               = 0;
+    bigParams.framing               = 0;
+    bigParams.encryption            = broadcastCode != nullptr;
+    bigParams.broadcast_code        = broadcastCode;
+
+    rc = ble_iso_create_big(&createParams, &bigParams, &m_bigHandle);
+    if (rc != 0) {
+        NIMBLE_LOGE(LOG_TAG, "ble_iso_create_big: rc=%d %s", rc, NimBLEUtils::returnCodeToString(rc));
+        releaseBis();
+        return false;
+    }
+
+    return true;
+} // start
+
+/**
+ * @brief Terminate the BIG, or cancel its creation if still pending.
+ * @return True if the terminate procedure was started, NimBLEIsoBroadcasterCallbacks::onStopped is called when
+ * complete, or NimBLEIsoBroadcasterCallbacks::onStarted with an error status if the creation was cancelled.
+ */
+bool NimBLEIsoBroadcaster::stop() {
+    if (m_bis == nullptr) {
+        return true;
+    }
+
+    m_active = false;
+    int rc   = ble_iso_terminate_big(m_bigHandle);
+    if (rc != 0) {
+        NIMBLE_LOGE(LOG_TAG, "ble_iso_terminate_big: rc=%d %s", rc, NimBLEUtils::returnCodeToString(rc));
+        return false;
+    }
+
+    return true;
+} // stop
+
+/**
+ * @brief Check if the BIG is created and SDUs can be sent.
+ * @return True if active.
+ */
+bool NimBLEIsoBroadcaster::isActive() const {
+    return m_active;
+} // isActive
+
+/**
+ * @brief Get the number of streams in the group.
+ * @return The number of streams.
+ */
+uint8_t NimBLEIsoBroadcaster::getNumBis() const {
+    return m_numBis;
+} // getNumBis
+
+/**
+ * @brief Get the maximum SDU size of the group.
+ * @return The maximum SDU size.
+ */
+uint16_t NimBLEIsoBroadcaster::getMaxSdu() const {
+    return m_maxSdu;
+} // getMaxSdu
+
+/**
+ * @brief Get the pooled SDU buffer of a stream, to build the next SDU in place.
+ * @param [in] bisIndex The index of the stream, 0 based.
+ * @return A pointer to a buffer of getMaxSdu() bytes or nullptr if the index is invalid.
+ * @details Send the buffer contents with send(bisIndex, length).
+ */
+uint8_t* NimBLEIsoBroadcaster::getSduBuffer(uint8_t bisIndex) {
+    if (m_bis == nullptr || bisIndex >= m_numBis) {
+        return nullptr;
+    }
+
+    return m_bis[bisIndex].buf;
+} // getSduBuffer
+
+/**
+ * @brief Send the SDU built in the pooled buffer of a stream.
+ * @param [in] bisIndex The index of the stream, 0 based.
+ * @param [in] length The length of the SDU.
+ * @param [out] pTimestampUs Optional pointer to receive the local send timestamp in microseconds.
+ * @return True if the SDU was passed to the controller.
+ */
+bool NimBLEIsoBroadcaster::send(uint8_t bisIndex, uint16_t length, uint32_t* pTimestampUs) {
+    if (m_bis == nullptr || bisIndex >= m_numBis) {
+        return false;
+    }
+
+    return send(bisIndex, m_bis[bisIndex].buf, length, pTimestampUs);
+} // send
+
+/**
+ * @brief Send an SDU on a stream.
+ * @param [in] bisIndex The index of the stream, 0 based.
+ * @param [in] data A pointer to the SDU data.
+ * @param [in] length The length of the SDU.
+ * @param [out] pTimestampUs Optional pointer to receive the local send timestamp in microseconds.
+ * @return True if the SDU was passed to the controller.
+ * @details The send time of each SDU is compared to the SDU interval to track late SDUs and jitter.
+ */
+bool NimBLEIsoBroadcaster::send(uint8_t bisIndex, const uint8_t* data, uint16_t length, uint32_t* pTimestampUs) {
+    if (!m_active || bisIndex >= m_numBis || length > m_maxSdu) {
+        NIMBLE_LOGE(LOG_TAG, "Cannot send SDU; active=%d, bis=%u, len=%u", m_active, bisIndex, length);
+        return false;
+    }
+
+    Bis&           bis   = m_bis[bisIndex];
+    const uint32_t nowUs = NimBLEUtils::getTimeUs();
+    int            rc    = ble_iso_tx(bis.connHandle, const_cast<uint8_t*>(data), length);
+
+    ble_npl_hw_enter_critical();
+    if (rc != 0) {
+        bis.stats.failed++;
+    } else {
+        if (bis.stats.sent > 0) {
+            const int32_t deviation = static_cast<int32_t>(nowUs - bis.stats.lastSendUs - m_sduIntervalUs);
+            if (deviation > static_cast<int32_t>(m_sduIntervalUs / 2)) {
+                bis.stats.late++;
+            }
+
+            const int32_t absDev = deviation < 0 ? -deviation : deviation;
+            const int32_t jitter = static_cast<int32_t>(bis.stats.jitterUs);
+            bis.stats.jitterUs   = jitter + (absDev - jitter) / 16;
+        }
+
+        bis.stats.sent++;
+        bis.stats.seqNum++;
+        bis.stats.lastSendUs = nowUs;
+    }
+    ble_npl_hw_exit_critical(0);
+
+    if (rc != 0) {
+        NIMBLE_LOGD(LOG_TAG, "ble_iso_tx: rc=%d %s", rc, NimBLEUtils::returnCodeToString(rc));
+        return false;
+    }
+
+    if (pTimestampUs != nullptr) {
+        *pTimestampUs = nowUs;
+    }
+
+    return true;
+} // send
+
+/**
+ * @brief Get the transmit statistics of a stream.
+ * @param [in] bisIndex The index of the stream, 0 based.
+ * @param [out] pStats A pointer to a BisStats struct to receive the statistics.
+ * @return True if the index is valid.
+ */
+bool NimBLEIsoBroadcaster::getStats(uint8_t bisIndex, BisStats* pStats) const {
+    if (m_bis == nullptr || bisIndex >= m_numBis || pStats == nullptr) {
+        return false;
+    }
+
+    ble_npl_hw_enter_critical();
+    *pStats = m_bis[bisIndex].stats;
+    ble_npl_hw_exit_critical(0);
+    return true;
+} // getStats
+
+/**
+ * @brief Reset the transmit statistics of all streams.
+ */
+void NimBLEIsoBroadcaster::resetStats() {
+    if (m_bis == nullptr) {
+        return;
+    }
+
+    ble_npl_hw_enter_critical();
+    for (uint8_t i = 0; i < m_numBis; i++) {
+        m_bis[i].stats = BisStats{};
+    }
+    ble_npl_hw_exit_critical(0);
+} // resetStats
+
+/**
+ * @brief Release the streams and the SDU pool.
+ */
+void NimBLEIsoBroadcaster::releaseBis() {
+    delete[] m_bis;
+    free(m_sduPool);
+    m_bis     = nullptr;
+    m_sduPool = nullptr;
+    m_numBis  = 0;
+} // releaseBis
+
+/**
+ * @brief Handle the BIG events from the host.
+ * @param [in] event The event data.
+ * @param [in] arg A pointer to the NimBLEIsoBroadcaster instance.
+ */
+int NimBLEIsoBroadcaster::handleIsoEvent(ble_iso_event* event, void* arg) {
+    auto pBc = static_cast<NimBLEIsoBroadcaster*>(arg);
+
+    switch (event->type) {
+        case BLE_ISO_EVENT_BIG_CREATE_COMPLETE: {
+            const uint8_t status = event->big_created.status;
+            NIMBLE_LOGD(LOG_TAG, "BIG create complete; status=%u", status);
+            if (status != 0) {
+                // The host has freed the BIG, no more events will reference this instance.
+                pBc->releaseBis();
+                pBc->m_pCallbacks->onStarted(pBc, status);
+                if (pBc->m_pTaskData != nullptr) {
+                    NimBLEUtils::taskRelease(*pBc->m_pTaskData, status);
+                }
+                break;
+            }
+
+            const auto& desc = event->big_created.desc;
+            pBc->m_bigHandle = desc.big_handle;
+            for (uint8_t i = 0; i < pBc->m_numBis && i < desc.num_bis; i++) {
+                pBc->m_bis[i].connHandle = desc.conn_handle[i];
+
+                ble_iso_data_path_setup_params params{};
+                params.conn_handle     = desc.conn_handle[i];
+                params.data_path_dir   = BLE_ISO_DATA_DIR_TX;
+                params.data_path_id    = BLE_HCI_ISO_DATA_PATH_ID_HCI;
+                params.codec_id.format = codingFormatTransparent;
+                int rc                 = ble_iso_data_path_setup(&params);
+                if (rc != 0) {
+                    NIMBLE_LOGE(LOG_TAG, "ble_iso_data_path_setup: rc=%d %s", rc, NimBLEUtils::returnCodeToString(rc));
+                }
+            }
+
+            pBc->m_active = true;
+            pBc->m_pCallbacks->onStarted(pBc, 0);
+            break;
+        } // BLE_ISO_EVENT_BIG_CREATE_COMPLETE
+
+        case BLE_ISO_EVENT_BIG_TERMINATE_COMPLETE: {
+            NIMBLE_LOGD(LOG_TAG, "BIG terminated; reason=%u", event->big_terminated.reason);
+            pBc->m_active = false;
+            pBc->releaseBis();
+            pBc->m_pCallbacks->onStopped(pBc, event->big_terminated.reason);
+            if (pBc->m_pTaskData != nullptr) {
+                NimBLEUtils::taskRelease(*pBc->m_pTaskData, event->big_terminated.reason);
+            }
+            break;
+        } // BLE_ISO_EVENT_BIG_TERMINATE_COMPLETE
+
+        default:
+            break;
+    }
+
+    return 0;
+} // handleIsoEvent
+
+/* -------------------------------------------------------------------------- */
+/*                          Default callback handlers                         */
+/* -------------------------------------------------------------------------- */
+
+void NimBLEIsoBroadcasterCallbacks::onStarted(NimBLEIsoBroadcaster* pBroadcaster, uint8_t status) {
+    NIMBLE_LOGD("NimBLEIsoBroadcasterCallbacks", "onStarted: Default, status=%u", status);
+} // onStarted
+
+void NimBLEIsoBroadcasterCallbacks::onStopped(NimBLEIsoBroadcaster* pBroadcaster, uint8_t reason) {
+    NIMBLE_LOGD("NimBLEIsoBroadcasterCallbacks", "onStopped: Default, reason=%u", reason);
+} // onStopped
+
+#endif // CONFIG_BT_NIMBLE_ENABLED && MYNEWT_VAL(BLE_ROLE_BROADCASTER) && MYNEWT_VAL(BLE_EXT_ADV) &&
+       // MYNEWT_VAL(BLE_PERIODIC_ADV) && MYNEWT_VAL(BLE_ISO) && MYNEWT_VAL(BLE_ISO_BROADCAST_SOURCE)
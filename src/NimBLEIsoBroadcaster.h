@@ -0,0 +1,126 @@
+/*
+ * Copyright 2020-2025 Ryan Powell <ryan@nable-embedded.io> and
+ * esp-nimble-cpp, NimBLE-Arduino contributors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NIMBLE_CPP_ISO_BROADCASTER_H_
+#define NIMBLE_CPP_ISO_BROADCASTER_H_
+
+#include "syscfg/syscfg.h"
+#if CONFIG_BT_NIMBLE_ENABLED && MYNEWT_VAL(BLE_ROLE_BROADCASTER) && MYNEWT_VAL(BLE_EXT_ADV) && \
+    MYNEWT_VAL(BLE_PERIODIC_ADV) && MYNEWT_VAL(BLE_ISO) && MYNEWT_VAL(BLE_ISO_BROADCAST_SOURCE)
+
+# ifdef USING_NIMBLE_ARDUINO_HEADERS
+#  include "nimble/nimble/host/include/host/ble_iso.h"
+# else
+#  include "host/ble_iso.h"
+# endif
+
+/****  FIX COMPILATION ****/
+# undef min
+# undef max
+/**************************/
+
+# include "NimBLEUtils.h"
+# include <cstdint>
+
+class NimBLEIsoBroadcasterCallbacks;
+
+/**
+ * @brief Broadcast isochronous stream source.
+ * @details Creates a Broadcast Isochronous Group (BIG) on a periodic advertising instance and
+ * sends fixed rate SDUs on each of its streams (BIS). SDUs can be built in place in a per-stream
+ * buffer taken from a single pool allocated when the group is started.
+ */
+class NimBLEIsoBroadcaster {
+  public:
+    /**
+     * @brief Per stream transmit statistics.
+     */
+    struct BisStats {
+        uint32_t sent{0};     // SDUs passed to the controller
+        uint32_t failed{0};   // SDUs that could not be sent
+        uint32_t late{0};     // SDUs sent more than half an SDU interval after their slot
+        uint32_t jitterUs{0}; // smoothed deviation of the send interval from the SDU interval
+        uint32_t lastSendUs{0};
+        uint16_t seqNum{0};   // sequence number of the next SDU
+    };
+
+    NimBLEIsoBroadcaster(NimBLEIsoBroadcasterCallbacks* pCallbacks = nullptr);
+    ~NimBLEIsoBroadcaster();
+    bool     start(uint8_t     advInstance,
+                   uint8_t     numBis,
+                   uint32_t    sduIntervalUs,
+                   uint16_t    maxSdu,
+                   uint16_t    maxLatencyMs  = 10,
+                   uint8_t     rtn           = 2,
+                   uint8_t     phy           = BLE_HCI_LE_PHY_2M_PREF_MASK,
+                   const char* broadcastCode = nullptr);
+    bool     stop();
+    bool     isActive() const;
+    uint8_t  getNumBis() const;
+    uint16_t getMaxSdu() const;
+    uint8_t* getSduBuffer(uint8_t bisIndex);
+    bool     send(uint8_t bisIndex, uint16_t length, uint32_t* pTimestampUs = nullptr);
+    bool     send(uint8_t bisIndex, const uint8_t* data, uint16_t length, uint32_t* pTimestampUs = nullptr);
+    bool     getStats(uint8_t bisIndex, BisStats* pStats) const;
+    void     resetStats();
+
+  private:
+    struct Bis {
+        uint16_t connHandle{0};
+        uint8_t* buf{nullptr};
+        BisStats stats{};
+    };
+
+    static int handleIsoEvent(ble_iso_event* event, void* arg);
+    void       releaseBis();
+
+    NimBLEIsoBroadcasterCallbacks* m_pCallbacks;
+    Bis*                           m_bis{nullptr};
+    uint8_t*                       m_sduPool{nullptr};
+    uint32_t                       m_sduIntervalUs{0};
+    uint16_t                       m_maxSdu{0};
+    uint8_t                        m_bigHandle{0xFF};
+    uint8_t                        m_numBis{0};
+    volatile bool                  m_active{false};
+    NimBLEUtils::TaskData*         m_pTaskData{nullptr};
+}; // NimBLEIsoBroadcaster
+
+/**
+ * @brief Callbacks associated with a NimBLEIsoBroadcaster.
+ */
+class NimBLEIsoBroadcasterCallbacks {
+  public:
+    virtual ~NimBLEIsoBroadcasterCallbacks() {}
+
+    /**
+     * @brief Called when the BIG has been created and the streams are ready to send.
+     * @param [in] pBroadcaster A pointer to the broadcaster.
+     * @param [in] status 0 on success, otherwise the HCI error code.
+     */
+    virtual void onStarted(NimBLEIsoBroadcaster* pBroadcaster, uint8_t status);
+
+    /**
+     * @brief Called when the BIG has been terminated.
+     * @param [in] pBroadcaster A pointer to the broadcaster.
+     * @param [in] reason The HCI reason code.
+     */
+    virtual void onStopped(NimBLEIsoBroadcaster* pBroadcaster, uint8_t reason);
+}; // NimBLEIsoBroadcasterCallbacks
+
+#endif // CONFIG_BT_NIMBLE_ENABLED && MYNEWT_VAL(BLE_ROLE_BROADCASTER) && MYNEWT_VAL(BLE_EXT_ADV) &&
+       // MYNEWT_VAL(BLE_PERIODIC_ADV) && MYNEWT_VAL(BLE_ISO) && MYNEWT_VAL(BLE_ISO_BROADCAST_SOURCE)
+#endif // NIMBLE_CPP_ISO_BROADCASTER_H_
@@ -0,0 +1,368 @@
+/*
+ * Copyright 2020-2025 Ryan Powell <ryan@nable-embedded.io> and
+ * esp-nimble-cpp, NimBLE-Arduino contributors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "NimBLEIsoReceiver.h"
+#if CONFIG_BT_NIMBLE_ENABLED && MYNEWT_VAL(BLE_ROLE_OBSERVER) && MYNEWT_VAL(BLE_EXT_ADV) && \
+    MYNEWT_VAL(BLE_PERIODIC_ADV) && MYNEWT_VAL(BLE_ISO) && MYNEWT_VAL(BLE_ISO_BROADCAST_SINK)
+
+# include "NimBLEPeriodicSync.h"
+# include "NimBLEUtils.h"
+# include "NimBLELog.h"
+
+# ifdef USING_NIMBLE_ARDUINO_HEADERS
+#  include "nimble/porting/nimble/include/os/os_mbuf.h"
+# else
+#  include "os/os_mbuf.h"
+# endif
+
+# include <algorithm>
+# include <cstdlib>
+
+static NimBLEIsoReceiverCallbacks defaultCallbacks;
+static const char*                LOG_TAG = "NimBLEIsoReceiver";
+
+static constexpr uint8_t codingFormatTransparent = 0x03;
+
+/**
+ * @brief Construct an ISO receiver.
+ * @param [in] pCallbacks A pointer to the callbacks, nullptr to use the default callbacks.
+ */
+NimBLEIsoReceiver::NimBLEIsoReceiver(NimBLEIsoReceiverCallbacks* pCallbacks)
+    : m_pCallbacks{pCallbacks ? pCallbacks : &defaultCallbacks} {}
+
+/**
+ * @brief Destructor, terminates the BIG sync if it is active.
+ */
+NimBLEIsoReceiver::~NimBLEIsoReceiver() {
+    stop();
+    releaseBis();
+}
+
+/**
+ * @brief Synchronize to the BIG announced on a periodic advertising train.
+ * @param [in] pSync A pointer to an established periodic sync with the broadcaster.
+ * @param [in] numBis The number of streams to receive, streams 1 to numBis of the BIG are used.
+ * @param [in] maxSdu The largest SDU expected, used to size the pooled SDU buffers.
+ * @param [in] syncTimeoutMs The time without a received PDU after which the sync is lost, in milliseconds.
+ * @param [in] broadcastCode The 16 character broadcast code of an encrypted BIG, nullptr if unencrypted.
+ * @return True if the sync procedure was started, NimBLEIsoReceiverCallbacks::onSync is called when complete.
+ */
+bool NimBLEIsoReceiver::start(
+    const NimBLEPeriodicSync* pSync, uint8_t numBis, uint16_t maxSdu, uint16_t syncTimeoutMs, const char* broadcastCode) {
+    if (m_bis != nullptr) {
+        NIMBLE_LOGE(LOG_TAG, "Receiver already started");
+        return false;
+    }
+
+    if (pSync == nullptr || !pSync->isSynced()) {
+        NIMBLE_LOGE(LOG_TAG, "Periodic sync not established");
+        return false;
+    }
+
+    if (numBis == 0 || numBis > MYNEWT_VAL(BLE_ISO_MAX_BISES) || maxSdu == 0) {
+        NIMBLE_LOGE(LOG_TAG, "Invalid BIS count or SDU size");
+        return false;
+    }
+
+    m_sduPool = static_cast<uint8_t*>(malloc(numBis * maxSdu));
+    m_bis     = new Bis[numBis];
+    if (m_sduPool == nullptr) {
+        NIMBLE_LOGE(LOG_TAG, "Failed to allocate SDU buffers");
+        releaseBis();
+        return false;
+    }
+
+    ble_iso_bis_params bisParams[MYNEWT_VAL(BLE_ISO_MAX_BISES)];
+    for (uint8_t i = 0; i < numBis; i++) {
+        m_bis[i].buf           = m_sduPool + i * maxSdu;
+        bisParams[i].bis_index = i + 1;
+    }
+
+    m_numBis = numBis;
+    m_maxSdu = maxSdu;
+
+    ble_iso_big_sync_create_params params{};
+    params.sync_handle    = pSync->getHandle();
+    params.broadcast_code = broadcastCode;
+    params.mse            = 0;
+    params.sync_timeout   = std::max<uint16_t>(syncTimeoutMs / 10, 0x000A);
+    params.cb             = NimBLEIsoReceiver::handleIsoEvent;
+    params.cb_arg         = this;
+    params.bis_cnt        = numBis;
+    params.bis_params     = bisParams;
+
+    int rc = ble_iso_big_sync_create(&params, &m_bigHandle);
+    if (rc != 0) {
+        NIMBLE_LOGE(LOG_TAG, "ble_iso_big_sync_create: rc=%d %s", rc, NimBLEUtils::returnCodeToString(rc));
+        releaseBis();
+        return false;
+    }
+
+    return true;
+} // start
+
+/**
+ * @brief Terminate the BIG sync.
+ * @return True if successful, NimBLEIsoReceiverCallbacks::onSyncLost is called.
+ */
+bool NimBLEIsoReceiver::stop() {
+    if (m_bis == nullptr) {
+        return true;
+    }
+
+    m_synced = false;
+    int rc   = ble_iso_big_sync_terminate(m_bigHandle);
+    if (rc != 0 && rc != BLE_HS_ENOENT) {
+        NIMBLE_LOGE(LOG_TAG, "ble_iso_big_sync_terminate: rc=%d %s", rc, NimBLEUtils::returnCodeToString(rc));
+        return false;
+    }
+
+    return true;
+} // stop
+
+/**
+ * @brief Check if the receiver is synchronized to the BIG.
+ * @return True if synchronized.
+ */
+bool NimBLEIsoReceiver::isSynced() const {
+    return m_synced;
+} // isSynced
+
+/**
+ * @brief Get the number of streams being received.
+ * @return The number of streams.
+ */
+uint8_t NimBLEIsoReceiver::getNumBis() const {
+    return m_numBis;
+} // getNumBis
+
+/**
+ * @brief Get the SDU interval of the BIG derived from the ISO interval and burst number.
+ * @return The SDU interval in microseconds, 0 if not synchronized.
+ */
+uint32_t NimBLEIsoReceiver::getSduInterval() const {
+    return m_sduIntervalUs;
+} // getSduInterval
+
+/**
+ * @brief Get the receive statistics of a stream.
+ * @param [in] bisIndex The index of the stream, 0 based.
+ * @param [out] pStats A pointer to a BisStats struct to receive the statistics.
+ * @return True if the index is valid.
+ */
+bool NimBLEIsoReceiver::getStats(uint8_t bisIndex, BisStats* pStats) const {
+    if (m_bis == nullptr || bisIndex >= m_numBis || pStats == nullptr) {
+        return false;
+    }
+
+    ble_npl_hw_enter_critical();
+    *pStats = m_bis[bisIndex].stats;
+    ble_npl_hw_exit_critical(0);
+    return true;
+} // getStats
+
+/**
+ * @brief Reset the receive statistics of all streams.
+ */
+void NimBLEIsoReceiver::resetStats() {
+    if (m_bis == nullptr) {
+        return;
+    }
+
+    ble_npl_hw_enter_critical();
+    for (uint8_t i = 0; i < m_numBis; i++) {
+        m_bis[i].stats = BisStats{};
+    }
+    ble_npl_hw_exit_critical(0);
+} // resetStats
+
+/**
+ * @brief Release the streams and the SDU pool.
+ */
+void NimBLEIsoReceiver::releaseBis() {
+    delete[] m_bis;
+    free(m_sduPool);
+    m_bis           = nullptr;
+    m_sduPool       = nullptr;
+    m_numBis        = 0;
+    m_sduIntervalUs = 0;
+} // releaseBis
+
+/**
+ * @brief Update the stream statistics and deliver a received SDU, called from the host task.
+ * @param [in] event The ISO RX event, the mbuf is consumed.
+ * @details SDUs contained in a single mbuf are delivered without copying, chained SDUs are
+ * flattened into the pooled buffer of the stream. Jitter follows RFC 3550 using the controller
+ * timestamps when available, otherwise the sequence number and SDU interval.
+ */
+void NimBLEIsoReceiver::onRx(const ble_iso_event& event) {
+    os_mbuf* om = event.iso_rx.om;
+
+    uint8_t idx = 0;
+    while (idx < m_numBis && m_bis[idx].connHandle != event.iso_rx.conn_handle) {
+        idx++;
+    }
+
+    if (!m_synced || idx == m_numBis) {
+        os_mbuf_free_chain(om);
+        return;
+    }
+
+    Bis&                        bis  = m_bis[idx];
+    const ble_iso_rx_data_info& info = *event.iso_rx.info;
+
+    Sdu sdu{};
+    sdu.arrivalUs      = NimBLEUtils::getTimeUs();
+    sdu.seqNum         = info.seq_num;
+    sdu.status         = info.status;
+    sdu.timestampUs    = info.ts;
+    sdu.timestampValid = info.ts_valid;
+
+    if (om != nullptr) {
+        sdu.length = OS_MBUF_PKTLEN(om);
+        if (om->om_len == sdu.length) {
+            sdu.data = om->om_data;
+        } else if (sdu.length <= m_maxSdu) {
+            os_mbuf_copydata(om, 0, sdu.length, bis.buf);
+            sdu.data = bis.buf;
+        } else {
+            NIMBLE_LOGW(LOG_TAG, "SDU larger than buffer, len=%u", sdu.length);
+            sdu.length = 0;
+            sdu.status = BLE_ISO_DATA_STATUS_ERROR;
+        }
+    }
+
+    ble_npl_hw_enter_critical();
+    if (!bis.first) {
+        const uint16_t gap = sdu.seqNum - bis.lastSeqNum;
+        if (gap > 1) {
+            bis.stats.lost += gap - 1;
+        }
+
+        const uint32_t expectedUs = sdu.timestampValid ? sdu.timestampUs - bis.lastTimestampUs : gap * m_sduIntervalUs;
+        const int32_t  transitUs  = static_cast<int32_t>(sdu.arrivalUs - bis.lastArrivalUs - expectedUs);
+        if (transitUs > static_cast<int32_t>(m_sduIntervalUs)) {
+            bis.stats.late++;
+        }
+
+        const int32_t absTransit = transitUs < 0 ? -transitUs : transitUs;
+        const int32_t jitter     = static_cast<int32_t>(bis.stats.jitterUs);
+        bis.stats.jitterUs       = jitter + (absTransit - jitter) / 16;
+    }
+
+    switch (sdu.status) {
+        case BLE_ISO_DATA_STATUS_LOST:
+            bis.stats.lost++;
+            break;
+        case BLE_ISO_DATA_STATUS_ERROR:
+            bis.stats.errors++;
+            break;
+        default:
+            bis.stats.received++;
+            break;
+    }
+
+    bis.first           = false;
+    bis.lastSeqNum      = sdu.seqNum;
+    bis.lastArrivalUs   = sdu.arrivalUs;
+    bis.lastTimestampUs = sdu.timestampUs;
+    ble_npl_hw_exit_critical(0);
+
+    m_pCallbacks->onSdu(this, idx, sdu);
+    os_mbuf_free_chain(om);
+} // onRx
+
+/**
+ * @brief Handle the BIG sync and ISO data events from the host.
+ * @param [in] event The event data.
+ * @param [in] arg A pointer to the NimBLEIsoReceiver instance.
+ */
+int NimBLEIsoReceiver::handleIsoEvent(ble_iso_event* event, void* arg) {
+    auto pRx = static_cast<NimBLEIsoReceiver*>(arg);
+
+    switch (event->type) {
+        case BLE_ISO_EVENT_BIG_SYNC_ESTABLISHED: {
+            const uint8_t status = event->big_sync_established.status;
+            NIMBLE_LOGD(LOG_TAG, "BIG sync established; status=%u", status);
+            if (status != 0) {
+                pRx->releaseBis();
+                pRx->m_pCallbacks->onSync(pRx, status);
+                break;
+            }
+
+            const auto& desc     = event->big_sync_established.desc;
+            pRx->m_bigHandle     = desc.big_handle;
+            pRx->m_sduIntervalUs = desc.iso_interval * 1250 / std::max<uint8_t>(desc.bn, 1);
+            for (uint8_t i = 0; i < pRx->m_numBis && i < desc.num_bis; i++) {
+                pRx->m_bis[i].connHandle = desc.conn_handle[i];
+
+                ble_iso_data_path_setup_params params{};
+                params.conn_handle     = desc.conn_handle[i];
+                params.data_path_dir   = BLE_ISO_DATA_DIR_RX;
+                params.data_path_id    = BLE_HCI_ISO_DATA_PATH_ID_HCI;
+                params.codec_id.format = codingFormatTransparent;
+                params.cb              = NimBLEIsoReceiver::handleIsoEvent;
+                params.cb_arg          = pRx;
+                int rc                 = ble_iso_data_path_setup(&params);
+                if (rc != 0) {
+                    NIMBLE_LOGE(LOG_TAG, "ble_iso_data_path_setup: rc=%d %s", rc, NimBLEUtils::returnCodeToString(rc));
+                }
+            }
+
+            pRx->m_synced = true;
+            pRx->m_pCallbacks->onSync(pRx, 0);
+            break;
+        } // BLE_ISO_EVENT_BIG_SYNC_ESTABLISHED
+
+        case BLE_ISO_EVENT_BIG_SYNC_TERMINATED: {
+            NIMBLE_LOGD(LOG_TAG, "BIG sync terminated; reason=%u", event->big_terminated.reason);
+            pRx->m_synced = false;
+            pRx->releaseBis();
+            pRx->m_pCallbacks->onSyncLost(pRx, event->big_terminated.reason);
+            break;
+        } // BLE_ISO_EVENT_BIG_SYNC_TERMINATED
+
+        case BLE_ISO_EVENT_ISO_RX: {
+            pRx->onRx(*event);
+            break;
+        } // BLE_ISO_EVENT_ISO_RX
+
+        default:
+            break;
+    }
+
+    return 0;
+} // handleIsoEvent
+
+/* -------------------------------------------------------------------------- */
+/*                          Default callback handlers                         */
+/* -------------------------------------------------------------------------- */
+
+void NimBLEIsoReceiverCallbacks::onSync(NimBLEIsoReceiver* pReceiver, uint8_t status) {
+    NIMBLE_LOGD("NimBLEIsoReceiverCallbacks", "onSync: Default, status=%u", status);
+} // onSync
+
+void NimBLEIsoReceiverCallbacks::onSdu(NimBLEIsoReceiver* pReceiver, uint8_t bisIndex, const NimBLEIsoReceiver::Sdu& sdu) {
+    NIMBLE_LOGD("NimBLEIsoReceiverCallbacks", "onSdu: Default, bis=%u, len=%u", bisIndex, sdu.length);
+} // onSdu
+
+void NimBLEIsoReceiverCallbacks::onSyncLost(NimBLEIsoReceiver* pReceiver, uint8_t reason) {
+    NIMBLE_LOGD("NimBLEIsoReceiverCallbacks", "onSyncLost: Default, reason=%u", reason);
+} // onSyncLost
+
+#endif // CONFIG_BT_NIMBLE_ENABLED && MYNEWT_VAL(BLE_ROLE_OBSERVER) && MYNEWT_VAL(BLE_EXT_ADV) &&
+       // MYNEWT_VAL(BLE_PERIODIC_ADV) && MYNEWT_VAL(BLE_ISO) && MYNEWT_VAL(BLE_ISO_BROADCAST_SINK)
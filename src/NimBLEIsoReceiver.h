@@ -0,0 +1,144 @@
+/*
+ * Copyright 2020-2025 Ryan Powell <ryan@nable-embedded.io> and
+ * esp-nimble-cpp, NimBLE-Arduino contributors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NIMBLE_CPP_ISO_RECEIVER_H_
+#define NIMBLE_CPP_ISO_RECEIVER_H_
+
+#include "syscfg/syscfg.h"
+#if CONFIG_BT_NIMBLE_ENABLED && MYNEWT_VAL(BLE_ROLE_OBSERVER) && MYNEWT_VAL(BLE_EXT_ADV) && \
+    MYNEWT_VAL(BLE_PERIODIC_ADV) && MYNEWT_VAL(BLE_ISO) && MYNEWT_VAL(BLE_ISO_BROADCAST_SINK)
+
+# ifdef USING_NIMBLE_ARDUINO_HEADERS
+#  include "nimble/nimble/host/include/host/ble_iso.h"
+# else
+#  include "host/ble_iso.h"
+# endif
+
+/****  FIX COMPILATION ****/
+# undef min
+# undef max
+/**************************/
+
+# include <cstdint>
+
+class NimBLEPeriodicSync;
+class NimBLEIsoReceiverCallbacks;
+
+/**
+ * @brief Broadcast isochronous stream sink.
+ * @details Synchronizes to a Broadcast Isochronous Group (BIG) announced on a periodic advertising
+ * train and delivers the SDUs received on each stream (BIS). Fragmented SDUs are flattened into a
+ * per-stream buffer taken from a single pool allocated when the receiver is started.
+ */
+class NimBLEIsoReceiver {
+  public:
+    /**
+     * @brief A received SDU, only valid for the duration of the callback.
+     */
+    struct Sdu {
+        const uint8_t* data{nullptr};
+        uint16_t       length{0};
+        uint16_t       seqNum{0};
+        uint32_t       timestampUs{0}; // controller timestamp, valid if timestampValid is set
+        uint32_t       arrivalUs{0};   // local time the SDU was received by the host
+        uint8_t        status{0};      // BLE_ISO_DATA_STATUS_VALID, BLE_ISO_DATA_STATUS_ERROR or BLE_ISO_DATA_STATUS_LOST
+        bool           timestampValid{false};
+    };
+
+    /**
+     * @brief Per stream receive statistics.
+     */
+    struct BisStats {
+        uint32_t received{0}; // SDUs delivered
+        uint32_t lost{0};     // SDUs missing from the sequence or reported lost by the controller
+        uint32_t errors{0};   // SDUs received with errors
+        uint32_t late{0};     // SDUs that arrived more than one SDU interval later than expected
+        uint32_t jitterUs{0}; // smoothed interarrival jitter
+    };
+
+    NimBLEIsoReceiver(NimBLEIsoReceiverCallbacks* pCallbacks = nullptr);
+    ~NimBLEIsoReceiver();
+    bool     start(const NimBLEPeriodicSync* pSync,
+                   uint8_t                   numBis,
+                   uint16_t                  maxSdu,
+                   uint16_t                  syncTimeoutMs = 1000,
+                   const char*               broadcastCode = nullptr);
+    bool     stop();
+    bool     isSynced() const;
+    uint8_t  getNumBis() const;
+    uint32_t getSduInterval() const;
+    bool     getStats(uint8_t bisIndex, BisStats* pStats) const;
+    void     resetStats();
+
+  private:
+    struct Bis {
+        uint16_t connHandle{0};
+        uint8_t* buf{nullptr};
+        uint32_t lastArrivalUs{0};
+        uint32_t lastTimestampUs{0};
+        uint16_t lastSeqNum{0};
+        bool     first{true};
+        BisStats stats{};
+    };
+
+    static int handleIsoEvent(ble_iso_event* event, void* arg);
+    void       onRx(const ble_iso_event& event);
+    void       releaseBis();
+
+    NimBLEIsoReceiverCallbacks* m_pCallbacks;
+    Bis*                        m_bis{nullptr};
+    uint8_t*                    m_sduPool{nullptr};
+    uint32_t                    m_sduIntervalUs{0};
+    uint16_t                    m_maxSdu{0};
+    uint8_t                     m_bigHandle{0xFF};
+    uint8_t                     m_numBis{0};
+    volatile bool               m_synced{false};
+}; // NimBLEIsoReceiver
+
+/**
+ * @brief Callbacks associated with a NimBLEIsoReceiver.
+ */
+class NimBLEIsoReceiverCallbacks {
+  public:
+    virtual ~NimBLEIsoReceiverCallbacks() {}
+
+    /**
+     * @brief Called when the BIG sync procedure completes.
+     * @param [in] pReceiver A pointer to the receiver.
+     * @param [in] status 0 if synchronized, otherwise the HCI error code.
+     */
+    virtual void onSync(NimBLEIsoReceiver* pReceiver, uint8_t status);
+
+    /**
+     * @brief Called when an SDU is received on a stream.
+     * @param [in] pReceiver A pointer to the receiver.
+     * @param [in] bisIndex The index of the stream, 0 based.
+     * @param [in] sdu The received SDU.
+     */
+    virtual void onSdu(NimBLEIsoReceiver* pReceiver, uint8_t bisIndex, const NimBLEIsoReceiver::Sdu& sdu);
+
+    /**
+     * @brief Called when the BIG sync is lost or terminated.
+     * @param [in] pReceiver A pointer to the receiver.
+     * @param [in] reason The HCI reason code.
+     */
+    virtual void onSyncLost(NimBLEIsoReceiver* pReceiver, uint8_t reason);
+}; // NimBLEIsoReceiverCallbacks
+
+#endif // CONFIG_BT_NIMBLE_ENABLED && MYNEWT_VAL(BLE_ROLE_OBSERVER) && MYNEWT_VAL(BLE_EXT_ADV) &&
+       // MYNEWT_VAL(BLE_PERIODIC_ADV) && MYNEWT_VAL(BLE_ISO) && MYNEWT_VAL(BLE_ISO_BROADCAST_SINK)
+#endif // NIMBLE_CPP_ISO_RECEIVER_H_
@@ -0,0 +1,384 @@
+/*
+ * Copyright 2020-2025 Ryan Powell <ryan@nable-embedded.io> and
+ * esp-nimble-cpp, NimBLE-Arduino contributors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "NimBLELog.h"
+#if CONFIG_BT_NIMBLE_ENABLED && MYNEWT_VAL(NIMBLE_CPP_LOG_DEFERRED)
+
+# ifdef USING_NIMBLE_ARDUINO_HEADERS
+#  include "nimble/porting/npl/freertos/include/nimble/nimble_port_freertos.h"
+#  include "nimble/console/console.h"
+# else
+#  include "nimble/nimble_port_freertos.h"
+#  include "esp_log.h"
+# endif
+
+# include <cstring>
+# include <cstddef>
+
+# define NIMBLE_LOG_ENTRIES     MYNEWT_VAL(NIMBLE_CPP_LOG_DEFERRED_ENTRIES)
+# define NIMBLE_LOG_LINE_SIZE   (192)
+# define NIMBLE_LOG_STR_NONE    UINT32_MAX
+
+# ifdef ESP_PLATFORM
+#  define NIMBLE_LOG_STACK_SIZE (MYNEWT_VAL(NIMBLE_CPP_LOG_DEFERRED_TASK_STACK_SIZE))
+# else
+#  define NIMBLE_LOG_STACK_SIZE (MYNEWT_VAL(NIMBLE_CPP_LOG_DEFERRED_TASK_STACK_SIZE) / 4)
+static StackType_t  logTaskStack[NIMBLE_LOG_STACK_SIZE];
+static StaticTask_t logTaskBuffer;
+# endif
+
+NimBLELog::Entry    NimBLELog::m_ring[NIMBLE_LOG_ENTRIES];
+uint32_t            NimBLELog::m_head            = 0;
+uint32_t            NimBLELog::m_tail            = 0;
+uint32_t            NimBLELog::m_dropped         = 0;
+uint32_t            NimBLELog::m_droppedReported = 0;
+static TaskHandle_t logTaskHandle                = nullptr;
+
+/**
+ * @brief Copy a raw argument value into the argument slots.
+ * @param [in] val A pointer to the value.
+ * @param [in] size The size of the value, a multiple of 4.
+ */
+void NimBLELog::Entry::addRaw(const void* val, size_t size) {
+    const size_t n = size / sizeof(uint32_t);
+    if (numSlots + n > MYNEWT_VAL(NIMBLE_CPP_LOG_DEFERRED_ARG_SLOTS)) {
+        truncated = true;
+        return;
+    }
+
+    memcpy(&slots[numSlots], val, size);
+    numSlots += n;
+} // addRaw
+
+/**
+ * @brief Copy a string argument into the entry, the slot holds its offset.
+ * @param [in] val The string, truncated if the entry does not have enough room left.
+ */
+void NimBLELog::Entry::addStr(const char* val) {
+    uint32_t offset = NIMBLE_LOG_STR_NONE;
+    if (val != nullptr && strLen < sizeof(str)) {
+        size_t len = strnlen(val, sizeof(str) - strLen - 1);
+        memcpy(&str[strLen], val, len);
+        str[strLen + len] = '\0';
+        offset            = strLen;
+        strLen += len + 1;
+    }
+
+    addRaw(&offset, sizeof(offset));
+} // addStr
+
+/**
+ * @brief Add an entry to the ring, dropped if the ring is full.
+ * @param [in] entry The entry to add.
+ */
+void NimBLELog::push(Entry& entry) {
+    entry.timeMs = ble_npl_time_ticks_to_ms32(ble_npl_time_get());
+
+    ble_npl_hw_enter_critical();
+    if (m_head - m_tail >= NIMBLE_LOG_ENTRIES) {
+        m_dropped++;
+    } else {
+        m_ring[m_head % NIMBLE_LOG_ENTRIES] = entry;
+        m_head++;
+    }
+    ble_npl_hw_exit_critical(0);
+} // push
+
+/**
+ * @brief Read the value of an argument from the slots of an entry.
+ * @param [in] entry The entry.
+ * @param [in,out] slot The first slot of the value, advanced past the value.
+ * @param [in] size The size of the value.
+ * @param [out] out The value, zero extended.
+ * @return True if the entry holds the value, false if the arguments are exhausted.
+ */
+bool NimBLELog::readSlots(const Entry& entry, uint8_t& slot, size_t size, uint64_t* out) {
+    const size_t n = size / sizeof(uint32_t);
+    if (slot + n > entry.numSlots) {
+        return false;
+    }
+
+    *out = 0;
+    memcpy(out, &entry.slots[slot], size);
+    slot += n;
+    return true;
+} // readSlots
+
+/**
+ * @brief Format an entry, interpreting the stored arguments as described by the format string.
+ * @param [in] entry The entry to format.
+ * @param [out] buf The buffer to write the message to.
+ * @param [in] len The size of the buffer.
+ * @return The length of the message.
+ */
+size_t NimBLELog::format(const Entry& entry, char* buf, size_t len) {
+    const char* f    = entry.format;
+    size_t      pos  = 0;
+    uint8_t     slot = 0;
+    bool        ok   = true;
+
+    auto append = [&](int n) {
+        if (n > 0) {
+            pos += n;
+            if (pos >= len) {
+                pos = len - 1;
+            }
+        }
+    };
+
+    while (*f != '\0' && pos < len - 1) {
+        if (*f != '%') {
+            buf[pos++] = *f++;
+            continue;
+        }
+
+        if (f[1] == '%') {
+            buf[pos++] = '%';
+            f += 2;
+            continue;
+        }
+
+        // Copy the flags, width and precision, '*' takes an int argument
+        char     spec[24];
+        size_t   specLen = 0;
+        int      star[2]{};
+        uint8_t  numStar = 0;
+        uint64_t val     = 0;
+
+        spec[specLen++] = *f++;
+        while (*f != '\0' && strchr("-+ #0123456789.*", *f) && specLen < sizeof(spec) - 4) {
+            if (*f == '*' && numStar < 2) {
+                if (!(ok = readSlots(entry, slot, sizeof(int), &val))) {
+                    break;
+                }
+                star[numStar++] = static_cast<int>(val);
+            }
+            spec[specLen++] = *f++;
+        }
+
+        // Length modifiers decide the argument size, they are rewritten to match the stored width
+        size_t argSize = sizeof(int);
+        bool   keepMod = false;
+        if (f[0] == 'h') {
+            keepMod = true;
+            spec[specLen++] = *f++;
+            if (f[0] == 'h') {
+                spec[specLen++] = *f++;
+            }
+        } else if (f[0] == 'l' && f[1] == 'l') {
+            argSize = sizeof(long long);
+            f += 2;
+        } else if (f[0] == 'l') {
+            argSize = sizeof(long);
+            f++;
+        } else if (f[0] == 'j') {
+            argSize = sizeof(intmax_t);
+            f++;
+        } else if (f[0] == 'z') {
+            argSize = sizeof(size_t);
+            f++;
+        } else if (f[0] == 't') {
+            argSize = sizeof(ptrdiff_t);
+            f++;
+        } else if (f[0] == 'L') {
+            f++;
+        }
+
+        const char conv = *f;
+        if (!ok || conv == '\0') {
+            break;
+        }
+        f++;
+
+        if (!keepMod && argSize > sizeof(uint32_t) && strchr("diouxX", conv)) {
+            spec[specLen++] = 'l';
+            spec[specLen++] = 'l';
+        }
+        spec[specLen++] = conv;
+        spec[specLen]   = '\0';
+
+        char*  out   = buf + pos;
+        size_t avail = len - pos;
+        int    n     = 0;
+
+        switch (conv) {
+            case 'd':
+            case 'i':
+            case 'o':
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'c':
+                if (argSize > sizeof(uint32_t) && conv != 'c') {
+                    if ((ok = readSlots(entry, slot, sizeof(uint64_t), &val))) {
+                        n = numStar == 2   ? snprintf(out, avail, spec, star[0], star[1], static_cast<long long>(val))
+                            : numStar == 1 ? snprintf(out, avail, spec, star[0], static_cast<long long>(val))
+                                           : snprintf(out, avail, spec, static_cast<long long>(val));
+                    }
+                } else if ((ok = readSlots(entry, slot, sizeof(uint32_t), &val))) {
+                    n = numStar == 2   ? snprintf(out, avail, spec, star[0], star[1], static_cast<int>(val))
+                        : numStar == 1 ? snprintf(out, avail, spec, star[0], static_cast<int>(val))
+                                       : snprintf(out, avail, spec, static_cast<int>(val));
+                }
+                break;
+
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                if ((ok = readSlots(entry, slot, sizeof(double), &val))) {
+                    double d;
+                    memcpy(&d, &val, sizeof(d));
+                    n = numStar == 2   ? snprintf(out, avail, spec, star[0], star[1], d)
+                        : numStar == 1 ? snprintf(out, avail, spec, star[0], d)
+                                       : snprintf(out, avail, spec, d);
+                }
+                break;
+
+            case 's':
+                if ((ok = readSlots(entry, slot, sizeof(uint32_t), &val))) {
+                    const char* str = val < entry.strLen ? &entry.str[val] : "(null)";
+                    n               = numStar == 2   ? snprintf(out, avail, spec, star[0], star[1], str)
+                                      : numStar == 1 ? snprintf(out, avail, spec, star[0], str)
+                                                     : snprintf(out, avail, spec, str);
+                }
+                break;
+
+            case 'p':
+                if ((ok = readSlots(entry, slot, sizeof(uintptr_t), &val))) {
+                    n = snprintf(out, avail, "%p", reinterpret_cast<void*>(static_cast<uintptr_t>(val)));
+                }
+                break;
+
+            default:
+                // %n and unknown conversions are not supported, print them as is
+                n = snprintf(out, avail, "%s", spec);
+                break;
+        }
+
+        if (!ok) {
+            break;
+        }
+        append(n);
+    }
+
+    if ((!ok || entry.truncated) && pos < len - 1) {
+        append(snprintf(buf + pos, len - pos, "<args truncated>"));
+    }
+
+    buf[pos] = '\0';
+    return pos;
+} // format
+
+/**
+ * @brief Format and print stored log messages.
+ * @param [in] maxEntries The maximum number of messages to print, all are printed by default.
+ * @details Called periodically by the log task if NIMBLE_CPP_LOG_DEFERRED_TASK_PRIORITY is not 0,
+ * otherwise the application should call it, e.g. from loop().
+ */
+void NimBLELog::flush(uint32_t maxEntries) {
+    static char line[NIMBLE_LOG_LINE_SIZE];
+    Entry       entry;
+
+    while (maxEntries--) {
+        ble_npl_hw_enter_critical();
+        if (m_tail == m_head) {
+            ble_npl_hw_exit_critical(0);
+            break;
+        }
+        entry = m_ring[m_tail % NIMBLE_LOG_ENTRIES];
+        m_tail++;
+        ble_npl_hw_exit_critical(0);
+
+        format(entry, line, sizeof(line));
+        const char lvl = "?EWID"[entry.level <= 4 ? entry.level : 0];
+# ifdef USING_NIMBLE_ARDUINO_HEADERS
+        console_printf("%c (%lu) %s: %s\n", lvl, static_cast<unsigned long>(entry.timeMs), entry.tag, line);
+# else
+        esp_log_write(static_cast<esp_log_level_t>(entry.level),
+                      entry.tag,
+                      "%c (%lu) %s: %s\n",
+                      lvl,
+                      static_cast<unsigned long>(entry.timeMs),
+                      entry.tag,
+                      line);
+# endif
+    }
+
+    const uint32_t dropped = m_dropped;
+    if (dropped != m_droppedReported) {
+# ifdef USING_NIMBLE_ARDUINO_HEADERS
+        console_printf("W NimBLELog: %lu messages dropped\n", static_cast<unsigned long>(dropped - m_droppedReported));
+# else
+        esp_log_write(ESP_LOG_WARN,
+                      "NimBLELog",
+                      "W NimBLELog: %lu messages dropped\n",
+                      static_cast<unsigned long>(dropped - m_droppedReported));
+# endif
+        m_droppedReported = dropped;
+    }
+} // flush
+
+/**
+ * @brief Get the number of messages dropped because the ring buffer was full.
+ * @return The number of dropped messages since startup.
+ */
+uint32_t NimBLELog::getDropped() {
+    return m_dropped;
+} // getDropped
+
+static void logTask(void* arg) {
+    (void)arg;
+
+    for (;;) {
+        NimBLELog::flush();
+        vTaskDelay(pdMS_TO_TICKS(MYNEWT_VAL(NIMBLE_CPP_LOG_DEFERRED_FLUSH_MS)));
+    }
+}
+
+/**
+ * @brief Start the low priority task that flushes the stored messages, called by NimBLEDevice::init.
+ * @details Does nothing if the task is running or NIMBLE_CPP_LOG_DEFERRED_TASK_PRIORITY is 0.
+ */
+void NimBLELog::startTask() {
+    if (MYNEWT_VAL(NIMBLE_CPP_LOG_DEFERRED_TASK_PRIORITY) == 0 || logTaskHandle != nullptr) {
+        return;
+    }
+
+# ifdef ESP_PLATFORM
+    xTaskCreate(logTask,
+                "nimble_log",
+                NIMBLE_LOG_STACK_SIZE,
+                nullptr,
+                MYNEWT_VAL(NIMBLE_CPP_LOG_DEFERRED_TASK_PRIORITY),
+                &logTaskHandle);
+# else
+    logTaskHandle = xTaskCreateStatic(logTask,
+                                      "nimble_log",
+                                      NIMBLE_LOG_STACK_SIZE,
+                                      nullptr,
+                                      MYNEWT_VAL(NIMBLE_CPP_LOG_DEFERRED_TASK_PRIORITY),
+                                      logTaskStack,
+                                      &logTaskBuffer);
+# endif
+} // startTask
+
+#endif // CONFIG_BT_NIMBLE_ENABLED && MYNEWT_VAL(NIMBLE_CPP_LOG_DEFERRED)
@@ -33,7 +33,139 @@
 #  endif
 # endif
 
-# ifndef USING_NIMBLE_ARDUINO_HEADERS
+# if MYNEWT_VAL(NIMBLE_CPP_LOG_DEFERRED)
+#  include <cstdio>
+#  include <cstdint>
+#  include <type_traits>
+
+/**
+ * @brief Deferred log backend.
+ * @details The NIMBLE_LOGx macros store the format string pointer and the raw arguments in a ring buffer
+ * instead of formatting at the call site, the messages are formatted when flush() is called, either by the
+ * background task or by the application. String arguments are copied into the entry since they may not outlive
+ * the call, other pointer arguments are stored as is. The format string must be a literal.
+ */
+class NimBLELog {
+  public:
+    static void     flush(uint32_t maxEntries = UINT32_MAX);
+    static uint32_t getDropped();
+    static void     startTask();
+
+    /**
+     * @brief Store a log message for later formatting, used by the NIMBLE_LOGx macros.
+     * @param [in] level The log level, 1 = ERROR, 2 = WARNING, 3 = INFO, 4 = DEBUG.
+     * @param [in] tag The log tag, must remain valid until the message is flushed.
+     * @param [in] format The printf style format string, must remain valid until the message is flushed.
+     * @param [in] args The arguments of the format string.
+     */
+    template <typename... Args>
+    static void record(uint8_t level, const char* tag, const char* format, const Args&... args) {
+        Entry entry{};
+        entry.level  = level;
+        entry.tag    = tag;
+        entry.format = format;
+        int expand[] = {0, (entry.add(args), 0)...}; // evaluated in order, C++11 has no fold expressions
+        (void)expand;
+        push(entry);
+    }
+
+  private:
+    struct Entry {
+        const char* tag{nullptr};
+        const char* format{nullptr};
+        uint32_t    timeMs{0};
+        uint8_t     level{0};
+        uint8_t     numSlots{0}; // 32 bit argument slots used, 64 bit values take two
+        uint8_t     strLen{0};   // bytes of str used by copied string arguments
+        bool        truncated{false};
+        uint32_t    slots[MYNEWT_VAL(NIMBLE_CPP_LOG_DEFERRED_ARG_SLOTS)]{};
+        char        str[MYNEWT_VAL(NIMBLE_CPP_LOG_DEFERRED_STR_SIZE)]{};
+
+        void addRaw(const void* val, size_t size);
+        void addStr(const char* val);
+
+        /* Overloads select how each argument is stored, arrays decay so string literals are copied. */
+        template <typename T>
+        void add(const T& val) {
+            addArg(static_cast<typename std::decay<const T>::type>(val));
+        }
+
+        void addArg(const char* val) { addStr(val); }
+        void addArg(char* val) { addStr(val); }
+        void addArg(double val) { addRaw(&val, sizeof(val)); }
+        void addArg(float val) { addArg(static_cast<double>(val)); }
+        void addArg(long double val) { addArg(static_cast<double>(val)); }
+
+        template <typename T>
+        void addArg(T* val) {
+            uintptr_t p = reinterpret_cast<uintptr_t>(val);
+            addRaw(&p, sizeof(p));
+        }
+
+        template <typename T>
+        void addArg(T val) {
+            static_assert(std::is_integral<T>::value || std::is_enum<T>::value, "unsupported log argument type");
+            addInt(val, std::integral_constant<bool, (sizeof(T) <= sizeof(uint32_t))>());
+        }
+
+        template <typename T>
+        void addInt(T val, std::true_type) {
+            uint32_t v = static_cast<uint32_t>(val);
+            addRaw(&v, sizeof(v));
+        }
+
+        template <typename T>
+        void addInt(T val, std::false_type) {
+            uint64_t v = static_cast<uint64_t>(val);
+            addRaw(&v, sizeof(v));
+        }
+    };
+
+    static void   push(Entry& entry);
+    static bool   readSlots(const Entry& entry, uint8_t& slot, size_t size, uint64_t* out);
+    static size_t format(const Entry& entry, char* buf, size_t len);
+
+    static Entry    m_ring[MYNEWT_VAL(NIMBLE_CPP_LOG_DEFERRED_ENTRIES)];
+    static uint32_t m_head; // next entry to write
+    static uint32_t m_tail; // next entry to format
+    static uint32_t m_dropped;
+    static uint32_t m_droppedReported;
+}; // NimBLELog
+
+/* The printf call is never executed, it only keeps the compiler's format string checks. */
+#  define NIMBLE_CPP_LOG_DEFER(level, tag, format, ...)                      \
+      do {                                                                  \
+          if (0) {                                                          \
+              ::printf(format, ##__VA_ARGS__);                              \
+          }                                                                 \
+          NimBLELog::record(level, tag, format, ##__VA_ARGS__);             \
+      } while (0)
+
+#  if MYNEWT_VAL(NIMBLE_CPP_LOG_LEVEL) >= 4
+#   define NIMBLE_LOGD(tag, format, ...) NIMBLE_CPP_LOG_DEFER(4, tag, format, ##__VA_ARGS__)
+#  else
+#   define NIMBLE_LOGD(tag, format, ...) (void)tag
+#  endif
+
+#  if MYNEWT_VAL(NIMBLE_CPP_LOG_LEVEL) >= 3
+#   define NIMBLE_LOGI(tag, format, ...) NIMBLE_CPP_LOG_DEFER(3, tag, format, ##__VA_ARGS__)
+#  else
+#   define NIMBLE_LOGI(tag, format, ...) (void)tag
+#  endif
+
+#  if MYNEWT_VAL(NIMBLE_CPP_LOG_LEVEL) >= 2
+#   define NIMBLE_LOGW(tag, format, ...) NIMBLE_CPP_LOG_DEFER(2, tag, format, ##__VA_ARGS__)
+#  else
+#   define NIMBLE_LOGW(tag, format, ...) (void)tag
+#  endif
+
+#  if MYNEWT_VAL(NIMBLE_CPP_LOG_LEVEL) >= 1
+#   define NIMBLE_LOGE(tag, format, ...) NIMBLE_CPP_LOG_DEFER(1, tag, format, ##__VA_ARGS__)
+#  else
+#   define NIMBLE_LOGE(tag, format, ...) (void)tag
+#  endif
+
+# elif !defined(USING_NIMBLE_ARDUINO_HEADERS)
 #  include "esp_log.h"
 #  include "console/console.h"
 
@@ -172,7 +304,7 @@
 #   define NIMBLE_LOGE(tag, format, ...) (void)tag
 #  endif
 
-# endif  /* !USING_NIMBLE_ARDUINO_HEADERS */
+# endif  /* MYNEWT_VAL(NIMBLE_CPP_LOG_DEFERRED) */
 
 #  define NIMBLE_LOGD_IF(cond, tag, format, ...) { if (cond) { NIMBLE_LOGD(tag, format, ##__VA_ARGS__); }}
 #  define NIMBLE_LOGI_IF(cond, tag, format, ...) { if (cond) { NIMBLE_LOGI(tag, format, ##__VA_ARGS__); }}
@@ -0,0 +1,278 @@
+/*
+ * Copyright 2020-2025 Ryan Powell <ryan@nable-embedded.io> and
+ * esp-nimble-cpp, NimBLE-Arduino contributors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "NimBLEPeriodicSync.h"
+#if CONFIG_BT_NIMBLE_ENABLED && MYNEWT_VAL(BLE_ROLE_OBSERVER) && MYNEWT_VAL(BLE_EXT_ADV) && MYNEWT_VAL(BLE_PERIODIC_ADV)
+
+# include "NimBLEDevice.h"
+# include "NimBLEScan.h"
+# include "NimBLEUtils.h"
+# include "NimBLELog.h"
+
+# include <algorithm>
+# include <cstring>
+
+static NimBLEPeriodicSyncCallbacks defaultCallbacks;
+static const char*                 LOG_TAG = "NimBLEPeriodicSync";
+
+/**
+ * @brief Constructor, syncs are created by NimBLEScan::createPeriodicSync().
+ * @param [in] address The address of the periodic advertiser.
+ * @param [in] sid The advertising set ID of the periodic advertisement.
+ * @param [in] pCallbacks A pointer to the callbacks, nullptr to use the default callbacks.
+ */
+NimBLEPeriodicSync::NimBLEPeriodicSync(const NimBLEAddress& address, uint8_t sid, NimBLEPeriodicSyncCallbacks* pCallbacks)
+    : m_address{address}, m_pCallbacks{pCallbacks ? pCallbacks : &defaultCallbacks}, m_sid{sid} {}
+
+/**
+ * @brief Schedule the sync procedure, it is performed while an extended scan is running.
+ * @param [in] timeoutMs The sync timeout in milliseconds.
+ * @param [in] skip The number of periodic advertising events that can be skipped after a successful receive.
+ * @return True if the procedure was scheduled.
+ */
+bool NimBLEPeriodicSync::create(uint16_t timeoutMs, uint16_t skip) {
+    ble_gap_periodic_sync_params params{};
+    params.skip         = skip;
+    params.sync_timeout = std::max<uint16_t>(timeoutMs / 10, 0x000A);
+
+    m_state = State::PENDING;
+    int rc  = ble_gap_periodic_adv_sync_create(m_address.getBase(), m_sid, &params, NimBLEPeriodicSync::handleGapEvent, this);
+    if (rc != 0) {
+        NIMBLE_LOGE(LOG_TAG, "ble_gap_periodic_adv_sync_create: rc=%d %s", rc, NimBLEUtils::returnCodeToString(rc));
+        m_state = State::IDLE;
+        return false;
+    }
+
+    return true;
+} // create
+
+/**
+ * @brief Terminate the sync, or cancel it if it is still pending.
+ * @return True if successful, NimBLEPeriodicSyncCallbacks::onSyncLost or onSync is called when complete.
+ */
+bool NimBLEPeriodicSync::terminate() {
+    int rc = 0;
+    switch (m_state) {
+        case State::PENDING:
+            rc = ble_gap_periodic_adv_sync_create_cancel();
+            break;
+        case State::SYNCED:
+            rc = ble_gap_periodic_adv_sync_terminate(m_handle);
+            break;
+        default:
+            return true;
+    }
+
+    if (rc != 0 && rc != BLE_HS_ENOTCONN) {
+        NIMBLE_LOGE(LOG_TAG, "Failed to terminate sync: rc=%d %s", rc, NimBLEUtils::returnCodeToString(rc));
+        return false;
+    }
+
+    return true;
+} // terminate
+
+/**
+ * @brief Check if the periodic advertising train is synchronized.
+ * @return True if synchronized.
+ */
+bool NimBLEPeriodicSync::isSynced() const {
+    return m_state == State::SYNCED;
+} // isSynced
+
+/**
+ * @brief Check if the sync procedure has been scheduled and not yet completed.
+ * @return True if pending.
+ */
+bool NimBLEPeriodicSync::isPending() const {
+    return m_state == State::PENDING;
+} // isPending
+
+/**
+ * @brief Get the sync handle assigned by the controller.
+ * @return The sync handle, 0xFFFF if not synchronized.
+ */
+uint16_t NimBLEPeriodicSync::getHandle() const {
+    return m_handle;
+} // getHandle
+
+/**
+ * @brief Get the address of the periodic advertiser.
+ * @return The address of the periodic advertiser.
+ */
+const NimBLEAddress& NimBLEPeriodicSync::getAddress() const {
+    return m_address;
+} // getAddress
+
+/**
+ * @brief Get the advertising set ID of the periodic advertisement.
+ * @return The advertising set ID.
+ */
+uint8_t NimBLEPeriodicSync::getSid() const {
+    return m_sid;
+} // getSid
+
+/**
+ * @brief Get the PHY of the periodic advertisement.
+ * @return The PHY, one of BLE_HCI_LE_PHY_1M, BLE_HCI_LE_PHY_2M, BLE_HCI_LE_PHY_CODED or 0 if not synchronized.
+ */
+uint8_t NimBLEPeriodicSync::getPhy() const {
+    return m_phy;
+} // getPhy
+
+/**
+ * @brief Get the periodic advertising interval.
+ * @return The interval in 1.25ms units, 0 if not synchronized.
+ */
+uint16_t NimBLEPeriodicSync::getInterval() const {
+    return m_interval;
+} // getInterval
+
+/**
+ * @brief Get the report counters of this sync.
+ * @return A reference to the report counters.
+ */
+const NimBLEPeriodicSync::Stats& NimBLEPeriodicSync::getStats() const {
+    return m_stats;
+} // getStats
+
+/**
+ * @brief Reset the report counters of this sync.
+ */
+void NimBLEPeriodicSync::resetStats() {
+    m_stats = Stats{};
+} // resetStats
+
+/**
+ * @brief Reassemble a periodic report fragment and deliver the report when complete.
+ * @param [in] event The report event.
+ * @details A report that arrives in a single fragment is delivered directly from the event data.
+ */
+void NimBLEPeriodicSync::onReport(const ble_gap_event& event) {
+    const auto& report = event.periodic_report;
+    m_stats.fragments++;
+
+    if (m_dropping) {
+        if (report.data_status != BLE_HCI_PERIODIC_DATA_STATUS_INCOMPLETE) {
+            m_dropping = false;
+        }
+        return;
+    }
+
+    if (report.data_status == BLE_HCI_PERIODIC_DATA_STATUS_TRUNCATED) {
+        m_stats.truncated++;
+        m_len = 0;
+        return;
+    }
+
+    if (m_len == 0 && report.data_status == BLE_HCI_PERIODIC_DATA_STATUS_COMPLETE) {
+        m_stats.reports++;
+        m_pCallbacks->onReport(this, report.data, report.data_length, report.rssi, report.tx_power);
+        return;
+    }
+
+    if (m_buf == nullptr || m_len + report.data_length > MYNEWT_VAL(NIMBLE_CPP_PERIODIC_REPORT_MAX_LEN)) {
+        NIMBLE_LOGW(LOG_TAG, "Periodic report too large, dropped");
+        m_stats.truncated++;
+        m_len      = 0;
+        m_dropping = report.data_status == BLE_HCI_PERIODIC_DATA_STATUS_INCOMPLETE;
+        return;
+    }
+
+    memcpy(m_buf + m_len, report.data, report.data_length);
+    m_len += report.data_length;
+
+    if (report.data_status == BLE_HCI_PERIODIC_DATA_STATUS_COMPLETE) {
+        m_stats.reports++;
+        m_pCallbacks->onReport(this, m_buf, m_len, report.rssi, report.tx_power);
+        m_len = 0;
+    }
+} // onReport
+
+/**
+ * @brief Handle the periodic sync events from the host.
+ * @param [in] event The event data.
+ * @param [in] arg A pointer to the NimBLEPeriodicSync instance.
+ */
+int NimBLEPeriodicSync::handleGapEvent(ble_gap_event* event, void* arg) {
+    auto pSync = static_cast<NimBLEPeriodicSync*>(arg);
+    auto pScan = NimBLEDevice::getScan();
+
+    switch (event->type) {
+        case BLE_GAP_EVENT_PERIODIC_SYNC: {
+            const auto& sync = event->periodic_sync;
+            NIMBLE_LOGD(LOG_TAG, "Periodic sync status=%d handle=%d", sync.status, sync.sync_handle);
+            if (sync.status == BLE_ERR_SUCCESS) {
+                pSync->m_handle   = sync.sync_handle;
+                pSync->m_phy      = sync.adv_phy;
+                pSync->m_interval = sync.per_adv_ival;
+                pSync->m_buf      = pScan->acquireReportBuffer();
+                pSync->m_len      = 0;
+                pSync->m_dropping = false;
+                pSync->m_state    = State::SYNCED;
+            } else {
+                pSync->m_state = State::IDLE;
+            }
+
+            pSync->m_pCallbacks->onSync(pSync, sync.status);
+            break;
+        } // BLE_GAP_EVENT_PERIODIC_SYNC
+
+        case BLE_GAP_EVENT_PERIODIC_REPORT: {
+            pSync->onReport(*event);
+            break;
+        } // BLE_GAP_EVENT_PERIODIC_REPORT
+
+        case BLE_GAP_EVENT_PERIODIC_SYNC_LOST: {
+            NIMBLE_LOGD(LOG_TAG, "Periodic sync lost; handle=%d reason=%d",
+                        event->periodic_sync_lost.sync_handle,
+                        event->periodic_sync_lost.reason);
+            pScan->releaseReportBuffer(pSync->m_buf);
+            pSync->m_buf      = nullptr;
+            pSync->m_len      = 0;
+            pSync->m_handle   = 0xFFFF;
+            pSync->m_interval = 0;
+            pSync->m_phy      = 0;
+            pSync->m_state    = State::IDLE;
+            pSync->m_pCallbacks->onSyncLost(pSync, event->periodic_sync_lost.reason);
+            break;
+        } // BLE_GAP_EVENT_PERIODIC_SYNC_LOST
+
+        default:
+            break;
+    }
+
+    return 0;
+} // handleGapEvent
+
+/* -------------------------------------------------------------------------- */
+/*                          Default callback handlers                         */
+/* -------------------------------------------------------------------------- */
+
+void NimBLEPeriodicSyncCallbacks::onSync(NimBLEPeriodicSync* pSync, uint8_t status) {
+    NIMBLE_LOGD("NimBLEPeriodicSyncCallbacks", "onSync: Default, status=%u", status);
+} // onSync
+
+void NimBLEPeriodicSyncCallbacks::onReport(
+    NimBLEPeriodicSync* pSync, const uint8_t* data, size_t length, int8_t rssi, int8_t txPower) {
+    NIMBLE_LOGD("NimBLEPeriodicSyncCallbacks", "onReport: Default, length=%zu", length);
+} // onReport
+
+void NimBLEPeriodicSyncCallbacks::onSyncLost(NimBLEPeriodicSync* pSync, int reason) {
+    NIMBLE_LOGD("NimBLEPeriodicSyncCallbacks", "onSyncLost: Default, reason=%d", reason);
+} // onSyncLost
+
+#endif // CONFIG_BT_NIMBLE_ENABLED && MYNEWT_VAL(BLE_ROLE_OBSERVER) && MYNEWT_VAL(BLE_EXT_ADV) && MYNEWT_VAL(BLE_PERIODIC_ADV)
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2020-2025 Ryan Powell <ryan@nable-embedded.io> and
+ * esp-nimble-cpp, NimBLE-Arduino contributors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NIMBLE_CPP_PERIODIC_SYNC_H_
+#define NIMBLE_CPP_PERIODIC_SYNC_H_
+
+#include "syscfg/syscfg.h"
+#if CONFIG_BT_NIMBLE_ENABLED && MYNEWT_VAL(BLE_ROLE_OBSERVER) && MYNEWT_VAL(BLE_EXT_ADV) && MYNEWT_VAL(BLE_PERIODIC_ADV)
+
+# ifdef USING_NIMBLE_ARDUINO_HEADERS
+#  include "nimble/nimble/host/include/host/ble_gap.h"
+# else
+#  include "host/ble_gap.h"
+# endif
+
+/****  FIX COMPILATION ****/
+# undef min
+# undef max
+/**************************/
+
+# include "NimBLEAddress.h"
+
+# include <cstddef>
+# include <cstdint>
+
+# ifndef MYNEWT_VAL_NIMBLE_CPP_PERIODIC_REPORT_MAX_LEN
+#  ifndef CONFIG_NIMBLE_CPP_PERIODIC_REPORT_MAX_LEN
+#   define MYNEWT_VAL_NIMBLE_CPP_PERIODIC_REPORT_MAX_LEN MYNEWT_VAL_BLE_EXT_ADV_MAX_SIZE
+#  else
+#   define MYNEWT_VAL_NIMBLE_CPP_PERIODIC_REPORT_MAX_LEN CONFIG_NIMBLE_CPP_PERIODIC_REPORT_MAX_LEN
+#  endif
+# endif
+
+class NimBLEScan;
+class NimBLEPeriodicSyncCallbacks;
+
+/**
+ * @brief A synchronization with a periodic advertising train.
+ * @details Created with NimBLEScan::createPeriodicSync(), the sync is established while an
+ * extended scan is running. Chained report fragments are reassembled into a buffer taken from
+ * a pool owned by NimBLEScan and complete reports are delivered as a pointer and length that
+ * are only valid for the duration of the callback.
+ */
+class NimBLEPeriodicSync {
+  public:
+    /**
+     * @brief Report counters for a periodic sync.
+     */
+    struct Stats {
+        uint32_t reports{0};   // complete reports delivered
+        uint32_t fragments{0}; // report fragments received
+        uint32_t truncated{0}; // reports dropped, truncated by the controller or larger than the buffer
+    };
+
+    bool                 isSynced() const;
+    bool                 isPending() const;
+    bool                 terminate();
+    uint16_t             getHandle() const;
+    const NimBLEAddress& getAddress() const;
+    uint8_t              getSid() const;
+    uint8_t              getPhy() const;
+    uint16_t             getInterval() const;
+    const Stats&         getStats() const;
+    void                 resetStats();
+
+  private:
+    friend class NimBLEScan;
+
+    enum class State : uint8_t { IDLE, PENDING, SYNCED };
+
+    NimBLEPeriodicSync(const NimBLEAddress& address, uint8_t sid, NimBLEPeriodicSyncCallbacks* pCallbacks);
+    bool       create(uint16_t timeoutMs, uint16_t skip);
+    void       onReport(const ble_gap_event& event);
+    static int handleGapEvent(ble_gap_event* event, void* arg);
+
+    NimBLEAddress                m_address;
+    NimBLEPeriodicSyncCallbacks* m_pCallbacks;
+    uint8_t*                     m_buf{nullptr}; // reassembly buffer from the scan pool, held while synced
+    uint16_t                     m_len{0};
+    uint16_t                     m_handle{0xFFFF};
+    uint16_t                     m_interval{0};
+    uint8_t                      m_sid;
+    uint8_t                      m_phy{0};
+    volatile State               m_state{State::IDLE};
+    bool                         m_dropping{false}; // discard fragments until the end of an oversized report
+    Stats                        m_stats{};
+}; // NimBLEPeriodicSync
+
+/**
+ * @brief Callbacks associated with a periodic advertising sync.
+ */
+class NimBLEPeriodicSyncCallbacks {
+  public:
+    virtual ~NimBLEPeriodicSyncCallbacks() {}
+
+    /**
+     * @brief Called when the sync procedure completes.
+     * @param [in] pSync A pointer to the periodic sync.
+     * @param [in] status BLE_ERR_SUCCESS (0) if the sync was established, otherwise the HCI error code.
+     */
+    virtual void onSync(NimBLEPeriodicSync* pSync, uint8_t status);
+
+    /**
+     * @brief Called when a complete periodic advertising report is received.
+     * @param [in] pSync A pointer to the periodic sync.
+     * @param [in] data A pointer to the report data, only valid for the duration of the callback.
+     * @param [in] length The length of the report data.
+     * @param [in] rssi The signal strength of the last fragment, 127 if unavailable.
+     * @param [in] txPower The advertiser transmit power, 127 if unavailable.
+     */
+    virtual void onReport(NimBLEPeriodicSync* pSync, const uint8_t* data, size_t length, int8_t rssi, int8_t txPower);
+
+    /**
+     * @brief Called when the sync is lost or terminated.
+     * @param [in] pSync A pointer to the periodic sync.
+     * @param [in] reason BLE_HS_ETIMEOUT if the sync timed out, BLE_HS_EDONE if terminated locally.
+     */
+    virtual void onSyncLost(NimBLEPeriodicSync* pSync, int reason);
+}; // NimBLEPeriodicSyncCallbacks
+
+#endif // CONFIG_BT_NIMBLE_ENABLED && MYNEWT_VAL(BLE_ROLE_OBSERVER) && MYNEWT_VAL(BLE_EXT_ADV) && MYNEWT_VAL(BLE_PERIODIC_ADV)
+#endif // NIMBLE_CPP_PERIODIC_SYNC_H_
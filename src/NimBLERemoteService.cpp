@@ -24,6 +24,7 @@
 # include "NimBLEUtils.h"
 # include "NimBLELog.h"
 
+# include <algorithm>
 # include <climits>
 
 static const char* LOG_TAG = "NimBLERemoteService";
@@ -68,6 +69,25 @@ NimBLERemoteCharacteristic* NimBLERemoteService::getCharacteristic(const char* u
     return getCharacteristic(NimBLEUUID(uuid));
 } // getCharacteristic
 
+/**
+ * @brief Get a characteristic already retrieved from the peer by its handle.
+ * @param [in] handle The handle of the characteristic value declaration.
+ * @return A pointer to the characteristic object, or nullptr if not found.
+ * @note This does not perform discovery, characteristics are kept in handle order so this is a binary search.
+ */
+NimBLERemoteCharacteristic* NimBLERemoteService::getCharacteristicByHandle(uint16_t handle) const {
+    auto it = std::lower_bound(m_vChars.begin(),
+                               m_vChars.end(),
+                               handle,
+                               [](const NimBLERemoteCharacteristic* chr, uint16_t h) { return chr->getHandle() < h; });
+
+    if (it != m_vChars.end() && (*it)->getHandle() == handle) {
+        return *it;
+    }
+
+    return nullptr;
+} // getCharacteristicByHandle
+
 /**
  * @brief Get the characteristic object for the UUID.
  * @param [in] uuid Characteristic uuid.
@@ -75,14 +95,10 @@ NimBLERemoteCharacteristic* NimBLERemoteService::getCharacteristic(const char* u
  */
 NimBLERemoteCharacteristic* NimBLERemoteService::getCharacteristic(const NimBLEUUID& uuid) const {
     NIMBLE_LOGD(LOG_TAG, ">> getCharacteristic: uuid: %s", uuid.toString().c_str());
-    NimBLERemoteCharacteristic* pChar = nullptr;
-
-    for (const auto& it : m_vChars) {
-        if (it->getUUID() == uuid) {
-            pChar = it;
-            NIMBLE_LOGD(LOG_TAG, "<< getCharacteristic: found in cache");
-            return pChar;
-        }
+    NimBLERemoteCharacteristic* pChar = m_chrIndex.find(m_vChars, uuid);
+    if (pChar != nullptr) {
+        NIMBLE_LOGD(LOG_TAG, "<< getCharacteristic: found in cache");
+        return pChar;
     }
 
     if (retrieveCharacteristics(&uuid, &pChar) && pChar == nullptr) {
@@ -141,6 +157,7 @@ int NimBLERemoteService::characteristicDiscCB(uint16_t              conn_handle,
 
     if (error->status == BLE_HS_ENOTCONN) {
         NIMBLE_LOGE(LOG_TAG, "<< Characteristic Discovery; Not connected");
+        pSvc->m_chrIndex.update(pSvc->m_vChars);
         NimBLEUtils::taskRelease(*pTaskData, error->status);
         return error->status;
     }
@@ -151,7 +168,7 @@ int NimBLERemoteService::characteristicDiscCB(uint16_t              conn_handle,
     }
 
     if (error->status == 0) {
-        // insert in handle order
+        // insert in handle order, the index is rebuilt once when discovery completes
         auto pNewChar = new NimBLERemoteCharacteristic(pSvc, chr);
         for (auto it = pSvc->m_vChars.begin(); it != pSvc->m_vChars.end(); ++it) {
             if ((*it)->getHandle() > chr->def_handle) {
@@ -166,6 +183,7 @@ int NimBLERemoteService::characteristicDiscCB(uint16_t              conn_handle,
         return 0;
     }
 
+    pSvc->m_chrIndex.update(pSvc->m_vChars);
     NimBLEUtils::taskRelease(*pTaskData, error->status);
     NIMBLE_LOGD(LOG_TAG, "<< Characteristic Discovery");
     return error->status;
@@ -263,6 +281,7 @@ void NimBLERemoteService::deleteCharacteristics() const {
         delete it;
     }
     std::vector<NimBLERemoteCharacteristic*>{}.swap(m_vChars);
+    m_chrIndex.update(m_vChars);
 } // deleteCharacteristics
 
 /**
@@ -275,6 +294,7 @@ size_t NimBLERemoteService::deleteCharacteristic(const NimBLEUUID& uuid) const {
         if ((*it)->getUUID() == uuid) {
             delete (*it);
             m_vChars.erase(it);
+            m_chrIndex.update(m_vChars);
             break;
         }
     }
@@ -22,6 +22,7 @@
 #if CONFIG_BT_NIMBLE_ENABLED && MYNEWT_VAL(BLE_ROLE_CENTRAL)
 
 # include "NimBLEAttribute.h"
+# include "NimBLEAttributeIndex.h"
 # include <vector>
 
 class NimBLERemoteCharacteristic;
@@ -35,6 +36,7 @@ class NimBLERemoteService : public NimBLEAttribute {
   public:
     NimBLERemoteCharacteristic* getCharacteristic(const char* uuid) const;
     NimBLERemoteCharacteristic* getCharacteristic(const NimBLEUUID& uuid) const;
+    NimBLERemoteCharacteristic* getCharacteristicByHandle(uint16_t handle) const;
     void                        deleteCharacteristics() const;
     size_t                      deleteCharacteristic(const NimBLEUUID& uuid) const;
     NimBLEClient*               getClient(void) const;
@@ -59,9 +61,10 @@ class NimBLERemoteService : public NimBLEAttribute {
                                     const struct ble_gatt_chr*   chr,
                                     void*                        arg);
 
-    mutable std::vector<NimBLERemoteCharacteristic*> m_vChars{};
-    NimBLEClient*                                    m_pClient{nullptr};
-    uint16_t                                         m_endHandle{0};
+    mutable std::vector<NimBLERemoteCharacteristic*>           m_vChars{};
+    mutable NimBLEAttributeIndex<NimBLERemoteCharacteristic> m_chrIndex{};
+    NimBLEClient*                                              m_pClient{nullptr};
+    uint16_t                                                   m_endHandle{0};
 }; // NimBLERemoteService
 
 #endif // CONFIG_BT_NIMBLE_ENABLED && MYNEWT_VAL(BLE_ROLE_CENTRAL)
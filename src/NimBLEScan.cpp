@@ -88,6 +88,17 @@ NimBLEScan::~NimBLEScan() {
     for (const auto& dev : m_scanResults.m_deviceVec) {
         delete dev;
     }
+
+# if MYNEWT_VAL(BLE_EXT_ADV) && MYNEWT_VAL(BLE_PERIODIC_ADV)
+    for (const auto& pSync : m_periodicSyncs) {
+        free(pSync->m_buf);
+        delete pSync;
+    }
+
+    for (const auto& buf : m_reportBufPool) {
+        free(buf);
+    }
+# endif
 }
 
 /**
@@ -236,6 +247,29 @@ int NimBLEScan::handleGapEvent(ble_gap_event* event, void* arg) {
 # endif
             NimBLEAddress advertisedAddress(disc.addr);
 
+            // Decode beacon frames in place, without creating an advertised device.
+            if (pScan->m_beaconFilter != BEACON_NONE
+# if MYNEWT_VAL(BLE_EXT_ADV)
+                && disc.data_status == BLE_GAP_EXT_ADV_DATA_STATUS_COMPLETE
+# endif
+            ) {
+                if (pScan->m_beaconFilter & BEACON_IBEACON) {
+                    NimBLEBeacon::BeaconData beacon;
+                    if (NimBLEBeacon::decode(disc.data, disc.length_data, &beacon)) {
+                        pScan->m_pScanCallbacks->onIBeacon(advertisedAddress, disc.rssi, beacon);
+                        return 0;
+                    }
+                }
+
+                if (pScan->m_beaconFilter & BEACON_EDDYSTONE_TLM) {
+                    NimBLEEddystoneTLM::BeaconData tlm;
+                    if (NimBLEEddystoneTLM::decode(disc.data, disc.length_data, &tlm)) {
+                        pScan->m_pScanCallbacks->onEddystoneTLM(advertisedAddress, disc.rssi, tlm);
+                        return 0;
+                    }
+                }
+            }
+
 # if MYNEWT_VAL(BLE_ROLE_CENTRAL)
             // stop processing if already connected
             NimBLEClient* pClient = NimBLEDevice::getClientByPeerAddress(advertisedAddress);
@@ -407,6 +441,21 @@ void NimBLEScan::setScanResponseTimeout(uint32_t timeoutMs) {
     resetWaitingTimer();
 } // setScanResponseTimeout
 
+/**
+ * @brief Get the number of events dropped before reaching the scan since it was started.
+ * @return The drop counts, see NimBLEScan::DropStats.
+ */
+NimBLEScan::DropStats NimBLEScan::getDropStats() const {
+    ble_hs_evt_drop_stats now;
+    ble_hs_evt_drop_stats_get(&now);
+
+    DropStats drops;
+    drops.rateLimited   = now.adv_rate_limited - m_dropBase.adv_rate_limited;
+    drops.noBuffer      = now.adv_no_buf - m_dropBase.adv_no_buf;
+    drops.otherNoBuffer = now.other_no_buf - m_dropBase.other_no_buf;
+    return drops;
+} // getDropStats
+
 /**
  * @brief Should we perform an active or passive scan?
  * The default is a passive scan. An active scan means that we will request a scan response.
@@ -470,6 +519,16 @@ void NimBLEScan::setMaxResults(uint8_t maxResults) {
     m_maxResults = maxResults;
 } // setMaxResults
 
+/**
+ * @brief Set the beacon types to decode directly from the scan reports.
+ * @param [in] beaconTypes A bitmask of NimBLEScan::BeaconType values, BEACON_NONE to disable.
+ * @details Reports containing a matching beacon frame are decoded without allocation and delivered
+ * to NimBLEScanCallbacks::onIBeacon or NimBLEScanCallbacks::onEddystoneTLM, they are not added to the scan results.
+ */
+void NimBLEScan::setBeaconFilter(uint8_t beaconTypes) {
+    m_beaconFilter = beaconTypes & BEACON_ALL;
+} // setBeaconFilter
+
 /**
  * @brief Set the call backs to be invoked.
  * @param [in] pScanCallbacks Call backs to be invoked.
@@ -531,6 +590,95 @@ void NimBLEScan::setPhy(Phy phyMask) {
 void NimBLEScan::setPeriod(uint32_t periodMs) {
     m_period = (periodMs + 500) / 1280; // round up 1.28 second units
 } // setScanPeriod
+
+#  if MYNEWT_VAL(BLE_PERIODIC_ADV)
+/**
+ * @brief Create a periodic advertising sync and schedule the sync procedure.
+ * @param [in] address The address of the periodic advertiser.
+ * @param [in] sid The advertising set ID of the periodic advertisement, see NimBLEAdvertisedDevice::getSetId().
+ * @param [in] pCallbacks A pointer to the callbacks for the sync, nullptr for the default callbacks.
+ * @param [in] timeoutMs The time without a received report after which the sync is lost, in milliseconds.
+ * @param [in] skip The number of periodic advertising events that can be skipped after a successful receive.
+ * @return A pointer to the sync or nullptr on failure.
+ * @details The sync is established while an extended scan is running, it is up to the application
+ * to start scanning. Only one sync procedure can be pending at a time.
+ * The sync is owned by NimBLEScan, use deletePeriodicSync() to release it.
+ */
+NimBLEPeriodicSync* NimBLEScan::createPeriodicSync(const NimBLEAddress&         address,
+                                                   uint8_t                      sid,
+                                                   NimBLEPeriodicSyncCallbacks* pCallbacks,
+                                                   uint16_t                     timeoutMs,
+                                                   uint16_t                     skip) {
+    if (m_periodicSyncs.size() >= MYNEWT_VAL(BLE_MAX_PERIODIC_SYNCS)) {
+        NIMBLE_LOGE(LOG_TAG, "Max periodic syncs reached");
+        return nullptr;
+    }
+
+    auto pSync = new NimBLEPeriodicSync(address, sid, pCallbacks);
+    if (!pSync->create(timeoutMs, skip)) {
+        delete pSync;
+        return nullptr;
+    }
+
+    m_periodicSyncs.push_back(pSync);
+    return pSync;
+} // createPeriodicSync
+
+/**
+ * @brief Delete a periodic advertising sync.
+ * @param [in] pSync A pointer to the sync to delete.
+ * @return True if deleted, false if the sync is still active.
+ * @details A sync that is pending or synchronized must be terminated first with
+ * NimBLEPeriodicSync::terminate(), wait for the onSync or onSyncLost callback before deleting it.
+ */
+bool NimBLEScan::deletePeriodicSync(NimBLEPeriodicSync* pSync) {
+    for (auto it = m_periodicSyncs.begin(); it != m_periodicSyncs.end(); ++it) {
+        if (*it == pSync) {
+            if (pSync->m_state != NimBLEPeriodicSync::State::IDLE) {
+                NIMBLE_LOGE(LOG_TAG, "Periodic sync still active, terminate it first");
+                return false;
+            }
+
+            m_periodicSyncs.erase(it);
+            delete pSync;
+            return true;
+        }
+    }
+
+    return false;
+} // deletePeriodicSync
+
+/**
+ * @brief Take a periodic report reassembly buffer from the pool, allocating one if none are free.
+ * @return A pointer to the buffer or nullptr if allocation failed.
+ * @details Only called from the host task.
+ */
+uint8_t* NimBLEScan::acquireReportBuffer() {
+    if (!m_reportBufPool.empty()) {
+        uint8_t* buf = m_reportBufPool.back();
+        m_reportBufPool.pop_back();
+        return buf;
+    }
+
+    auto buf = static_cast<uint8_t*>(malloc(MYNEWT_VAL(NIMBLE_CPP_PERIODIC_REPORT_MAX_LEN)));
+    if (buf == nullptr) {
+        NIMBLE_LOGE(LOG_TAG, "Failed to allocate periodic report buffer");
+    }
+
+    return buf;
+} // acquireReportBuffer
+
+/**
+ * @brief Return a periodic report reassembly buffer to the pool.
+ * @param [in] buf A pointer to the buffer.
+ * @details Only called from the host task.
+ */
+void NimBLEScan::releaseReportBuffer(uint8_t* buf) {
+    if (buf != nullptr) {
+        m_reportBufPool.push_back(buf);
+    }
+} // releaseReportBuffer
+#  endif
 # endif
 
 /**
@@ -553,12 +701,14 @@ bool NimBLEScan::start(uint32_t duration, bool isContinue, bool restart) {
             if (!isContinue) {
                 clearResults();
                 m_stats.reset();
+                ble_hs_evt_drop_stats_get(&m_dropBase);
             }
         }
     } else { // Don't clear results while scanning is active
         if (!isContinue) {
             clearResults();
             m_stats.reset();
+            ble_hs_evt_drop_stats_get(&m_dropBase);
         }
     }
 
@@ -822,4 +972,14 @@ void NimBLEScanCallbacks::onScanEnd(const NimBLEScanResults& results, int reason
     NIMBLE_LOGD(CB_TAG, "Scan ended; reason %d, num results: %d", reason, results.getCount());
 }
 
+void NimBLEScanCallbacks::onIBeacon(const NimBLEAddress& address, int8_t rssi, const NimBLEBeacon::BeaconData& data) {
+    NIMBLE_LOGD(CB_TAG, "iBeacon: %s, rssi: %d, major: %d, minor: %d",
+                address.toString().c_str(), rssi, ((data.major & 0xFF) << 8) | (data.major >> 8),
+                ((data.minor & 0xFF) << 8) | (data.minor >> 8));
+}
+
+void NimBLEScanCallbacks::onEddystoneTLM(const NimBLEAddress& address, int8_t rssi, const NimBLEEddystoneTLM::BeaconData& data) {
+    NIMBLE_LOGD(CB_TAG, "Eddystone TLM: %s, rssi: %d, version: %d", address.toString().c_str(), rssi, data.version);
+}
+
 #endif // CONFIG_BT_NIMBLE_ENABLED && MYNEWT_VAL(BLE_ROLE_OBSERVER)
@@ -23,11 +23,16 @@
 
 # include "NimBLEAdvertisedDevice.h"
 # include "NimBLEUtils.h"
+# include "NimBLEBeacon.h"
+# include "NimBLEEddystoneTLM.h"
+# include "NimBLEPeriodicSync.h"
 
 # ifdef USING_NIMBLE_ARDUINO_HEADERS
 #  include "nimble/nimble/host/include/host/ble_gap.h"
+#  include "nimble/nimble/host/include/host/ble_hs.h"
 # else
 #  include "host/ble_gap.h"
+#  include "host/ble_hs.h"
 # endif
 
 # include <vector>
@@ -85,12 +90,37 @@ class NimBLEScan {
     void              erase(const NimBLEAddress& address);
     void              erase(const NimBLEAdvertisedDevice* device);
     void              setScanResponseTimeout(uint32_t timeoutMs);
-    std::string       getStatsString() const { return m_stats.toString(); }
+
+    /**
+     * @brief Events dropped before reaching the scan since it was started.
+     * @details Reports are rate limited per advertiser when BLE_HS_ADV_RPT_RATE_LIMIT is set and
+     * BLE_TRANSPORT_EVT_DISCARDABLE_RESERVED keeps event buffers free for connection events.
+     */
+    struct DropStats {
+        uint32_t rateLimited{0};   // reports dropped by the per-advertiser rate limit
+        uint32_t noBuffer{0};      // reports dropped because no event buffer was available
+        uint32_t otherNoBuffer{0}; // non advertising events dropped because no event buffer was available
+    };
+
+    DropStats   getDropStats() const;
+    std::string getStatsString() const { return m_stats.toString(getDropStats()); }
+    size_t      getStatsString(char* buf, size_t len) const { return m_stats.format(getDropStats(), buf, len); }
+
+    enum BeaconType : uint8_t { BEACON_NONE = 0x00, BEACON_IBEACON = 0x01, BEACON_EDDYSTONE_TLM = 0x02, BEACON_ALL = 0x03 };
+    void setBeaconFilter(uint8_t beaconTypes);
 
 # if MYNEWT_VAL(BLE_EXT_ADV)
     enum Phy { SCAN_1M = 0x01, SCAN_CODED = 0x02, SCAN_ALL = 0x03 };
     void setPhy(Phy phyMask);
     void setPeriod(uint32_t periodMs);
+#  if MYNEWT_VAL(BLE_PERIODIC_ADV)
+    NimBLEPeriodicSync* createPeriodicSync(const NimBLEAddress&       address,
+                                           uint8_t                    sid,
+                                           NimBLEPeriodicSyncCallbacks* pCallbacks,
+                                           uint16_t                   timeoutMs = 2000,
+                                           uint16_t                   skip      = 0);
+    bool                deletePeriodicSync(NimBLEPeriodicSync* pSync);
+#  endif
 # endif
 
   private:
@@ -123,34 +153,46 @@ class NimBLEScan {
         void incMissedSrCount() { missedSrCount++; }
         void incOrphanedSrCount() { orphanedSrCount++; }
 
-        std::string toString() const {
+        std::string toString(const DropStats& drops) const {
             std::string out;
-            out.resize(400); // should be more than enough for the stats string
-            snprintf(&out[0],
-                     out.size(),
-                     "Scan stats:\n"
-                     "  Devices seen      : %" PRIu32
-                     "\n"
-                     "  Duplicate advs    : %" PRIu32
-                     "\n"
-                     "  Scan responses    : %" PRIu32
-                     "\n"
-                     "  SR timing (ms)    : min=%" PRIu32 ", max=%" PRIu32 ", avg=%" PRIu64
-                     "\n"
-                     "  Orphaned SR       : %" PRIu32
-                     "\n"
-                     "  Missed SR         : %" PRIu32 "\n",
-                     devCount,
-                     dupCount,
-                     srCount,
-                     srCount ? srMinMs : 0,
-                     srCount ? srMaxMs : 0,
-                     srCount ? srTotalMs / srCount : 0,
-                     orphanedSrCount,
-                     missedSrCount);
+            out.resize(format(drops, nullptr, 0));
+            format(drops, &out[0], out.size() + 1);
             return out;
         }
 
+        size_t format(const DropStats& drops, char* buf, size_t len) const {
+            int n = snprintf(buf,
+                             len,
+                             "Scan stats:\n"
+                             "  Devices seen      : %" PRIu32
+                             "\n"
+                             "  Duplicate advs    : %" PRIu32
+                             "\n"
+                             "  Scan responses    : %" PRIu32
+                             "\n"
+                             "  SR timing (ms)    : min=%" PRIu32 ", max=%" PRIu32 ", avg=%" PRIu64
+                             "\n"
+                             "  Orphaned SR       : %" PRIu32
+                             "\n"
+                             "  Missed SR         : %" PRIu32
+                             "\n"
+                             "  Dropped (rate)    : %" PRIu32
+                             "\n"
+                             "  Dropped (no buf)  : %" PRIu32 ", other events=%" PRIu32 "\n",
+                             devCount,
+                             dupCount,
+                             srCount,
+                             srCount ? srMinMs : 0,
+                             srCount ? srMaxMs : 0,
+                             srCount ? srTotalMs / srCount : 0,
+                             orphanedSrCount,
+                             missedSrCount,
+                             drops.rateLimited,
+                             drops.noBuffer,
+                             drops.otherNoBuffer);
+            return n < 0 ? 0 : n;
+        }
+
         // Records scan-response round-trip time.
         void recordSrTime(uint32_t ticks) {
             uint32_t ms;
@@ -172,7 +214,13 @@ class NimBLEScan {
         void        incDupCount() {}
         void        incMissedSrCount() {}
         void        incOrphanedSrCount() {}
-        std::string toString() const { return ""; }
+        std::string toString(const DropStats& drops) const { return ""; }
+        size_t      format(const DropStats& drops, char* buf, size_t len) const {
+            if (len > 0) {
+                buf[0] = '\0';
+            }
+            return 0;
+        }
         void        recordSrTime(uint32_t ticks) {}
 # endif
     } m_stats;
@@ -189,6 +237,11 @@ class NimBLEScan {
     void removeWaitingDevice(NimBLEAdvertisedDevice* pDev);
     void clearWaitingList();
     void resetWaitingTimer();
+# if MYNEWT_VAL(BLE_EXT_ADV) && MYNEWT_VAL(BLE_PERIODIC_ADV)
+    friend class NimBLEPeriodicSync;
+    uint8_t* acquireReportBuffer();
+    void     releaseReportBuffer(uint8_t* buf);
+# endif
 
     NimBLEScanCallbacks*    m_pScanCallbacks;
     ble_gap_disc_params     m_scanParams;
@@ -198,12 +251,18 @@ class NimBLEScan {
     bool                    m_srTimerInitialized{false};
     ble_npl_time_t          m_srTimeoutTicks{};
     uint8_t                 m_maxResults;
+    uint8_t                 m_beaconFilter{BEACON_NONE};
     NimBLEAdvertisedDevice* m_pWaitingListHead{}; // head of linked list for devices awaiting scan responses
     NimBLEAdvertisedDevice* m_pWaitingListTail{}; // tail of linked list for FIFO ordering
+    ble_hs_evt_drop_stats   m_dropBase{};         // drop counts when the scan was started
 
 # if MYNEWT_VAL(BLE_EXT_ADV)
     uint8_t  m_phy{SCAN_ALL};
     uint16_t m_period{0};
+#  if MYNEWT_VAL(BLE_PERIODIC_ADV)
+    std::vector<NimBLEPeriodicSync*> m_periodicSyncs{};
+    std::vector<uint8_t*>            m_reportBufPool{}; // free periodic report reassembly buffers
+#  endif
 # endif
 };
 
@@ -232,6 +291,24 @@ class NimBLEScanCallbacks {
      * @param [in] reason The reason code for why the scan ended.
      */
     virtual void onScanEnd(const NimBLEScanResults& scanResults, int reason);
+
+    /**
+     * @brief Called when an iBeacon frame is received and the iBeacon filter is enabled.
+     * @param [in] address The address of the advertiser.
+     * @param [in] rssi The signal strength of the advertisement.
+     * @param [in] data The decoded beacon frame, only valid for the duration of the callback.
+     * @details No NimBLEAdvertisedDevice is created for beacons consumed by the filter.
+     */
+    virtual void onIBeacon(const NimBLEAddress& address, int8_t rssi, const NimBLEBeacon::BeaconData& data);
+
+    /**
+     * @brief Called when an Eddystone TLM frame is received and the Eddystone TLM filter is enabled.
+     * @param [in] address The address of the advertiser.
+     * @param [in] rssi The signal strength of the advertisement.
+     * @param [in] data The decoded telemetry frame, only valid for the duration of the callback.
+     * @details No NimBLEAdvertisedDevice is created for beacons consumed by the filter.
+     */
+    virtual void onEddystoneTLM(const NimBLEAddress& address, int8_t rssi, const NimBLEEddystoneTLM::BeaconData& data);
 };
 
 #endif // CONFIG_BT_NIMBLE_ENABLED MYNEWT_VAL(BLE_ROLE_OBSERVER)
@@ -98,6 +98,7 @@ NimBLEService* NimBLEServer::createService(const char* uuid) {
 NimBLEService* NimBLEServer::createService(const NimBLEUUID& uuid) {
     NimBLEService* pService = new NimBLEService(uuid);
     m_svcVec.push_back(pService);
+    m_svcIndex.update(m_svcVec);
     setServiceChanged();
     return pService;
 } // createService
@@ -119,17 +120,7 @@ NimBLEService* NimBLEServer::getServiceByUUID(const char* uuid, uint16_t instanc
  * @return A pointer to the service object or nullptr if not found.
  */
 NimBLEService* NimBLEServer::getServiceByUUID(const NimBLEUUID& uuid, uint16_t instanceId) const {
-    uint16_t position = 0;
-    for (const auto& svc : m_svcVec) {
-        if (svc->getUUID() == uuid) {
-            if (position == instanceId) {
-                return svc;
-            }
-            position++;
-        }
-    }
-
-    return nullptr;
+    return m_svcIndex.find(m_svcVec, uuid, instanceId);
 } // getServiceByUUID
 
 /**
@@ -832,6 +823,7 @@ void NimBLEServer::removeService(NimBLEService* service, bool deleteSvc) {
                 if ((*it) == service) {
                     delete *it;
                     m_svcVec.erase(it);
+                    m_svcIndex.update(m_svcVec);
                     break;
                 }
             }
@@ -869,6 +861,7 @@ void NimBLEServer::addService(NimBLEService* service) {
     // Else reset GATT and send service changed notification.
     if (service->getRemoved() == 0) {
         m_svcVec.push_back(service);
+        m_svcIndex.update(m_svcVec);
         return;
     }
 
@@ -920,14 +913,17 @@ bool NimBLEServer::resetGATT() {
                 pDsc->m_handle = 0;
                 ++dscIt;
             }
+            pChr->m_dscIndex.update(pChr->m_vDescriptors);
 
             pChr->m_handle = 0;
             ++chrIt;
         }
+        pSvc->m_chrIndex.update(pSvc->m_vChars);
 
         if (pSvc->getRemoved() == 0) {
             if (!pSvc->start_internal()) {
                 NIMBLE_LOGE(LOG_TAG, "Failed to start service: %s", pSvc->getUUID().toString().c_str());
+                m_svcIndex.update(m_svcVec);
                 return false;
             }
         }
@@ -936,6 +932,7 @@ bool NimBLEServer::resetGATT() {
         ++svcIt;
     }
 
+    m_svcIndex.update(m_svcVec);
     return true;
 } // resetGATT
 
@@ -32,6 +32,8 @@
 # undef max
 /**************************/
 
+# include "NimBLEAttributeIndex.h"
+
 # include <vector>
 # include <array>
 
@@ -134,6 +136,7 @@ class NimBLEServer {
 # endif
     NimBLEServerCallbacks*                                m_pServerCallbacks;
     std::vector<NimBLEService*>                           m_svcVec;
+    NimBLEAttributeIndex<NimBLEService>                   m_svcIndex{};
     std::array<uint16_t, MYNEWT_VAL(BLE_MAX_CONNECTIONS)> m_connectedPeers;
 
 # if MYNEWT_VAL(BLE_ROLE_CENTRAL)
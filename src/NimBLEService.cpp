@@ -242,6 +242,7 @@ void NimBLEService::addCharacteristic(NimBLECharacteristic* pChar) {
 
     if (!foundRemoved) {
         m_vChars.push_back(pChar);
+        m_chrIndex.update(m_vChars);
     }
 
     pChar->setService(this);
@@ -263,6 +264,7 @@ void NimBLEService::removeCharacteristic(NimBLECharacteristic* pChar, bool delet
                 if ((*it) == pChar) {
                     delete (*it);
                     m_vChars.erase(it);
+                    m_chrIndex.update(m_vChars);
                     break;
                 }
             }
@@ -292,17 +294,7 @@ NimBLECharacteristic* NimBLEService::getCharacteristic(const char* uuid, uint16_
  * @return A pointer to the characteristic object or nullptr if not found.
  */
 NimBLECharacteristic* NimBLEService::getCharacteristic(const NimBLEUUID& uuid, uint16_t idx) const {
-    uint16_t position = 0;
-    for (const auto& chr : m_vChars) {
-        if (chr->getUUID() == uuid) {
-            if (position == idx) {
-                return chr;
-            }
-            position++;
-        }
-    }
-
-    return nullptr;
+    return m_chrIndex.find(m_vChars, uuid, idx);
 } // getCharacteristic
 
 /**
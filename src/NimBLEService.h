@@ -72,7 +72,8 @@ class NimBLEService : public NimBLELocalAttribute {
     bool start_internal();
     void clearServiceDefinitions();
 
-    std::vector<NimBLECharacteristic*> m_vChars{};
+    std::vector<NimBLECharacteristic*>         m_vChars{};
+    NimBLEAttributeIndex<NimBLECharacteristic> m_chrIndex{};
     // Nimble requires an array of services to be sent to the api
     // Since we are adding 1 at a time we create an array of 2 and set the type
     // of the second service to 0 to indicate the end of the array.
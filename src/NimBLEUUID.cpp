@@ -27,16 +27,23 @@
 /**************************/
 
 # include <algorithm>
+# include <cstring>
 
 static const char*   LOG_TAG         = "NimBLEUUID";
 static const uint8_t ble_base_uuid[] = {
     0xfb, 0x34, 0x9b, 0x5f, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
 
+// ble_base_uuid as little endian 64bit words, the short UUID goes in the upper half of the high word.
+static constexpr uint64_t ble_base_uuid_lo = 0x800000805f9b34fbULL;
+static constexpr uint64_t ble_base_uuid_hi = 0x0000000000001000ULL;
+
 /**
  * @brief Create a UUID from the native UUID.
  * @param [in] uuid The native UUID.
  */
-NimBLEUUID::NimBLEUUID(const ble_uuid_any_t& uuid) : m_uuid{uuid} {}
+NimBLEUUID::NimBLEUUID(const ble_uuid_any_t& uuid) {
+    memcpy(static_cast<void*>(&m_uuid), &uuid, sizeof(m_uuid));
+}
 
 /**
  * @brief Create a UUID from the native UUID pointer.
@@ -49,7 +56,7 @@ NimBLEUUID::NimBLEUUID(const ble_uuid_t* uuid) {
         return;
     }
 
-    ble_uuid_copy(&m_uuid, uuid);
+    ble_uuid_copy(reinterpret_cast<ble_uuid_any_t*>(&m_uuid), uuid);
 }
 
 /**
@@ -69,27 +76,9 @@ NimBLEUUID::NimBLEUUID(const ble_uuid_t* uuid) {
  *
  * @param [in] value The string to build a UUID from.
  */
-NimBLEUUID::NimBLEUUID(const std::string& value) {
-    if (value.length() == 4) {
-        m_uuid.u.type    = BLE_UUID_TYPE_16;
-        m_uuid.u16.value = strtoul(value.c_str(), nullptr, 16);
-    } else if (value.length() == 8) {
-        m_uuid.u.type    = BLE_UUID_TYPE_32;
-        m_uuid.u32.value = strtoul(value.c_str(), nullptr, 16);
-    } else if (value.length() == 16) {
-        memcpy(m_uuid.u128.value, &value[0], 16);
-        m_uuid.u.type = BLE_UUID_TYPE_128;
-    } else if (value.length() == 36) {
-        char*    position;
-        uint64_t first_half = (strtoull(&value[0], &position, 16) << 32) +
-                              (strtoull(position + 1, &position, 16) << 16) + strtoull(position + 1, &position, 16);
-        uint64_t second_half = (strtoull(position + 1, &position, 16) << 48) + strtoull(position + 1, nullptr, 16);
-        memcpy(m_uuid.u128.value + 8, &first_half, 8);
-        memcpy(m_uuid.u128.value, &second_half, 8);
-        m_uuid.u.type = BLE_UUID_TYPE_128;
-    } else {
-        NIMBLE_LOGE(LOG_TAG, "Invalid UUID length");
-        m_uuid.u.type = 0;
+NimBLEUUID::NimBLEUUID(const std::string& value) : NimBLEUUID{parse(value.c_str(), value.length())} {
+    if (!bitSize()) {
+        NIMBLE_LOGE(LOG_TAG, "Invalid UUID string");
     }
 } // NimBLEUUID(std::string)
 
@@ -99,30 +88,12 @@ NimBLEUUID::NimBLEUUID(const std::string& value) {
  * @param [in] size The size of the data.
  */
 NimBLEUUID::NimBLEUUID(const uint8_t* pData, size_t size) {
-    if (ble_uuid_init_from_buf(&m_uuid, pData, size)) {
+    if (ble_uuid_init_from_buf(reinterpret_cast<ble_uuid_any_t*>(&m_uuid), pData, size)) {
         NIMBLE_LOGE(LOG_TAG, "Invalid UUID size");
         m_uuid.u.type = 0;
     }
 } // NimBLEUUID(const uint8_t* pData, size_t size)
 
-/**
- * @brief Create a UUID from the 16bit value.
- * @param [in] uuid The 16bit short form UUID.
- */
-NimBLEUUID::NimBLEUUID(uint16_t uuid) {
-    m_uuid.u.type    = BLE_UUID_TYPE_16;
-    m_uuid.u16.value = uuid;
-} // NimBLEUUID(uint16_t uuid)
-
-/**
- * @brief Create a UUID from the 32bit value.
- * @param [in] uuid The 32bit short form UUID.
- */
-NimBLEUUID::NimBLEUUID(uint32_t uuid) {
-    m_uuid.u.type    = BLE_UUID_TYPE_32;
-    m_uuid.u32.value = uuid;
-} // NimBLEUUID(uint32_t uuid)
-
 /**
  * @brief Create a UUID from the native UUID.
  * @param [in] uuid The native UUID.
@@ -132,24 +103,6 @@ NimBLEUUID::NimBLEUUID(const ble_uuid128_t* uuid) {
     memcpy(m_uuid.u128.value, uuid->value, 16);
 } // NimBLEUUID(const ble_uuid128_t* uuid)
 
-/**
- * @brief Create a UUID from the 128bit value using hex parts instead of string,
- * instead of NimBLEUUID("ebe0ccb0-7a0a-4b0c-8a1a-6ff2997da3a6"), it becomes
- * NimBLEUUID(0xebe0ccb0, 0x7a0a, 0x4b0c, 0x8a1a6ff2997da3a6)
- *
- * @param [in] first  The first 32bit of the UUID.
- * @param [in] second The next 16bit of the UUID.
- * @param [in] third  The next 16bit of the UUID.
- * @param [in] fourth The last 64bit of the UUID, combining the last 2 parts of the string equivalent
- */
-NimBLEUUID::NimBLEUUID(uint32_t first, uint16_t second, uint16_t third, uint64_t fourth) {
-    m_uuid.u.type = BLE_UUID_TYPE_128;
-    memcpy(m_uuid.u128.value + 12, &first, 4);
-    memcpy(m_uuid.u128.value + 10, &second, 2);
-    memcpy(m_uuid.u128.value + 8, &third, 2);
-    memcpy(m_uuid.u128.value, &fourth, 8);
-} // NimBLEUUID(uint32_t first, uint16_t second, uint16_t third, uint64_t fourth)
-
 /**
  * @brief Get the bit size of the UUID, 16, 32 or 128.
  * @return The bit size of the UUID or 0 if not initialized.
@@ -296,41 +249,63 @@ const NimBLEUUID& NimBLEUUID::reverseByteOrder() {
 } // reverseByteOrder
 
 /**
- * @brief Convenience operator to check if this UUID is equal to another.
+ * @brief Get the UUID as a 128bit value split in little endian 64bit words.
+ * @param [out] lo The lower 64 bits.
+ * @param [out] hi The upper 64 bits.
+ * @return False if the UUID is not initialized.
+ * @details 16 and 32bit UUIDs are expanded with the Bluetooth base UUID, so every UUID has a single
+ * canonical form regardless of how it is stored.
  */
-bool NimBLEUUID::operator==(const NimBLEUUID& rhs) const {
-    if (!this->bitSize() || !rhs.bitSize()) {
-        return false;
-    }
-
-    if (this->bitSize() != rhs.bitSize()) {
-        uint8_t uuid128[sizeof(ble_base_uuid)];
-        memcpy(uuid128, &ble_base_uuid, sizeof(ble_base_uuid));
-        if (this->bitSize() == BLE_UUID_TYPE_128) {
-            memcpy(uuid128 + 12, rhs.getValue(), rhs.bitSize() == BLE_UUID_TYPE_16 ? 2 : 4);
-            return memcmp(this->getValue(), uuid128, sizeof(ble_base_uuid)) == 0;
-
-        } else if (rhs.bitSize() == BLE_UUID_TYPE_128) {
-            memcpy(uuid128 + 12, getValue(), this->bitSize() == BLE_UUID_TYPE_16 ? 2 : 4);
-            return memcmp(rhs.getValue(), uuid128, sizeof(ble_base_uuid)) == 0;
-        } else {
+bool NimBLEUUID::getCanonical(uint64_t& lo, uint64_t& hi) const {
+    switch (bitSize()) {
+        case BLE_UUID_TYPE_16:
+            lo = ble_base_uuid_lo;
+            hi = ble_base_uuid_hi | (static_cast<uint64_t>(m_uuid.u16.value) << 32);
+            return true;
+        case BLE_UUID_TYPE_32:
+            lo = ble_base_uuid_lo;
+            hi = ble_base_uuid_hi | (static_cast<uint64_t>(m_uuid.u32.value) << 32);
+            return true;
+        case BLE_UUID_TYPE_128:
+            // All supported targets are little endian.
+            memcpy(&lo, m_uuid.u128.value, sizeof(lo));
+            memcpy(&hi, m_uuid.u128.value + sizeof(lo), sizeof(hi));
+            return true;
+        default:
             return false;
-        }
     }
+} // getCanonical
 
-    if (this->bitSize() == BLE_UUID_TYPE_16) {
-        return *reinterpret_cast<const uint16_t*>(this->getValue()) == *reinterpret_cast<const uint16_t*>(rhs.getValue());
+/**
+ * @brief Get a hash of the UUID.
+ * @return The hash value, equal for UUIDs that compare equal regardless of their bit size.
+ */
+size_t NimBLEUUID::hash() const {
+    uint64_t lo, hi;
+    if (!getCanonical(lo, hi)) {
+        return 0;
     }
 
-    if (this->bitSize() == BLE_UUID_TYPE_32) {
-        return *reinterpret_cast<const uint32_t*>(this->getValue()) == *reinterpret_cast<const uint32_t*>(rhs.getValue());
+    // Short UUIDs only differ in the upper half of hi, multiply to spread it over all the bits.
+    uint64_t h = lo ^ (hi * 0x9e3779b97f4a7c15ULL);
+    return static_cast<size_t>(h ^ (h >> 32));
+} // hash
+
+/**
+ * @brief Convenience operator to check if this UUID is equal to another.
+ * @details UUIDs of different bit sizes are equal if they expand to the same 128bit UUID.
+ */
+bool NimBLEUUID::operator==(const NimBLEUUID& rhs) const {
+    if (bitSize() == BLE_UUID_TYPE_16 && rhs.bitSize() == BLE_UUID_TYPE_16) {
+        return m_uuid.u16.value == rhs.m_uuid.u16.value;
     }
 
-    if (this->bitSize() == BLE_UUID_TYPE_128) {
-        return memcmp(this->getValue(), rhs.getValue(), 16) == 0;
+    uint64_t lo, hi, rhsLo, rhsHi;
+    if (!getCanonical(lo, hi) || !rhs.getCanonical(rhsLo, rhsHi)) {
+        return false;
     }
 
-    return false;
+    return lo == rhsLo && hi == rhsHi;
 } // operator==
 
 /**
@@ -350,4 +325,26 @@ NimBLEUUID::operator std::string() const {
     return ble_uuid_to_str(&m_uuid.u, buf);
 } // operator std::string
 
+/**
+ * @brief Write the string representation of the UUID into a buffer without allocating.
+ * @param [in] buf The buffer to write to, BLE_UUID_STR_LEN bytes is enough for any UUID.
+ * @param [in] len The size of the buffer, the output is truncated and null terminated if it does not fit.
+ * @return The length of the full string, excluding the null terminator.
+ */
+size_t NimBLEUUID::format(char* buf, size_t len) const {
+    if (len >= BLE_UUID_STR_LEN) {
+        return strlen(ble_uuid_to_str(&m_uuid.u, buf));
+    }
+
+    char   tmp[BLE_UUID_STR_LEN];
+    size_t n = strlen(ble_uuid_to_str(&m_uuid.u, tmp));
+    if (len > 0) {
+        size_t copy = n < len ? n : len - 1;
+        memcpy(buf, tmp, copy);
+        buf[copy] = '\0';
+    }
+
+    return n;
+} // format
+
 #endif /* CONFIG_BT_NIMBLE_ENABLED */
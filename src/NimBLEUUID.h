@@ -34,6 +34,7 @@
 
 # include <string>
 # include <cstring>
+# include <functional>
 
 /**
  * @brief A model of a %BLE UUID.
@@ -43,21 +44,53 @@ class NimBLEUUID {
     /**
      * @brief Created a blank UUID.
      */
-    NimBLEUUID() = default;
+    constexpr NimBLEUUID() = default;
     NimBLEUUID(const ble_uuid_any_t& uuid);
     NimBLEUUID(const ble_uuid_t* uuid);
     NimBLEUUID(const std::string& uuid);
-    NimBLEUUID(uint16_t uuid);
-    NimBLEUUID(uint32_t uuid);
     NimBLEUUID(const ble_uuid128_t* uuid);
     NimBLEUUID(const uint8_t* pData, size_t size);
-    NimBLEUUID(uint32_t first, uint16_t second, uint16_t third, uint64_t fourth);
+
+    /**
+     * @brief Create a UUID from the 16bit value.
+     * @param [in] uuid The 16bit short form UUID.
+     */
+    constexpr NimBLEUUID(uint16_t uuid) : m_uuid{ble_uuid16_t{{BLE_UUID_TYPE_16}, uuid}} {}
+
+    /**
+     * @brief Create a UUID from the 32bit value.
+     * @param [in] uuid The 32bit short form UUID.
+     */
+    constexpr NimBLEUUID(uint32_t uuid) : m_uuid{ble_uuid32_t{{BLE_UUID_TYPE_32}, uuid}} {}
+
+    /**
+     * @brief Create a UUID from the 128bit value using hex parts instead of string,
+     * instead of NimBLEUUID("ebe0ccb0-7a0a-4b0c-8a1a-6ff2997da3a6"), it becomes
+     * NimBLEUUID(0xebe0ccb0, 0x7a0a, 0x4b0c, 0x8a1a6ff2997da3a6)
+     *
+     * @param [in] first  The first 32bit of the UUID.
+     * @param [in] second The next 16bit of the UUID.
+     * @param [in] third  The next 16bit of the UUID.
+     * @param [in] fourth The last 64bit of the UUID, combining the last 2 parts of the string equivalent
+     */
+    constexpr NimBLEUUID(uint32_t first, uint16_t second, uint16_t third, uint64_t fourth)
+        : m_uuid{fourth, (static_cast<uint64_t>(first) << 32) | (static_cast<uint32_t>(second) << 16) | third} {}
+
+    /**
+     * @brief Create a UUID from a C string, see NimBLEUUID(const std::string&) for the accepted forms.
+     * @details Parsing does not allocate and is done by the compiler when used in a constant expression,
+     * e.g. `constexpr NimBLEUUID uuid("beb5483e-36e1-4688-b7f5-ea07361b26a8");`.
+     * @param [in] uuid The string to build a UUID from, a blank UUID is created if it is invalid.
+     */
+    constexpr NimBLEUUID(const char* uuid) : NimBLEUUID{parse(uuid, uuid ? length(uuid) : 0)} {}
 
     uint8_t           bitSize() const;
     const uint8_t*    getValue() const;
     const ble_uuid_t* getBase() const;
     bool              equals(const NimBLEUUID& uuid) const;
+    size_t            hash() const;
     std::string       toString() const;
+    size_t            format(char* buf, size_t len) const;
     static NimBLEUUID fromString(const std::string& uuid);
     const NimBLEUUID& to128();
     const NimBLEUUID& to16();
@@ -68,8 +101,109 @@ class NimBLEUUID {
          operator std::string() const;
 
   private:
-    ble_uuid_any_t m_uuid{};
+    /**
+     * @brief Storage laid out as ble_uuid_any_t, with constructors so each variant can be
+     * initialized in a constant expression.
+     */
+    union Storage {
+        ble_uuid_t    u;
+        ble_uuid16_t  u16;
+        ble_uuid32_t  u32;
+        ble_uuid128_t u128;
+
+        constexpr Storage() : u{} {}
+        explicit constexpr Storage(ble_uuid16_t uuid) : u16{uuid} {}
+        explicit constexpr Storage(ble_uuid32_t uuid) : u32{uuid} {}
+
+        /** @brief 128bit UUID from its little endian low and high 64 bits. */
+        explicit constexpr Storage(uint64_t lo, uint64_t hi)
+            : u128{{BLE_UUID_TYPE_128},
+                   {static_cast<uint8_t>(lo),       static_cast<uint8_t>(lo >> 8),  static_cast<uint8_t>(lo >> 16),
+                    static_cast<uint8_t>(lo >> 24), static_cast<uint8_t>(lo >> 32), static_cast<uint8_t>(lo >> 40),
+                    static_cast<uint8_t>(lo >> 48), static_cast<uint8_t>(lo >> 56), static_cast<uint8_t>(hi),
+                    static_cast<uint8_t>(hi >> 8),  static_cast<uint8_t>(hi >> 16), static_cast<uint8_t>(hi >> 24),
+                    static_cast<uint8_t>(hi >> 32), static_cast<uint8_t>(hi >> 40), static_cast<uint8_t>(hi >> 48),
+                    static_cast<uint8_t>(hi >> 56)}} {}
+    };
+
+    static_assert(sizeof(Storage) == sizeof(ble_uuid_any_t), "UUID storage must match ble_uuid_any_t");
+
+    explicit constexpr NimBLEUUID(const Storage& uuid) : m_uuid{uuid} {}
+
+    // The parsing helpers are single return statement constexpr functions to be usable with C++11.
+
+    /** @brief Longest string form accepted by parse(). */
+    static constexpr size_t maxStrLen = 36;
+
+    /**
+     * @brief Get the length of a C string, counting stops past maxStrLen as longer strings are never valid.
+     */
+    static constexpr size_t length(const char* str, size_t len = 0) {
+        return (len > maxStrLen || str[len] == '\0') ? len : length(str, len + 1);
+    }
+
+    /** @brief Get the value of a hex digit, -1 if not a hex digit. */
+    static constexpr int hexDigit(char c) {
+        return (c >= '0' && c <= '9') ? c - '0'
+             : (c >= 'a' && c <= 'f') ? c - 'a' + 10
+             : (c >= 'A' && c <= 'F') ? c - 'A' + 10
+                                      : -1;
+    }
+
+    /** @brief Check that the first len characters of a string are hex digits. */
+    static constexpr bool isHex(const char* str, size_t len) {
+        return len == 0 || (hexDigit(*str) >= 0 && isHex(str + 1, len - 1));
+    }
+
+    /** @brief Get the value of len hex digits, the digits must have been checked with isHex(). */
+    static constexpr uint64_t hexValue(const char* str, size_t len, uint64_t value = 0) {
+        return len == 0 ? value : hexValue(str + 1, len - 1, (value << 4) | static_cast<uint64_t>(hexDigit(*str)));
+    }
+
+    /** @brief Get the little endian value of len bytes of a binary string. */
+    static constexpr uint64_t byteValue(const char* str, size_t len) {
+        return len == 0 ? 0
+                        : static_cast<uint64_t>(static_cast<uint8_t>(*str)) | (byteValue(str + 1, len - 1) << 8);
+    }
+
+    /** @brief Check a 36 character string has the 12345678-90ab-cdef-1234-567890abcdef form. */
+    static constexpr bool isCanonical(const char* str) {
+        return str[8] == '-' && str[13] == '-' && str[18] == '-' && str[23] == '-' && isHex(str, 8) &&
+               isHex(str + 9, 4) && isHex(str + 14, 4) && isHex(str + 19, 4) && isHex(str + 24, 12);
+    }
+
+    /** @brief Build a UUID from a string checked with isCanonical(). */
+    static constexpr NimBLEUUID parseCanonical(const char* str) {
+        return NimBLEUUID(Storage((hexValue(str + 19, 4) << 48) | hexValue(str + 24, 12),
+                                  (hexValue(str, 8) << 32) | (hexValue(str + 9, 4) << 16) | hexValue(str + 14, 4)));
+    }
+
+    /**
+     * @brief Build a UUID from a string, the 4, 8, 16 (binary) and 36 character forms are accepted.
+     * @return The UUID or a blank UUID if the string is invalid.
+     */
+    static constexpr NimBLEUUID parse(const char* str, size_t len) {
+        return (len == 4 && isHex(str, 4))     ? NimBLEUUID(static_cast<uint16_t>(hexValue(str, 4)))
+             : (len == 8 && isHex(str, 8))     ? NimBLEUUID(static_cast<uint32_t>(hexValue(str, 8)))
+             : (len == 16)                     ? NimBLEUUID(Storage(byteValue(str, 8), byteValue(str + 8, 8)))
+             : (len == 36 && isCanonical(str)) ? parseCanonical(str)
+                                               : NimBLEUUID();
+    }
+
+    bool getCanonical(uint64_t& lo, uint64_t& hi) const;
+
+    Storage m_uuid{};
 }; // NimBLEUUID
 
+/**
+ * @brief Hash support so NimBLEUUID can be used as a key of unordered containers.
+ */
+namespace std {
+template <>
+struct hash<NimBLEUUID> {
+    size_t operator()(const NimBLEUUID& uuid) const { return uuid.hash(); }
+};
+} // namespace std
+
 #endif // CONFIG_BT_NIMBLE_ENABLED
 #endif // NIMBLE_CPP_UUID_H_
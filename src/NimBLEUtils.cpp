@@ -32,6 +32,10 @@
 # undef max
 /**************************/
 
+# ifdef ESP_PLATFORM
+#  include "esp_timer.h"
+# endif
+
 # include <stdlib.h>
 # include <climits>
 
@@ -579,18 +583,53 @@ const char* NimBLEUtils::gapEventToString(uint8_t eventType) {
  * @return A string representation of the data.
  */
 std::string NimBLEUtils::dataToHexString(const uint8_t* source, uint8_t length) {
-    constexpr char hexmap[] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'};
-    std::string    str{};
+    std::string str{};
     str.resize(length << 1);
+    dataToHexString(source, length, &str[0], str.size() + 1);
+    return str;
+} // dataToHexString
 
-    for (uint8_t i = 0; i < length; i++) {
-        str[2 * i]     = hexmap[(source[i] & 0xF0) >> 4];
-        str[2 * i + 1] = hexmap[source[i] & 0x0F];
+/**
+ * @brief Write a hexadecimal string representation of the input data into a buffer without allocating.
+ * @param [in] source The start of the binary data.
+ * @param [in] length The length of the data to convert.
+ * @param [in] buf The buffer to write to, needs 2 * length + 1 bytes to hold the full string.
+ * @param [in] len The size of the buffer, the output is truncated and null terminated if it does not fit.
+ * @return The length of the full string, excluding the null terminator.
+ */
+size_t NimBLEUtils::dataToHexString(const uint8_t* source, size_t length, char* buf, size_t len) {
+    constexpr char hexmap[] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'};
+    if (len == 0) {
+        return length << 1;
     }
 
-    return str;
+    size_t count = length < (len - 1) / 2 ? length : (len - 1) / 2;
+    for (size_t i = 0; i < count; i++) {
+        buf[2 * i]     = hexmap[(source[i] & 0xF0) >> 4];
+        buf[2 * i + 1] = hexmap[source[i] & 0x0F];
+    }
+
+    buf[2 * count] = '\0';
+    return length << 1;
 } // dataToHexString
 
+/**
+ * @brief Compute a 32 bit FNV-1a hash of a block of data.
+ * @param [in] data The start of the data.
+ * @param [in] length The length of the data.
+ * @return The hash of the length and content of the data.
+ * @details Used to detect when a payload has not changed since it was last sent to the controller.
+ */
+uint32_t NimBLEUtils::dataHash(const uint8_t* data, size_t length) {
+    uint32_t hash = 2166136261u;
+    hash          = (hash ^ static_cast<uint32_t>(length)) * 16777619u;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+
+    return hash;
+} // dataHash
+
 /**
  * @brief Generate a random BLE address.
  * @param [in] nrpa True to generate a non-resolvable private address,
@@ -607,4 +646,17 @@ NimBLEAddress NimBLEUtils::generateAddr(bool nrpa) {
     return NimBLEAddress{addr};
 } // generateAddr
 
+/**
+ * @brief Get a free running timestamp in microseconds, used for latency and jitter measurements.
+ * @return The timestamp, wraps around after ~71 minutes.
+ * @details Falls back to the OS tick resolution on platforms without a high resolution timer.
+ */
+uint32_t NimBLEUtils::getTimeUs() {
+# ifdef ESP_PLATFORM
+    return static_cast<uint32_t>(esp_timer_get_time());
+# else
+    return ble_npl_time_ticks_to_ms32(ble_npl_time_get()) * 1000;
+# endif
+} // getTimeUs
+
 #endif // CONFIG_BT_NIMBLE_ENABLED
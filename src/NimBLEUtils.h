@@ -75,11 +75,14 @@ class NimBLEUtils {
 
     static const char*   gapEventToString(uint8_t eventType);
     static std::string   dataToHexString(const uint8_t* source, uint8_t length);
+    static size_t        dataToHexString(const uint8_t* source, size_t length, char* buf, size_t len);
+    static uint32_t      dataHash(const uint8_t* data, size_t length);
     static const char*   advTypeToString(uint8_t advType);
     static const char*   returnCodeToString(int rc);
     static NimBLEAddress generateAddr(bool nrpa);
     static bool          taskWait(const TaskData& taskData, uint32_t timeout);
     static void          taskRelease(const TaskData& taskData, int rc = 0);
+    static uint32_t      getTimeUs();
 
   private:
     friend class NimBLEDevice;
@@ -260,6 +260,17 @@ int ble_ll_scan_dup_check_ext(uint8_t addr_type, uint8_t *addr, bool has_aux,
                               uint16_t adi);
 int ble_ll_scan_dup_update_ext(uint8_t addr_type, uint8_t *addr, bool has_aux,
                                uint16_t adi);
+
+/* Duplicate filter statistics */
+struct ble_ll_scan_dup_stats {
+    uint32_t hits;      /* lookups that matched an entry */
+    uint32_t misses;    /* lookups that created a new entry */
+    uint32_t evictions; /* least recently seen entries reused for new ones */
+    uint32_t refreshes; /* entries reported again after BLE_LL_SCAN_DUP_REFRESH_MS */
+};
+
+void ble_ll_scan_dup_stats_get(struct ble_ll_scan_dup_stats *stats);
+void ble_ll_scan_dup_stats_reset(void);
 int ble_ll_scan_have_rxd_scan_rsp(uint8_t *addr, uint8_t txadd, uint8_t ext_adv,
                                   uint16_t adi);
 void ble_ll_scan_add_scan_rsp_adv(uint8_t *addr, uint8_t txadd, uint8_t ext_adv,
@@ -122,14 +122,172 @@ struct ble_ll_scan_dup_entry {
 #if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_EXT_ADV)
     uint16_t adi;
 #endif
-    TAILQ_ENTRY(ble_ll_scan_dup_entry) link;
+#if MYNEWT_VAL(BLE_LL_SCAN_DUP_REFRESH_MS)
+    ble_npl_time_t report_time; /* time the first report was sent */
+#endif
+    TAILQ_ENTRY(ble_ll_scan_dup_entry) link;    /* LRU order, most recent first */
+    LIST_ENTRY(ble_ll_scan_dup_entry) hash_link;
 };
 
+#define BLE_LL_SCAN_DUP_HASH_SIZE   MYNEWT_VAL(BLE_LL_SCAN_DUP_HASH_SIZE)
+
+#if (BLE_LL_SCAN_DUP_HASH_SIZE == 0) || \
+    (BLE_LL_SCAN_DUP_HASH_SIZE & (BLE_LL_SCAN_DUP_HASH_SIZE - 1))
+#error "BLE_LL_SCAN_DUP_HASH_SIZE must be a power of two"
+#endif
+
 static os_membuf_t g_scan_dup_mem[ OS_MEMPOOL_SIZE(
                                    MYNEWT_VAL(BLE_LL_NUM_SCAN_DUP_ADVS),
                                    sizeof(struct ble_ll_scan_dup_entry)) ];
 static struct os_mempool g_scan_dup_pool;
 static TAILQ_HEAD(ble_ll_scan_dup_list, ble_ll_scan_dup_entry) g_scan_dup_list;
+static LIST_HEAD(ble_ll_scan_dup_bucket, ble_ll_scan_dup_entry)
+    g_scan_dup_hash[BLE_LL_SCAN_DUP_HASH_SIZE];
+static struct ble_ll_scan_dup_stats g_scan_dup_stats;
+
+static void
+ble_ll_scan_dup_clear(void)
+{
+    int i;
+
+    os_mempool_clear(&g_scan_dup_pool);
+    TAILQ_INIT(&g_scan_dup_list);
+
+    for (i = 0; i < BLE_LL_SCAN_DUP_HASH_SIZE; i++) {
+        LIST_INIT(&g_scan_dup_hash[i]);
+    }
+}
+
+/**
+ * Returns the hash bucket for an entry. Anonymous entries are stored with an
+ * all-zero address so they hash by type only.
+ */
+static inline struct ble_ll_scan_dup_bucket *
+ble_ll_scan_dup_bucket(uint8_t type, const uint8_t *addr)
+{
+    uint32_t h;
+    int i;
+
+    /* FNV-1a */
+    h = (2166136261u ^ type) * 16777619u;
+    for (i = 0; i < BLE_DEV_ADDR_LEN; i++) {
+        h = (h ^ (addr ? addr[i] : 0)) * 16777619u;
+    }
+
+    return &g_scan_dup_hash[(h ^ (h >> 16)) & (BLE_LL_SCAN_DUP_HASH_SIZE - 1)];
+}
+
+/**
+ * Looks up an entry, addr is NULL for anonymous advertising.
+ */
+static inline struct ble_ll_scan_dup_entry *
+ble_ll_scan_dup_find(uint8_t type, const uint8_t *addr)
+{
+    struct ble_ll_scan_dup_entry *e;
+
+    LIST_FOREACH(e, ble_ll_scan_dup_bucket(type, addr), hash_link) {
+        if ((e->type == type) &&
+            (!addr || !memcmp(e->addr, addr, BLE_DEV_ADDR_LEN))) {
+            break;
+        }
+    }
+
+    if (e) {
+        g_scan_dup_stats.hits++;
+    } else {
+        g_scan_dup_stats.misses++;
+    }
+
+    return e;
+}
+
+static inline void
+ble_ll_scan_dup_move_to_head(struct ble_ll_scan_dup_entry *e)
+{
+    if (e != TAILQ_FIRST(&g_scan_dup_list)) {
+        TAILQ_REMOVE(&g_scan_dup_list, e, link);
+        TAILQ_INSERT_HEAD(&g_scan_dup_list, e, link);
+    }
+}
+
+/**
+ * Allocates an entry for the given type and address and places it at the
+ * head of the list. If the pool is exhausted the least recently seen entry
+ * is evicted and reused.
+ */
+static struct ble_ll_scan_dup_entry *
+ble_ll_scan_dup_new(uint8_t type, const uint8_t *addr)
+{
+    struct ble_ll_scan_dup_entry *e;
+
+    e = os_memblock_get(&g_scan_dup_pool);
+    if (!e) {
+        e = TAILQ_LAST(&g_scan_dup_list, ble_ll_scan_dup_list);
+        TAILQ_REMOVE(&g_scan_dup_list, e, link);
+        LIST_REMOVE(e, hash_link);
+        g_scan_dup_stats.evictions++;
+    }
+
+    memset(e, 0, sizeof(*e));
+    e->type = type;
+    if (addr) {
+        memcpy(e->addr, addr, BLE_DEV_ADDR_LEN);
+    }
+
+    TAILQ_INSERT_HEAD(&g_scan_dup_list, e, link);
+    LIST_INSERT_HEAD(ble_ll_scan_dup_bucket(type, addr), e, hash_link);
+
+    return e;
+}
+
+#if MYNEWT_VAL(BLE_LL_SCAN_DUP_REFRESH_MS)
+/**
+ * Forgets the reports sent for an entry once the refresh period has passed
+ * so the advertiser is reported again.
+ */
+static inline void
+ble_ll_scan_dup_refresh(struct ble_ll_scan_dup_entry *e)
+{
+    if (e->flags &&
+        (ble_npl_time_get() - e->report_time >=
+         ble_npl_time_ms_to_ticks32(MYNEWT_VAL(BLE_LL_SCAN_DUP_REFRESH_MS)))) {
+        e->flags = 0;
+        g_scan_dup_stats.refreshes++;
+    }
+}
+
+static inline void
+ble_ll_scan_dup_set_flags(struct ble_ll_scan_dup_entry *e, uint8_t flags)
+{
+    if (!e->flags) {
+        e->report_time = ble_npl_time_get();
+    }
+    e->flags |= flags;
+}
+#else
+#define ble_ll_scan_dup_refresh(e)
+#define ble_ll_scan_dup_set_flags(e, f)     ((e)->flags |= (f))
+#endif
+
+void
+ble_ll_scan_dup_stats_get(struct ble_ll_scan_dup_stats *stats)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    *stats = g_scan_dup_stats;
+    OS_EXIT_CRITICAL(sr);
+}
+
+void
+ble_ll_scan_dup_stats_reset(void)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    memset(&g_scan_dup_stats, 0, sizeof(g_scan_dup_stats));
+    OS_EXIT_CRITICAL(sr);
+}
 
 #if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_EXT_ADV)
 static int
@@ -637,12 +795,12 @@ ble_ll_scan_dup_update_legacy(uint8_t addr_type, const uint8_t *addr,
     BLE_LL_ASSERT(e && e->type == type && !memcmp(e->addr, addr, 6));
 
     if (subev == BLE_HCI_LE_SUBEV_DIRECT_ADV_RPT) {
-        e->flags |= BLE_LL_SCAN_DUP_F_DIR_ADV_REPORT_SENT;
+        ble_ll_scan_dup_set_flags(e, BLE_LL_SCAN_DUP_F_DIR_ADV_REPORT_SENT);
     } else {
         if (evtype == BLE_HCI_ADV_RPT_EVTYPE_SCAN_RSP) {
-            e->flags |= BLE_LL_SCAN_DUP_F_SCAN_RSP_SENT;
+            ble_ll_scan_dup_set_flags(e, BLE_LL_SCAN_DUP_F_SCAN_RSP_SENT);
         } else {
-            e->flags |= BLE_LL_SCAN_DUP_F_ADV_REPORT_SENT;
+            ble_ll_scan_dup_set_flags(e, BLE_LL_SCAN_DUP_F_ADV_REPORT_SENT);
         }
     }
 
@@ -966,8 +1124,7 @@ ble_ll_scan_sm_start(struct ble_ll_scan_sm *scansm)
     /* Forget filtered advertisers from previous scan. */
     g_ble_ll_scan_num_rsp_advs = 0;
 
-    os_mempool_clear(&g_scan_dup_pool);
-    TAILQ_INIT(&g_scan_dup_list);
+    ble_ll_scan_dup_clear();
 
     /*
      * First scan window can start when RF is enabled. Add 1 tick since we are
@@ -1776,31 +1933,6 @@ ble_ll_scan_wfr_timer_exp(void)
     ble_phy_restart_rx();
 }
 
-static inline void
-ble_ll_scan_dup_move_to_head(struct ble_ll_scan_dup_entry *e)
-{
-    if (e != TAILQ_FIRST(&g_scan_dup_list)) {
-        TAILQ_REMOVE(&g_scan_dup_list, e, link);
-        TAILQ_INSERT_HEAD(&g_scan_dup_list, e, link);
-    }
-}
-
-static inline struct ble_ll_scan_dup_entry *
-ble_ll_scan_dup_new(void)
-{
-    struct ble_ll_scan_dup_entry *e;
-
-    e = os_memblock_get(&g_scan_dup_pool);
-    if (!e) {
-        e = TAILQ_LAST(&g_scan_dup_list, ble_ll_scan_dup_list);
-        TAILQ_REMOVE(&g_scan_dup_list, e, link);
-    }
-
-    memset(e, 0, sizeof(*e));
-
-    return e;
-}
-
 static int
 ble_ll_scan_dup_check_legacy(uint8_t addr_type, uint8_t *addr, uint8_t pdu_type)
 {
@@ -1810,13 +1942,10 @@ ble_ll_scan_dup_check_legacy(uint8_t addr_type, uint8_t *addr, uint8_t pdu_type)
 
     type = BLE_LL_SCAN_ENTRY_TYPE_LEGACY(addr_type);
 
-    TAILQ_FOREACH(e, &g_scan_dup_list, link) {
-        if ((e->type == type) && !memcmp(e->addr, addr, 6)) {
-            break;
-        }
-    }
-
+    e = ble_ll_scan_dup_find(type, addr);
     if (e) {
+        ble_ll_scan_dup_refresh(e);
+
         if (pdu_type == BLE_ADV_PDU_TYPE_ADV_DIRECT_IND) {
             rc = e->flags & BLE_LL_SCAN_DUP_F_DIR_ADV_REPORT_SENT;
         } else if (pdu_type == BLE_ADV_PDU_TYPE_SCAN_RSP) {
@@ -1829,12 +1958,7 @@ ble_ll_scan_dup_check_legacy(uint8_t addr_type, uint8_t *addr, uint8_t pdu_type)
     } else {
         rc = 0;
 
-        e = ble_ll_scan_dup_new();
-        e->flags = 0;
-        e->type = type;
-        memcpy(e->addr, addr, 6);
-
-        TAILQ_INSERT_HEAD(&g_scan_dup_list, e, link);
+        ble_ll_scan_dup_new(type, addr);
     }
 
     return rc;
@@ -1855,13 +1979,7 @@ ble_ll_scan_dup_check_ext(uint8_t addr_type, uint8_t *addr, bool has_aux,
 
     type = BLE_LL_SCAN_ENTRY_TYPE_EXT(addr_type, has_aux, is_anon, adi);
 
-    TAILQ_FOREACH(e, &g_scan_dup_list, link) {
-        if ((e->type == type) &&
-            (is_anon || !memcmp(e->addr, addr, BLE_DEV_ADDR_LEN))) {
-            break;
-        }
-    }
-
+    e = ble_ll_scan_dup_find(type, is_anon ? NULL : addr);
     if (e) {
         if (e->adi != adi) {
             rc = 0;
@@ -1869,6 +1987,7 @@ ble_ll_scan_dup_check_ext(uint8_t addr_type, uint8_t *addr, bool has_aux,
             e->flags = 0;
             e->adi = adi;
         } else {
+            ble_ll_scan_dup_refresh(e);
             rc = e->flags & BLE_LL_SCAN_DUP_F_ADV_REPORT_SENT;
         }
 
@@ -1876,15 +1995,8 @@ ble_ll_scan_dup_check_ext(uint8_t addr_type, uint8_t *addr, bool has_aux,
     } else {
         rc = 0;
 
-        e = ble_ll_scan_dup_new();
-        e->flags = 0;
-        e->type = type;
+        e = ble_ll_scan_dup_new(type, is_anon ? NULL : addr);
         e->adi = adi;
-        if (!is_anon) {
-            memcpy(e->addr, addr, 6);
-        }
-
-        TAILQ_INSERT_HEAD(&g_scan_dup_list, e, link);
     }
 
     return rc;
@@ -1911,7 +2023,7 @@ ble_ll_scan_dup_update_ext(uint8_t addr_type, uint8_t *addr, bool has_aux,
     e = TAILQ_FIRST(&g_scan_dup_list);
     BLE_LL_ASSERT(e && e->type == type && (is_anon || !memcmp(e->addr, addr, 6)));
 
-    e->flags |= BLE_LL_SCAN_DUP_F_ADV_REPORT_SENT;
+    ble_ll_scan_dup_set_flags(e, BLE_LL_SCAN_DUP_F_ADV_REPORT_SENT);
 
     return 0;
 }
@@ -2804,8 +2916,7 @@ ble_ll_scan_reset(void)
     g_ble_ll_scan_num_rsp_advs = 0;
     memset(&g_ble_ll_scan_rsp_advs[0], 0, sizeof(g_ble_ll_scan_rsp_advs));
 
-    os_mempool_clear(&g_scan_dup_pool);
-    TAILQ_INIT(&g_scan_dup_list);
+    ble_ll_scan_dup_clear();
 
     /* Call the common init function again */
     ble_ll_scan_common_init();
@@ -2832,7 +2943,7 @@ ble_ll_scan_init(void)
                           "ble_ll_scan_dup_pool");
     BLE_LL_ASSERT(err == 0);
 
-    TAILQ_INIT(&g_scan_dup_list);
+    ble_ll_scan_dup_clear();
 
     ble_ll_scan_common_init();
 #if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_EXT_ADV)
@@ -33,11 +33,13 @@
 #include "nimble/nimble/host/include/host/ble_gap.h"
 #include "nimble/nimble/host/include/host/ble_gatt.h"
 #include "nimble/nimble/host/include/host/ble_hs_adv.h"
+#include "nimble/nimble/host/include/host/ble_hs_conn_stats.h"
 #include "nimble/nimble/host/include/host/ble_hs_id.h"
 #include "nimble/nimble/host/include/host/ble_hs_hci.h"
 #include "nimble/nimble/host/include/host/ble_hs_log.h"
 #include "nimble/nimble/host/include/host/ble_hs_mbuf.h"
 #include "nimble/nimble/host/include/host/ble_hs_stop.h"
+#include "nimble/nimble/host/include/host/ble_hs_trace.h"
 #include "nimble/nimble/host/include/host/ble_ibeacon.h"
 #include "nimble/nimble/host/include/host/ble_l2cap.h"
 #include "nimble/nimble/host/include/host/ble_sm.h"
@@ -461,6 +463,35 @@ void ble_hs_init(void);
  */
 int ble_hs_shutdown(int reason);
 
+/** HCI events dropped before reaching the host. */
+struct ble_hs_evt_drop_stats {
+    /** Advertising reports dropped by the per-source rate limit. */
+    uint32_t adv_rate_limited;
+
+    /** Advertising reports dropped because no event buffer was available. */
+    uint32_t adv_no_buf;
+
+    /** Other events dropped because no event buffer was available. */
+    uint32_t other_no_buf;
+};
+
+/**
+ * Retrieves the number of HCI events dropped by the transport and host since
+ * the last call to ble_hs_evt_drop_stats_reset().
+ *
+ * Advertising reports are rate limited per source address when
+ * BLE_HS_ADV_RPT_RATE_LIMIT is non-zero; BLE_TRANSPORT_EVT_DISCARDABLE_RESERVED
+ * keeps part of the discardable event pool free for other events.
+ *
+ * @param stats                 Filled with the drop counts.
+ */
+void ble_hs_evt_drop_stats_get(struct ble_hs_evt_drop_stats *stats);
+
+/**
+ * Clears the HCI event drop counts.
+ */
+void ble_hs_evt_drop_stats_reset(void);
+
 #ifdef __cplusplus
 }
 #endif
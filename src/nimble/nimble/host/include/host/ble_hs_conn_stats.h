@@ -0,0 +1,164 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_BLE_HS_CONN_STATS_
+#define H_BLE_HS_CONN_STATS_
+
+/**
+ * @brief Bluetooth Host Connection Statistics
+ * @defgroup bt_hs_conn_stats Bluetooth Host Connection Statistics
+ * @ingroup bt_host
+ * @{
+ *
+ * Traffic and latency counters kept for each open connection. The counters
+ * are cleared when the connection is established and discarded when it is
+ * closed.
+ *
+ * Requires BLE_HS_CONN_STATS to be enabled.
+ */
+
+#include <inttypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Number of buckets in the ATT request round trip histogram. */
+#define BLE_HS_CONN_STATS_RTT_BUCKETS       8
+
+/**
+ * Upper bound, in milliseconds, of round trip histogram bucket i. The last
+ * bucket has no upper bound.
+ */
+#define BLE_HS_CONN_STATS_RTT_BUCKET_MS(i)  (5u << (i))
+
+/** Counters of a single connection. */
+struct ble_hs_conn_stats {
+    /** ATT PDUs received, on the fixed and enhanced ATT channels. */
+    uint32_t att_rx_pdus;
+
+    /** ATT bytes received, including the opcode. */
+    uint32_t att_rx_bytes;
+
+    /** ATT PDUs sent. */
+    uint32_t att_tx_pdus;
+
+    /** ATT bytes sent, including the opcode. */
+    uint32_t att_tx_bytes;
+
+    /** Notifications passed to the controller. */
+    uint32_t notify_tx;
+
+    /** Notifications that could not be sent. */
+    uint32_t notify_drop;
+
+    /** Notifications and indications that had to wait for a free buffer. */
+    uint32_t notify_retry;
+
+    /** Indications sent. */
+    uint32_t indicate_tx;
+
+    /** Indications that failed or were not confirmed in time. */
+    uint32_t indicate_fail;
+
+    /** Indications confirmed by the peer. */
+    uint32_t indicate_ack;
+
+    /** Sum of the indication to confirmation times, in microseconds. */
+    uint64_t indicate_ack_us_sum;
+
+    /** Longest indication to confirmation time, in microseconds. */
+    uint32_t indicate_ack_us_max;
+
+    /**
+     * Round trip times of ATT requests sent on the fixed ATT channel, bucket i
+     * counts responses received within BLE_HS_CONN_STATS_RTT_BUCKET_MS(i).
+     */
+    uint32_t att_rtt_hist[BLE_HS_CONN_STATS_RTT_BUCKETS];
+
+    /** Longest ATT request round trip time, in microseconds. */
+    uint32_t att_rtt_us_max;
+
+    /** Times an LE credit based channel ran out of credits mid SDU. */
+    uint32_t l2cap_stalls;
+
+    /** Time spent waiting for credits, in microseconds. */
+    uint64_t l2cap_stall_us;
+
+    /** GAP event and GATT access callbacks run for the connection. */
+    uint32_t cb_calls;
+
+    /** Time spent in those callbacks, in microseconds. */
+    uint64_t cb_us;
+
+    /** Longest callback, in microseconds. */
+    uint32_t cb_us_max;
+};
+
+/**
+ * Retrieves the counters of a connection.
+ *
+ * @param conn_handle           The connection to query.
+ * @param out_stats             On success, the counters are written here.
+ *
+ * @return                      0 on success;
+ *                              BLE_HS_ENOTCONN if the connection is not open;
+ *                              BLE_HS_ENOTSUP if statistics are not compiled
+ *                                  in.
+ */
+int ble_hs_conn_stats_get(uint16_t conn_handle,
+                          struct ble_hs_conn_stats *out_stats);
+
+/**
+ * Clears the counters of a connection.
+ *
+ * @param conn_handle           The connection to clear.
+ *
+ * @return                      0 on success;
+ *                              BLE_HS_ENOTCONN if the connection is not open;
+ *                              BLE_HS_ENOTSUP if statistics are not compiled
+ *                                  in.
+ */
+int ble_hs_conn_stats_reset(uint16_t conn_handle);
+
+/**
+ * Records that a notification or indication to a connection had to wait for
+ * a free buffer. For use by code allocating the value buffer itself.
+ *
+ * @param conn_handle           The connection.
+ */
+void ble_hs_conn_stats_notify_retry(uint16_t conn_handle);
+
+/**
+ * Records a notification to a connection that was dropped before it reached
+ * the host, e.g. because no buffer could be allocated for it.
+ *
+ * @param conn_handle           The connection.
+ */
+void ble_hs_conn_stats_notify_drop(uint16_t conn_handle);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @}
+ */
+
+#endif
@@ -0,0 +1,183 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_BLE_HS_TRACE_
+#define H_BLE_HS_TRACE_
+
+/**
+ * @brief Bluetooth Host Binary Trace
+ * @defgroup bt_hs_trace Bluetooth Host Binary Trace
+ * @ingroup bt_host
+ * @{
+ *
+ * A fixed-size ring of binary records written at key points of the host
+ * (GAP events, ATT PDUs, notifications, L2CAP credits and mbuf allocation
+ * failures). Recording a record is a copy of 16 bytes, so it can stay
+ * enabled while measuring timing. The ring is exported with
+ * ble_hs_trace_dump() and decoded off target with
+ * extras/nimble_trace_decode.py.
+ *
+ * Requires BLE_HS_TRACE to be enabled.
+ */
+
+#include <inttypes.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** "NBTR", first word of a dump. */
+#define BLE_HS_TRACE_MAGIC                  0x5254424e
+#define BLE_HS_TRACE_VERSION                1
+
+/**
+ * @defgroup ble_hs_trace_ids Trace record IDs
+ * @{
+ */
+
+/** GAP event delivered to the application; arg0: event type, arg1: status or reason. */
+#define BLE_HS_TRACE_ID_GAP_EVENT           1
+
+/** ATT PDU received; arg0: opcode, arg1: length. */
+#define BLE_HS_TRACE_ID_ATT_RX              2
+
+/** ATT PDU sent; arg0: opcode, arg1: length. */
+#define BLE_HS_TRACE_ID_ATT_TX              3
+
+/**
+ * Notification or indication sent, or indication acknowledged;
+ * arg0: attribute handle | (is_indication << 16), arg1: status.
+ */
+#define BLE_HS_TRACE_ID_NOTIFY_TX           4
+
+/** LE credit based channel credits received from the peer; arg0: CID, arg1: credits. */
+#define BLE_HS_TRACE_ID_L2CAP_CREDITS_RX    5
+
+/** LE credit based channel credits given to the peer; arg0: CID, arg1: credits. */
+#define BLE_HS_TRACE_ID_L2CAP_CREDITS_TX    6
+
+/** LE credit based channel ran out of credits mid SDU; arg0: CID, arg1: bytes left. */
+#define BLE_HS_TRACE_ID_L2CAP_STALLED       7
+
+/** Host mbuf allocation failed; arg0: requested leading space. */
+#define BLE_HS_TRACE_ID_MBUF_ALLOC_FAIL     8
+
+/** First ID available to the application. */
+#define BLE_HS_TRACE_ID_USER                0x80
+
+/** @} */
+
+/** A trace record, all fields little endian in a dump. */
+struct ble_hs_trace_rec {
+    /** Microsecond timestamp, wraps after ~71 minutes. */
+    uint32_t time_us;
+
+    /** Connection handle, BLE_HS_CONN_HANDLE_NONE if not related to a connection. */
+    uint16_t conn_handle;
+
+    /** One of the BLE_HS_TRACE_ID_[...] values. */
+    uint8_t id;
+
+    /** Reserved, always 0. */
+    uint8_t reserved;
+
+    /** ID specific arguments. */
+    uint32_t arg0;
+    uint32_t arg1;
+};
+
+/** Header written ahead of the records by ble_hs_trace_dump(). */
+struct ble_hs_trace_hdr {
+    /** BLE_HS_TRACE_MAGIC. */
+    uint32_t magic;
+
+    /** BLE_HS_TRACE_VERSION. */
+    uint8_t version;
+
+    /** sizeof(struct ble_hs_trace_rec). */
+    uint8_t rec_size;
+
+    /** Number of records following the header. */
+    uint16_t rec_count;
+
+    /** Number of records overwritten before they were dumped. */
+    uint32_t lost;
+};
+
+/** @typedef ble_hs_trace_write_fn
+ * @brief Callback function; receives a chunk of a trace dump.
+ *
+ * @param data                  The chunk.
+ * @param len                   The length of the chunk, in bytes.
+ * @param arg                   Optional argument passed to ble_hs_trace_dump().
+ *
+ * @return                      0 to continue; nonzero to abort the dump.
+ */
+typedef int ble_hs_trace_write_fn(const void *data, size_t len, void *arg);
+
+/**
+ * Adds a record to the trace ring, overwriting the oldest record when full.
+ * Can be called by the application with IDs from BLE_HS_TRACE_ID_USER.
+ *
+ * @param id                    The record ID.
+ * @param conn_handle           The related connection, or
+ *                                  BLE_HS_CONN_HANDLE_NONE.
+ * @param arg0                  First ID specific argument.
+ * @param arg1                  Second ID specific argument.
+ */
+void ble_hs_trace(uint8_t id, uint16_t conn_handle, uint32_t arg0,
+                  uint32_t arg1);
+
+/**
+ * Enables or disables recording. Recording is enabled at startup.
+ *
+ * @param enabled               1 to record; 0 to stop recording.
+ */
+void ble_hs_trace_set_enabled(int enabled);
+
+/**
+ * Discards all records and resets the lost count.
+ */
+void ble_hs_trace_clear(void);
+
+/**
+ * Writes a struct ble_hs_trace_hdr followed by the records, oldest first,
+ * to the supplied callback. Recording is paused for the duration of the dump
+ * and records emitted meanwhile are discarded. The ring is not cleared.
+ *
+ * @param fn                    Callback receiving the dump.
+ * @param arg                   Optional argument passed to the callback.
+ *
+ * @return                      0 on success;
+ *                              BLE_HS_ENOTSUP if tracing is not compiled in;
+ *                              the callback's return code if it aborted
+ *                                  the dump.
+ */
+int ble_hs_trace_dump(ble_hs_trace_write_fn *fn, void *arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @}
+ */
+
+#endif
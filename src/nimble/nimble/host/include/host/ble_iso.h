@@ -329,6 +329,21 @@ int ble_iso_create_big(const struct ble_iso_create_big_params *create_params,
  */
 int ble_iso_terminate_big(uint8_t big_handle);
 
+/**
+ * Replaces the event callback of a BIG. Events of the BIG are delivered in
+ * the host task, so this is safe to call from the host task or while no
+ * event of the BIG can be pending.
+ *
+ * @param big_handle            The identifier of the BIG.
+ * @param cb                    The new callback, NULL to stop reporting events.
+ * @param cb_arg                The argument passed to the callback.
+ *
+ * @return                      0 on success;
+ *                              BLE_HS_ENOENT if the BIG does not exist.
+ */
+int ble_iso_big_cb_set(uint8_t big_handle, ble_iso_event_fn *cb,
+                       void *cb_arg);
+
 /** @brief BIS parameters for @ref ble_iso_big_sync_create */
 struct ble_iso_bis_params {
     /** BIS index */
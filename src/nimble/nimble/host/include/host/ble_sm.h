@@ -28,6 +28,7 @@
  */
 
 #include <inttypes.h>
+#include <stddef.h>
 #include "syscfg/syscfg.h"
 #include <stdbool.h>
 #include "nimble/nimble/include/nimble/ble.h"
@@ -311,6 +312,30 @@ struct ble_sm_io {
  */
 int ble_sm_sc_oob_generate_data(struct ble_sm_sc_oob_data *oob_data);
 
+/**
+ * Generates one P-256 key pair into the Secure Connections key pool if it is
+ * not full. Pairing takes a precomputed key pair from the pool instead of
+ * generating one while the procedure is in progress.
+ *
+ * The FreeRTOS port calls this from a low priority task; other ports can call
+ * it from any task other than the host task when the CPU is idle.
+ *
+ * @return                      0 if a key pair was added to the pool;
+ *                              BLE_HS_EALREADY if the pool is full;
+ *                              BLE_HS_ENOTSYNCED if the host is not synced;
+ *                              BLE_HS_ENOTSUP if the pool is disabled;
+ *                              Other nonzero on key generation failure.
+ */
+int ble_sm_sc_key_pool_refill(void);
+
+/**
+ * Retrieves the number of precomputed key pairs in the Secure Connections key
+ * pool.
+ *
+ * @return                      The number of ready key pairs.
+ */
+int ble_sm_sc_key_pool_count(void);
+
 #if MYNEWT_VAL(BLE_SM_CSIS_SIRK)
 /**
  * Resolves CSIS RSI to check if advertising device is part of the same Coordinated Set,
@@ -343,6 +368,109 @@ int ble_sm_csis_resolve_rsi(const uint8_t *rsi, const uint8_t *sirk,
  *                              Non-zero on failure.
  */
 int ble_sm_inject_io(uint16_t conn_handle, struct ble_sm_io *pkey);
+
+/**
+ * @brief Cryptographic primitives used by the Security Manager and by host
+ * based address resolution.
+ *
+ * All buffers are in standard (most significant octet first) byte order as
+ * used by FIPS-197, NIST SP 800-38B and SEC 1; the host converts from and to
+ * the little-endian order used on air. Every member is optional, a NULL
+ * member falls back to the built-in implementation. Callbacks return 0 on
+ * success and non-zero on failure, and may be invoked from the host task or
+ * the Secure Connections key pool task.
+ */
+struct ble_sm_crypto_provider {
+    /** Name reported in the host log, may be NULL. */
+    const char *name;
+
+    /**
+     * AES-128 encryption of a single 16 octet block.
+     * `in` and `out` may point to the same buffer.
+     */
+    int (*aes_encrypt)(const uint8_t *key, const uint8_t *in, uint8_t *out);
+
+    /** AES-CMAC with a 128-bit key (f4, f5, f6, g2 and CSIS functions). */
+    int (*aes_cmac)(const uint8_t *key, const uint8_t *in, size_t len,
+                    uint8_t *out);
+
+    /**
+     * Generates a P-256 key pair; `pub` is X || Y (64 octets), `priv` is 32
+     * octets.
+     */
+    int (*p256_gen_key_pair)(uint8_t *pub, uint8_t *priv);
+
+    /**
+     * Computes the P-256 DH key from the peer public key (X || Y) and our
+     * private key. The implementation must reject public keys that are not
+     * on the curve.
+     */
+    int (*p256_dhkey)(const uint8_t *pub, const uint8_t *priv,
+                      uint8_t *dhkey);
+};
+
+/**
+ * @brief Installs a crypto provider for the Security Manager.
+ *
+ * The provider must remain valid while installed.
+ *
+ * @param provider              The provider to use, NULL to restore the
+ *                                  built-in implementation.
+ *
+ * @return                      0 on success;
+ *                              BLE_HS_EBUSY if a pairing procedure is in
+ *                                  progress.
+ */
+int ble_sm_crypto_set_provider(const struct ble_sm_crypto_provider *provider);
+
+/**
+ * @brief Retrieves the installed crypto provider.
+ *
+ * @return                      The provider, NULL if the built-in
+ *                                  implementation is in use.
+ */
+const struct ble_sm_crypto_provider *ble_sm_crypto_get_provider(void);
+
+/** Average time per operation measured by ble_sm_crypto_bench(). */
+struct ble_sm_crypto_bench_result {
+    /** ble_sm_alg_encrypt(), one block. */
+    uint32_t aes_encrypt_us;
+
+    /** ble_sm_alg_aes_cmac(), 65 octet message as used by f4. */
+    uint32_t aes_cmac_us;
+
+    /** P-256 key pair generation. */
+    uint32_t p256_key_pair_us;
+
+    /** ble_sm_alg_gen_dhkey(). */
+    uint32_t p256_dhkey_us;
+};
+
+/**
+ * @brief Times the Security Manager crypto functions with a given provider.
+ *
+ * Runs the same code paths used during pairing and address resolution,
+ * including byte order conversion. Timing uses the microsecond timer where
+ * the target has one and the OS tick otherwise, so the iteration counts
+ * should be large enough for each run to span many ticks. Should not be
+ * called while a pairing procedure is in progress.
+ *
+ * @param provider              The provider to measure, NULL for the
+ *                                  built-in implementation.
+ * @param aes_iterations        Number of AES and AES-CMAC operations.
+ * @param ecc_iterations        Number of P-256 operations, 0 to skip them.
+ * @param result                On success, the average time per operation in
+ *                                  microseconds. P-256 and CMAC results are 0
+ *                                  if not measured.
+ *
+ * @return                      0 on success;
+ *                              BLE_HS_EINVAL on invalid arguments;
+ *                              Other nonzero on crypto failure.
+ */
+int ble_sm_crypto_bench(const struct ble_sm_crypto_provider *provider,
+                        unsigned int aes_iterations,
+                        unsigned int ecc_iterations,
+                        struct ble_sm_crypto_bench_result *result);
 #else
 /** This macro replaces the function to return BLE_HS_ENOTSUP when SM is disabled. */
 #define ble_sm_inject_io(conn_handle, pkey) \
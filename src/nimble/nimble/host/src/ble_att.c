@@ -537,6 +537,12 @@ ble_att_rx_extended(uint16_t conn_handle, uint16_t cid, struct os_mbuf **om)
         return BLE_HS_EMSGSIZE;
     }
 
+    BLE_HS_TRACE_REC(BLE_HS_TRACE_ID_ATT_RX, conn_handle, op,
+                     OS_MBUF_PKTLEN(*om));
+#if MYNEWT_VAL(BLE_HS_CONN_STATS)
+    ble_hs_conn_stats_att_rx(conn_handle, cid, op, OS_MBUF_PKTLEN(*om));
+#endif
+
     if (cid == BLE_L2CAP_CID_ATT && ble_att_is_response_op(op)) {
         ble_att_send_outstanding_after_response(conn_handle);
     }
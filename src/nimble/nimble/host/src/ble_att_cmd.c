@@ -92,6 +92,12 @@ ble_att_tx_with_conn(struct ble_hs_conn *conn, struct ble_l2cap_chan *chan, stru
     ble_att_inc_tx_stat(txom->om_data[0]);
 
     ble_att_truncate_to_mtu(chan, txom);
+    BLE_HS_TRACE_REC(BLE_HS_TRACE_ID_ATT_TX, conn->bhc_handle,
+                     txom->om_data[0], OS_MBUF_PKTLEN(txom));
+#if MYNEWT_VAL(BLE_HS_CONN_STATS)
+    ble_hs_conn_stats_att_tx(conn, chan->scid, txom->om_data[0],
+                             OS_MBUF_PKTLEN(txom));
+#endif
     rc = ble_l2cap_tx(conn, chan, txom);
     assert(rc == 0);
     return rc;
@@ -795,6 +795,88 @@ ble_gap_set_prefered_le_phy(uint16_t conn_handle, uint8_t tx_phys_mask,
 static int
 ble_gap_event_listener_call(struct ble_gap_event *event);
 
+#if MYNEWT_VAL(BLE_HS_TRACE)
+static void
+ble_gap_trace_event(const struct ble_gap_event *event)
+{
+    uint16_t conn_handle;
+    uint32_t arg;
+
+    conn_handle = BLE_HS_CONN_HANDLE_NONE;
+    arg = 0;
+
+    switch (event->type) {
+    case BLE_GAP_EVENT_CONNECT:
+        conn_handle = event->connect.conn_handle;
+        arg = event->connect.status;
+        break;
+
+    case BLE_GAP_EVENT_DISCONNECT:
+        conn_handle = event->disconnect.conn.conn_handle;
+        arg = event->disconnect.reason;
+        break;
+
+    case BLE_GAP_EVENT_CONN_UPDATE:
+        conn_handle = event->conn_update.conn_handle;
+        arg = event->conn_update.status;
+        break;
+
+    case BLE_GAP_EVENT_CONN_UPDATE_REQ:
+    case BLE_GAP_EVENT_L2CAP_UPDATE_REQ:
+        conn_handle = event->conn_update_req.conn_handle;
+        break;
+
+    case BLE_GAP_EVENT_ENC_CHANGE:
+        conn_handle = event->enc_change.conn_handle;
+        arg = event->enc_change.status;
+        break;
+
+    case BLE_GAP_EVENT_PASSKEY_ACTION:
+        conn_handle = event->passkey.conn_handle;
+        break;
+
+    case BLE_GAP_EVENT_NOTIFY_RX:
+        conn_handle = event->notify_rx.conn_handle;
+        arg = event->notify_rx.attr_handle;
+        break;
+
+    case BLE_GAP_EVENT_SUBSCRIBE:
+        conn_handle = event->subscribe.conn_handle;
+        arg = event->subscribe.attr_handle;
+        break;
+
+    case BLE_GAP_EVENT_MTU:
+        conn_handle = event->mtu.conn_handle;
+        arg = event->mtu.value;
+        break;
+
+    case BLE_GAP_EVENT_PHY_UPDATE_COMPLETE:
+        conn_handle = event->phy_updated.conn_handle;
+        arg = event->phy_updated.status;
+        break;
+
+    case BLE_GAP_EVENT_ADV_COMPLETE:
+#if MYNEWT_VAL(BLE_EXT_ADV)
+        conn_handle = event->adv_complete.conn_handle;
+#endif
+        arg = event->adv_complete.reason;
+        break;
+
+    case BLE_GAP_EVENT_DISC:
+    case BLE_GAP_EVENT_EXT_DISC:
+    case BLE_GAP_EVENT_PERIODIC_REPORT:
+    case BLE_GAP_EVENT_NOTIFY_TX:
+        /* Reports would flood the ring; notify tx has its own record. */
+        return;
+
+    default:
+        break;
+    }
+
+    ble_hs_trace(BLE_HS_TRACE_ID_GAP_EVENT, conn_handle, event->type, arg);
+}
+#endif
+
 static int
 ble_gap_call_event_cb(struct ble_gap_event *event,
                       ble_gap_event_fn *cb, void *cb_arg)
@@ -803,6 +885,10 @@ ble_gap_call_event_cb(struct ble_gap_event *event,
 
     BLE_HS_DBG_ASSERT(!ble_hs_locked_by_cur_task());
 
+#if MYNEWT_VAL(BLE_HS_TRACE)
+    ble_gap_trace_event(event);
+#endif
+
     if (cb != NULL) {
         rc = cb(event, cb_arg);
     } else {
@@ -823,6 +909,9 @@ ble_gap_call_conn_event_cb(struct ble_gap_event *event, uint16_t conn_handle)
 {
     ble_gap_event_fn *cb;
     void *cb_arg;
+#if MYNEWT_VAL(BLE_HS_CONN_STATS)
+    uint32_t start_us;
+#endif
     int rc;
 
     rc = ble_gap_extract_conn_cb(conn_handle, &cb, &cb_arg);
@@ -830,7 +919,13 @@ ble_gap_call_conn_event_cb(struct ble_gap_event *event, uint16_t conn_handle)
         return rc;
     }
 
+#if MYNEWT_VAL(BLE_HS_CONN_STATS)
+    start_us = ble_hs_misc_time_us();
     rc = ble_gap_call_event_cb(event, cb, cb_arg);
+    ble_hs_conn_stats_cb(conn_handle, start_us);
+#else
+    rc = ble_gap_call_event_cb(event, cb, cb_arg);
+#endif
     if (rc != 0) {
         return rc;
     }
@@ -6844,6 +6939,12 @@ ble_gap_notify_tx_event(int status, uint16_t conn_handle, uint16_t attr_handle,
 #if (MYNEWT_VAL(BLE_GATT_NOTIFY) || MYNEWT_VAL(BLE_GATT_INDICATE)) && NIMBLE_BLE_CONNECT
     struct ble_gap_event event;
 
+    BLE_HS_TRACE_REC(BLE_HS_TRACE_ID_NOTIFY_TX, conn_handle,
+                     attr_handle | ((uint32_t)!!is_indication << 16), status);
+#if MYNEWT_VAL(BLE_HS_CONN_STATS)
+    ble_hs_conn_stats_notify_tx(conn_handle, status, is_indication);
+#endif
+
     memset(&event, 0, sizeof event);
     event.type = BLE_GAP_EVENT_NOTIFY_TX;
     event.notify_tx.conn_handle = conn_handle;
@@ -36,10 +36,11 @@
  * Notes on thread-safety:
  * 1. The ble_hs mutex must never be locked when an application callback is
  *    executed.  A callback is free to initiate additional host procedures.
- * 2. The only resource protected by the mutex is the list of active procedures
- *    (ble_gattc_procs).  Thread-safety is achieved by locking the mutex during
- *    removal and insertion operations.  Procedure objects are only modified
- *    while they are not in the list.  This is sufficient, as the host parent
+ * 2. The only resources protected by the mutex are the per-connection lists
+ *    of active procedures (ble_gattc_procs) and the expiry queue
+ *    (ble_gattc_exp_queue).  Thread-safety is achieved by locking the mutex
+ *    during removal and insertion operations.  Procedure objects are only
+ *    modified while they are not in the lists.  This is sufficient, as the host parent
  *    task is the only task which inspects or modifies individual procedure
  *    entries.  Tasks have the following permissions regarding procedure
  *    entries:
@@ -103,9 +104,23 @@
 /** Procedure stalled due to resource exhaustion. */
 #define BLE_GATTC_PROC_F_STALLED                0x01
 
+/** Procedure is in the expiry queue. */
+#define BLE_GATTC_PROC_F_EXP_QUEUED             0x02
+
+/** Expiry time of a stalled procedure is set, kept while it stays stalled. */
+#define BLE_GATTC_PROC_F_STALL_EXP              0x04
+
+/**
+ * Number of per-connection procedure lists.  Controllers hand out connection
+ * handles starting from either 0 or 1, so one more list than the maximum
+ * number of connections gives each connection a list of its own.
+ */
+#define BLE_GATTC_PROC_LISTS    (MYNEWT_VAL(BLE_MAX_CONNECTIONS) + 1)
+
 /** Represents an in-progress GATT procedure. */
 struct ble_gattc_proc {
     STAILQ_ENTRY(ble_gattc_proc) next;
+    TAILQ_ENTRY(ble_gattc_proc) exp_next;
 
     uint32_t exp_os_ticks;
     uint16_t conn_handle;
@@ -225,6 +240,7 @@ struct ble_gattc_proc {
 };
 
 STAILQ_HEAD(ble_gattc_proc_list, ble_gattc_proc);
+TAILQ_HEAD(ble_gattc_exp_list, ble_gattc_proc);
 
 /**
  * Error functions - these handle an incoming ATT error response and apply it
@@ -429,8 +445,20 @@ static os_membuf_t ble_gattc_proc_mem[
 
 static struct os_mempool ble_gattc_proc_pool;
 
-/* The list of active GATT client procedures. */
-static struct ble_gattc_proc_list ble_gattc_procs;
+/* The active GATT client procedures, listed per connection in the order they
+ * were inserted.  A list is selected by connection handle modulo
+ * BLE_GATTC_PROC_LISTS.
+ */
+static struct ble_gattc_proc_list ble_gattc_procs[BLE_GATTC_PROC_LISTS];
+static int ble_gattc_num_procs;
+
+/* Procedures awaiting a response or waiting to be resumed, in expiry order,
+ * so the head is always the next procedure to expire.  A procedure that sent
+ * a request gets a full timeout and goes to the tail; a stalled procedure
+ * keeps the expiry time set when it first stalled, so it can not wait for
+ * resources forever.
+ */
+static struct ble_gattc_exp_list ble_gattc_exp_queue;
 
 /* The time when we should attempt to resume stalled procedures, in OS ticks.
  * A value of 0 indicates no stalled procedures.
@@ -486,11 +514,14 @@ ble_gattc_dbg_assert_proc_not_inserted(struct ble_gattc_proc *proc)
 {
 #if MYNEWT_VAL(BLE_HS_DEBUG)
     struct ble_gattc_proc *cur;
+    int i;
 
     ble_hs_lock();
 
-    STAILQ_FOREACH(cur, &ble_gattc_procs, next) {
-        BLE_HS_DBG_ASSERT(cur != proc);
+    for (i = 0; i < BLE_GATTC_PROC_LISTS; i++) {
+        STAILQ_FOREACH(cur, &ble_gattc_procs[i], next) {
+            BLE_HS_DBG_ASSERT(cur != proc);
+        }
     }
 
     ble_hs_unlock();
@@ -753,20 +784,77 @@ ble_gattc_proc_free(struct ble_gattc_proc *proc)
     }
 }
 
+static struct ble_gattc_proc_list *
+ble_gattc_proc_list_get(uint16_t conn_handle)
+{
+    return &ble_gattc_procs[conn_handle % BLE_GATTC_PROC_LISTS];
+}
+
 static void
 ble_gattc_proc_insert(struct ble_gattc_proc *proc, bool insert_head)
 {
+    struct ble_gattc_proc_list *list;
+    struct ble_gattc_proc *cur;
+
     ble_gattc_dbg_assert_proc_not_inserted(proc);
 
+    list = ble_gattc_proc_list_get(proc->conn_handle);
+
     ble_hs_lock();
     if (insert_head) {
-        STAILQ_INSERT_HEAD(&ble_gattc_procs, proc, next);
+        STAILQ_INSERT_HEAD(list, proc, next);
     } else {
-        STAILQ_INSERT_TAIL(&ble_gattc_procs, proc, next);
+        STAILQ_INSERT_TAIL(list, proc, next);
     }
+
+    /* Search from the tail, where new expiry times nearly always belong. */
+    cur = TAILQ_LAST(&ble_gattc_exp_queue, ble_gattc_exp_list);
+    while (cur != NULL &&
+           (int32_t)(cur->exp_os_ticks - proc->exp_os_ticks) > 0) {
+        cur = TAILQ_PREV(cur, ble_gattc_exp_list, exp_next);
+    }
+
+    if (cur == NULL) {
+        TAILQ_INSERT_HEAD(&ble_gattc_exp_queue, proc, exp_next);
+    } else {
+        TAILQ_INSERT_AFTER(&ble_gattc_exp_queue, cur, proc, exp_next);
+    }
+    proc->flags |= BLE_GATTC_PROC_F_EXP_QUEUED;
+
+    ble_gattc_num_procs++;
     ble_hs_unlock();
 }
 
+/**
+ * Removes a procedure from its connection list and from the expiry queue.
+ * The host mutex must be held.
+ *
+ * @param list                  The connection list containing the procedure.
+ * @param prev                  The procedure preceding it in the list, or
+ *                                  null if it is the first entry.
+ * @param proc                  The procedure to remove.
+ */
+static void
+ble_gattc_proc_unlink(struct ble_gattc_proc_list *list,
+                      struct ble_gattc_proc *prev,
+                      struct ble_gattc_proc *proc)
+{
+    BLE_HS_DBG_ASSERT(ble_hs_locked_by_cur_task());
+
+    if (prev == NULL) {
+        STAILQ_REMOVE_HEAD(list, next);
+    } else {
+        STAILQ_REMOVE_AFTER(list, prev, next);
+    }
+
+    if (proc->flags & BLE_GATTC_PROC_F_EXP_QUEUED) {
+        TAILQ_REMOVE(&ble_gattc_exp_queue, proc, exp_next);
+        proc->flags &= ~BLE_GATTC_PROC_F_EXP_QUEUED;
+    }
+
+    ble_gattc_num_procs--;
+}
+
 static void
 ble_gattc_proc_set_exp_timer(struct ble_gattc_proc *proc)
 {
@@ -800,6 +888,10 @@ ble_gattc_process_status(struct ble_gattc_proc *proc, int status, bool insert_he
     case 0:
         if (!(proc->flags & BLE_GATTC_PROC_F_STALLED)) {
             ble_gattc_proc_set_exp_timer(proc);
+            proc->flags &= ~BLE_GATTC_PROC_F_STALL_EXP;
+        } else if (!(proc->flags & BLE_GATTC_PROC_F_STALL_EXP)) {
+            ble_gattc_proc_set_exp_timer(proc);
+            proc->flags |= BLE_GATTC_PROC_F_STALL_EXP;
         }
 
         ble_gattc_proc_insert(proc, insert_head);
@@ -923,33 +1015,6 @@ ble_gattc_proc_matches_conn_cid_op(struct ble_gattc_proc *proc, void *arg)
     return 1;
 }
 
-struct ble_gattc_criteria_exp {
-    ble_npl_time_t now;
-    int32_t next_exp_in;
-};
-
-static int
-ble_gattc_proc_matches_expired(struct ble_gattc_proc *proc, void *arg)
-{
-    struct ble_gattc_criteria_exp *criteria;
-    int32_t time_diff;
-
-    criteria = arg;
-
-    time_diff = proc->exp_os_ticks - criteria->now;
-
-    if (time_diff <= 0) {
-        /* Procedure is expired. */
-        return 1;
-    }
-
-    /* Procedure isn't expired; determine if it is the next to expire. */
-    if (time_diff < criteria->next_exp_in) {
-        criteria->next_exp_in = time_diff;
-    }
-    return 0;
-}
-
 struct ble_gattc_criteria_conn_rx_entry {
     uint16_t conn_handle;
     uint16_t cid;
@@ -981,14 +1046,32 @@ ble_gattc_proc_matches_conn_rx_entry(struct ble_gattc_proc *proc, void *arg)
     return (criteria->matching_rx_entry != NULL);
 }
 
+/**
+ * Moves the procedures that match the specified criteria to the destination
+ * list.
+ *
+ * @param conn_handle           The connection the procedures belong to; only
+ *                                  that connection's list is searched.
+ *                                  BLE_HS_CONN_HANDLE_NONE searches all
+ *                                  connections.
+ * @param cb                    The match function applied to each procedure.
+ * @param arg                   The argument passed to the match function.
+ * @param max_procs             The maximum number of procedures to extract,
+ *                                  0 for no limit.
+ * @param dst_list              The list extracted procedures are appended to.
+ */
 static void
-ble_gattc_extract(ble_gattc_match_fn *cb, void *arg, int max_procs,
-                  struct ble_gattc_proc_list *dst_list)
+ble_gattc_extract(uint16_t conn_handle, ble_gattc_match_fn *cb, void *arg,
+                  int max_procs, struct ble_gattc_proc_list *dst_list)
 {
+    struct ble_gattc_proc_list *list;
     struct ble_gattc_proc *proc;
     struct ble_gattc_proc *prev;
     struct ble_gattc_proc *next;
     int num_extracted;
+    int first;
+    int last;
+    int i;
 
     /* Only the parent task is allowed to remove entries from the list. */
     BLE_HS_DBG_ASSERT(ble_hs_is_parent_task());
@@ -996,43 +1079,52 @@ ble_gattc_extract(ble_gattc_match_fn *cb, void *arg, int max_procs,
     STAILQ_INIT(dst_list);
     num_extracted = 0;
 
+    if (conn_handle == BLE_HS_CONN_HANDLE_NONE) {
+        first = 0;
+        last = BLE_GATTC_PROC_LISTS - 1;
+    } else {
+        first = conn_handle % BLE_GATTC_PROC_LISTS;
+        last = first;
+    }
+
     ble_hs_lock();
 
-    prev = NULL;
-    proc = STAILQ_FIRST(&ble_gattc_procs);
-    while (proc != NULL) {
-        next = STAILQ_NEXT(proc, next);
+    for (i = first; i <= last; i++) {
+        list = &ble_gattc_procs[i];
 
-        if (cb(proc, arg)) {
-            if (prev == NULL) {
-                STAILQ_REMOVE_HEAD(&ble_gattc_procs, next);
-            } else {
-                STAILQ_REMOVE_AFTER(&ble_gattc_procs, prev, next);
-            }
-            STAILQ_INSERT_TAIL(dst_list, proc, next);
+        prev = NULL;
+        proc = STAILQ_FIRST(list);
+        while (proc != NULL) {
+            next = STAILQ_NEXT(proc, next);
+
+            if (cb(proc, arg)) {
+                ble_gattc_proc_unlink(list, prev, proc);
+                STAILQ_INSERT_TAIL(dst_list, proc, next);
 
-            if (max_procs > 0) {
-                num_extracted++;
-                if (num_extracted >= max_procs) {
-                    break;
+                if (max_procs > 0) {
+                    num_extracted++;
+                    if (num_extracted >= max_procs) {
+                        goto done;
+                    }
                 }
+            } else {
+                prev = proc;
             }
-        } else {
-            prev = proc;
-        }
 
-        proc = next;
+            proc = next;
+        }
     }
 
+done:
     ble_hs_unlock();
 }
 
 static struct ble_gattc_proc *
-ble_gattc_extract_one(ble_gattc_match_fn *cb, void *arg)
+ble_gattc_extract_one(uint16_t conn_handle, ble_gattc_match_fn *cb, void *arg)
 {
     struct ble_gattc_proc_list dst_list;
 
-    ble_gattc_extract(cb, arg, 1, &dst_list);
+    ble_gattc_extract(conn_handle, cb, arg, 1, &dst_list);
     return STAILQ_FIRST(&dst_list);
 }
 
@@ -1045,7 +1137,8 @@ ble_gattc_extract_by_conn_op(uint16_t conn_handle, uint8_t op, int max_procs,
     criteria.conn_handle = conn_handle;
     criteria.op = op;
 
-    ble_gattc_extract(ble_gattc_proc_matches_conn_op, &criteria, max_procs, dst_list);
+    ble_gattc_extract(conn_handle, ble_gattc_proc_matches_conn_op, &criteria,
+                      max_procs, dst_list);
 }
 
 static void
@@ -1059,7 +1152,8 @@ ble_gattc_extract_by_conn_cid_op(uint16_t conn_handle, uint16_t psm, uint8_t op,
     criteria.op = op;
     criteria.psm = psm;
 
-    ble_gattc_extract(ble_gattc_proc_matches_conn_cid_op, &criteria, max_procs, dst_list);
+    ble_gattc_extract(conn_handle, ble_gattc_proc_matches_conn_cid_op,
+                      &criteria, max_procs, dst_list);
 }
 
 static struct ble_gattc_proc *
@@ -1080,7 +1174,8 @@ ble_gattc_proc_matches_stalled(struct ble_gattc_proc *proc, void *unused)
 static void
 ble_gattc_extract_stalled(struct ble_gattc_proc_list *dst_list)
 {
-    ble_gattc_extract(ble_gattc_proc_matches_stalled, NULL, 0, dst_list);
+    ble_gattc_extract(BLE_HS_CONN_HANDLE_NONE, ble_gattc_proc_matches_stalled,
+                      NULL, 0, dst_list);
 }
 
 /**
@@ -1090,15 +1185,48 @@ ble_gattc_extract_stalled(struct ble_gattc_proc_list *dst_list)
 static int32_t
 ble_gattc_extract_expired(struct ble_gattc_proc_list *dst_list)
 {
-    struct ble_gattc_criteria_exp criteria;
+    struct ble_gattc_proc_list *list;
+    struct ble_gattc_proc *proc;
+    struct ble_gattc_proc *prev;
+    struct ble_gattc_proc *cur;
+    ble_npl_time_t now;
+    int32_t next_exp_in;
+    int32_t time_diff;
 
-    criteria.now = ble_npl_time_get();
-    criteria.next_exp_in = BLE_HS_FOREVER;
+    /* Only the parent task is allowed to remove entries from the list. */
+    BLE_HS_DBG_ASSERT(ble_hs_is_parent_task());
 
     STAILQ_INIT(dst_list);
-    ble_gattc_extract(ble_gattc_proc_matches_expired, &criteria, 0, dst_list);
+    next_exp_in = BLE_HS_FOREVER;
+    now = ble_npl_time_get();
+
+    ble_hs_lock();
+
+    /* The queue is in expiry order; stop at the first unexpired procedure. */
+    while ((proc = TAILQ_FIRST(&ble_gattc_exp_queue)) != NULL) {
+        time_diff = proc->exp_os_ticks - now;
+        if (time_diff > 0) {
+            next_exp_in = time_diff;
+            break;
+        }
+
+        list = ble_gattc_proc_list_get(proc->conn_handle);
+        prev = NULL;
+        STAILQ_FOREACH(cur, list, next) {
+            if (cur == proc) {
+                break;
+            }
+            prev = cur;
+        }
+        BLE_HS_DBG_ASSERT(cur == proc);
 
-    return criteria.next_exp_in;
+        ble_gattc_proc_unlink(list, prev, proc);
+        STAILQ_INSERT_TAIL(dst_list, proc, next);
+    }
+
+    ble_hs_unlock();
+
+    return next_exp_in;
 }
 
 static struct ble_gattc_proc *
@@ -1115,7 +1243,8 @@ ble_gattc_extract_with_rx_entry(uint16_t conn_handle, uint16_t cid,
     criteria.num_rx_entries = num_rx_entries;
     criteria.matching_rx_entry = NULL;
 
-    proc = ble_gattc_extract_one(ble_gattc_proc_matches_conn_rx_entry,
+    proc = ble_gattc_extract_one(conn_handle,
+                                 ble_gattc_proc_matches_conn_rx_entry,
                                  &criteria);
     *out_rx_entry = criteria.matching_rx_entry;
 
@@ -1123,7 +1252,7 @@ ble_gattc_extract_with_rx_entry(uint16_t conn_handle, uint16_t cid,
 }
 
 /**
- * Searches the main proc list for an entry whose connection handle and op code
+ * Searches the connection's proc list for an entry whose connection handle and op code
  * match those specified.  If a matching entry is found, it is removed from the
  * list and returned.
  *
@@ -5162,15 +5291,20 @@ ble_gattc_connection_broken(uint16_t conn_handle)
 int
 ble_gattc_any_jobs(void)
 {
-    return !STAILQ_EMPTY(&ble_gattc_procs);
+    return ble_gattc_num_procs > 0;
 }
 
 int
 ble_gattc_init(void)
 {
     int rc;
+    int i;
 
-    STAILQ_INIT(&ble_gattc_procs);
+    for (i = 0; i < BLE_GATTC_PROC_LISTS; i++) {
+        STAILQ_INIT(&ble_gattc_procs[i]);
+    }
+    TAILQ_INIT(&ble_gattc_exp_queue);
+    ble_gattc_num_procs = 0;
 
     if (MYNEWT_VAL(BLE_GATT_MAX_PROCS) > 0) {
         rc = os_mempool_init(&ble_gattc_proc_pool,
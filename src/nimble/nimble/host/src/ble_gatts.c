@@ -350,6 +350,25 @@ ble_gatts_mutable(void)
     return true;
 }
 
+static int
+ble_gatts_call_access_cb(ble_gatt_access_fn *access_cb, uint16_t conn_handle,
+                         uint16_t attr_handle,
+                         struct ble_gatt_access_ctxt *gatt_ctxt, void *cb_arg)
+{
+#if MYNEWT_VAL(BLE_HS_CONN_STATS)
+    uint32_t start_us;
+    int rc;
+
+    start_us = ble_hs_misc_time_us();
+    rc = access_cb(conn_handle, attr_handle, gatt_ctxt, cb_arg);
+    ble_hs_conn_stats_cb(conn_handle, start_us);
+
+    return rc;
+#else
+    return access_cb(conn_handle, attr_handle, gatt_ctxt, cb_arg);
+#endif
+}
+
 static int
 ble_gatts_val_access(uint16_t conn_handle, uint16_t attr_handle,
                      uint16_t offset, struct ble_gatt_access_ctxt *gatt_ctxt,
@@ -386,7 +405,8 @@ ble_gatts_val_access(uint16_t conn_handle, uint16_t attr_handle,
         }
 
         initial_len = OS_MBUF_PKTLEN(gatt_ctxt->om);
-        rc = access_cb(conn_handle, attr_handle, gatt_ctxt, cb_arg);
+        rc = ble_gatts_call_access_cb(access_cb, conn_handle, attr_handle,
+                                      gatt_ctxt, cb_arg);
         if (rc == 0) {
             attr_len = OS_MBUF_PKTLEN(gatt_ctxt->om) - initial_len - offset;
             if (attr_len >= 0) {
@@ -406,7 +426,8 @@ ble_gatts_val_access(uint16_t conn_handle, uint16_t attr_handle,
     case BLE_GATT_ACCESS_OP_WRITE_CHR:
     case BLE_GATT_ACCESS_OP_WRITE_DSC:
         gatt_ctxt->om = *om;
-        rc = access_cb(conn_handle, attr_handle, gatt_ctxt, cb_arg);
+        rc = ble_gatts_call_access_cb(access_cb, conn_handle, attr_handle,
+                                      gatt_ctxt, cb_arg);
         *om = gatt_ctxt->om;
         return rc;
 
@@ -1623,9 +1644,6 @@ ble_gatts_chr_updated(uint16_t chr_val_handle)
 
     ble_hs_lock();
     for (i = 0; ; i++) {
-        /* XXX: This is inefficient when there are a lot of connections.
-         * Consider using a "foreach" function to walk the connection list.
-         */
         conn = ble_hs_conn_find_by_idx(i);
         if (conn == NULL) {
             break;
@@ -580,7 +580,7 @@ ble_hs_enqueue_hci_event(uint8_t *hci_evt)
 
     ev = os_memblock_get(&ble_hs_hci_ev_pool);
     if (ev == NULL) {
-        ble_transport_free(hci_evt);
+        ble_hs_hci_evt_drop(hci_evt);
     } else {
         ble_npl_event_init(ev, ble_hs_event_rx_hci_ev, hci_evt);
         ble_npl_eventq_put(ble_hs_evq, ev);
@@ -661,6 +661,8 @@ ble_hs_start(void)
 
     ble_npl_callout_init(&ble_hs_timer, ble_hs_evq, ble_hs_timer_exp, NULL);
 
+    os_mempool_stats_start(ble_hs_evq);
+
 #if NIMBLE_BLE_CONNECT
     rc = ble_gatts_start();
     if (rc != 0) {
@@ -892,6 +894,8 @@ ble_hs_deinit(void)
 
     ble_npl_callout_deinit(&ble_hs_timer);
 
+    os_mempool_stats_stop();
+
 #if (MYNEWT_VAL(BLE_HOST_BASED_PRIVACY))
     ble_hs_resolv_deinit();
 #endif
@@ -28,9 +28,27 @@
 /** At least three channels required per connection (sig, att, sm). */
 #define BLE_HS_CONN_MIN_CHANS       3
 
+/**
+ * Size of the handle lookup table.  Controllers hand out connection handles
+ * starting from either 0 or 1, so one more slot than the maximum number of
+ * connections lets consecutive handles map to distinct slots.
+ */
+#define BLE_HS_CONN_HANDLE_TBL_SIZE (MYNEWT_VAL(BLE_MAX_CONNECTIONS) + 1)
+
 static SLIST_HEAD(, ble_hs_conn) ble_hs_conns;
 static struct os_mempool ble_hs_conn_pool;
 
+/**
+ * Connections indexed by handle modulo the table size.  A slot holds the
+ * first inserted connection that maps to it; connections whose slot is
+ * already taken are still found by the scan of ble_hs_conn_arr.
+ */
+static struct ble_hs_conn *ble_hs_conn_handle_tbl[BLE_HS_CONN_HANDLE_TBL_SIZE];
+
+/** Connections in insertion order, for index based lookups. */
+static struct ble_hs_conn *ble_hs_conn_arr[MYNEWT_VAL(BLE_MAX_CONNECTIONS)];
+static int ble_hs_conn_cnt;
+
 static os_membuf_t ble_hs_conn_elem_mem[
     OS_MEMPOOL_SIZE(MYNEWT_VAL(BLE_MAX_CONNECTIONS),
                     sizeof (struct ble_hs_conn))
@@ -278,8 +296,19 @@ ble_hs_conn_insert(struct ble_hs_conn *conn)
 
     BLE_HS_DBG_ASSERT(ble_hs_locked_by_cur_task());
 
+    struct ble_hs_conn **slot;
+
     BLE_HS_DBG_ASSERT_EVAL(ble_hs_conn_find(conn->bhc_handle) == NULL);
+    BLE_HS_DBG_ASSERT(ble_hs_conn_cnt < MYNEWT_VAL(BLE_MAX_CONNECTIONS));
+
     SLIST_INSERT_HEAD(&ble_hs_conns, conn, bhc_next);
+    ble_hs_conn_arr[ble_hs_conn_cnt++] = conn;
+
+    slot = &ble_hs_conn_handle_tbl[conn->bhc_handle %
+                                   BLE_HS_CONN_HANDLE_TBL_SIZE];
+    if (*slot == NULL) {
+        *slot = conn;
+    }
 }
 
 void
@@ -289,9 +318,37 @@ ble_hs_conn_remove(struct ble_hs_conn *conn)
     return;
 #endif
 
+    struct ble_hs_conn **slot;
+    int slot_idx;
+    int i;
+
     BLE_HS_DBG_ASSERT(ble_hs_locked_by_cur_task());
 
     SLIST_REMOVE(&ble_hs_conns, conn, ble_hs_conn, bhc_next);
+
+    for (i = 0; i < ble_hs_conn_cnt; i++) {
+        if (ble_hs_conn_arr[i] == conn) {
+            ble_hs_conn_cnt--;
+            memmove(&ble_hs_conn_arr[i], &ble_hs_conn_arr[i + 1],
+                    (ble_hs_conn_cnt - i) * sizeof ble_hs_conn_arr[0]);
+            ble_hs_conn_arr[ble_hs_conn_cnt] = NULL;
+            break;
+        }
+    }
+
+    slot_idx = conn->bhc_handle % BLE_HS_CONN_HANDLE_TBL_SIZE;
+    slot = &ble_hs_conn_handle_tbl[slot_idx];
+    if (*slot == conn) {
+        /* Hand the slot to another connection that maps to it, if any. */
+        *slot = NULL;
+        for (i = 0; i < ble_hs_conn_cnt; i++) {
+            if (ble_hs_conn_arr[i]->bhc_handle % BLE_HS_CONN_HANDLE_TBL_SIZE ==
+                slot_idx) {
+                *slot = ble_hs_conn_arr[i];
+                break;
+            }
+        }
+    }
 }
 
 struct ble_hs_conn *
@@ -302,10 +359,22 @@ ble_hs_conn_find(uint16_t conn_handle)
 #endif
 
     struct ble_hs_conn *conn;
+    int i;
 
     BLE_HS_DBG_ASSERT(ble_hs_locked_by_cur_task());
 
-    SLIST_FOREACH(conn, &ble_hs_conns, bhc_next) {
+    conn = ble_hs_conn_handle_tbl[conn_handle % BLE_HS_CONN_HANDLE_TBL_SIZE];
+    if (conn == NULL) {
+        /* The slot is filled whenever a connection maps to it. */
+        return NULL;
+    }
+    if (conn->bhc_handle == conn_handle) {
+        return conn;
+    }
+
+    /* Slot collision; fall back to a scan. */
+    for (i = 0; i < ble_hs_conn_cnt; i++) {
+        conn = ble_hs_conn_arr[i];
         if (conn->bhc_handle == conn_handle) {
             return conn;
         }
@@ -334,6 +403,7 @@ ble_hs_conn_find_by_addr(const ble_addr_t *addr)
 
     struct ble_hs_conn *conn;
     struct ble_hs_conn_addrs addrs;
+    int i;
 
     BLE_HS_DBG_ASSERT(ble_hs_locked_by_cur_task());
 
@@ -341,7 +411,8 @@ ble_hs_conn_find_by_addr(const ble_addr_t *addr)
         return NULL;
     }
 
-    SLIST_FOREACH(conn, &ble_hs_conns, bhc_next) {
+    for (i = 0; i < ble_hs_conn_cnt; i++) {
+        conn = ble_hs_conn_arr[i];
         if (BLE_ADDR_IS_RPA(addr)) {
             if (ble_addr_cmp(&conn->bhc_peer_rpa_addr, addr) == 0) {
                 return conn;
@@ -371,21 +442,13 @@ ble_hs_conn_find_by_idx(int idx)
     return NULL;
 #endif
 
-    struct ble_hs_conn *conn;
-    int i;
-
     BLE_HS_DBG_ASSERT(ble_hs_locked_by_cur_task());
 
-    i = 0;
-    SLIST_FOREACH(conn, &ble_hs_conns, bhc_next) {
-        if (i == idx) {
-            return conn;
-        }
-
-        i++;
+    if (idx < 0 || idx >= ble_hs_conn_cnt) {
+        return NULL;
     }
 
-    return NULL;
+    return ble_hs_conn_arr[idx];
 }
 
 int
@@ -591,6 +654,9 @@ ble_hs_conn_init(void)
     }
 
     SLIST_INIT(&ble_hs_conns);
+    memset(ble_hs_conn_handle_tbl, 0, sizeof ble_hs_conn_handle_tbl);
+    memset(ble_hs_conn_arr, 0, sizeof ble_hs_conn_arr);
+    ble_hs_conn_cnt = 0;
 
     return 0;
 }
@@ -116,6 +116,18 @@ struct ble_hs_conn {
 
     STAILQ_HEAD(, os_mbuf_pkthdr) att_tx_q;
     bool client_att_busy;
+
+#if MYNEWT_VAL(BLE_HS_CONN_STATS)
+    struct ble_hs_conn_stats bhc_stats;
+
+    /* Send times of the outstanding client request and server indication on
+     * the ATT channel, each may be outstanding independently of the other.
+     */
+    uint32_t bhc_att_req_us;
+    uint32_t bhc_att_ind_us;
+    uint8_t bhc_att_req_pending;
+    uint8_t bhc_att_ind_pending;
+#endif
 };
 
 struct ble_hs_conn_addrs {
@@ -155,6 +167,20 @@ void ble_hs_conn_foreach(ble_hs_conn_foreach_fn *cb, void *arg);
 
 int ble_hs_conn_init(void);
 
+#if MYNEWT_VAL(BLE_HS_CONN_STATS)
+void ble_hs_conn_stats_att_rx(uint16_t conn_handle, uint16_t cid, uint8_t op,
+                              uint32_t len);
+void ble_hs_conn_stats_att_tx(struct ble_hs_conn *conn, uint16_t cid,
+                              uint8_t op, uint32_t len);
+void ble_hs_conn_stats_notify_tx(uint16_t conn_handle, int status,
+                                 int is_indication);
+#if MYNEWT_VAL(BLE_L2CAP_COC_MAX_NUM) != 0
+void ble_hs_conn_stats_coc_stalled(struct ble_l2cap_chan *chan);
+void ble_hs_conn_stats_coc_unstalled(struct ble_l2cap_chan *chan);
+#endif
+void ble_hs_conn_stats_cb(uint16_t conn_handle, uint32_t start_us);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,296 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "ble_hs_priv.h"
+
+#if MYNEWT_VAL(BLE_HS_CONN_STATS)
+
+static struct ble_hs_conn_stats *
+ble_hs_conn_stats_find(uint16_t conn_handle)
+{
+    struct ble_hs_conn *conn;
+
+    BLE_HS_DBG_ASSERT(ble_hs_locked_by_cur_task());
+
+    conn = ble_hs_conn_find(conn_handle);
+    if (conn == NULL) {
+        return NULL;
+    }
+
+    return &conn->bhc_stats;
+}
+
+static void
+ble_hs_conn_stats_rtt(struct ble_hs_conn_stats *stats, uint32_t rtt_us)
+{
+    uint32_t rtt_ms;
+    int i;
+
+    rtt_ms = rtt_us / 1000;
+    for (i = 0; i < BLE_HS_CONN_STATS_RTT_BUCKETS - 1; i++) {
+        if (rtt_ms < BLE_HS_CONN_STATS_RTT_BUCKET_MS(i)) {
+            break;
+        }
+    }
+
+    stats->att_rtt_hist[i]++;
+    if (rtt_us > stats->att_rtt_us_max) {
+        stats->att_rtt_us_max = rtt_us;
+    }
+}
+
+void
+ble_hs_conn_stats_att_rx(uint16_t conn_handle, uint16_t cid, uint8_t op,
+                         uint32_t len)
+{
+    struct ble_hs_conn *conn;
+    uint32_t elapsed_us;
+
+    ble_hs_lock();
+
+    conn = ble_hs_conn_find(conn_handle);
+    if (conn != NULL) {
+        conn->bhc_stats.att_rx_pdus++;
+        conn->bhc_stats.att_rx_bytes += len;
+
+        if (cid == BLE_L2CAP_CID_ATT && op == BLE_ATT_OP_INDICATE_RSP) {
+            if (conn->bhc_att_ind_pending) {
+                elapsed_us = ble_hs_misc_time_us() - conn->bhc_att_ind_us;
+                conn->bhc_stats.indicate_ack++;
+                conn->bhc_stats.indicate_ack_us_sum += elapsed_us;
+                if (elapsed_us > conn->bhc_stats.indicate_ack_us_max) {
+                    conn->bhc_stats.indicate_ack_us_max = elapsed_us;
+                }
+                conn->bhc_att_ind_pending = 0;
+            }
+        } else if (cid == BLE_L2CAP_CID_ATT && conn->bhc_att_req_pending &&
+                   ble_att_is_response_op(op)) {
+            elapsed_us = ble_hs_misc_time_us() - conn->bhc_att_req_us;
+            ble_hs_conn_stats_rtt(&conn->bhc_stats, elapsed_us);
+            conn->bhc_att_req_pending = 0;
+        }
+    }
+
+    ble_hs_unlock();
+}
+
+void
+ble_hs_conn_stats_att_tx(struct ble_hs_conn *conn, uint16_t cid, uint8_t op,
+                         uint32_t len)
+{
+    BLE_HS_DBG_ASSERT(ble_hs_locked_by_cur_task());
+
+    conn->bhc_stats.att_tx_pdus++;
+    conn->bhc_stats.att_tx_bytes += len;
+
+    if (cid != BLE_L2CAP_CID_ATT) {
+        return;
+    }
+
+    /* A client request and a server indication are each serialized on their
+     * own, but one of each may be outstanding at the same time. Multiple
+     * handle value notifications share the request opcode range yet are
+     * never answered.
+     */
+    if (op == BLE_ATT_OP_INDICATE_REQ) {
+        conn->bhc_att_ind_pending = 1;
+        conn->bhc_att_ind_us = ble_hs_misc_time_us();
+    } else if (op != BLE_ATT_OP_NOTIFY_MULTI_REQ && ble_att_is_request_op(op)) {
+        conn->bhc_att_req_pending = 1;
+        conn->bhc_att_req_us = ble_hs_misc_time_us();
+    }
+}
+
+void
+ble_hs_conn_stats_notify_tx(uint16_t conn_handle, int status,
+                            int is_indication)
+{
+    struct ble_hs_conn_stats *stats;
+
+    /* Confirmations are counted with their latency on reception. */
+    if (status == BLE_HS_EDONE) {
+        return;
+    }
+
+    ble_hs_lock();
+
+    stats = ble_hs_conn_stats_find(conn_handle);
+    if (stats != NULL) {
+        if (is_indication) {
+            if (status == 0) {
+                stats->indicate_tx++;
+            } else {
+                stats->indicate_fail++;
+            }
+        } else {
+            if (status == 0) {
+                stats->notify_tx++;
+            } else {
+                stats->notify_drop++;
+            }
+        }
+    }
+
+    ble_hs_unlock();
+}
+
+#if MYNEWT_VAL(BLE_L2CAP_COC_MAX_NUM) != 0
+void
+ble_hs_conn_stats_coc_stalled(struct ble_l2cap_chan *chan)
+{
+    struct ble_hs_conn_stats *stats;
+
+    if (chan->coc_tx.flags & BLE_L2CAP_COC_FLAG_STALLED) {
+        /* Still waiting since the previous stall. */
+        return;
+    }
+
+    stats = ble_hs_conn_stats_find(chan->conn_handle);
+    if (stats != NULL) {
+        stats->l2cap_stalls++;
+    }
+    chan->coc_tx.stalled_us = ble_hs_misc_time_us();
+}
+
+void
+ble_hs_conn_stats_coc_unstalled(struct ble_l2cap_chan *chan)
+{
+    struct ble_hs_conn_stats *stats;
+
+    stats = ble_hs_conn_stats_find(chan->conn_handle);
+    if (stats != NULL) {
+        stats->l2cap_stall_us += ble_hs_misc_time_us() - chan->coc_tx.stalled_us;
+    }
+}
+#endif
+
+void
+ble_hs_conn_stats_cb(uint16_t conn_handle, uint32_t start_us)
+{
+    struct ble_hs_conn_stats *stats;
+    uint32_t elapsed_us;
+
+    elapsed_us = ble_hs_misc_time_us() - start_us;
+
+    ble_hs_lock();
+
+    stats = ble_hs_conn_stats_find(conn_handle);
+    if (stats != NULL) {
+        stats->cb_calls++;
+        stats->cb_us += elapsed_us;
+        if (elapsed_us > stats->cb_us_max) {
+            stats->cb_us_max = elapsed_us;
+        }
+    }
+
+    ble_hs_unlock();
+}
+
+void
+ble_hs_conn_stats_notify_retry(uint16_t conn_handle)
+{
+    struct ble_hs_conn_stats *stats;
+
+    ble_hs_lock();
+
+    stats = ble_hs_conn_stats_find(conn_handle);
+    if (stats != NULL) {
+        stats->notify_retry++;
+    }
+
+    ble_hs_unlock();
+}
+
+void
+ble_hs_conn_stats_notify_drop(uint16_t conn_handle)
+{
+    struct ble_hs_conn_stats *stats;
+
+    ble_hs_lock();
+
+    stats = ble_hs_conn_stats_find(conn_handle);
+    if (stats != NULL) {
+        stats->notify_drop++;
+    }
+
+    ble_hs_unlock();
+}
+
+int
+ble_hs_conn_stats_get(uint16_t conn_handle,
+                      struct ble_hs_conn_stats *out_stats)
+{
+    struct ble_hs_conn_stats *stats;
+
+    ble_hs_lock();
+
+    stats = ble_hs_conn_stats_find(conn_handle);
+    if (stats != NULL) {
+        *out_stats = *stats;
+    }
+
+    ble_hs_unlock();
+
+    return stats != NULL ? 0 : BLE_HS_ENOTCONN;
+}
+
+int
+ble_hs_conn_stats_reset(uint16_t conn_handle)
+{
+    struct ble_hs_conn_stats *stats;
+
+    ble_hs_lock();
+
+    stats = ble_hs_conn_stats_find(conn_handle);
+    if (stats != NULL) {
+        memset(stats, 0, sizeof *stats);
+    }
+
+    ble_hs_unlock();
+
+    return stats != NULL ? 0 : BLE_HS_ENOTCONN;
+}
+
+#else /* MYNEWT_VAL(BLE_HS_CONN_STATS) */
+
+void
+ble_hs_conn_stats_notify_retry(uint16_t conn_handle)
+{
+}
+
+void
+ble_hs_conn_stats_notify_drop(uint16_t conn_handle)
+{
+}
+
+int
+ble_hs_conn_stats_get(uint16_t conn_handle,
+                      struct ble_hs_conn_stats *out_stats)
+{
+    return BLE_HS_ENOTSUP;
+}
+
+int
+ble_hs_conn_stats_reset(uint16_t conn_handle)
+{
+    return BLE_HS_ENOTSUP;
+}
+
+#endif /* MYNEWT_VAL(BLE_HS_CONN_STATS) */
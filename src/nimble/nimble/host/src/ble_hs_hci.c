@@ -40,6 +40,33 @@ static uint8_t ble_hs_hci_version;
 
 static struct ble_hs_hci_sup_cmd ble_hs_hci_sup_cmd;
 
+/* HCI events dropped before reaching the host.  Only written from the
+ * transport's event context, apart from resets by the application.
+ */
+static struct ble_hs_evt_drop_stats ble_hs_hci_drop_stats;
+static uint32_t ble_hs_hci_transport_discarded_base;
+
+#if MYNEWT_VAL(BLE_HS_ADV_RPT_RATE_LIMIT) > 0
+/* Extended report chain of a source, the rate limit is decided on the first
+ * fragment and applied to the whole chain.
+ */
+#define BLE_HS_HCI_ADV_CHAIN_NONE       0
+#define BLE_HS_HCI_ADV_CHAIN_PASSED     1
+#define BLE_HS_HCI_ADV_CHAIN_DROPPED    2
+
+/* Advertising report counts of recently seen sources */
+struct ble_hs_hci_adv_src {
+    uint8_t addr_type;
+    uint8_t addr[6];
+    uint8_t chain;
+    uint16_t count;
+    ble_npl_time_t window_start;
+};
+
+static struct ble_hs_hci_adv_src
+    ble_hs_hci_adv_srcs[MYNEWT_VAL(BLE_HS_ADV_RPT_RATE_SOURCES)];
+#endif
+
 #ifdef ESP_PLATFORM
 #if CONFIG_BT_NIMBLE_LEGACY_VHCI_ENABLE
 #define BLE_HS_HCI_FRAG_DATABUF_SIZE    \
@@ -404,16 +431,240 @@ ble_hs_hci_rx_ack(uint8_t *ack_ev)
     ble_npl_sem_release(&ble_hs_hci_sem);
 }
 
+/**
+ * Tests if an HCI event is an advertising report that may be dropped.
+ *
+ * @param ev                    The HCI event.
+ * @param out_addr_type         On success, the address type of the first
+ *                                  report in the event.
+ * @param out_addr              On success, the address of the first report
+ *                                  in the event.
+ *
+ * @return                      1 if the event is a discardable advertising
+ *                                  report; 0 otherwise.
+ */
+static int
+ble_hs_hci_evt_is_adv_rpt(const struct ble_hci_ev *ev, uint8_t *out_addr_type,
+                          const uint8_t **out_addr)
+{
+    const struct ble_hci_ev_le_subev_ext_adv_rpt *ext_rpt;
+    const struct ble_hci_ev_le_subev_adv_rpt *rpt;
+    const struct ble_hci_ev_le_meta *meta;
+
+    if (ev->opcode != BLE_HCI_EVCODE_LE_META || ev->length < 1) {
+        return 0;
+    }
+
+    meta = (const void *)ev->data;
+
+    switch (meta->subevent) {
+    case BLE_HCI_LE_SUBEV_ADV_RPT:
+        rpt = (const void *)ev->data;
+        if (ev->length < sizeof(*rpt) + sizeof(rpt->reports[0]) ||
+            rpt->num_reports == 0) {
+            return 0;
+        }
+
+        *out_addr_type = rpt->reports[0].addr_type;
+        *out_addr = rpt->reports[0].addr;
+        return 1;
+
+    case BLE_HCI_LE_SUBEV_EXT_ADV_RPT:
+        ext_rpt = (const void *)ev->data;
+        if (ev->length < sizeof(*ext_rpt) + sizeof(ext_rpt->reports[0]) ||
+            ext_rpt->num_reports == 0) {
+            return 0;
+        }
+
+        *out_addr_type = ext_rpt->reports[0].addr_type;
+        *out_addr = ext_rpt->reports[0].addr;
+        return 1;
+
+    default:
+        return 0;
+    }
+}
+
+#if MYNEWT_VAL(BLE_HS_ADV_RPT_RATE_LIMIT) > 0
+/**
+ * Tests if an advertising report event is exempt from rate limiting.  Scan
+ * responses are exempt so that scannable advertisers are still reported
+ * complete.  Events carrying more than one report are exempt as well, since
+ * the reports may come from different sources.
+ *
+ * @param ev                    The advertising report event.
+ * @param out_more              On return, 1 if the event is an extended
+ *                                  report fragment with more data to follow;
+ *                                  0 otherwise.
+ *
+ * @return                      1 if the event is exempt; 0 otherwise.
+ */
+static int
+ble_hs_hci_adv_rpt_exempt(const struct ble_hci_ev *ev, int *out_more)
+{
+    const struct ble_hci_ev_le_subev_ext_adv_rpt *ext_rpt;
+    const struct ble_hci_ev_le_subev_adv_rpt *rpt;
+    uint16_t evt_type;
+
+    *out_more = 0;
+
+    rpt = (const void *)ev->data;
+    if (rpt->subev_code == BLE_HCI_LE_SUBEV_ADV_RPT) {
+        return rpt->num_reports > 1 ||
+               rpt->reports[0].type == BLE_HCI_ADV_RPT_EVTYPE_SCAN_RSP;
+    }
+
+    ext_rpt = (const void *)ev->data;
+    if (ext_rpt->num_reports > 1) {
+        return 1;
+    }
+
+    evt_type = get_le16(&ext_rpt->reports[0].evt_type);
+    *out_more = (evt_type & BLE_HCI_ADV_DATA_STATUS_MASK) ==
+                BLE_HCI_ADV_DATA_STATUS_INCOMPLETE;
+
+    return (evt_type & BLE_HCI_ADV_SCAN_RSP_MASK) != 0;
+}
+
+/**
+ * Counts an advertising report against its source and tests if the source
+ * has exceeded BLE_HS_ADV_RPT_RATE_LIMIT reports in the current window.
+ * Sources are tracked in a small table; when it is full the source whose
+ * window started first is replaced.
+ *
+ * A chained extended report is counted once, on its first fragment, and the
+ * continuation fragments follow that decision so that a chain is either
+ * reported whole or not at all.
+ *
+ * @param addr_type             The address type of the source.
+ * @param addr                  The address of the source.
+ * @param more                  1 if the report is an extended report
+ *                                  fragment with more data to follow.
+ *
+ * @return                      1 if the report should be dropped; 0 otherwise.
+ */
+static int
+ble_hs_hci_adv_rpt_rate_limited(uint8_t addr_type, const uint8_t *addr,
+                                int more)
+{
+    struct ble_hs_hci_adv_src *oldest;
+    struct ble_hs_hci_adv_src *src;
+    ble_npl_time_t window;
+    ble_npl_time_t now;
+    int drop;
+    int i;
+
+    now = ble_npl_time_get();
+    window = ble_npl_time_ms_to_ticks32(MYNEWT_VAL(BLE_HS_ADV_RPT_RATE_WINDOW_MS));
+
+    oldest = &ble_hs_hci_adv_srcs[0];
+    for (i = 0; i < MYNEWT_VAL(BLE_HS_ADV_RPT_RATE_SOURCES); i++) {
+        src = &ble_hs_hci_adv_srcs[i];
+
+        if (src->count > 0 && src->addr_type == addr_type &&
+            memcmp(src->addr, addr, sizeof(src->addr)) == 0) {
+            if (src->chain != BLE_HS_HCI_ADV_CHAIN_NONE) {
+                drop = (src->chain == BLE_HS_HCI_ADV_CHAIN_DROPPED);
+                if (!more) {
+                    src->chain = BLE_HS_HCI_ADV_CHAIN_NONE;
+                }
+                return drop;
+            }
+
+            if ((ble_npl_stime_t)(now - src->window_start) >=
+                (ble_npl_stime_t)window) {
+                src->window_start = now;
+                src->count = 0;
+            }
+
+            drop = (src->count >= MYNEWT_VAL(BLE_HS_ADV_RPT_RATE_LIMIT));
+            if (!drop) {
+                src->count++;
+            }
+
+            if (more) {
+                src->chain = drop ? BLE_HS_HCI_ADV_CHAIN_DROPPED :
+                                    BLE_HS_HCI_ADV_CHAIN_PASSED;
+            }
+            return drop;
+        }
+
+        if (oldest->count != 0 &&
+            (src->count == 0 ||
+             (ble_npl_stime_t)(src->window_start - oldest->window_start) < 0)) {
+            oldest = src;
+        }
+    }
+
+    oldest->addr_type = addr_type;
+    memcpy(oldest->addr, addr, sizeof(oldest->addr));
+    oldest->window_start = now;
+    oldest->count = 1;
+    oldest->chain = more ? BLE_HS_HCI_ADV_CHAIN_PASSED :
+                           BLE_HS_HCI_ADV_CHAIN_NONE;
+
+    return 0;
+}
+#endif
+
+void
+ble_hs_hci_evt_drop(uint8_t *hci_ev)
+{
+    const uint8_t *addr;
+    uint8_t addr_type;
+
+    if (ble_hs_hci_evt_is_adv_rpt((void *)hci_ev, &addr_type, &addr)) {
+        ble_hs_hci_drop_stats.adv_no_buf++;
+    } else {
+        ble_hs_hci_drop_stats.other_no_buf++;
+    }
+
+    ble_transport_free(hci_ev);
+}
+
+void
+ble_hs_evt_drop_stats_get(struct ble_hs_evt_drop_stats *stats)
+{
+    *stats = ble_hs_hci_drop_stats;
+    stats->adv_no_buf += ble_transport_evt_discarded() -
+                         ble_hs_hci_transport_discarded_base;
+}
+
+void
+ble_hs_evt_drop_stats_reset(void)
+{
+    memset(&ble_hs_hci_drop_stats, 0, sizeof(ble_hs_hci_drop_stats));
+    ble_hs_hci_transport_discarded_base = ble_transport_evt_discarded();
+}
+
 int
 ble_hs_hci_rx_evt(uint8_t *hci_ev, void *arg)
 {
     struct ble_hci_ev *ev = (void *) hci_ev;
     struct ble_hci_ev_command_complete *cmd_complete = (void *) ev->data;
     struct ble_hci_ev_command_status *cmd_status = (void *) ev->data;
+#if MYNEWT_VAL(BLE_HS_ADV_RPT_RATE_LIMIT) > 0
+    const uint8_t *addr;
+    uint8_t addr_type;
+    int more;
+#endif
     int enqueue;
 
     BLE_HS_DBG_ASSERT(hci_ev != NULL);
 
+#if MYNEWT_VAL(BLE_HS_ADV_RPT_RATE_LIMIT) > 0
+    /* Drop reports from sources that flood the air before they take up a
+     * place in the host event queue.
+     */
+    if (ble_hs_hci_evt_is_adv_rpt(ev, &addr_type, &addr) &&
+        !ble_hs_hci_adv_rpt_exempt(ev, &more) &&
+        ble_hs_hci_adv_rpt_rate_limited(addr_type, addr, more)) {
+        ble_hs_hci_drop_stats.adv_rate_limited++;
+        ble_transport_free(hci_ev);
+        return 0;
+    }
+#endif
+
     switch (ev->opcode) {
     case BLE_HCI_EVCODE_COMMAND_COMPLETE:
         enqueue = (cmd_complete->opcode == BLE_HCI_OPCODE_NOP);
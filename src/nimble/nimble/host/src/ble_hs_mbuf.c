@@ -36,6 +36,8 @@ ble_hs_mbuf_gen_pkt(uint16_t leading_space)
     om = os_msys_get_pkthdr(0, 0);
 #endif
     if (om == NULL) {
+        BLE_HS_TRACE_REC(BLE_HS_TRACE_ID_MBUF_ALLOC_FAIL,
+                         BLE_HS_CONN_HANDLE_NONE, leading_space, 0);
         return NULL;
     }
 
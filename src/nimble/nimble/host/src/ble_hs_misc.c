@@ -22,6 +22,12 @@
 #include "nimble/porting/nimble/include/os/os.h"
 #include "ble_hs_priv.h"
 
+#ifdef ESP_PLATFORM
+#include "esp_timer.h"
+#elif MYNEWT_VAL(BLE_CONTROLLER)
+#include "nimble/porting/nimble/include/os/os_cputime.h"
+#endif
+
 int
 ble_hs_misc_conn_chan_find(uint16_t conn_handle, uint16_t cid,
                            struct ble_hs_conn **out_conn,
@@ -145,3 +151,19 @@ ble_hs_misc_restore_irks(void)
                            NULL);
     return rc;
 }
+
+/**
+ * Returns a free running microsecond timestamp, wrapping after ~71 minutes.
+ * The resolution is one OS tick on targets without a microsecond timer.
+ */
+uint32_t
+ble_hs_misc_time_us(void)
+{
+#ifdef ESP_PLATFORM
+    return (uint32_t)esp_timer_get_time();
+#elif MYNEWT_VAL(BLE_CONTROLLER)
+    return os_cputime_ticks_to_usecs(os_cputime_get32());
+#else
+    return ble_npl_time_ticks_to_ms32(ble_npl_time_get()) * 1000;
+#endif
+}
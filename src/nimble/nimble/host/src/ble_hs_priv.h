@@ -70,6 +70,13 @@ struct os_event;
 #define BLE_HS_MAX_CONNECTIONS 0
 #endif
 
+#if MYNEWT_VAL(BLE_HS_TRACE)
+#define BLE_HS_TRACE_REC(id, conn_handle, arg0, arg1) \
+    ble_hs_trace((id), (conn_handle), (arg0), (arg1))
+#else
+#define BLE_HS_TRACE_REC(id, conn_handle, arg0, arg1)
+#endif
+
 #if !MYNEWT_VAL(BLE_ATT_SVR_QUEUED_WRITE)
 #define BLE_HS_ATT_SVR_QUEUED_WRITE_TMO 0
 #else
@@ -107,6 +114,7 @@ void ble_hs_enqueue_hci_event(uint8_t *hci_evt);
 void ble_hs_event_enqueue(struct os_event *ev);
 
 int ble_hs_hci_rx_evt(uint8_t *hci_ev, void *arg);
+void ble_hs_hci_evt_drop(uint8_t *hci_ev);
 int ble_hs_hci_evt_acl_process(struct os_mbuf *om);
 
 int ble_hs_misc_conn_chan_find(uint16_t conn_handle, uint16_t cid,
@@ -118,6 +126,7 @@ int ble_hs_misc_conn_chan_find_reqd(uint16_t conn_handle, uint16_t cid,
 uint8_t ble_hs_misc_own_addr_type_to_id(uint8_t addr_type);
 uint8_t ble_hs_misc_peer_addr_type_to_id(uint8_t addr_type);
 int ble_hs_misc_restore_irks(void);
+uint32_t ble_hs_misc_time_us(void);
 
 int ble_hs_locked_by_cur_task(void);
 int ble_hs_is_parent_task(void);
@@ -53,6 +53,150 @@ static int ble_store_num_peer_dev_rec;
 /* NRPA bit: Enables NRPA as private address. */
 static bool nrpa_pvcy;
 
+/*** Cache of recently resolved RPAs.
+ *
+ * Resolving a peer RPA costs one AES operation per known IRK. Recently seen
+ * RPAs are remembered along with the IRK that resolved them, or as
+ * unresolvable by the resolving list and/or the peer records, until the RPA
+ * timeout expires. The cache is flushed whenever the set of IRKs changes. ***/
+
+#define BLE_HS_RESOLV_CACHE_RESOLVED        0x01
+#define BLE_HS_RESOLV_CACHE_NOT_IN_RL       0x02
+#define BLE_HS_RESOLV_CACHE_NOT_IN_PEER_REC 0x04
+
+#if MYNEWT_VAL(BLE_HOST_RPA_CACHE_SIZE)
+struct ble_hs_resolv_cache_entry {
+    uint8_t rpa[BLE_DEV_ADDR_LEN];
+    uint8_t irk[16];
+    uint8_t flags;
+    ble_npl_time_t expiry;
+};
+
+static struct ble_hs_resolv_cache_entry
+    g_ble_hs_resolv_cache[MYNEWT_VAL(BLE_HOST_RPA_CACHE_SIZE)];
+
+static bool
+ble_hs_resolv_cache_expired(const struct ble_hs_resolv_cache_entry *entry,
+                            ble_npl_time_t now)
+{
+    return entry->flags == 0 || (int32_t)(now - entry->expiry) >= 0;
+}
+
+static struct ble_hs_resolv_cache_entry *
+ble_hs_resolv_cache_find(const uint8_t *rpa)
+{
+    struct ble_hs_resolv_cache_entry *entry;
+    ble_npl_time_t now = ble_npl_time_get();
+    int i;
+
+    for (i = 0; i < MYNEWT_VAL(BLE_HOST_RPA_CACHE_SIZE); i++) {
+        entry = &g_ble_hs_resolv_cache[i];
+        if (!ble_hs_resolv_cache_expired(entry, now) &&
+            memcmp(entry->rpa, rpa, BLE_DEV_ADDR_LEN) == 0) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+/* Marks rpa with flags, irk is the resolving IRK if flags is RESOLVED. */
+static void
+ble_hs_resolv_cache_add(const uint8_t *rpa, uint8_t flags, const uint8_t *irk)
+{
+    struct ble_hs_resolv_cache_entry *entry;
+    ble_npl_time_t now;
+    int i;
+
+    entry = ble_hs_resolv_cache_find(rpa);
+    if (entry == NULL) {
+        /* Take a free slot or the one closest to expiry */
+        now = ble_npl_time_get();
+        entry = &g_ble_hs_resolv_cache[0];
+        for (i = 0; i < MYNEWT_VAL(BLE_HOST_RPA_CACHE_SIZE); i++) {
+            if (ble_hs_resolv_cache_expired(&g_ble_hs_resolv_cache[i], now)) {
+                entry = &g_ble_hs_resolv_cache[i];
+                break;
+            }
+
+            if ((int32_t)(g_ble_hs_resolv_cache[i].expiry - entry->expiry) < 0) {
+                entry = &g_ble_hs_resolv_cache[i];
+            }
+        }
+
+        memset(entry, 0, sizeof *entry);
+        memcpy(entry->rpa, rpa, BLE_DEV_ADDR_LEN);
+        entry->expiry = now + g_ble_hs_resolv_data.rpa_tmo;
+    }
+
+    if (flags & BLE_HS_RESOLV_CACHE_RESOLVED) {
+        memcpy(entry->irk, irk, 16);
+    }
+    entry->flags |= flags;
+}
+#endif
+
+/**
+ * Forgets all cached RPA resolutions, called when an IRK is added or removed.
+ */
+void
+ble_hs_resolv_cache_flush(void)
+{
+#if MYNEWT_VAL(BLE_HOST_RPA_CACHE_SIZE)
+    memset(g_ble_hs_resolv_cache, 0, sizeof g_ble_hs_resolv_cache);
+#endif
+}
+
+/* Returns true if rpa is known not to resolve with any IRK of the given list */
+static bool
+ble_hs_resolv_cache_unresolvable(const uint8_t *rpa, uint8_t not_in)
+{
+#if MYNEWT_VAL(BLE_HOST_RPA_CACHE_SIZE)
+    struct ble_hs_resolv_cache_entry *entry;
+
+    entry = ble_hs_resolv_cache_find(rpa);
+    return entry != NULL && (entry->flags & not_in);
+#else
+    return false;
+#endif
+}
+
+static void
+ble_hs_resolv_cache_set_unresolvable(const uint8_t *rpa, uint8_t not_in)
+{
+#if MYNEWT_VAL(BLE_HOST_RPA_CACHE_SIZE)
+    ble_hs_resolv_cache_add(rpa, not_in, NULL);
+#endif
+}
+
+/* Resolves rpa with irk, answering from the cache when the RPA was already
+ * resolved by an IRK.
+ */
+static int
+ble_hs_resolv_rpa_cached(uint8_t *rpa, uint8_t *irk)
+{
+    int rc;
+
+#if MYNEWT_VAL(BLE_HOST_RPA_CACHE_SIZE)
+    struct ble_hs_resolv_cache_entry *entry;
+
+    entry = ble_hs_resolv_cache_find(rpa);
+    if (entry != NULL && (entry->flags & BLE_HS_RESOLV_CACHE_RESOLVED)) {
+        return memcmp(entry->irk, irk, 16) == 0 ? 0 : BLE_HS_ENOENT;
+    }
+#endif
+
+    rc = ble_hs_resolv_rpa(rpa, irk);
+
+#if MYNEWT_VAL(BLE_HOST_RPA_CACHE_SIZE)
+    if (rc == 0) {
+        ble_hs_resolv_cache_add(rpa, BLE_HS_RESOLV_CACHE_RESOLVED, irk);
+    }
+#endif
+
+    return rc;
+}
+
 /*** APIs for Peer Device Records.
  *
  * These Peer records are necessary to take care of Peers with RPA address when
@@ -74,6 +218,7 @@ void
 ble_rpa_set_num_peer_dev_records(int num_rec)
 {
     ble_store_num_peer_dev_rec = num_rec;
+    ble_hs_resolv_cache_flush();
 }
 
 int
@@ -94,6 +239,7 @@ ble_rpa_remove_peer_dev_rec(struct ble_hs_dev_records *p_dev_rec)
     }
 
     ble_store_num_peer_dev_rec--;
+    ble_hs_resolv_cache_flush();
     if ((i != ble_store_num_peer_dev_rec) && (ble_store_num_peer_dev_rec != 0)) {
         memmove(&peer_dev_rec[i], &peer_dev_rec[i + 1],
                 (ble_store_num_peer_dev_rec - i) * sizeof(struct ble_hs_dev_records ));
@@ -174,7 +320,7 @@ static bool
 is_rpa_resolvable_by_peer_rec(struct ble_hs_dev_records *p_dev_rec, uint8_t *peer_add)
 {
     if (p_dev_rec->peer_sec.irk_present) {
-        if (ble_hs_resolv_rpa(peer_add, p_dev_rec->peer_sec.irk) == 0) {
+        if (ble_hs_resolv_rpa_cached(peer_add, p_dev_rec->peer_sec.irk) == 0) {
             return true;
         }
     }
@@ -246,9 +392,14 @@ ble_rpa_find_rl_from_peer_records(uint8_t *peer_addr, uint8_t *peer_addr_type)
 {
     struct ble_hs_dev_records *p_dev_rec = NULL;
     struct ble_hs_resolv_entry *rl = NULL;
+    bool unresolvable;
+    bool resolved = false;
     int i;
     int rc = 0;
 
+    unresolvable = ble_hs_resolv_cache_unresolvable(peer_addr,
+                                                    BLE_HS_RESOLV_CACHE_NOT_IN_PEER_REC);
+
     for (i = (ble_store_num_peer_dev_rec - 1); i >= 0; i--) {
         p_dev_rec = &peer_dev_rec[i];
         /* If the record is not used, skip */
@@ -256,7 +407,8 @@ ble_rpa_find_rl_from_peer_records(uint8_t *peer_addr, uint8_t *peer_addr_type)
             continue;
         }
 
-        if (is_rpa_resolvable_by_peer_rec(p_dev_rec, peer_addr)) {
+        if (!unresolvable && is_rpa_resolvable_by_peer_rec(p_dev_rec, peer_addr)) {
+            resolved = true;
             memcpy(p_dev_rec->rand_addr, peer_addr, BLE_DEV_ADDR_LEN);
             p_dev_rec->rand_addr_type = *peer_addr_type;
             rl = ble_hs_resolv_list_find(p_dev_rec->identity_addr);
@@ -297,6 +449,11 @@ ble_rpa_find_rl_from_peer_records(uint8_t *peer_addr, uint8_t *peer_addr_type)
         }
     }
 
+    if (!resolved) {
+        ble_hs_resolv_cache_set_unresolvable(peer_addr,
+                                             BLE_HS_RESOLV_CACHE_NOT_IN_PEER_REC);
+    }
+
     return rl;
 }
 
@@ -590,6 +747,7 @@ ble_hs_resolv_list_add(uint8_t *cmdbuf)
     ble_hs_resolv_gen_priv_addr(rl, 1);
     ble_hs_resolv_gen_priv_addr(rl, 0);
     ++(g_ble_hs_resolv_data.rl_cnt);
+    ble_hs_resolv_cache_flush();
     BLE_HS_LOG(DEBUG, "Device added to RL, Resolving list count = %d\n", g_ble_hs_resolv_data.rl_cnt);
 
     return 0;
@@ -617,6 +775,7 @@ ble_hs_resolv_list_rmv(uint8_t addr_type, uint8_t *ident_addr)
                 (g_ble_hs_resolv_data.rl_cnt - position) * sizeof (struct
                         ble_hs_resolv_entry));
         --g_ble_hs_resolv_data.rl_cnt;
+        ble_hs_resolv_cache_flush();
 
         rc = 0;
     }
@@ -639,6 +798,7 @@ ble_hs_resolv_list_clear_all(void)
     g_ble_hs_resolv_data.rl_cnt = 0;
     memset(g_ble_hs_resolv_list, 0, BLE_RESOLV_LIST_SIZE * sizeof(struct
            ble_hs_resolv_entry));
+    ble_hs_resolv_cache_flush();
 
     /* Now delete peer device records as well */
     ble_rpa_peer_dev_rec_clear_all();
@@ -728,8 +888,12 @@ ble_hs_resolv_rpa_addr(uint8_t *addr, uint8_t addr_type) {
     int i;
     struct ble_hs_resolv_entry *rl = &g_ble_hs_resolv_list[1];
 
+    if (ble_hs_resolv_cache_unresolvable(addr, BLE_HS_RESOLV_CACHE_NOT_IN_RL)) {
+        return NULL;
+    }
+
     for (i = 1; i < g_ble_hs_resolv_data.rl_cnt; ++i) {
-        if(ble_hs_resolv_rpa(addr, rl->rl_peer_irk) == 0) {
+        if(ble_hs_resolv_rpa_cached(addr, rl->rl_peer_irk) == 0) {
             memcpy(g_ble_hs_resolv_list[i].rl_peer_rpa, addr, BLE_DEV_ADDR_LEN);
             g_ble_hs_resolv_list[i].rl_addr_type = addr_type;
             return rl;
@@ -737,6 +901,8 @@ ble_hs_resolv_rpa_addr(uint8_t *addr, uint8_t addr_type) {
 
         ++rl;
     }
+
+    ble_hs_resolv_cache_set_unresolvable(addr, BLE_HS_RESOLV_CACHE_NOT_IN_RL);
 #endif
     return NULL;
 }
@@ -788,6 +954,7 @@ ble_hs_resolv_rpa(uint8_t *rpa, uint8_t *irk)
 void ble_hs_resolv_init(void)
 {
     g_ble_hs_resolv_data.rpa_tmo = ble_npl_time_ms_to_ticks32(MYNEWT_VAL(BLE_RPA_TIMEOUT) * 1000);
+    ble_hs_resolv_cache_flush();
 
     ble_npl_callout_init(&g_ble_hs_resolv_data.rpa_timer,
                          ble_hs_evq_get(),
@@ -106,6 +106,9 @@ int ble_hs_resolv_set_rpa_tmo(uint16_t);
 /* Resolve a resolvable private address */
 int ble_hs_resolv_rpa(uint8_t *rpa, uint8_t *irk);
 
+/* Forget cached RPA resolutions, must be called when an IRK is added or removed */
+void ble_hs_resolv_cache_flush(void);
+
 /* Initialize resolv*/
 void ble_hs_resolv_init(void);
 
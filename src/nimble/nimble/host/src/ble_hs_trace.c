@@ -0,0 +1,152 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "ble_hs_priv.h"
+
+#if MYNEWT_VAL(BLE_HS_TRACE)
+
+#define BLE_HS_TRACE_SIZE   MYNEWT_VAL(BLE_HS_TRACE_SIZE)
+
+#if (BLE_HS_TRACE_SIZE == 0) || (BLE_HS_TRACE_SIZE > 0xffff)
+#error "BLE_HS_TRACE_SIZE must be between 1 and 65535"
+#endif
+
+static struct ble_hs_trace_rec ble_hs_trace_ring[BLE_HS_TRACE_SIZE];
+
+/* Total number of records written since the last clear. */
+static uint32_t ble_hs_trace_cnt;
+static uint8_t ble_hs_trace_enabled = 1;
+static uint8_t ble_hs_trace_dumping;
+
+void
+ble_hs_trace(uint8_t id, uint16_t conn_handle, uint32_t arg0, uint32_t arg1)
+{
+    struct ble_hs_trace_rec *rec;
+    uint32_t time_us;
+    os_sr_t sr;
+
+    if (!ble_hs_trace_enabled) {
+        return;
+    }
+
+    time_us = ble_hs_misc_time_us();
+
+    OS_ENTER_CRITICAL(sr);
+    if (ble_hs_trace_dumping) {
+        OS_EXIT_CRITICAL(sr);
+        return;
+    }
+
+    rec = &ble_hs_trace_ring[ble_hs_trace_cnt % BLE_HS_TRACE_SIZE];
+    ble_hs_trace_cnt++;
+
+    rec->time_us = time_us;
+    rec->conn_handle = conn_handle;
+    rec->id = id;
+    rec->reserved = 0;
+    rec->arg0 = arg0;
+    rec->arg1 = arg1;
+    OS_EXIT_CRITICAL(sr);
+}
+
+void
+ble_hs_trace_set_enabled(int enabled)
+{
+    ble_hs_trace_enabled = !!enabled;
+}
+
+void
+ble_hs_trace_clear(void)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    ble_hs_trace_cnt = 0;
+    OS_EXIT_CRITICAL(sr);
+}
+
+int
+ble_hs_trace_dump(ble_hs_trace_write_fn *fn, void *arg)
+{
+    struct ble_hs_trace_hdr hdr;
+    uint32_t first;
+    uint32_t cnt;
+    uint32_t i;
+    os_sr_t sr;
+    int rc;
+
+    /* Stop writers before reading the ring; the flag is checked inside the
+     * writers' critical section so no record is half written once it is set.
+     */
+    OS_ENTER_CRITICAL(sr);
+    ble_hs_trace_dumping = 1;
+    cnt = ble_hs_trace_cnt;
+    OS_EXIT_CRITICAL(sr);
+
+    if (cnt > BLE_HS_TRACE_SIZE) {
+        first = cnt - BLE_HS_TRACE_SIZE;
+    } else {
+        first = 0;
+    }
+
+    hdr.magic = htole32(BLE_HS_TRACE_MAGIC);
+    hdr.version = BLE_HS_TRACE_VERSION;
+    hdr.rec_size = sizeof(struct ble_hs_trace_rec);
+    hdr.rec_count = htole16(cnt - first);
+    hdr.lost = htole32(first);
+
+    rc = fn(&hdr, sizeof(hdr), arg);
+
+    /* Records are stored in host byte order; all supported targets are
+     * little endian.
+     */
+    for (i = first; rc == 0 && i < cnt; i++) {
+        rc = fn(&ble_hs_trace_ring[i % BLE_HS_TRACE_SIZE],
+                sizeof(struct ble_hs_trace_rec), arg);
+    }
+
+    ble_hs_trace_dumping = 0;
+
+    return rc;
+}
+
+#else /* MYNEWT_VAL(BLE_HS_TRACE) */
+
+void
+ble_hs_trace(uint8_t id, uint16_t conn_handle, uint32_t arg0, uint32_t arg1)
+{
+}
+
+void
+ble_hs_trace_set_enabled(int enabled)
+{
+}
+
+void
+ble_hs_trace_clear(void)
+{
+}
+
+int
+ble_hs_trace_dump(ble_hs_trace_write_fn *fn, void *arg)
+{
+    return BLE_HS_ENOTSUP;
+}
+
+#endif /* MYNEWT_VAL(BLE_HS_TRACE) */
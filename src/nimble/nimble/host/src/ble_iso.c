@@ -334,6 +334,22 @@ ble_iso_terminate_big(uint8_t big_handle)
     return rc;
 }
 
+int
+ble_iso_big_cb_set(uint8_t big_handle, ble_iso_event_fn *cb, void *cb_arg)
+{
+    struct ble_iso_big *big;
+
+    big = ble_iso_big_find_by_handle(big_handle);
+    if (big == NULL) {
+        return BLE_HS_ENOENT;
+    }
+
+    big->cb = cb;
+    big->cb_arg = cb_arg;
+
+    return 0;
+}
+
 void
 ble_iso_rx_create_big_complete(const struct ble_hci_ev_le_subev_create_big_complete *ev)
 {
@@ -60,6 +60,7 @@ ble_l2cap_chan_alloc(uint16_t conn_handle)
 
     chan = os_memblock_get(&ble_l2cap_chan_pool);
     if (chan == NULL) {
+        os_mempool_stats_alloc_fail(&ble_l2cap_chan_pool);
         return NULL;
     }
 
@@ -497,6 +498,8 @@ ble_l2cap_init(void)
         return BLE_HS_EOS;
     }
 
+    os_mempool_stats_register(&ble_l2cap_chan_pool, "l2cap_chan");
+
     rc = ble_l2cap_sig_init();
     if (rc != 0) {
         return rc;
@@ -60,6 +60,8 @@ ble_l2cap_coc_srv_alloc(void)
     srv = os_memblock_get(&ble_l2cap_coc_srv_pool);
     if (srv != NULL) {
         memset(srv, 0, sizeof(*srv));
+    } else {
+        os_mempool_stats_alloc_fail(&ble_l2cap_coc_srv_pool);
     }
 
     return srv;
@@ -547,13 +549,22 @@ ble_l2cap_coc_continue_tx(struct ble_l2cap_chan *chan)
 
     if (tx->sdus[0]) {
         /* Not complete SDU sent, wait for credits */
+#if MYNEWT_VAL(BLE_HS_CONN_STATS)
+        ble_hs_conn_stats_coc_stalled(chan);
+#endif
         tx->flags |= BLE_L2CAP_COC_FLAG_STALLED;
+        BLE_HS_TRACE_REC(BLE_HS_TRACE_ID_L2CAP_STALLED, chan->conn_handle,
+                         chan->dcid,
+                         OS_MBUF_PKTLEN(tx->sdus[0]) - tx->data_offset);
         ble_hs_unlock();
         return BLE_HS_ESTALLED;
     }
 
     if (tx->flags & BLE_L2CAP_COC_FLAG_STALLED) {
         tx->flags &= ~BLE_L2CAP_COC_FLAG_STALLED;
+#if MYNEWT_VAL(BLE_HS_CONN_STATS)
+        ble_hs_conn_stats_coc_unstalled(chan);
+#endif
         ble_hs_unlock();
         ble_l2cap_event_coc_unstalled(chan, 0);
     } else {
@@ -569,6 +580,9 @@ failed:
     os_mbuf_free_chain(txom);
     if (tx->flags & BLE_L2CAP_COC_FLAG_STALLED) {
         tx->flags &= ~BLE_L2CAP_COC_FLAG_STALLED;
+#if MYNEWT_VAL(BLE_HS_CONN_STATS)
+        ble_hs_conn_stats_coc_unstalled(chan);
+#endif
         ble_hs_unlock();
         ble_l2cap_event_coc_unstalled(chan, rc);
     } else {
@@ -607,6 +621,8 @@ ble_l2cap_coc_le_credits_update(uint16_t conn_handle, uint16_t dcid,
     }
 
     chan->coc_tx.credits += credits;
+    BLE_HS_TRACE_REC(BLE_HS_TRACE_ID_L2CAP_CREDITS_RX, conn_handle,
+                     chan->dcid, credits);
 
     /* leave the host locked on purpose when ble_l2cap_coc_continue_tx() */
     ble_l2cap_coc_continue_tx(chan);
@@ -691,13 +707,20 @@ ble_l2cap_coc_send(struct ble_l2cap_chan *chan, struct os_mbuf *sdu_tx)
 int
 ble_l2cap_coc_init(void)
 {
+    int rc;
+
     STAILQ_INIT(&ble_l2cap_coc_srvs);
 
-    return os_mempool_init(&ble_l2cap_coc_srv_pool,
-                           MYNEWT_VAL(BLE_L2CAP_COC_MAX_NUM),
-                           sizeof(struct ble_l2cap_coc_srv),
-                           ble_l2cap_coc_srv_mem,
-                           "ble_l2cap_coc_srv_pool");
+    rc = os_mempool_init(&ble_l2cap_coc_srv_pool,
+                         MYNEWT_VAL(BLE_L2CAP_COC_MAX_NUM),
+                         sizeof(struct ble_l2cap_coc_srv),
+                         ble_l2cap_coc_srv_mem,
+                         "ble_l2cap_coc_srv_pool");
+    if (rc == 0) {
+        os_mempool_stats_register(&ble_l2cap_coc_srv_pool, "l2cap_coc_srv");
+    }
+
+    return rc;
 }
 
 #endif
@@ -46,6 +46,10 @@ struct ble_l2cap_coc_endpoint {
     uint16_t credits;
     uint16_t data_offset;
     uint8_t flags;
+#if MYNEWT_VAL(BLE_HS_CONN_STATS)
+    /* Time the channel last ran out of credits */
+    uint32_t stalled_us;
+#endif
 };
 
 struct ble_l2cap_coc_srv {
@@ -1817,6 +1817,9 @@ ble_l2cap_sig_le_credits_nolock(uint16_t conn_handle, uint16_t scid, uint16_t cr
     cmd->scid = htole16(scid);
     cmd->credits = htole16(credits);
 
+    BLE_HS_TRACE_REC(BLE_HS_TRACE_ID_L2CAP_CREDITS_TX, conn_handle, scid,
+                     credits);
+
     return ble_l2cap_sig_tx_nolock(conn_handle, txom);
 }
 
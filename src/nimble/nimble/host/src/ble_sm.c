@@ -587,6 +587,7 @@ ble_sm_persist_keys(struct ble_sm_proc *proc)
                 memcpy(p_dev_rec->peer_sec.peer_addr.val,
                        proc->peer_keys.addr, 6);
                 p_dev_rec->peer_sec.peer_addr.type = proc->peer_keys.addr_type;
+                ble_hs_resolv_cache_flush();
 
                 ble_store_persist_peer_records();
             }
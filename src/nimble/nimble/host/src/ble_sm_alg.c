@@ -56,11 +56,7 @@
 
 #endif
 
-#if MYNEWT_VAL(BLE_CRYPTO_STACK_MBEDTLS)
-#if MYNEWT_VAL(BLE_SM_SC)
-static mbedtls_ecp_keypair keypair;
-#endif
-#else
+#if !MYNEWT_VAL(BLE_CRYPTO_STACK_MBEDTLS)
 #if MYNEWT_VAL(BLE_SM_SC) && MYNEWT_VAL(TRNG)
 static struct trng_dev *g_trng;
 #endif
@@ -80,6 +76,11 @@ static struct trng_dev *g_trng;
 #endif
 #endif
 
+/* Crypto provider installed by the application, NULL selects the built-in
+ * implementation. Members left NULL fall back to the built-in as well.
+ */
+static const struct ble_sm_crypto_provider *ble_sm_alg_provider;
+
 static void
 ble_sm_alg_xor_128(const uint8_t *p, const uint8_t *q, uint8_t *r)
 {
@@ -90,25 +91,23 @@ ble_sm_alg_xor_128(const uint8_t *p, const uint8_t *q, uint8_t *r)
     }
 }
 
-int
-ble_sm_alg_encrypt(const uint8_t *key, const uint8_t *plaintext,
-                   uint8_t *enc_data)
+/**
+ * Built-in AES-128 ECB encryption of a single block, standard byte order.
+ */
+static int
+ble_sm_alg_builtin_aes_encrypt(const uint8_t *key, const uint8_t *in,
+                               uint8_t *out)
 {
-    uint8_t tmp[16];
-
-    swap_buf(tmp, key, 16);
 #if MYNEWT_VAL(BLE_CRYPTO_STACK_MBEDTLS)
     mbedtls_aes_context s = {0};
 
     mbedtls_aes_init(&s);
-    if (mbedtls_aes_setkey_enc(&s, tmp, 128) != 0) {
+    if (mbedtls_aes_setkey_enc(&s, key, 128) != 0) {
         mbedtls_aes_free(&s);
         return BLE_HS_EUNKNOWN;
     }
 
-    swap_buf(tmp, plaintext, 16);
-
-    if (mbedtls_aes_crypt_ecb(&s, MBEDTLS_AES_ENCRYPT, tmp, enc_data) != 0) {
+    if (mbedtls_aes_crypt_ecb(&s, MBEDTLS_AES_ENCRYPT, in, out) != 0) {
         mbedtls_aes_free(&s);
         return BLE_HS_EUNKNOWN;
     }
@@ -117,22 +116,55 @@ ble_sm_alg_encrypt(const uint8_t *key, const uint8_t *plaintext,
 #else
     struct tc_aes_key_sched_struct s;
 
-    if (tc_aes128_set_encrypt_key(&s, tmp) == TC_CRYPTO_FAIL) {
+    if (tc_aes128_set_encrypt_key(&s, key) == TC_CRYPTO_FAIL) {
         return BLE_HS_EUNKNOWN;
     }
 
-    swap_buf(tmp, plaintext, 16);
-
-    if (tc_aes_encrypt(enc_data, tmp, &s) == TC_CRYPTO_FAIL) {
+    if (tc_aes_encrypt(out, in, &s) == TC_CRYPTO_FAIL) {
         return BLE_HS_EUNKNOWN;
     }
-
 #endif
+
+    return 0;
+}
+
+static int
+ble_sm_alg_encrypt_with(const struct ble_sm_crypto_provider *provider,
+                        const uint8_t *key, const uint8_t *plaintext,
+                        uint8_t *enc_data)
+{
+    uint8_t key_be[16];
+    uint8_t in_be[16];
+    int rc;
+
+    swap_buf(key_be, key, 16);
+    swap_buf(in_be, plaintext, 16);
+
+    if (provider != NULL && provider->aes_encrypt != NULL) {
+        rc = provider->aes_encrypt(key_be, in_be, enc_data);
+        if (rc != 0) {
+            return BLE_HS_EUNKNOWN;
+        }
+    } else {
+        rc = ble_sm_alg_builtin_aes_encrypt(key_be, in_be, enc_data);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+
     swap_in_place(enc_data, 16);
 
     return 0;
 }
 
+int
+ble_sm_alg_encrypt(const uint8_t *key, const uint8_t *plaintext,
+                   uint8_t *enc_data)
+{
+    return ble_sm_alg_encrypt_with(ble_sm_alg_provider, key, plaintext,
+                                   enc_data);
+}
+
 int
 ble_sm_alg_s1(const uint8_t *k, const uint8_t *r1, const uint8_t *r2,
               uint8_t *out)
@@ -259,9 +291,9 @@ ble_sm_alg_log_buf(const char *name, const uint8_t *buf, int len)
  */
 
 #if MYNEWT_VAL(BLE_CRYPTO_STACK_MBEDTLS)
-int
-ble_sm_alg_aes_cmac(const uint8_t *key, const uint8_t *in, size_t len,
-                    uint8_t *out)
+static int
+ble_sm_alg_builtin_aes_cmac(const uint8_t *key, const uint8_t *in,
+                            size_t len, uint8_t *out)
 {
     int rc = BLE_HS_EUNKNOWN;
     mbedtls_cipher_context_t ctx = {0};
@@ -297,18 +329,9 @@ exit:
 }
 
 #else
-
-/**
- * Cypher based Message Authentication Code (CMAC) with AES 128 bit
- *
- * @param key                   128-bit key.
- * @param in                    Message to be authenticated.
- * @param len                   Length of the message in octets.
- * @param out                   Output; message authentication code.
- */
 static int
-ble_sm_alg_aes_cmac(const uint8_t *key, const uint8_t *in, size_t len,
-                    uint8_t *out)
+ble_sm_alg_builtin_aes_cmac(const uint8_t *key, const uint8_t *in,
+                            size_t len, uint8_t *out)
 {
     struct tc_aes_key_sched_struct sched;
     struct tc_cmac_struct state;
@@ -329,6 +352,32 @@ ble_sm_alg_aes_cmac(const uint8_t *key, const uint8_t *in, size_t len,
 }
 #endif
 
+static int
+ble_sm_alg_aes_cmac_with(const struct ble_sm_crypto_provider *provider,
+                         const uint8_t *key, const uint8_t *in, size_t len,
+                         uint8_t *out)
+{
+    if (provider != NULL && provider->aes_cmac != NULL) {
+        if (provider->aes_cmac(key, in, len, out) != 0) {
+            return BLE_HS_EUNKNOWN;
+        }
+        return 0;
+    }
+
+    return ble_sm_alg_builtin_aes_cmac(key, in, len, out);
+}
+
+/**
+ * Cypher based Message Authentication Code (CMAC) with AES 128 bit, using
+ * the active crypto provider. All buffers are big-endian.
+ */
+static int
+ble_sm_alg_aes_cmac(const uint8_t *key, const uint8_t *in, size_t len,
+                    uint8_t *out)
+{
+    return ble_sm_alg_aes_cmac_with(ble_sm_alg_provider, key, in, len, out);
+}
+
 int
 ble_sm_alg_f4(const uint8_t *u, const uint8_t *v, const uint8_t *x,
               uint8_t z, uint8_t *out_enc_data)
@@ -656,20 +705,17 @@ ble_sm_alg_csis_sih(const uint8_t *k, const uint8_t *r, uint8_t *out)
     return 0;
 }
 
-int
-ble_sm_alg_gen_dhkey(const uint8_t *peer_pub_key_x, const uint8_t *peer_pub_key_y,
-                     const uint8_t *our_priv_key, uint8_t *out_dhkey)
+/**
+ * Built-in P-256 ECDH, standard byte order. The peer public key is validated
+ * before computing the shared secret.
+ */
+static int
+ble_sm_alg_builtin_p256_dhkey(const uint8_t *pk, const uint8_t *priv,
+                              uint8_t *dh)
 {
-    uint8_t dh[32];
-    uint8_t pk[64];
-    uint8_t priv[32];
-    int rc = BLE_HS_EUNKNOWN;
-
-    swap_buf(pk, peer_pub_key_x, 32);
-    swap_buf(&pk[32], peer_pub_key_y, 32);
-    swap_buf(priv, our_priv_key, 32);
-
 #if MYNEWT_VAL(BLE_CRYPTO_STACK_MBEDTLS)
+    int rc = BLE_HS_EUNKNOWN;
+    mbedtls_ecp_group grp;
     struct mbedtls_ecp_point pt = {0}, Q = {0};
     mbedtls_mpi z = {0}, d = {0};
     mbedtls_ctr_drbg_context ctr_drbg = {0};
@@ -681,6 +727,7 @@ ble_sm_alg_gen_dhkey(const uint8_t *peer_pub_key_x, const uint8_t *peer_pub_key_
     memcpy(&pub[1], pk, 64);
 
     /* Initialize the required structures here */
+    mbedtls_ecp_group_init(&grp);
     mbedtls_ecp_point_init(&pt);
     mbedtls_ecp_point_init(&Q);
     mbedtls_ctr_drbg_init(&ctr_drbg);
@@ -689,15 +736,15 @@ ble_sm_alg_gen_dhkey(const uint8_t *peer_pub_key_x, const uint8_t *peer_pub_key_
     mbedtls_mpi_init(&z);
 
     /* Below 3 steps are to validate public key on curve secp256r1 */
-    if (mbedtls_ecp_group_load(&keypair.MBEDTLS_PRIVATE(grp), MBEDTLS_ECP_DP_SECP256R1) != 0) {
+    if (mbedtls_ecp_group_load(&grp, MBEDTLS_ECP_DP_SECP256R1) != 0) {
         goto exit;
     }
 
-    if (mbedtls_ecp_point_read_binary(&keypair.MBEDTLS_PRIVATE(grp), &pt, pub, 65) != 0) {
+    if (mbedtls_ecp_point_read_binary(&grp, &pt, pub, 65) != 0) {
         goto exit;
     }
 
-    if (mbedtls_ecp_check_pubkey(&keypair.MBEDTLS_PRIVATE(grp), &pt) != 0) {
+    if (mbedtls_ecp_check_pubkey(&grp, &pt) != 0) {
         goto exit;
     }
 
@@ -708,7 +755,7 @@ ble_sm_alg_gen_dhkey(const uint8_t *peer_pub_key_x, const uint8_t *peer_pub_key_
     }
 
     /* Prepare point Q from pub key */
-    if (mbedtls_ecp_point_read_binary(&keypair.MBEDTLS_PRIVATE(grp), &Q, pub, 65) != 0) {
+    if (mbedtls_ecp_point_read_binary(&grp, &Q, pub, 65) != 0) {
         goto exit;
     }
 
@@ -716,7 +763,7 @@ ble_sm_alg_gen_dhkey(const uint8_t *peer_pub_key_x, const uint8_t *peer_pub_key_
         goto exit;
     }
 
-    rc = mbedtls_ecdh_compute_shared(&keypair.MBEDTLS_PRIVATE(grp), &z, &Q, &d,
+    rc = mbedtls_ecdh_compute_shared(&grp, &z, &Q, &d,
                                      mbedtls_ctr_drbg_random, &ctr_drbg);
     if (rc != 0) {
         goto exit;
@@ -728,6 +775,7 @@ ble_sm_alg_gen_dhkey(const uint8_t *peer_pub_key_x, const uint8_t *peer_pub_key_
     }
 
 exit:
+    mbedtls_ecp_group_free(&grp);
     mbedtls_ecp_point_free(&pt);
     mbedtls_mpi_free(&z);
     mbedtls_mpi_free(&d);
@@ -743,17 +791,53 @@ exit:
         return BLE_HS_EUNKNOWN;
     }
 
-    rc = uECC_shared_secret(pk, priv, dh, &curve_secp256r1);
-    if (rc == TC_CRYPTO_FAIL) {
+    if (uECC_shared_secret(pk, priv, dh, &curve_secp256r1) == TC_CRYPTO_FAIL) {
         return BLE_HS_EUNKNOWN;
     }
 #endif
 
+    return 0;
+}
+
+static int
+ble_sm_alg_gen_dhkey_with(const struct ble_sm_crypto_provider *provider,
+                          const uint8_t *peer_pub_key_x,
+                          const uint8_t *peer_pub_key_y,
+                          const uint8_t *our_priv_key, uint8_t *out_dhkey)
+{
+    uint8_t dh[32];
+    uint8_t pk[64];
+    uint8_t priv[32];
+    int rc;
+
+    swap_buf(pk, peer_pub_key_x, 32);
+    swap_buf(&pk[32], peer_pub_key_y, 32);
+    swap_buf(priv, our_priv_key, 32);
+
+    if (provider != NULL && provider->p256_dhkey != NULL) {
+        rc = provider->p256_dhkey(pk, priv, dh);
+    } else {
+        rc = ble_sm_alg_builtin_p256_dhkey(pk, priv, dh);
+    }
+
+    memset(priv, 0, sizeof(priv));
+    if (rc != 0) {
+        return BLE_HS_EUNKNOWN;
+    }
+
     swap_buf(out_dhkey, dh, 32);
 
     return 0;
 }
 
+int
+ble_sm_alg_gen_dhkey(const uint8_t *peer_pub_key_x, const uint8_t *peer_pub_key_y,
+                     const uint8_t *our_priv_key, uint8_t *out_dhkey)
+{
+    return ble_sm_alg_gen_dhkey_with(ble_sm_alg_provider, peer_pub_key_x,
+                                     peer_pub_key_y, our_priv_key, out_dhkey);
+}
+
 /* based on Core Specification 4.2 Vol 3. Part H 2.3.5.6.1 */
 static const uint8_t ble_sm_alg_dbg_priv_key[32] = {
     0x3f, 0x49, 0xf6, 0xd4, 0xa3, 0xc5, 0x5f, 0x38, 0x74, 0xc9, 0xb3, 0xe3,
@@ -779,18 +863,19 @@ static int
 mbedtls_gen_keypair(uint8_t *public_key, uint8_t *private_key)
 {
     int rc = BLE_HS_EUNKNOWN;
+    mbedtls_ecp_keypair keypair;
     mbedtls_entropy_context entropy = {0};
     mbedtls_ctr_drbg_context ctr_drbg = {0};
+    size_t olen = 0;
+    uint8_t pub[65] = {0};
 
-
+    /* The key pair is local so that keys can be generated by the SC key pool
+     * task while the host computes a DH key.
+     */
+    mbedtls_ecp_keypair_init(&keypair);
     mbedtls_entropy_init(&entropy);
     mbedtls_ctr_drbg_init(&ctr_drbg);
 
-    /* Free the previously allocate keypair */
-    mbedtls_ecp_keypair_free(&keypair);
-
-    mbedtls_ecp_keypair_init(&keypair);
-
     if (( rc = mbedtls_ctr_drbg_seed(&ctr_drbg, mbedtls_entropy_func, &entropy,
                                 NULL, 0)) != 0) {
         goto exit;
@@ -805,9 +890,6 @@ mbedtls_gen_keypair(uint8_t *public_key, uint8_t *private_key)
         goto exit;
     }
 
-    size_t olen = 0;
-    uint8_t pub[65] = {0};
-
     if ((rc = mbedtls_ecp_point_write_binary(&keypair.MBEDTLS_PRIVATE(grp), &keypair.MBEDTLS_PRIVATE(Q), MBEDTLS_ECP_PF_UNCOMPRESSED,
                                              &olen, pub, 65)) != 0) {
         goto exit;
@@ -818,19 +900,46 @@ mbedtls_gen_keypair(uint8_t *public_key, uint8_t *private_key)
 exit:
     mbedtls_ctr_drbg_free( &ctr_drbg );
     mbedtls_entropy_free( &entropy );
+    mbedtls_ecp_keypair_free(&keypair);
     if (rc != 0) {
-        mbedtls_ecp_keypair_free(&keypair);
         return BLE_HS_EUNKNOWN;
     }
 
     return 0;
 }
+#endif
 
-void mbedtls_free_keypair(void)
+/**
+ * Generates a P-256 key pair in standard byte order.
+ *
+ * pub: 64 bytes (X || Y)
+ * priv: 32 bytes
+ */
+static int
+ble_sm_alg_p256_gen_key_pair(const struct ble_sm_crypto_provider *provider,
+                             uint8_t *pk, uint8_t *priv)
 {
-    mbedtls_ecp_keypair_free(&keypair);
-}
+    int rc;
+
+    do {
+        if (provider != NULL && provider->p256_gen_key_pair != NULL) {
+            rc = provider->p256_gen_key_pair(pk, priv);
+        } else {
+#if MYNEWT_VAL(BLE_CRYPTO_STACK_MBEDTLS)
+            rc = mbedtls_gen_keypair(pk, priv);
+#else
+            rc = uECC_make_key(pk, priv, &curve_secp256r1) != TC_CRYPTO_SUCCESS;
 #endif
+        }
+
+        if (rc != 0) {
+            return BLE_HS_EUNKNOWN;
+        }
+        /* Make sure generated key isn't debug key. */
+    } while (memcmp(priv, ble_sm_alg_dbg_priv_key, 32) == 0);
+
+    return 0;
+}
 
 /**
  * pub: 64 bytes
@@ -845,19 +954,12 @@ ble_sm_alg_gen_key_pair(uint8_t *pub, uint8_t *priv)
     swap_buf(priv, ble_sm_alg_dbg_priv_key, 32);
 #else
     uint8_t pk[64];
+    int rc;
 
-    do {
-#if MYNEWT_VAL(BLE_CRYPTO_STACK_MBEDTLS)
-        if (mbedtls_gen_keypair(pk, priv) != 0) {
-            return BLE_HS_EUNKNOWN;
-        }
-#else
-        if (uECC_make_key(pk, priv, &curve_secp256r1) != TC_CRYPTO_SUCCESS) {
-            return BLE_HS_EUNKNOWN;
-        }
-#endif
-        /* Make sure generated key isn't debug key. */
-    } while (memcmp(priv, ble_sm_alg_dbg_priv_key, 32) == 0);
+    rc = ble_sm_alg_p256_gen_key_pair(ble_sm_alg_provider, pk, priv);
+    if (rc != 0) {
+        return rc;
+    }
 
     swap_buf(pub, pk, 32);
     swap_buf(&pub[32], &pk[32], 32);
@@ -907,5 +1009,130 @@ ble_sm_alg_ecc_init(void)
 }
 
 #endif
+
+int
+ble_sm_crypto_set_provider(const struct ble_sm_crypto_provider *provider)
+{
+    int rc;
+
+    ble_hs_lock();
+
+    /* Don't swap primitives underneath a pairing procedure. */
+    if (ble_sm_num_procs() > 0) {
+        rc = BLE_HS_EBUSY;
+    } else {
+        ble_sm_alg_provider = provider;
+        rc = 0;
+    }
+
+    ble_hs_unlock();
+
+    if (rc == 0) {
+        BLE_HS_LOG(INFO, "SM crypto provider: %s\n",
+                   provider != NULL && provider->name != NULL ?
+                   provider->name : "built-in");
+    }
+
+    return rc;
+}
+
+const struct ble_sm_crypto_provider *
+ble_sm_crypto_get_provider(void)
+{
+    return ble_sm_alg_provider;
+}
+
+static uint32_t
+ble_sm_alg_bench_us(uint32_t start_us, unsigned int iterations)
+{
+    return (ble_hs_misc_time_us() - start_us) / iterations;
+}
+
+int
+ble_sm_crypto_bench(const struct ble_sm_crypto_provider *provider,
+                    unsigned int aes_iterations, unsigned int ecc_iterations,
+                    struct ble_sm_crypto_bench_result *result)
+{
+    static const uint8_t key[16] = {
+        0xec, 0x02, 0x34, 0xa3, 0x57, 0xc8, 0xad, 0x05,
+        0x34, 0x10, 0x10, 0xa6, 0x0a, 0x39, 0x7d, 0x9b
+    };
+    uint32_t start;
+    uint8_t buf[65];
+    unsigned int i;
+    int rc;
+#if MYNEWT_VAL(BLE_SM_SC)
+    uint8_t pk[64];
+    uint8_t pub[64];
+    uint8_t priv[32];
+    uint8_t dhkey[32];
+#endif
+
+    if (result == NULL || aes_iterations == 0) {
+        return BLE_HS_EINVAL;
+    }
+
+    memset(result, 0, sizeof(*result));
+    memset(buf, 0xa5, sizeof(buf));
+
+    /* ble_sm_alg_encrypt() */
+    start = ble_hs_misc_time_us();
+    for (i = 0; i < aes_iterations; i++) {
+        rc = ble_sm_alg_encrypt_with(provider, key, buf, buf);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+    result->aes_encrypt_us = ble_sm_alg_bench_us(start, aes_iterations);
+
+#if MYNEWT_VAL(BLE_SM_SC)
+    /* ble_sm_alg_aes_cmac() on an f4 sized message */
+    start = ble_hs_misc_time_us();
+    for (i = 0; i < aes_iterations; i++) {
+        rc = ble_sm_alg_aes_cmac_with(provider, key, buf, sizeof(buf), buf);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+    result->aes_cmac_us = ble_sm_alg_bench_us(start, aes_iterations);
+
+    if (ecc_iterations == 0) {
+        return 0;
+    }
+
+    start = ble_hs_misc_time_us();
+    for (i = 0; i < ecc_iterations; i++) {
+        rc = ble_sm_alg_p256_gen_key_pair(provider, pk, priv);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+    result->p256_key_pair_us = ble_sm_alg_bench_us(start, ecc_iterations);
+
+    /* ble_sm_alg_gen_dhkey() takes little-endian keys */
+    swap_buf(pub, pk, 32);
+    swap_buf(&pub[32], &pk[32], 32);
+    swap_in_place(priv, 32);
+
+    start = ble_hs_misc_time_us();
+    for (i = 0; i < ecc_iterations; i++) {
+        rc = ble_sm_alg_gen_dhkey_with(provider, pub, &pub[32], priv, dhkey);
+        if (rc != 0) {
+            break;
+        }
+    }
+    result->p256_dhkey_us = ble_sm_alg_bench_us(start, ecc_iterations);
+
+    memset(priv, 0, sizeof(priv));
+    memset(dhkey, 0, sizeof(dhkey));
+
+    return rc;
+#else
+    (void)ecc_iterations;
+
+    return 0;
+#endif
+}
+
 #endif
 #endif
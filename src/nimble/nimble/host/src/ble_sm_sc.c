@@ -39,6 +39,27 @@ static uint8_t ble_sm_sc_priv_key[32];
  */
 static uint8_t ble_sm_sc_keys_generated;
 
+/** Number of pairing procedures that have used the current key pair. */
+static uint16_t ble_sm_sc_key_uses;
+
+/**
+ * Set when local OOB data has been generated from the current key pair; the
+ * OOB confirm value commits to the public key so it must not be rotated.
+ */
+static uint8_t ble_sm_sc_key_pinned;
+
+#if MYNEWT_VAL(BLE_SM_SC_KEY_POOL_SIZE) > 0
+struct ble_sm_sc_key_pair {
+    uint8_t pub[64];
+    uint8_t priv[32];
+};
+
+/** Precomputed key pairs, protected by the host lock. */
+static struct ble_sm_sc_key_pair
+    ble_sm_sc_key_pool[MYNEWT_VAL(BLE_SM_SC_KEY_POOL_SIZE)];
+static uint8_t ble_sm_sc_key_pool_cnt;
+#endif
+
 /**
  * Create some shortened names for the passkey actions so that the table is
  * easier to read.
@@ -164,6 +185,27 @@ ble_sm_gen_pub_priv(uint8_t *pub, uint8_t *priv)
     }
 #endif
 
+#if MYNEWT_VAL(BLE_SM_SC_KEY_POOL_SIZE) > 0
+    rc = BLE_HS_ENOENT;
+
+    ble_hs_lock_nested();
+    if (ble_sm_sc_key_pool_cnt > 0) {
+        ble_sm_sc_key_pool_cnt--;
+        memcpy(pub, ble_sm_sc_key_pool[ble_sm_sc_key_pool_cnt].pub, 64);
+        memcpy(priv, ble_sm_sc_key_pool[ble_sm_sc_key_pool_cnt].priv, 32);
+        memset(&ble_sm_sc_key_pool[ble_sm_sc_key_pool_cnt], 0,
+               sizeof(ble_sm_sc_key_pool[0]));
+        rc = 0;
+    }
+    ble_hs_unlock_nested();
+
+    if (rc == 0) {
+        return 0;
+    }
+
+    BLE_HS_LOG(DEBUG, "SC key pool empty, generating key pair\n");
+#endif
+
     rc = ble_sm_alg_gen_key_pair(pub, priv);
     if (rc != 0) {
         return rc;
@@ -172,11 +214,52 @@ ble_sm_gen_pub_priv(uint8_t *pub, uint8_t *priv)
     return 0;
 }
 
+/**
+ * Indicates whether the current key pair has served its configured number of
+ * pairings and can be replaced. Keys are only rotated when no other pairing
+ * procedure is in progress since it may already have exchanged the current
+ * public key.
+ *
+ * Lock restrictions:
+ *     o Caller must lock the host.
+ */
 static int
-ble_sm_sc_ensure_keys_generated(void)
+ble_sm_sc_key_expired(void)
 {
+#if MYNEWT_VAL(BLE_SM_SC_KEY_MAX_USES) > 0
+    return ble_sm_sc_key_uses >= MYNEWT_VAL(BLE_SM_SC_KEY_MAX_USES) &&
+           !ble_sm_sc_key_pinned &&
+           ble_sm_num_procs() <= 1;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Makes sure our key pair is available for the pairing procedure on the
+ * specified connection. The first call for a procedure counts as one use of
+ * the key pair and replaces it first if it has expired.
+ */
+static int
+ble_sm_sc_ensure_keys_generated(uint16_t conn_handle)
+{
+    struct ble_sm_proc *proc;
+    int new_use;
     int rc;
 
+    new_use = 0;
+
+    ble_hs_lock_nested();
+    proc = ble_sm_proc_find(conn_handle, BLE_SM_PROC_STATE_NONE, -1, NULL);
+    if (proc != NULL && !(proc->flags & BLE_SM_PROC_F_SC_KEY_USED)) {
+        proc->flags |= BLE_SM_PROC_F_SC_KEY_USED;
+        if (ble_sm_sc_keys_generated && ble_sm_sc_key_expired()) {
+            ble_sm_sc_keys_generated = 0;
+        }
+        new_use = 1;
+    }
+    ble_hs_unlock_nested();
+
     if (!ble_sm_sc_keys_generated) {
         rc = ble_sm_gen_pub_priv(ble_sm_sc_pub_key, ble_sm_sc_priv_key);
         if (rc != 0) {
@@ -184,6 +267,11 @@ ble_sm_sc_ensure_keys_generated(void)
         }
 
         ble_sm_sc_keys_generated = 1;
+        ble_sm_sc_key_uses = 0;
+    }
+
+    if (new_use && ble_sm_sc_key_uses < UINT16_MAX) {
+        ble_sm_sc_key_uses++;
     }
 
     BLE_HS_LOG(DEBUG, "our pubkey=");
@@ -540,7 +628,7 @@ ble_sm_sc_public_key_exec(struct ble_sm_proc *proc, struct ble_sm_result *res,
     uint8_t ioact;
     int rc;
 
-    res->app_status = ble_sm_sc_ensure_keys_generated();
+    res->app_status = ble_sm_sc_ensure_keys_generated(proc->conn_handle);
     if (res->app_status != 0) {
         res->enc_cb = 1;
         res->sm_err = BLE_SM_ERR_UNSPECIFIED;
@@ -604,7 +692,7 @@ ble_sm_sc_public_key_rx(uint16_t conn_handle, struct os_mbuf **om,
         return;
     }
 
-    res->app_status = ble_sm_sc_ensure_keys_generated();
+    res->app_status = ble_sm_sc_ensure_keys_generated(conn_handle);
     if (res->app_status != 0) {
         res->enc_cb = 1;
         res->sm_err = BLE_SM_ERR_UNSPECIFIED;
@@ -888,7 +976,19 @@ ble_sm_sc_oob_generate_data(struct ble_sm_sc_oob_data *oob_data)
     return BLE_HS_ENOTSUP;
 #endif
 
-    rc = ble_sm_sc_ensure_keys_generated();
+    /* Local OOB data commits to our public key; take a fresh key pair if the
+     * current one has been used and keep it until OOB data is generated again.
+     */
+    ble_hs_lock();
+    if (ble_sm_sc_keys_generated && MYNEWT_VAL(BLE_SM_SC_KEY_MAX_USES) > 0 &&
+        ble_sm_sc_key_uses > 0 && ble_sm_num_procs() == 0) {
+
+        ble_sm_sc_keys_generated = 0;
+    }
+    ble_sm_sc_key_pinned = 1;
+    ble_hs_unlock();
+
+    rc = ble_sm_sc_ensure_keys_generated(BLE_HS_CONN_HANDLE_NONE);
     if (rc) {
         return rc;
     }
@@ -907,11 +1007,72 @@ ble_sm_sc_oob_generate_data(struct ble_sm_sc_oob_data *oob_data)
     return 0;
 }
 
+int
+ble_sm_sc_key_pool_refill(void)
+{
+#if MYNEWT_VAL(BLE_SM_SC_KEY_POOL_SIZE) > 0
+    struct ble_sm_sc_key_pair kp;
+    int full;
+    int rc;
+
+    if (!ble_hs_synced()) {
+        return BLE_HS_ENOTSYNCED;
+    }
+
+    ble_hs_lock();
+    full = ble_sm_sc_key_pool_cnt >= MYNEWT_VAL(BLE_SM_SC_KEY_POOL_SIZE);
+    ble_hs_unlock();
+
+    if (full) {
+        return BLE_HS_EALREADY;
+    }
+
+    /* Generate outside of the lock, this is the slow part. */
+    rc = ble_sm_alg_gen_key_pair(kp.pub, kp.priv);
+    if (rc != 0) {
+        return rc;
+    }
+
+    ble_hs_lock();
+    if (ble_sm_sc_key_pool_cnt < MYNEWT_VAL(BLE_SM_SC_KEY_POOL_SIZE)) {
+        ble_sm_sc_key_pool[ble_sm_sc_key_pool_cnt++] = kp;
+        rc = 0;
+    } else {
+        rc = BLE_HS_EALREADY;
+    }
+    ble_hs_unlock();
+
+    memset(&kp, 0, sizeof(kp));
+
+    return rc;
+#else
+    return BLE_HS_ENOTSUP;
+#endif
+}
+
+int
+ble_sm_sc_key_pool_count(void)
+{
+#if MYNEWT_VAL(BLE_SM_SC_KEY_POOL_SIZE) > 0
+    int cnt;
+
+    ble_hs_lock();
+    cnt = ble_sm_sc_key_pool_cnt;
+    ble_hs_unlock();
+
+    return cnt;
+#else
+    return 0;
+#endif
+}
+
 void
 ble_sm_sc_init(void)
 {
     ble_sm_alg_ecc_init();
     ble_sm_sc_keys_generated = 0;
+    ble_sm_sc_key_uses = 0;
+    ble_sm_sc_key_pinned = 0;
 }
 
 #endif  /* MYNEWT_VAL(BLE_SM_SC) */
@@ -26,9 +26,13 @@
 #include "nimble/nimble/host/include/host/ble_hs.h"
 #include "nimble/porting/nimble/include/os/util.h"
 #include "nimble/nimble/host/store/config/include/store/config/ble_store_config.h"
+#include "nimble/porting/nimble/include/nimble/nimble_port.h"
 #include "ble_store_config_priv.h"
 
-#if MYNEWT_VAL(BLE_STORE_MAX_BONDS)
+#if BLE_STORE_CONFIG_LAZY
+struct ble_store_config_sec_dir
+    ble_store_config_our_sec_dirs[MYNEWT_VAL(BLE_STORE_MAX_BONDS)];
+#elif MYNEWT_VAL(BLE_STORE_MAX_BONDS)
 struct ble_store_value_sec
     ble_store_config_our_secs[MYNEWT_VAL(BLE_STORE_MAX_BONDS)];
 #endif
@@ -37,7 +41,10 @@ int ble_store_config_num_our_secs;
 uint16_t ble_store_config_our_bond_count;
 uint16_t ble_store_config_peer_bond_count;
 
-#if MYNEWT_VAL(BLE_STORE_MAX_BONDS)
+#if BLE_STORE_CONFIG_LAZY
+struct ble_store_config_sec_dir
+    ble_store_config_peer_sec_dirs[MYNEWT_VAL(BLE_STORE_MAX_BONDS)];
+#elif MYNEWT_VAL(BLE_STORE_MAX_BONDS)
 struct ble_store_value_sec
     ble_store_config_peer_secs[MYNEWT_VAL(BLE_STORE_MAX_BONDS)];
 #endif
@@ -73,6 +80,340 @@ struct ble_store_value_local_irk
     ble_store_config_local_irks[MYNEWT_VAL(BLE_STORE_MAX_BONDS)];
 int ble_store_config_num_local_irks;
 
+/*****************************************************************************
+ * $write-behind                                                             *
+ *****************************************************************************/
+
+/* CCCD, CSFC and EAD writes are marked dirty and committed together once the
+ * flush delay expires or a peer disconnects, so a burst of subscriptions
+ * costs a single flash commit. Security records are always written through,
+ * only their connection recency is deferred. It is held in the bond directory
+ * with lazy loading and in a separate record of the connection order without.
+ */
+#define BLE_STORE_CONFIG_DIRTY_CCCDS        0x01
+#define BLE_STORE_CONFIG_DIRTY_CSFCS        0x02
+#define BLE_STORE_CONFIG_DIRTY_EADS         0x04
+#define BLE_STORE_CONFIG_DIRTY_OUR_SECS     0x08
+#define BLE_STORE_CONFIG_DIRTY_PEER_SECS    0x10
+#define BLE_STORE_CONFIG_DIRTY_SEC_ORDER    0x20
+
+static bool ble_store_config_started;
+static struct ble_gap_event_listener ble_store_config_gap_listener;
+
+#if MYNEWT_VAL(BLE_STORE_CONFIG_PERSIST) && MYNEWT_VAL(BLE_STORE_CONFIG_FLUSH_DELAY_MS)
+static uint8_t ble_store_config_dirty;
+static struct ble_npl_callout ble_store_config_flush_timer;
+#endif
+
+static int
+ble_store_config_persist_dirty(uint8_t dirty)
+{
+    int rc = 0;
+
+#if MYNEWT_VAL(BLE_STORE_MAX_CCCDS)
+    if (dirty & BLE_STORE_CONFIG_DIRTY_CCCDS) {
+        rc = ble_store_config_persist_cccds();
+        if (rc != 0) {
+            return rc;
+        }
+    }
+#endif
+
+#if MYNEWT_VAL(BLE_STORE_MAX_CSFCS)
+    if (dirty & BLE_STORE_CONFIG_DIRTY_CSFCS) {
+        rc = ble_store_config_persist_csfcs();
+        if (rc != 0) {
+            return rc;
+        }
+    }
+#endif
+
+#if MYNEWT_VAL(ENC_ADV_DATA)
+    if (dirty & BLE_STORE_CONFIG_DIRTY_EADS) {
+        rc = ble_store_config_persist_eads();
+        if (rc != 0) {
+            return rc;
+        }
+    }
+#endif
+
+    if (dirty & BLE_STORE_CONFIG_DIRTY_OUR_SECS) {
+        rc = ble_store_config_persist_our_secs();
+        if (rc != 0) {
+            return rc;
+        }
+    }
+
+    if (dirty & BLE_STORE_CONFIG_DIRTY_PEER_SECS) {
+        rc = ble_store_config_persist_peer_secs();
+        if (rc != 0) {
+            return rc;
+        }
+    }
+
+#if MYNEWT_VAL(BLE_STORE_MAX_BONDS) && !BLE_STORE_CONFIG_LAZY
+    if (dirty & BLE_STORE_CONFIG_DIRTY_SEC_ORDER) {
+        rc = ble_store_config_persist_sec_order();
+        if (rc != 0) {
+            return rc;
+        }
+    }
+#endif
+
+    return rc;
+}
+
+/**
+ * Commits all pending record changes to persistent storage.
+ *
+ * @return                      0 on success; BLE_HS_ESTORE_FAIL if a record
+ *                              set could not be written, the set remains
+ *                              pending and is retried on the next flush.
+ */
+int
+ble_store_config_flush(void)
+{
+#if MYNEWT_VAL(BLE_STORE_CONFIG_PERSIST) && MYNEWT_VAL(BLE_STORE_CONFIG_FLUSH_DELAY_MS)
+    uint32_t sr;
+    uint8_t dirty;
+    int rc;
+
+    OS_ENTER_CRITICAL(sr);
+    dirty = ble_store_config_dirty;
+    ble_store_config_dirty = 0;
+    OS_EXIT_CRITICAL(sr);
+
+    if (dirty == 0) {
+        return 0;
+    }
+
+    rc = ble_store_config_persist_dirty(dirty);
+    if (rc != 0) {
+        BLE_HS_LOG(ERROR, "error flushing store; rc=%d\n", rc);
+        OS_ENTER_CRITICAL(sr);
+        ble_store_config_dirty |= dirty;
+        OS_EXIT_CRITICAL(sr);
+    }
+
+    return rc;
+#else
+    return 0;
+#endif
+}
+
+#if MYNEWT_VAL(BLE_STORE_CONFIG_PERSIST) && MYNEWT_VAL(BLE_STORE_CONFIG_FLUSH_DELAY_MS)
+static void
+ble_store_config_flush_timer_exp(struct ble_npl_event *ev)
+{
+    ble_store_config_flush();
+}
+#endif
+
+/* Marks a record set dirty. The flush timer is not extended by later writes,
+ * so pending changes reach flash within one flush delay and a write storm
+ * results in at most one commit per delay.
+ */
+static int
+ble_store_config_persist_deferred(uint8_t dirty)
+{
+#if MYNEWT_VAL(BLE_STORE_CONFIG_PERSIST) && MYNEWT_VAL(BLE_STORE_CONFIG_FLUSH_DELAY_MS)
+    uint32_t sr;
+
+    if (!ble_store_config_started) {
+        return ble_store_config_persist_dirty(dirty);
+    }
+
+    OS_ENTER_CRITICAL(sr);
+    ble_store_config_dirty |= dirty;
+    OS_EXIT_CRITICAL(sr);
+
+    if (!ble_npl_callout_is_active(&ble_store_config_flush_timer)) {
+        ble_npl_callout_reset(&ble_store_config_flush_timer,
+            ble_npl_time_ms_to_ticks32(MYNEWT_VAL(BLE_STORE_CONFIG_FLUSH_DELAY_MS)));
+    }
+
+    return 0;
+#else
+    return ble_store_config_persist_dirty(dirty);
+#endif
+}
+
+/*****************************************************************************
+ * $index                                                                    *
+ *****************************************************************************/
+
+/* Open addressing hash indexes over the peer identity address, plus the
+ * characteristic handle for CCCDs, so keyed lookups do not scan the record
+ * arrays. The tables are sized to stay at most half full; a slot holds the
+ * array index + 1 and the table is rebuilt whenever records are removed or
+ * reordered.
+ */
+#if MYNEWT_VAL(BLE_STORE_MAX_BONDS) || MYNEWT_VAL(BLE_STORE_MAX_CCCDS)
+struct ble_store_config_index_key {
+    ble_addr_t addr;
+    uint16_t handle;
+};
+
+typedef void ble_store_config_index_key_fn(const void *value,
+                                           struct ble_store_config_index_key *key);
+
+struct ble_store_config_index {
+    uint16_t *slots;
+    int num_slots;
+    const void *values;
+    int value_size;
+    ble_store_config_index_key_fn *key_fn;
+};
+
+static uint32_t
+ble_store_config_index_hash(const struct ble_store_config_index_key *key)
+{
+    uint32_t hash = 2166136261u;
+    int i;
+
+    hash = (hash ^ key->addr.type) * 16777619u;
+    for (i = 0; i < 6; i++) {
+        hash = (hash ^ key->addr.val[i]) * 16777619u;
+    }
+    hash = (hash ^ (key->handle & 0xff)) * 16777619u;
+    hash = (hash ^ (key->handle >> 8)) * 16777619u;
+
+    return hash;
+}
+
+static void
+ble_store_config_index_insert(const struct ble_store_config_index *index,
+                              int idx)
+{
+    struct ble_store_config_index_key key = {0};
+    int slot;
+
+    index->key_fn((const uint8_t *)index->values + idx * index->value_size,
+                  &key);
+
+    slot = ble_store_config_index_hash(&key) % index->num_slots;
+    while (index->slots[slot] != 0) {
+        slot = (slot + 1) % index->num_slots;
+    }
+
+    index->slots[slot] = idx + 1;
+}
+
+static void
+ble_store_config_index_rebuild(const struct ble_store_config_index *index,
+                               int num_values)
+{
+    int i;
+
+    memset(index->slots, 0, index->num_slots * sizeof *index->slots);
+    for (i = 0; i < num_values; i++) {
+        ble_store_config_index_insert(index, i);
+    }
+}
+
+static int
+ble_store_config_index_find(const struct ble_store_config_index *index,
+                            const struct ble_store_config_index_key *key)
+{
+    struct ble_store_config_index_key cur = {0};
+    int slot;
+    int idx;
+
+    slot = ble_store_config_index_hash(key) % index->num_slots;
+    while (index->slots[slot] != 0) {
+        idx = index->slots[slot] - 1;
+        index->key_fn((const uint8_t *)index->values + idx * index->value_size,
+                      &cur);
+        if (cur.handle == key->handle && !ble_addr_cmp(&cur.addr, &key->addr)) {
+            return idx;
+        }
+
+        slot = (slot + 1) % index->num_slots;
+    }
+
+    return -1;
+}
+#endif
+
+#if MYNEWT_VAL(BLE_STORE_MAX_BONDS)
+#define BLE_STORE_CONFIG_SEC_INDEX_SZ   (MYNEWT_VAL(BLE_STORE_MAX_BONDS) * 2 + 1)
+
+#if BLE_STORE_CONFIG_LAZY
+static void
+ble_store_config_sec_index_key(const void *value,
+                               struct ble_store_config_index_key *key)
+{
+    const struct ble_store_config_sec_dir *dir = value;
+
+    key->addr = dir->peer_addr;
+    key->handle = 0;
+}
+#else
+static void
+ble_store_config_sec_index_key(const void *value,
+                               struct ble_store_config_index_key *key)
+{
+    const struct ble_store_value_sec *sec = value;
+
+    key->addr = sec->peer_addr;
+    key->handle = 0;
+}
+#endif
+
+static uint16_t ble_store_config_our_sec_slots[BLE_STORE_CONFIG_SEC_INDEX_SZ];
+static uint16_t ble_store_config_peer_sec_slots[BLE_STORE_CONFIG_SEC_INDEX_SZ];
+
+static const struct ble_store_config_index ble_store_config_our_sec_index = {
+    .slots = ble_store_config_our_sec_slots,
+    .num_slots = BLE_STORE_CONFIG_SEC_INDEX_SZ,
+#if BLE_STORE_CONFIG_LAZY
+    .values = ble_store_config_our_sec_dirs,
+    .value_size = sizeof(struct ble_store_config_sec_dir),
+#else
+    .values = ble_store_config_our_secs,
+    .value_size = sizeof(struct ble_store_value_sec),
+#endif
+    .key_fn = ble_store_config_sec_index_key,
+};
+
+static const struct ble_store_config_index ble_store_config_peer_sec_index = {
+    .slots = ble_store_config_peer_sec_slots,
+    .num_slots = BLE_STORE_CONFIG_SEC_INDEX_SZ,
+#if BLE_STORE_CONFIG_LAZY
+    .values = ble_store_config_peer_sec_dirs,
+    .value_size = sizeof(struct ble_store_config_sec_dir),
+#else
+    .values = ble_store_config_peer_secs,
+    .value_size = sizeof(struct ble_store_value_sec),
+#endif
+    .key_fn = ble_store_config_sec_index_key,
+};
+#endif
+
+#if MYNEWT_VAL(BLE_STORE_MAX_CCCDS)
+#define BLE_STORE_CONFIG_CCCD_INDEX_SZ  (MYNEWT_VAL(BLE_STORE_MAX_CCCDS) * 2 + 1)
+
+static void
+ble_store_config_cccd_index_key(const void *value,
+                                struct ble_store_config_index_key *key)
+{
+    const struct ble_store_value_cccd *cccd = value;
+
+    key->addr = cccd->peer_addr;
+    key->handle = cccd->chr_val_handle;
+}
+
+static uint16_t ble_store_config_cccd_slots[BLE_STORE_CONFIG_CCCD_INDEX_SZ];
+
+static const struct ble_store_config_index ble_store_config_cccd_index = {
+    .slots = ble_store_config_cccd_slots,
+    .num_slots = BLE_STORE_CONFIG_CCCD_INDEX_SZ,
+    .values = ble_store_config_cccds,
+    .value_size = sizeof(struct ble_store_value_cccd),
+    .key_fn = ble_store_config_cccd_index_key,
+};
+#endif
+
 /*****************************************************************************
  * $sec                                                                      *
  *****************************************************************************/
@@ -84,10 +425,10 @@ int ble_store_config_compare_bond_count(const void *a, const void *b) {
     return sec_a->bond_count - sec_b->bond_count;
 }
 
-/* This function gets the stored device records of OUR_SEC object type, arranges them in order of their bond count,
- * and then updates them with new counts so they're in sequence.
+/* This function gets the stored device records of OUR_SEC object type, which are kept in least recently connected
+ * order, and then updates them with new counts so they're in sequence.
  */
-#if MYNEWT_VAL(BLE_STORE_MAX_BONDS)
+#if MYNEWT_VAL(BLE_STORE_MAX_BONDS) && !BLE_STORE_CONFIG_LAZY
 int ble_restore_our_sec_nvs(void)
 {
     int rc;
@@ -100,8 +441,6 @@ int ble_restore_our_sec_nvs(void)
     memcpy(temp_our_secs, ble_store_config_our_secs, ble_store_config_num_our_secs * sizeof(struct ble_store_value_sec));
     temp_count = ble_store_config_num_our_secs;
 
-    qsort(temp_our_secs, temp_count, sizeof(struct ble_store_value_sec), ble_store_config_compare_bond_count);
-
     for (int i = 0; i < temp_count; i++) {
 
         union ble_store_key key;
@@ -131,8 +470,8 @@ int ble_restore_our_sec_nvs(void)
     return 0;
 }
 
-/* This function gets the stored device records of PEER_SEC object type, arranges them in order of their bond count,
- * and then updates them with new counts so they're in sequence.
+/* This function gets the stored device records of PEER_SEC object type, which are kept in least recently connected
+ * order, and then updates them with new counts so they're in sequence.
  */
 int ble_restore_peer_sec_nvs(void)
 {
@@ -146,8 +485,6 @@ int ble_restore_peer_sec_nvs(void)
     memcpy(temp_peer_secs, ble_store_config_peer_secs, ble_store_config_num_peer_secs * sizeof(struct ble_store_value_sec));
     temp_count = ble_store_config_num_peer_secs;
 
-    qsort(temp_peer_secs, temp_count, sizeof(struct ble_store_value_sec), ble_store_config_compare_bond_count);
-
     for (int i = 0; i < temp_count; i++) {
 
         union ble_store_key key;
@@ -217,27 +554,361 @@ ble_store_config_print_key_sec(const struct ble_store_key_sec *key_sec)
 #if MYNEWT_VAL(BLE_STORE_MAX_BONDS)
 static int
 ble_store_config_find_sec(const struct ble_store_key_sec *key_sec,
-                          const struct ble_store_value_sec *value_secs,
+                          const struct ble_store_config_index *index,
                           int num_value_secs)
 {
-    const struct ble_store_value_sec *cur;
-    int i;
+    struct ble_store_config_index_key key = {0};
 
     if (!ble_addr_cmp(&key_sec->peer_addr, BLE_ADDR_ANY)) {
         if (key_sec->idx < num_value_secs) {
             return key_sec->idx;
         }
     } else if (key_sec->idx == 0) {
-        for (i = 0; i < num_value_secs; i++) {
-            cur = &value_secs[i];
+        key.addr = key_sec->peer_addr;
+        return ble_store_config_index_find(index, &key);
+    }
 
-            if (!ble_addr_cmp(&cur->peer_addr, &key_sec->peer_addr)) {
-                return i;
+    return -1;
+}
+#endif
+
+#if MYNEWT_VAL(BLE_STORE_MAX_BONDS) && !BLE_STORE_CONFIG_LAZY
+/* The security record arrays are kept in least recently connected order so
+ * that ble_store_util_delete_oldest_peer() evicts the peer that has gone the
+ * longest without connecting. bond_count only changes when a record is
+ * written, a reconnect only persists the new order of the peer addresses,
+ * which is restored at init.
+ */
+static int
+ble_store_config_sec_move_to_tail(struct ble_store_value_sec *value_secs,
+                                  int num_value_secs, int idx,
+                                  const struct ble_store_config_index *index)
+{
+    struct ble_store_value_sec sec;
+
+    if (idx == num_value_secs - 1) {
+        return idx;
+    }
+
+    sec = value_secs[idx];
+    memmove(value_secs + idx, value_secs + idx + 1,
+            (num_value_secs - idx - 1) * sizeof *value_secs);
+    value_secs[num_value_secs - 1] = sec;
+
+    ble_store_config_index_rebuild(index, num_value_secs);
+    return num_value_secs - 1;
+}
+#endif
+
+/*****************************************************************************
+ * $lazy                                                                     *
+ *****************************************************************************/
+
+/* Only a directory of the security records (peer address, bond_count and NVS
+ * slot) is resident. Records are read from NVS on first use and held in a
+ * small least recently used cache, the directory is authoritative for
+ * bond_count so recency updates only rewrite the directory.
+ */
+#if BLE_STORE_CONFIG_LAZY
+struct ble_store_config_lazy_set {
+    int obj_type;
+    struct ble_store_config_sec_dir *dirs;
+    int *num_dirs;
+    uint16_t *bond_count;
+    const struct ble_store_config_index *index;
+};
+
+static const struct ble_store_config_lazy_set ble_store_config_lazy_our = {
+    .obj_type = BLE_STORE_OBJ_TYPE_OUR_SEC,
+    .dirs = ble_store_config_our_sec_dirs,
+    .num_dirs = &ble_store_config_num_our_secs,
+    .bond_count = &ble_store_config_our_bond_count,
+    .index = &ble_store_config_our_sec_index,
+};
+
+static const struct ble_store_config_lazy_set ble_store_config_lazy_peer = {
+    .obj_type = BLE_STORE_OBJ_TYPE_PEER_SEC,
+    .dirs = ble_store_config_peer_sec_dirs,
+    .num_dirs = &ble_store_config_num_peer_secs,
+    .bond_count = &ble_store_config_peer_bond_count,
+    .index = &ble_store_config_peer_sec_index,
+};
+
+struct ble_store_config_sec_cache {
+    struct ble_store_value_sec sec;
+    /* 0 if the entry is free */
+    uint32_t last_used;
+    uint16_t nvs_idx;
+    uint8_t obj_type;
+};
+
+static struct ble_store_config_sec_cache
+    ble_store_config_sec_cache[MYNEWT_VAL(BLE_STORE_CONFIG_LAZY_CACHE_SIZE)];
+static uint32_t ble_store_config_sec_cache_clock;
+
+static struct ble_store_config_sec_cache *
+ble_store_config_sec_cache_find(int obj_type, uint16_t nvs_idx)
+{
+    struct ble_store_config_sec_cache *entry;
+    int i;
+
+    for (i = 0; i < MYNEWT_VAL(BLE_STORE_CONFIG_LAZY_CACHE_SIZE); i++) {
+        entry = &ble_store_config_sec_cache[i];
+        if (entry->last_used != 0 && entry->obj_type == obj_type &&
+            entry->nvs_idx == nvs_idx) {
+            entry->last_used = ++ble_store_config_sec_cache_clock;
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+static void
+ble_store_config_sec_cache_put(int obj_type, uint16_t nvs_idx,
+                               const struct ble_store_value_sec *sec)
+{
+    struct ble_store_config_sec_cache *entry;
+    int i;
+
+    entry = ble_store_config_sec_cache_find(obj_type, nvs_idx);
+    if (entry == NULL) {
+        entry = &ble_store_config_sec_cache[0];
+        for (i = 1; i < MYNEWT_VAL(BLE_STORE_CONFIG_LAZY_CACHE_SIZE); i++) {
+            if (ble_store_config_sec_cache[i].last_used < entry->last_used) {
+                entry = &ble_store_config_sec_cache[i];
             }
         }
     }
 
-    return -1;
+    entry->sec = *sec;
+    entry->obj_type = obj_type;
+    entry->nvs_idx = nvs_idx;
+    entry->last_used = ++ble_store_config_sec_cache_clock;
+}
+
+static void
+ble_store_config_sec_cache_drop(int obj_type, uint16_t nvs_idx)
+{
+    struct ble_store_config_sec_cache *entry;
+
+    entry = ble_store_config_sec_cache_find(obj_type, nvs_idx);
+    if (entry != NULL) {
+        memset(entry, 0, sizeof *entry);
+    }
+}
+
+static int
+ble_store_config_lazy_fetch(const struct ble_store_config_lazy_set *set,
+                            int idx, struct ble_store_value_sec *value_sec)
+{
+    const struct ble_store_config_sec_dir *dir = &set->dirs[idx];
+    struct ble_store_config_sec_cache *entry;
+    int rc;
+
+    entry = ble_store_config_sec_cache_find(set->obj_type, dir->nvs_idx);
+    if (entry != NULL) {
+        *value_sec = entry->sec;
+    } else {
+        rc = ble_store_config_nvs_read_sec(set->obj_type, dir->nvs_idx,
+                                           value_sec);
+        if (rc != 0) {
+            return rc;
+        }
+
+        ble_store_config_sec_cache_put(set->obj_type, dir->nvs_idx, value_sec);
+    }
+
+    value_sec->bond_count = dir->bond_count;
+    return 0;
+}
+
+static int
+ble_store_config_lazy_move_to_tail(const struct ble_store_config_lazy_set *set,
+                                   int idx)
+{
+    struct ble_store_config_sec_dir dir;
+    int num_dirs = *set->num_dirs;
+
+    if (idx == num_dirs - 1) {
+        return idx;
+    }
+
+    dir = set->dirs[idx];
+    memmove(set->dirs + idx, set->dirs + idx + 1,
+            (num_dirs - idx - 1) * sizeof *set->dirs);
+    set->dirs[num_dirs - 1] = dir;
+
+    ble_store_config_index_rebuild(set->index, num_dirs);
+    return num_dirs - 1;
+}
+
+static uint16_t
+ble_store_config_lazy_free_nvs_idx(const struct ble_store_config_lazy_set *set)
+{
+    uint8_t used[(MYNEWT_VAL(BLE_STORE_MAX_BONDS) + 8) / 8] = {0};
+    uint16_t nvs_idx;
+    int i;
+
+    for (i = 0; i < *set->num_dirs; i++) {
+        nvs_idx = set->dirs[i].nvs_idx;
+        used[nvs_idx / 8] |= 1 << (nvs_idx % 8);
+    }
+
+    for (nvs_idx = 1; nvs_idx <= MYNEWT_VAL(BLE_STORE_MAX_BONDS); nvs_idx++) {
+        if (!(used[nvs_idx / 8] & (1 << (nvs_idx % 8)))) {
+            return nvs_idx;
+        }
+    }
+
+    return 0;
+}
+
+/* Renumbers bond_count in recency order once the counter nears overflow. */
+static int
+ble_store_config_lazy_renumber(const struct ble_store_config_lazy_set *set)
+{
+    int i;
+
+    for (i = 0; i < *set->num_dirs; i++) {
+        set->dirs[i].bond_count = i + 1;
+    }
+    *set->bond_count = *set->num_dirs;
+
+    return ble_store_config_nvs_update_sec(set->obj_type, 0, NULL);
+}
+
+int ble_restore_our_sec_nvs(void)
+{
+    return ble_store_config_lazy_renumber(&ble_store_config_lazy_our);
+}
+
+int ble_restore_peer_sec_nvs(void)
+{
+    return ble_store_config_lazy_renumber(&ble_store_config_lazy_peer);
+}
+
+static int
+ble_store_config_lazy_read(const struct ble_store_config_lazy_set *set,
+                           const struct ble_store_key_sec *key_sec,
+                           struct ble_store_value_sec *value_sec)
+{
+    int idx;
+
+    idx = ble_store_config_find_sec(key_sec, set->index, *set->num_dirs);
+    if (idx == -1) {
+        return BLE_HS_ENOENT;
+    }
+
+    return ble_store_config_lazy_fetch(set, idx, value_sec);
+}
+
+static int
+ble_store_config_lazy_write(const struct ble_store_config_lazy_set *set,
+                            const struct ble_store_value_sec *value_sec)
+{
+    struct ble_store_config_sec_dir old_dir;
+    struct ble_store_value_sec sec;
+    struct ble_store_key_sec key_sec;
+    uint16_t old_bond_count;
+    uint16_t nvs_idx;
+    int old_idx;
+    int idx;
+    int rc;
+
+    ble_store_key_from_value_sec(&key_sec, value_sec);
+    idx = ble_store_config_find_sec(&key_sec, set->index, *set->num_dirs);
+    old_idx = idx;
+    old_bond_count = *set->bond_count;
+    if (idx == -1) {
+        nvs_idx = ble_store_config_lazy_free_nvs_idx(set);
+        if (nvs_idx == 0) {
+            BLE_HS_LOG(DEBUG, "error persisting sec; too many entries "
+                              "(%d)\n", *set->num_dirs);
+            return BLE_HS_ESTORE_CAP;
+        }
+
+        idx = *set->num_dirs;
+        (*set->num_dirs)++;
+        set->dirs[idx].peer_addr = value_sec->peer_addr;
+        set->dirs[idx].nvs_idx = nvs_idx;
+        ble_store_config_index_insert(set->index, idx);
+    } else {
+        old_dir = set->dirs[idx];
+        idx = ble_store_config_lazy_move_to_tail(set, idx);
+    }
+
+    sec = *value_sec;
+    sec.bond_count = ++(*set->bond_count);
+    set->dirs[idx].bond_count = sec.bond_count;
+    ble_store_config_sec_cache_put(set->obj_type, set->dirs[idx].nvs_idx, &sec);
+
+    rc = ble_store_config_nvs_update_sec(set->obj_type, set->dirs[idx].nvs_idx,
+                                         &sec);
+    if (rc != 0) {
+        /* Restore the directory to match what is stored.  The stored record
+         * may or may not have been replaced, so drop it from the cache and
+         * let the next read fetch it.
+         */
+        ble_store_config_sec_cache_drop(set->obj_type, set->dirs[idx].nvs_idx);
+        *set->bond_count = old_bond_count;
+        if (old_idx == -1) {
+            (*set->num_dirs)--;
+        } else {
+            memmove(set->dirs + old_idx + 1, set->dirs + old_idx,
+                    (idx - old_idx) * sizeof *set->dirs);
+            set->dirs[old_idx] = old_dir;
+        }
+        ble_store_config_index_rebuild(set->index, *set->num_dirs);
+        return rc;
+    }
+
+    if (*set->bond_count > (UINT16_MAX - 5)) {
+        rc = ble_store_config_lazy_renumber(set);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+
+    return 0;
+}
+
+static int
+ble_store_config_lazy_delete(const struct ble_store_config_lazy_set *set,
+                             const struct ble_store_key_sec *key_sec)
+{
+    uint16_t nvs_idx;
+    int idx;
+
+    idx = ble_store_config_find_sec(key_sec, set->index, *set->num_dirs);
+    if (idx == -1) {
+        return BLE_HS_ENOENT;
+    }
+
+    nvs_idx = set->dirs[idx].nvs_idx;
+    (*set->num_dirs)--;
+    memmove(set->dirs + idx, set->dirs + idx + 1,
+            (*set->num_dirs - idx) * sizeof *set->dirs);
+    ble_store_config_index_rebuild(set->index, *set->num_dirs);
+    ble_store_config_sec_cache_drop(set->obj_type, nvs_idx);
+
+    return ble_store_config_nvs_update_sec(set->obj_type, nvs_idx, NULL);
+}
+
+static bool
+ble_store_config_lazy_touch(const struct ble_store_config_lazy_set *set,
+                            const struct ble_store_config_index_key *key)
+{
+    int idx;
+
+    idx = ble_store_config_index_find(set->index, key);
+    if (idx < 0 || set->dirs[idx].bond_count == *set->bond_count) {
+        return false;
+    }
+
+    idx = ble_store_config_lazy_move_to_tail(set, idx);
+    set->dirs[idx].bond_count = ++(*set->bond_count);
+    return true;
 }
 #endif
 
@@ -245,10 +916,13 @@ static int
 ble_store_config_read_our_sec(const struct ble_store_key_sec *key_sec,
                               struct ble_store_value_sec *value_sec)
 {
-#if MYNEWT_VAL(BLE_STORE_MAX_BONDS)
+#if BLE_STORE_CONFIG_LAZY
+    return ble_store_config_lazy_read(&ble_store_config_lazy_our, key_sec,
+                                      value_sec);
+#elif MYNEWT_VAL(BLE_STORE_MAX_BONDS)
     int idx;
 
-    idx = ble_store_config_find_sec(key_sec, ble_store_config_our_secs,
+    idx = ble_store_config_find_sec(key_sec, &ble_store_config_our_sec_index,
                                     ble_store_config_num_our_secs);
     if (idx == -1) {
         return BLE_HS_ENOENT;
@@ -265,7 +939,12 @@ ble_store_config_read_our_sec(const struct ble_store_key_sec *key_sec,
 static int
 ble_store_config_write_our_sec(const struct ble_store_value_sec *value_sec)
 {
-#if MYNEWT_VAL(BLE_STORE_MAX_BONDS)
+#if BLE_STORE_CONFIG_LAZY
+    BLE_HS_LOG(DEBUG, "persisting our sec; ");
+    ble_store_config_print_value_sec(value_sec);
+
+    return ble_store_config_lazy_write(&ble_store_config_lazy_our, value_sec);
+#elif MYNEWT_VAL(BLE_STORE_MAX_BONDS)
     struct ble_store_key_sec key_sec;
     int idx;
     int rc;
@@ -274,7 +953,7 @@ ble_store_config_write_our_sec(const struct ble_store_value_sec *value_sec)
     ble_store_config_print_value_sec(value_sec);
 
     ble_store_key_from_value_sec(&key_sec, value_sec);
-    idx = ble_store_config_find_sec(&key_sec, ble_store_config_our_secs,
+    idx = ble_store_config_find_sec(&key_sec, &ble_store_config_our_sec_index,
                                     ble_store_config_num_our_secs);
     if (idx == -1) {
         if (ble_store_config_num_our_secs >= MYNEWT_VAL(BLE_STORE_MAX_BONDS)) {
@@ -285,6 +964,13 @@ ble_store_config_write_our_sec(const struct ble_store_value_sec *value_sec)
 
         idx = ble_store_config_num_our_secs;
         ble_store_config_num_our_secs++;
+        ble_store_config_our_secs[idx] = *value_sec;
+        ble_store_config_index_insert(&ble_store_config_our_sec_index, idx);
+    } else {
+        idx = ble_store_config_sec_move_to_tail(ble_store_config_our_secs,
+                                                ble_store_config_num_our_secs,
+                                                idx,
+                                                &ble_store_config_our_sec_index);
     }
 
     ble_store_config_our_secs[idx] = *value_sec;
@@ -316,7 +1002,7 @@ ble_store_config_delete_obj(void *values, int value_size, int idx,
 {
     uint8_t *dst;
     uint8_t *src;
-    uint8_t move_count;
+    int move_count;
 
     (*num_values)--;
     if (idx < *num_values) {
@@ -331,16 +1017,17 @@ ble_store_config_delete_obj(void *values, int value_size, int idx,
     return 0;
 }
 
-#if MYNEWT_VAL(BLE_STORE_MAX_BONDS)
+#if MYNEWT_VAL(BLE_STORE_MAX_BONDS) && !BLE_STORE_CONFIG_LAZY
 static int
 ble_store_config_delete_sec(const struct ble_store_key_sec *key_sec,
                             struct ble_store_value_sec *value_secs,
-                            int *num_value_secs)
+                            int *num_value_secs,
+                            const struct ble_store_config_index *index)
 {
     int idx;
     int rc;
 
-    idx = ble_store_config_find_sec(key_sec, value_secs, *num_value_secs);
+    idx = ble_store_config_find_sec(key_sec, index, *num_value_secs);
     if (idx == -1) {
         return BLE_HS_ENOENT;
     }
@@ -351,6 +1038,7 @@ ble_store_config_delete_sec(const struct ble_store_key_sec *key_sec,
         return rc;
     }
 
+    ble_store_config_index_rebuild(index, *num_value_secs);
     return 0;
 }
 #endif
@@ -358,11 +1046,14 @@ ble_store_config_delete_sec(const struct ble_store_key_sec *key_sec,
 static int
 ble_store_config_delete_our_sec(const struct ble_store_key_sec *key_sec)
 {
-#if MYNEWT_VAL(BLE_STORE_MAX_BONDS)
+#if BLE_STORE_CONFIG_LAZY
+    return ble_store_config_lazy_delete(&ble_store_config_lazy_our, key_sec);
+#elif MYNEWT_VAL(BLE_STORE_MAX_BONDS)
     int rc;
 
     rc = ble_store_config_delete_sec(key_sec, ble_store_config_our_secs,
-                                     &ble_store_config_num_our_secs);
+                                     &ble_store_config_num_our_secs,
+                                     &ble_store_config_our_sec_index);
     if (rc != 0) {
         return rc;
     }
@@ -381,11 +1072,14 @@ ble_store_config_delete_our_sec(const struct ble_store_key_sec *key_sec)
 static int
 ble_store_config_delete_peer_sec(const struct ble_store_key_sec *key_sec)
 {
-#if MYNEWT_VAL(BLE_STORE_MAX_BONDS)
+#if BLE_STORE_CONFIG_LAZY
+    return ble_store_config_lazy_delete(&ble_store_config_lazy_peer, key_sec);
+#elif MYNEWT_VAL(BLE_STORE_MAX_BONDS)
     int rc;
 
     rc = ble_store_config_delete_sec(key_sec, ble_store_config_peer_secs,
-                                  &ble_store_config_num_peer_secs);
+                                  &ble_store_config_num_peer_secs,
+                                  &ble_store_config_peer_sec_index);
     if (rc != 0) {
         return rc;
     }
@@ -404,10 +1098,13 @@ static int
 ble_store_config_read_peer_sec(const struct ble_store_key_sec *key_sec,
                                struct ble_store_value_sec *value_sec)
 {
-#if MYNEWT_VAL(BLE_STORE_MAX_BONDS)
+#if BLE_STORE_CONFIG_LAZY
+    return ble_store_config_lazy_read(&ble_store_config_lazy_peer, key_sec,
+                                      value_sec);
+#elif MYNEWT_VAL(BLE_STORE_MAX_BONDS)
     int idx;
 
-    idx = ble_store_config_find_sec(key_sec, ble_store_config_peer_secs,
+    idx = ble_store_config_find_sec(key_sec, &ble_store_config_peer_sec_index,
                              ble_store_config_num_peer_secs);
     if (idx == -1) {
         return BLE_HS_ENOENT;
@@ -424,7 +1121,12 @@ ble_store_config_read_peer_sec(const struct ble_store_key_sec *key_sec,
 static int
 ble_store_config_write_peer_sec(const struct ble_store_value_sec *value_sec)
 {
-#if MYNEWT_VAL(BLE_STORE_MAX_BONDS)
+#if BLE_STORE_CONFIG_LAZY
+    BLE_HS_LOG(DEBUG, "persisting peer sec; ");
+    ble_store_config_print_value_sec(value_sec);
+
+    return ble_store_config_lazy_write(&ble_store_config_lazy_peer, value_sec);
+#elif MYNEWT_VAL(BLE_STORE_MAX_BONDS)
     struct ble_store_key_sec key_sec;
     int idx;
     int rc;
@@ -433,7 +1135,7 @@ ble_store_config_write_peer_sec(const struct ble_store_value_sec *value_sec)
     ble_store_config_print_value_sec(value_sec);
 
     ble_store_key_from_value_sec(&key_sec, value_sec);
-    idx = ble_store_config_find_sec(&key_sec, ble_store_config_peer_secs,
+    idx = ble_store_config_find_sec(&key_sec, &ble_store_config_peer_sec_index,
                                  ble_store_config_num_peer_secs);
     if (idx == -1) {
         if (ble_store_config_num_peer_secs >= MYNEWT_VAL(BLE_STORE_MAX_BONDS)) {
@@ -444,6 +1146,13 @@ ble_store_config_write_peer_sec(const struct ble_store_value_sec *value_sec)
 
         idx = ble_store_config_num_peer_secs;
         ble_store_config_num_peer_secs++;
+        ble_store_config_peer_secs[idx] = *value_sec;
+        ble_store_config_index_insert(&ble_store_config_peer_sec_index, idx);
+    } else {
+        idx = ble_store_config_sec_move_to_tail(ble_store_config_peer_secs,
+                                                ble_store_config_num_peer_secs,
+                                                idx,
+                                                &ble_store_config_peer_sec_index);
     }
 
     ble_store_config_peer_secs[idx] = *value_sec;
@@ -476,10 +1185,19 @@ ble_store_config_write_peer_sec(const struct ble_store_value_sec *value_sec)
 static int
 ble_store_config_find_cccd(const struct ble_store_key_cccd *key)
 {
+    struct ble_store_config_index_key index_key;
     struct ble_store_value_cccd *cccd;
     int skipped;
     int i;
 
+    if (key->idx == 0 && key->chr_val_handle != 0 &&
+        ble_addr_cmp(&key->peer_addr, BLE_ADDR_ANY)) {
+        index_key.addr = key->peer_addr;
+        index_key.handle = key->chr_val_handle;
+        return ble_store_config_index_find(&ble_store_config_cccd_index,
+                                           &index_key);
+    }
+
     skipped = 0;
     for (i = 0; i < ble_store_config_num_cccds; i++) {
         cccd = ble_store_config_cccds + i;
@@ -527,7 +1245,10 @@ ble_store_config_delete_cccd(const struct ble_store_key_cccd *key_cccd)
         return rc;
     }
 
-    rc = ble_store_config_persist_cccds();
+    ble_store_config_index_rebuild(&ble_store_config_cccd_index,
+                                   ble_store_config_num_cccds);
+
+    rc = ble_store_config_persist_deferred(BLE_STORE_CONFIG_DIRTY_CCCDS);
     if (rc != 0) {
         return rc;
     }
@@ -575,11 +1296,13 @@ ble_store_config_write_cccd(const struct ble_store_value_cccd *value_cccd)
 
         idx = ble_store_config_num_cccds;
         ble_store_config_num_cccds++;
+        ble_store_config_cccds[idx] = *value_cccd;
+        ble_store_config_index_insert(&ble_store_config_cccd_index, idx);
     }
 
     ble_store_config_cccds[idx] = *value_cccd;
 
-    rc = ble_store_config_persist_cccds();
+    rc = ble_store_config_persist_deferred(BLE_STORE_CONFIG_DIRTY_CCCDS);
     if (rc != 0) {
         return rc;
     }
@@ -641,7 +1364,7 @@ ble_store_config_delete_ead(const struct ble_store_key_ead *key_ead)
         return rc;
     }
 
-    rc = ble_store_config_persist_eads();
+    rc = ble_store_config_persist_deferred(BLE_STORE_CONFIG_DIRTY_EADS);
     if (rc != 0) {
         return rc;
     }
@@ -687,7 +1410,7 @@ ble_store_config_write_ead(const struct ble_store_value_ead *value_ead)
 
     ble_store_config_eads[idx] = *value_ead;
 
-    rc = ble_store_config_persist_eads();
+    rc = ble_store_config_persist_deferred(BLE_STORE_CONFIG_DIRTY_EADS);
     if (rc != 0) {
         return rc;
     }
@@ -957,7 +1680,7 @@ ble_store_config_delete_csfc(const struct ble_store_key_csfc *key_csfc)
         return rc;
     }
 
-    rc = ble_store_config_persist_csfcs();
+    rc = ble_store_config_persist_deferred(BLE_STORE_CONFIG_DIRTY_CSFCS);
     if (rc != 0) {
         return rc;
     }
@@ -1004,7 +1727,7 @@ ble_store_config_write_csfc(const struct ble_store_value_csfc *value_csfc)
 
     ble_store_config_csfcs[idx] = *value_csfc;
 
-    rc = ble_store_config_persist_csfcs();
+    rc = ble_store_config_persist_deferred(BLE_STORE_CONFIG_DIRTY_CSFCS);
     if (rc != 0) {
         return rc;
     }
@@ -1012,6 +1735,106 @@ ble_store_config_write_csfc(const struct ble_store_value_csfc *value_csfc)
     return 0;
 }
 
+/*****************************************************************************
+ * $lru                                                                      *
+ *****************************************************************************/
+
+#if MYNEWT_VAL(BLE_STORE_MAX_BONDS)
+/* Moves a reconnected peer to the most recently used end of the security
+ * records. The records themselves are not rewritten, the bond directory or
+ * the connection order record is persisted with the write-behind flush.
+ */
+static void
+ble_store_config_touch_sec(const ble_addr_t *peer_id_addr)
+{
+    struct ble_store_config_index_key key = {0};
+    uint8_t dirty = 0;
+#if !BLE_STORE_CONFIG_LAZY
+    int idx;
+#endif
+
+    key.addr = *peer_id_addr;
+
+#if BLE_STORE_CONFIG_LAZY
+    if (ble_store_config_lazy_touch(&ble_store_config_lazy_our, &key)) {
+        dirty |= BLE_STORE_CONFIG_DIRTY_OUR_SECS;
+    }
+
+    if (ble_store_config_lazy_touch(&ble_store_config_lazy_peer, &key)) {
+        dirty |= BLE_STORE_CONFIG_DIRTY_PEER_SECS;
+    }
+
+    if (dirty == 0) {
+        return;
+    }
+
+    ble_store_config_persist_deferred(dirty);
+
+    if (ble_store_config_our_bond_count > (UINT16_MAX - 5)) {
+        ble_restore_our_sec_nvs();
+    }
+
+    if (ble_store_config_peer_bond_count > (UINT16_MAX - 5)) {
+        ble_restore_peer_sec_nvs();
+    }
+#else
+    idx = ble_store_config_index_find(&ble_store_config_our_sec_index, &key);
+    if (idx >= 0 && idx != ble_store_config_num_our_secs - 1) {
+        ble_store_config_sec_move_to_tail(ble_store_config_our_secs,
+                                          ble_store_config_num_our_secs, idx,
+                                          &ble_store_config_our_sec_index);
+        dirty |= BLE_STORE_CONFIG_DIRTY_SEC_ORDER;
+    }
+
+    idx = ble_store_config_index_find(&ble_store_config_peer_sec_index, &key);
+    if (idx >= 0 && idx != ble_store_config_num_peer_secs - 1) {
+        ble_store_config_sec_move_to_tail(ble_store_config_peer_secs,
+                                          ble_store_config_num_peer_secs, idx,
+                                          &ble_store_config_peer_sec_index);
+        dirty |= BLE_STORE_CONFIG_DIRTY_SEC_ORDER;
+    }
+
+    if (dirty != 0) {
+        ble_store_config_persist_deferred(dirty);
+    }
+#endif
+}
+#endif
+
+static int
+ble_store_config_gap_event(struct ble_gap_event *event, void *arg)
+{
+#if MYNEWT_VAL(BLE_STORE_MAX_BONDS)
+    struct ble_gap_conn_desc desc;
+#endif
+
+    switch (event->type) {
+#if MYNEWT_VAL(BLE_STORE_MAX_BONDS)
+    case BLE_GAP_EVENT_ENC_CHANGE:
+        if (event->enc_change.status == 0 &&
+            ble_gap_conn_find(event->enc_change.conn_handle, &desc) == 0 &&
+            desc.sec_state.bonded) {
+            ble_store_config_touch_sec(&desc.peer_id_addr);
+        }
+        break;
+#endif
+
+#if MYNEWT_VAL(BLE_STORE_CONFIG_PERSIST) && MYNEWT_VAL(BLE_STORE_CONFIG_FLUSH_DELAY_MS)
+    case BLE_GAP_EVENT_DISCONNECT:
+        if (ble_store_config_dirty) {
+            ble_npl_callout_stop(&ble_store_config_flush_timer);
+            ble_store_config_flush();
+        }
+        break;
+#endif
+
+    default:
+        break;
+    }
+
+    return 0;
+}
+
 /*****************************************************************************
  * $api                                                                      *
  *****************************************************************************/
@@ -1181,5 +2004,51 @@ ble_store_config_init(void)
 #endif
     ble_store_config_num_rpa_recs = 0;
     ble_store_config_num_local_irks=0;
+#if BLE_STORE_CONFIG_LAZY
+    memset(ble_store_config_sec_cache, 0, sizeof ble_store_config_sec_cache);
+#endif
     ble_store_config_conf_init();
+
+#if MYNEWT_VAL(BLE_STORE_MAX_BONDS)
+    ble_store_config_index_rebuild(&ble_store_config_our_sec_index,
+                                   ble_store_config_num_our_secs);
+    ble_store_config_index_rebuild(&ble_store_config_peer_sec_index,
+                                   ble_store_config_num_peer_secs);
+#endif
+#if MYNEWT_VAL(BLE_STORE_MAX_CCCDS)
+    ble_store_config_index_rebuild(&ble_store_config_cccd_index,
+                                   ble_store_config_num_cccds);
+#endif
+
+    if (!ble_store_config_started) {
+#if MYNEWT_VAL(BLE_STORE_CONFIG_PERSIST) && MYNEWT_VAL(BLE_STORE_CONFIG_FLUSH_DELAY_MS)
+        ble_store_config_dirty = 0;
+        ble_npl_callout_init(&ble_store_config_flush_timer,
+                             nimble_port_get_dflt_eventq(),
+                             ble_store_config_flush_timer_exp, NULL);
+#endif
+        ble_gap_event_listener_register(&ble_store_config_gap_listener,
+                                        ble_store_config_gap_event, NULL);
+        ble_store_config_started = true;
+    }
+}
+
+/**
+ * Commits any pending changes and releases the flush timer. Must be called
+ * after the host is stopped and before the port is de-initialized.
+ */
+void
+ble_store_config_deinit(void)
+{
+    if (!ble_store_config_started) {
+        return;
+    }
+
+#if MYNEWT_VAL(BLE_STORE_CONFIG_PERSIST) && MYNEWT_VAL(BLE_STORE_CONFIG_FLUSH_DELAY_MS)
+    ble_npl_callout_stop(&ble_store_config_flush_timer);
+    ble_store_config_flush();
+    ble_npl_callout_deinit(&ble_store_config_flush_timer);
+#endif
+    ble_gap_event_listener_unregister(&ble_store_config_gap_listener);
+    ble_store_config_started = false;
 }
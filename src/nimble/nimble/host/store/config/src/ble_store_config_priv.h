@@ -24,12 +24,37 @@
 extern "C" {
 #endif
 
+/* Lazy loading keeps only a directory of the security records in RAM and
+ * reads the records themselves from NVS on demand. Only the ESP32 NVS backend
+ * stores one record per key, so it is the only one that supports it.
+ */
+#if MYNEWT_VAL(BLE_STORE_CONFIG_LAZY_LOAD) && MYNEWT_VAL(BLE_STORE_CONFIG_PERSIST) && \
+    MYNEWT_VAL(BLE_STORE_MAX_BONDS) && defined(ESP_PLATFORM)
+#define BLE_STORE_CONFIG_LAZY 1
+#else
+#define BLE_STORE_CONFIG_LAZY 0
+#endif
+
+#if BLE_STORE_CONFIG_LAZY
+/** Resident directory entry for a security record stored in NVS. */
+struct ble_store_config_sec_dir {
+    ble_addr_t peer_addr;
+    uint16_t bond_count;
+    /** NVS key index of the record, 1 based. */
+    uint16_t nvs_idx;
+};
+
+extern struct ble_store_config_sec_dir
+    ble_store_config_our_sec_dirs[MYNEWT_VAL(BLE_STORE_MAX_BONDS)];
+extern struct ble_store_config_sec_dir
+    ble_store_config_peer_sec_dirs[MYNEWT_VAL(BLE_STORE_MAX_BONDS)];
+#else
 extern struct ble_store_value_sec
     ble_store_config_our_secs[MYNEWT_VAL(BLE_STORE_MAX_BONDS)];
-extern int ble_store_config_num_our_secs;
-
 extern struct ble_store_value_sec
     ble_store_config_peer_secs[MYNEWT_VAL(BLE_STORE_MAX_BONDS)];
+#endif
+extern int ble_store_config_num_our_secs;
 extern int ble_store_config_num_peer_secs;
 
 extern struct ble_store_value_cccd
@@ -64,12 +89,21 @@ int ble_store_config_persist_csfcs(void);
 int ble_restore_our_sec_nvs(void);
 int ble_restore_peer_sec_nvs(void);
 #endif
+#if MYNEWT_VAL(BLE_STORE_MAX_BONDS) && !BLE_STORE_CONFIG_LAZY
+int ble_store_config_persist_sec_order(void);
+#endif
 #if MYNEWT_VAL(ENC_ADV_DATA)
 int ble_store_config_persist_eads(void);
 #endif
 int ble_store_config_persist_rpa_recs(void);
 int ble_store_config_persist_local_irk(void);
 void ble_store_config_conf_init(void);
+#if BLE_STORE_CONFIG_LAZY
+int ble_store_config_nvs_read_sec(int obj_type, uint16_t nvs_idx,
+                                  struct ble_store_value_sec *value_sec);
+int ble_store_config_nvs_update_sec(int obj_type, uint16_t nvs_idx,
+                                    const struct ble_store_value_sec *value_sec);
+#endif
 
 #else
 
@@ -77,6 +111,7 @@ static inline int ble_store_config_persist_our_secs(void)   { return 0; }
 static inline int ble_store_config_persist_peer_secs(void)  { return 0; }
 static inline int ble_store_config_persist_cccds(void)      { return 0; }
 static inline int ble_store_config_persist_csfcs(void)      { return 0; }
+static inline int ble_store_config_persist_sec_order(void)  { return 0; }
 #if MYNEWT_VAL(ENC_ADV_DATA)
 static inline int ble_store_config_persist_eads(void)       { return 0; }
 #endif
@@ -39,6 +39,10 @@
 #define NIMBLE_NVS_STR_NAME_MAX_LEN              16
 #define NIMBLE_NVS_PEER_SEC_KEY                  "peer_sec"
 #define NIMBLE_NVS_OUR_SEC_KEY                   "our_sec"
+#define NIMBLE_NVS_PEER_SEC_DIR_KEY              "peer_sec_dir"
+#define NIMBLE_NVS_OUR_SEC_DIR_KEY               "our_sec_dir"
+#define NIMBLE_NVS_PEER_SEC_ORDER_KEY            "peer_sec_lru"
+#define NIMBLE_NVS_OUR_SEC_ORDER_KEY             "our_sec_lru"
 #define NIMBLE_NVS_CCCD_SEC_KEY                  "cccd_sec"
 #define NIMBLE_NVS_CSFC_SEC_KEY                  "csfc_sec"
 #define NIMBLE_NVS_PEER_RECORDS_KEY              "p_dev_rec"
@@ -104,6 +108,7 @@ get_nvs_key_string(int obj_type, int index, char *key_string)
     }
 }
 
+#if MYNEWT_VAL(BLE_HOST_BASED_PRIVACY)
 /* compares values at two addresses of size = item_size
 * @Returns               index if entries match
 *                       -1 if mismatch
@@ -124,6 +129,7 @@ get_nvs_matching_index(void *nvs_val, void *db_list, int db_num, size_t
     }
     return -1;
 }
+#endif
 
 static int
 get_nvs_max_obj_value(int obj_type)
@@ -146,6 +152,72 @@ get_nvs_max_obj_value(int obj_type)
     }
 }
 
+#define NIMBLE_NVS_MAX(a, b)                    ((a) > (b) ? (a) : (b))
+#define NIMBLE_NVS_MAX_ITEMS                                                  \
+    NIMBLE_NVS_MAX(NIMBLE_NVS_MAX(MYNEWT_VAL(BLE_STORE_MAX_CCCDS),            \
+                                  MYNEWT_VAL(BLE_STORE_MAX_CSFCS)),           \
+                   NIMBLE_NVS_MAX(MYNEWT_VAL(BLE_STORE_MAX_EADS),             \
+                                  MYNEWT_VAL(BLE_STORE_MAX_BONDS) + 1))
+#define NIMBLE_NVS_ITEM_MAP_SZ                  ((NIMBLE_NVS_MAX_ITEMS + 8) / 8)
+
+/* RAM copy of the hash of the record stored at each NVS index of a record
+* set, and of the key identifying it, so syncing a set only reads back the
+* records that look unchanged. Index i is at hash[i], key[i] and bit i of used.
+*/
+struct ble_store_nvs_map {
+    uint32_t *hash;
+    uint32_t *key;
+    uint8_t *used;
+    uint8_t loaded;
+};
+
+#define NIMBLE_NVS_MAP_DEFINE(name, max)                                      \
+    static uint32_t name##_hash[(max) + 1];                                   \
+    static uint32_t name##_key[(max) + 1];                                    \
+    static uint8_t name##_used[((max) + 8) / 8];                              \
+    static struct ble_store_nvs_map name = {                                  \
+        name##_hash, name##_key, name##_used, 0                               \
+    }
+
+NIMBLE_NVS_MAP_DEFINE(nvs_map_our_sec, MYNEWT_VAL(BLE_STORE_MAX_BONDS));
+NIMBLE_NVS_MAP_DEFINE(nvs_map_peer_sec, MYNEWT_VAL(BLE_STORE_MAX_BONDS));
+NIMBLE_NVS_MAP_DEFINE(nvs_map_cccd, MYNEWT_VAL(BLE_STORE_MAX_CCCDS));
+NIMBLE_NVS_MAP_DEFINE(nvs_map_csfc, MYNEWT_VAL(BLE_STORE_MAX_CSFCS));
+#if MYNEWT_VAL(ENC_ADV_DATA)
+NIMBLE_NVS_MAP_DEFINE(nvs_map_ead, MYNEWT_VAL(BLE_STORE_MAX_EADS));
+#endif
+NIMBLE_NVS_MAP_DEFINE(nvs_map_local_irk, MYNEWT_VAL(BLE_STORE_MAX_BONDS));
+NIMBLE_NVS_MAP_DEFINE(nvs_map_rpa_rec, MYNEWT_VAL(BLE_STORE_MAX_BONDS));
+
+static struct ble_store_nvs_map *
+get_nvs_map(int obj_type)
+{
+    switch (obj_type) {
+    case BLE_STORE_OBJ_TYPE_OUR_SEC:
+        return &nvs_map_our_sec;
+    case BLE_STORE_OBJ_TYPE_PEER_SEC:
+        return &nvs_map_peer_sec;
+    case BLE_STORE_OBJ_TYPE_CCCD:
+        return &nvs_map_cccd;
+    case BLE_STORE_OBJ_TYPE_CSFC:
+        return &nvs_map_csfc;
+#if MYNEWT_VAL(ENC_ADV_DATA)
+    case BLE_STORE_OBJ_TYPE_ENC_ADV_DATA:
+        return &nvs_map_ead;
+#endif
+    case BLE_STORE_OBJ_TYPE_LOCAL_IRK:
+        return &nvs_map_local_irk;
+    case BLE_STORE_OBJ_TYPE_PEER_ADDR:
+        return &nvs_map_rpa_rec;
+    default:
+        return NULL;
+    }
+}
+
+#define NIMBLE_NVS_MAP_TEST(bits, i)            ((bits)[(i) / 8] & (1 << ((i) % 8)))
+#define NIMBLE_NVS_MAP_SET(bits, i)             ((bits)[(i) / 8] |= 1 << ((i) % 8))
+#define NIMBLE_NVS_MAP_CLR(bits, i)             ((bits)[(i) / 8] &= ~(1 << ((i) % 8)))
+
 /*****************************************************************************
  * $ NVS                                                                     *
  *****************************************************************************/
@@ -228,6 +300,7 @@ end:
     return err;
 }
 
+#if MYNEWT_VAL(BLE_HOST_BASED_PRIVACY)
 /* Finds empty index or total count or index to be deleted in NVS database
 * This function serves 3 different purposes depending upon 'empty' and `value`
 * arguments.
@@ -322,7 +395,9 @@ get_nvs_db_attribute(int obj_type, bool empty, void *value, int num_value)
         return (max_limit + 1);
     }
 }
+#endif
 
+#if MYNEWT_VAL(BLE_HOST_BASED_PRIVACY)
 /* Deletes NVS value at given index
 * @Returns               0 on success,
 *                       -1 on NVS memory access failure
@@ -363,7 +438,9 @@ error:
     nvs_close(nimble_handle);
     return BLE_HS_ESTORE_FAIL;
 }
+#endif
 
+#if MYNEWT_VAL(BLE_HOST_BASED_PRIVACY)
 static int
 ble_nvs_write_key_value(char *key, const void *value, size_t required_size)
 {
@@ -395,55 +472,290 @@ error:
     nvs_close(nimble_handle);
     return BLE_HS_ESTORE_FAIL;
 }
+#endif
+
+static uint32_t
+get_nvs_item_hash(const void *item, size_t item_size)
+{
+    const uint8_t *u8p = item;
+    uint32_t hash = 2166136261u;
+    size_t i;
+
+    for (i = 0; i < item_size; i++) {
+        hash = (hash ^ u8p[i]) * 16777619u;
+    }
+
+    return hash;
+}
+
+/* Hashes the part of a record that identifies it. Every record type starts
+* with the address of the peer it belongs to, CCCDs are per characteristic.
+*/
+static uint32_t
+get_nvs_item_key_hash(int obj_type, const void *item)
+{
+    const struct ble_store_value_cccd *cccd;
+    uint32_t hash;
+
+    hash = get_nvs_item_hash(item, sizeof(ble_addr_t));
+    if (obj_type == BLE_STORE_OBJ_TYPE_CCCD) {
+        cccd = item;
+        hash = (hash ^ cccd->chr_val_handle) * 16777619u;
+    }
+
+    return hash;
+}
+
+/* Tests if the record stored at an NVS index is identical to a RAM record,
+* a read failure counts as a difference so the record is written again.
+*/
+static bool
+ble_store_nvs_item_equal(nvs_handle_t nimble_handle, int obj_type, int index,
+                         const void *item, size_t item_size)
+{
+    char key_string[NIMBLE_NVS_STR_NAME_MAX_LEN];
+    union ble_store_value cur;
+    size_t cur_size;
+
+    get_nvs_key_string(obj_type, index, key_string);
+    cur_size = sizeof cur;
+    if (nvs_get_blob(nimble_handle, key_string, &cur, &cur_size) != ESP_OK) {
+        return false;
+    }
+
+    return cur_size == item_size && memcmp(&cur, item, item_size) == 0;
+}
+
+/* Fills the index map of a record set from the records stored in NVS.
+* Stored records of the wrong size are mapped with a hash that can not match
+* so they are replaced or erased by the next sync.
+* @Returns              0 if success
+*                       BLE_HS_ESTORE_FAIL if failure
+*/
+static int
+ble_store_nvs_map_load(nvs_handle_t nimble_handle, int obj_type,
+                       struct ble_store_nvs_map *map, size_t item_size)
+{
+    char key_string[NIMBLE_NVS_STR_NAME_MAX_LEN];
+    union ble_store_value cur;
+    size_t cur_size;
+    esp_err_t err;
+    int max_limit;
+    int i;
+
+    max_limit = get_nvs_max_obj_value(obj_type);
+    memset(map->used, 0, (max_limit + 8) / 8);
+
+    for (i = 1; i <= max_limit; i++) {
+        get_nvs_key_string(obj_type, i, key_string);
+        cur_size = sizeof cur;
+        err = nvs_get_blob(nimble_handle, key_string, &cur, &cur_size);
+        if (err == ESP_ERR_NVS_NOT_FOUND) {
+            continue;
+        } else if (err != ESP_OK && err != ESP_ERR_NVS_INVALID_LENGTH) {
+            ESP_LOGE(LOG_TAG, "NVS read operation failed !!");
+            return BLE_HS_ESTORE_FAIL;
+        }
+
+        if (err == ESP_OK && cur_size == item_size) {
+            map->hash[i] = get_nvs_item_hash(&cur, item_size);
+            map->key[i] = get_nvs_item_key_hash(obj_type, &cur);
+        } else {
+            map->hash[i] = get_nvs_item_hash(&cur, 0) ^ 1;
+            map->key[i] = 0;
+        }
+        NIMBLE_NVS_MAP_SET(map->used, i);
+    }
+
+    map->loaded = 1;
+    return 0;
+}
 
-/* To write key value in NVS.
+/* Serializes the syncs of the application task, which flushes pending
+* changes when a bond is deleted, with those of the host task.
+*/
+static struct ble_npl_mutex ble_store_nvs_mutex;
+static bool ble_store_nvs_mutex_ready;
+
+/* Brings the NVS copy of a record set in line with the RAM database in a
+* single commit. Records are matched against the index map of the set, so
+* NVS is only read in full the first time a set is synced if it was not
+* loaded at init. A stored record whose hash matches is read back and
+* compared before it is kept, so a hash collision can not hide a change.
+*
+* A modified record is written over the stale copy with the same key, which
+* NVS replaces atomically, new records go to free indexes and the remaining
+* stale records are erased only once all writes succeeded. A power loss can
+* leave a deleted record in place but never two copies of one record.
 * @Returns              0 if success
 *                       BLE_HS_ESTORE_FAIL if failure
 *                       BLE_HS_ESTORE_CAP if no space in NVS
 */
 static int
-ble_store_nvs_write(int obj_type, const union ble_store_value *val)
+ble_store_nvs_sync_locked(int obj_type, const void *db_list, int db_num,
+                          size_t item_size)
 {
+    uint8_t db_synced[NIMBLE_NVS_ITEM_MAP_SZ] = {0};
+    uint8_t nvs_keep[NIMBLE_NVS_ITEM_MAP_SZ] = {0};
+    static uint32_t db_hash[NIMBLE_NVS_MAX_ITEMS];
     char key_string[NIMBLE_NVS_STR_NAME_MAX_LEN];
-    int8_t write_key_index = 0;
+    struct ble_store_nvs_map *map;
+    const uint8_t *db_item;
+    nvs_handle_t nimble_handle;
+    bool changed = false;
+    uint32_t db_key;
+    esp_err_t err;
+    int max_limit;
+    int free_idx;
+    int stale;
+    int idx;
+    int i, j;
+    int rc;
+
+    map = get_nvs_map(obj_type);
+    if (map == NULL) {
+        return BLE_HS_EINVAL;
+    }
 
-    write_key_index = get_nvs_db_attribute(obj_type, 1, NULL, 0);
-    if (write_key_index == -1) {
-        ESP_LOGE(LOG_TAG, "NVS operation failed !!");
+    max_limit = get_nvs_max_obj_value(obj_type);
+
+    err = nvs_open(NIMBLE_NVS_NAMESPACE, NVS_READWRITE, &nimble_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(LOG_TAG, "NVS open operation failed !!");
         return BLE_HS_ESTORE_FAIL;
-    } else if (write_key_index > get_nvs_max_obj_value(obj_type)) {
+    }
 
-        /* bare-bone config code will take care of capacity overflow event,
-         * however another check added for consistency */
-        ESP_LOGD(LOG_TAG, "NVS size overflow.");
-        return BLE_HS_ESTORE_CAP;
+    if (!map->loaded) {
+        rc = ble_store_nvs_map_load(nimble_handle, obj_type, map, item_size);
+        if (rc != 0) {
+            nvs_close(nimble_handle);
+            return rc;
+        }
     }
 
-    get_nvs_key_string(obj_type, write_key_index, key_string);
+    /* Match the RAM database against the stored records */
+    db_item = (const uint8_t *)db_list;
+    for (j = 0; j < db_num; j++, db_item += item_size) {
+        db_hash[j] = get_nvs_item_hash(db_item, item_size);
+        for (i = 1; i <= max_limit; i++) {
+            if (NIMBLE_NVS_MAP_TEST(map->used, i) &&
+                !NIMBLE_NVS_MAP_TEST(nvs_keep, i) &&
+                map->hash[i] == db_hash[j] &&
+                ble_store_nvs_item_equal(nimble_handle, obj_type, i,
+                                         db_item, item_size)) {
+                NIMBLE_NVS_MAP_SET(nvs_keep, i);
+                NIMBLE_NVS_MAP_SET(db_synced, j);
+                break;
+            }
+        }
+    }
 
-    if (obj_type == BLE_STORE_OBJ_TYPE_CCCD) {
-        return ble_nvs_write_key_value(key_string, &val->cccd, sizeof(struct
-                                       ble_store_value_cccd));
-    } else if (obj_type == BLE_STORE_OBJ_TYPE_CSFC) {
-        return ble_nvs_write_key_value(key_string, &val->csfc, sizeof(struct
-                                       ble_store_value_csfc));
-#if MYNEWT_VAL(ENC_ADV_DATA)
-    } else if (obj_type == BLE_STORE_OBJ_TYPE_ENC_ADV_DATA) {
-        return ble_nvs_write_key_value(key_string, &val->ead, sizeof(struct
-                                       ble_store_value_ead));
-#endif
-    } else if (obj_type == BLE_STORE_OBJ_TYPE_LOCAL_IRK) {
-        return ble_nvs_write_key_value(key_string, &val->local_irk, sizeof(struct
-                                   ble_store_value_local_irk));
+    /* Write the new and modified records, over the stale copy of the same
+     * record if there is one, else to a free index, else over any stale
+     * record */
+    free_idx = 1;
+    stale = 1;
+    db_item = (const uint8_t *)db_list;
+    for (j = 0; j < db_num; j++, db_item += item_size) {
+        if (NIMBLE_NVS_MAP_TEST(db_synced, j)) {
+            continue;
+        }
 
-    } else if (obj_type == BLE_STORE_OBJ_TYPE_PEER_ADDR) {
-        return ble_nvs_write_key_value(key_string, &val->rpa_rec, sizeof(struct
-                                       ble_store_value_rpa_rec));
+        db_key = get_nvs_item_key_hash(obj_type, db_item);
+        for (idx = 1; idx <= max_limit; idx++) {
+            if (NIMBLE_NVS_MAP_TEST(map->used, idx) &&
+                !NIMBLE_NVS_MAP_TEST(nvs_keep, idx) &&
+                map->key[idx] == db_key) {
+                break;
+            }
+        }
 
-    } else {
-        return ble_nvs_write_key_value(key_string, &val->sec, sizeof(struct
-                                       ble_store_value_sec));
+        if (idx > max_limit) {
+            while (free_idx <= max_limit &&
+                   NIMBLE_NVS_MAP_TEST(map->used, free_idx)) {
+                free_idx++;
+            }
+            idx = free_idx;
+        }
+
+        if (idx > max_limit) {
+            while (stale <= max_limit && NIMBLE_NVS_MAP_TEST(nvs_keep, stale)) {
+                stale++;
+            }
+
+            if (stale > max_limit) {
+                /* bare-bone config code will take care of capacity overflow
+                 * event, however another check added for consistency */
+                ESP_LOGD(LOG_TAG, "NVS size overflow.");
+                nvs_commit(nimble_handle);
+                nvs_close(nimble_handle);
+                return BLE_HS_ESTORE_CAP;
+            }
+            idx = stale;
+        }
+
+        ESP_LOGD(LOG_TAG, "Persisting obj_type = %d, nvs idx = %d", obj_type, idx);
+        get_nvs_key_string(obj_type, idx, key_string);
+        err = nvs_set_blob(nimble_handle, key_string, db_item, item_size);
+        if (err != ESP_OK) {
+            ESP_LOGE(LOG_TAG, "NVS write operation failed !!");
+            goto error;
+        }
+
+        map->hash[idx] = db_hash[j];
+        map->key[idx] = db_key;
+        NIMBLE_NVS_MAP_SET(map->used, idx);
+        NIMBLE_NVS_MAP_SET(nvs_keep, idx);
+        changed = true;
+    }
+
+    /* All records are stored, erase the stale ones */
+    for (i = 1; i <= max_limit; i++) {
+        if (!NIMBLE_NVS_MAP_TEST(map->used, i) ||
+            NIMBLE_NVS_MAP_TEST(nvs_keep, i)) {
+            continue;
+        }
+
+        ESP_LOGD(LOG_TAG, "Deleting obj_type = %d, nvs idx = %d", obj_type, i);
+        get_nvs_key_string(obj_type, i, key_string);
+        err = nvs_erase_key(nimble_handle, key_string);
+        if (err != ESP_OK && err != ESP_ERR_NVS_NOT_FOUND) {
+            goto error;
+        }
+        NIMBLE_NVS_MAP_CLR(map->used, i);
+        changed = true;
     }
+
+    if (changed) {
+        err = nvs_commit(nimble_handle);
+        if (err != ESP_OK) {
+            ESP_LOGE(LOG_TAG, "NVS commit operation failed !!");
+            goto error;
+        }
+    }
+
+    nvs_close(nimble_handle);
+    return 0;
+error:
+    nvs_close(nimble_handle);
+    return BLE_HS_ESTORE_FAIL;
+}
+
+static int
+ble_store_nvs_sync(int obj_type, const void *db_list, int db_num,
+                   size_t item_size)
+{
+    int rc;
+
+    if (!ble_store_nvs_mutex_ready) {
+        return ble_store_nvs_sync_locked(obj_type, db_list, db_num, item_size);
+    }
+
+    ble_npl_mutex_pend(&ble_store_nvs_mutex, BLE_NPL_TIME_FOREVER);
+    rc = ble_store_nvs_sync_locked(obj_type, db_list, db_num, item_size);
+    ble_npl_mutex_release(&ble_store_nvs_mutex);
+
+    return rc;
 }
 
 #if MYNEWT_VAL(BLE_HOST_BASED_PRIVACY)
@@ -473,10 +785,372 @@ ble_store_nvs_peer_records(int obj_type, const struct ble_hs_dev_records *p_dev_
 }
 #endif
 
+#if BLE_STORE_CONFIG_LAZY
+static const char *
+get_nvs_sec_dir(int obj_type, struct ble_store_config_sec_dir **dirs,
+                int **num_dirs)
+{
+    if (obj_type == BLE_STORE_OBJ_TYPE_OUR_SEC) {
+        *dirs = ble_store_config_our_sec_dirs;
+        *num_dirs = &ble_store_config_num_our_secs;
+        return NIMBLE_NVS_OUR_SEC_DIR_KEY;
+    }
+
+    *dirs = ble_store_config_peer_sec_dirs;
+    *num_dirs = &ble_store_config_num_peer_secs;
+    return NIMBLE_NVS_PEER_SEC_DIR_KEY;
+}
+
+static int
+ble_store_nvs_compare_sec_dir(const void *a, const void *b)
+{
+    const struct ble_store_config_sec_dir *dir_a = a;
+    const struct ble_store_config_sec_dir *dir_b = b;
+
+    return dir_a->bond_count - dir_b->bond_count;
+}
+
+/* Reads a single security record from its NVS slot.
+* @Returns              0 if success
+*                       BLE_HS_ENOENT if the slot is empty
+*                       BLE_HS_ESTORE_FAIL if failure
+*/
+int
+ble_store_config_nvs_read_sec(int obj_type, uint16_t nvs_idx,
+                              struct ble_store_value_sec *value_sec)
+{
+    char key_string[NIMBLE_NVS_STR_NAME_MAX_LEN];
+    nvs_handle_t nimble_handle;
+    size_t required_size;
+    esp_err_t err;
+
+    err = nvs_open(NIMBLE_NVS_NAMESPACE, NVS_READONLY, &nimble_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(LOG_TAG, "NVS open operation failed");
+        return BLE_HS_ESTORE_FAIL;
+    }
+
+    get_nvs_key_string(obj_type, nvs_idx, key_string);
+    required_size = sizeof *value_sec;
+    err = nvs_get_blob(nimble_handle, key_string, value_sec, &required_size);
+    nvs_close(nimble_handle);
+
+    if (err == ESP_ERR_NVS_NOT_FOUND) {
+        ESP_LOGE(LOG_TAG, "Missing record obj_type = %d, nvs idx = %d",
+                 obj_type, nvs_idx);
+        return BLE_HS_ENOENT;
+    } else if (err != ESP_OK || required_size != sizeof *value_sec) {
+        ESP_LOGE(LOG_TAG, "NVS read operation failed !!");
+        return BLE_HS_ESTORE_FAIL;
+    }
+
+    return 0;
+}
+
+/* Writes or erases (value_sec == NULL) the record in an NVS slot, if nvs_idx
+* is not 0, and the directory of the record set in a single commit.
+* @Returns              0 if success
+*                       BLE_HS_ESTORE_FAIL if failure
+*/
+int
+ble_store_config_nvs_update_sec(int obj_type, uint16_t nvs_idx,
+                                const struct ble_store_value_sec *value_sec)
+{
+    char key_string[NIMBLE_NVS_STR_NAME_MAX_LEN];
+    struct ble_store_config_sec_dir *dirs;
+    nvs_handle_t nimble_handle;
+    const char *dir_key;
+    int *num_dirs;
+    esp_err_t err;
+
+    err = nvs_open(NIMBLE_NVS_NAMESPACE, NVS_READWRITE, &nimble_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(LOG_TAG, "NVS open operation failed !!");
+        return BLE_HS_ESTORE_FAIL;
+    }
+
+    if (nvs_idx != 0) {
+        get_nvs_key_string(obj_type, nvs_idx, key_string);
+        if (value_sec != NULL) {
+            ESP_LOGD(LOG_TAG, "Persisting obj_type = %d, nvs idx = %d", obj_type, nvs_idx);
+            err = nvs_set_blob(nimble_handle, key_string, value_sec,
+                               sizeof *value_sec);
+        } else {
+            ESP_LOGD(LOG_TAG, "Deleting obj_type = %d, nvs idx = %d", obj_type, nvs_idx);
+            err = nvs_erase_key(nimble_handle, key_string);
+            if (err == ESP_ERR_NVS_NOT_FOUND) {
+                err = ESP_OK;
+            }
+        }
+
+        if (err != ESP_OK) {
+            goto error;
+        }
+    }
+
+    dir_key = get_nvs_sec_dir(obj_type, &dirs, &num_dirs);
+    if (*num_dirs > 0) {
+        err = nvs_set_blob(nimble_handle, dir_key, dirs,
+                           *num_dirs * sizeof *dirs);
+    } else {
+        err = nvs_erase_key(nimble_handle, dir_key);
+        if (err == ESP_ERR_NVS_NOT_FOUND) {
+            err = ESP_OK;
+        }
+    }
+
+    if (err != ESP_OK) {
+        goto error;
+    }
+
+    err = nvs_commit(nimble_handle);
+    if (err != ESP_OK) {
+        goto error;
+    }
+
+    nvs_close(nimble_handle);
+    return 0;
+error:
+    ESP_LOGE(LOG_TAG, "NVS write operation failed !!");
+    nvs_close(nimble_handle);
+    return BLE_HS_ESTORE_FAIL;
+}
+
+/* Loads the directory of a security record set. If there is no directory, or
+* it does not match the configured capacity, it is rebuilt once from the
+* stored records so bonds created without lazy loading are kept.
+*/
+static int
+ble_nvs_restore_sec_dir(int obj_type)
+{
+    char key_string[NIMBLE_NVS_STR_NAME_MAX_LEN];
+    struct ble_store_config_sec_dir *dirs;
+    struct ble_store_value_sec sec;
+    nvs_handle_t nimble_handle;
+    const char *dir_key;
+    size_t required_size;
+    int *num_dirs;
+    int num_stored;
+    esp_err_t err;
+    int i;
+
+    dir_key = get_nvs_sec_dir(obj_type, &dirs, &num_dirs);
+    *num_dirs = 0;
+
+    err = nvs_open(NIMBLE_NVS_NAMESPACE, NVS_READWRITE, &nimble_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(LOG_TAG, "NVS open operation failed");
+        return BLE_HS_ESTORE_FAIL;
+    }
+
+    required_size = MYNEWT_VAL(BLE_STORE_MAX_BONDS) * sizeof *dirs;
+    err = nvs_get_blob(nimble_handle, dir_key, dirs, &required_size);
+    if (err == ESP_OK && required_size % sizeof *dirs == 0) {
+        num_stored = required_size / sizeof *dirs;
+        for (i = 0; i < num_stored; i++) {
+            if (dirs[i].nvs_idx == 0 ||
+                dirs[i].nvs_idx > MYNEWT_VAL(BLE_STORE_MAX_BONDS)) {
+                break;
+            }
+        }
+
+        if (i == num_stored) {
+            *num_dirs = num_stored;
+            nvs_close(nimble_handle);
+            return 0;
+        }
+    } else if (err != ESP_ERR_NVS_NOT_FOUND &&
+               err != ESP_ERR_NVS_INVALID_LENGTH) {
+        ESP_LOGE(LOG_TAG, "NVS read operation failed !!");
+        goto error;
+    }
+
+    ESP_LOGD(LOG_TAG, "Building bond directory obj_type = %d", obj_type);
+    for (i = 1; i <= MYNEWT_VAL(BLE_STORE_MAX_BONDS); i++) {
+        get_nvs_key_string(obj_type, i, key_string);
+        required_size = sizeof sec;
+        err = nvs_get_blob(nimble_handle, key_string, &sec, &required_size);
+        if (err == ESP_ERR_NVS_NOT_FOUND) {
+            continue;
+        } else if (err != ESP_OK) {
+            ESP_LOGE(LOG_TAG, "NVS read operation failed !!");
+            goto error;
+        }
+
+        dirs[*num_dirs].peer_addr = sec.peer_addr;
+        dirs[*num_dirs].bond_count = sec.bond_count;
+        dirs[*num_dirs].nvs_idx = i;
+        (*num_dirs)++;
+    }
+
+    qsort(dirs, *num_dirs, sizeof *dirs, ble_store_nvs_compare_sec_dir);
+
+    if (*num_dirs > 0) {
+        err = nvs_set_blob(nimble_handle, dir_key, dirs,
+                           *num_dirs * sizeof *dirs);
+        if (err == ESP_OK) {
+            err = nvs_commit(nimble_handle);
+        }
+
+        if (err != ESP_OK) {
+            ESP_LOGE(LOG_TAG, "NVS write operation failed !!");
+            goto error;
+        }
+    }
+
+    nvs_close(nimble_handle);
+    return 0;
+error:
+    *num_dirs = 0;
+    nvs_close(nimble_handle);
+    return BLE_HS_ESTORE_FAIL;
+}
+#elif MYNEWT_VAL(BLE_STORE_MAX_BONDS)
+/* A directory left behind by a build with lazy loading enabled would be stale
+* once the record sets are modified here, drop it so it gets rebuilt.
+*/
+static void
+ble_nvs_drop_sec_dirs(void)
+{
+    nvs_handle_t nimble_handle;
+    esp_err_t err;
+
+    err = nvs_open(NIMBLE_NVS_NAMESPACE, NVS_READWRITE, &nimble_handle);
+    if (err != ESP_OK) {
+        return;
+    }
+
+    err = nvs_erase_key(nimble_handle, NIMBLE_NVS_OUR_SEC_DIR_KEY);
+    if (nvs_erase_key(nimble_handle, NIMBLE_NVS_PEER_SEC_DIR_KEY) == ESP_OK ||
+        err == ESP_OK) {
+        nvs_commit(nimble_handle);
+    }
+
+    nvs_close(nimble_handle);
+}
+
+/* The security records are kept in least recently connected order, which is
+* stored as the list of their peer addresses in a record of its own so that a
+* reconnect does not rewrite any keys. Only used under ble_store_nvs_mutex or
+* at init.
+*/
+static ble_addr_t ble_store_nvs_sec_order[MYNEWT_VAL(BLE_STORE_MAX_BONDS)];
+
+static const char *
+ble_nvs_sec_order_key(int obj_type, struct ble_store_value_sec **out_secs,
+                      int **out_num)
+{
+    if (obj_type == BLE_STORE_OBJ_TYPE_OUR_SEC) {
+        *out_secs = ble_store_config_our_secs;
+        *out_num = &ble_store_config_num_our_secs;
+        return NIMBLE_NVS_OUR_SEC_ORDER_KEY;
+    }
+
+    *out_secs = ble_store_config_peer_secs;
+    *out_num = &ble_store_config_num_peer_secs;
+    return NIMBLE_NVS_PEER_SEC_ORDER_KEY;
+}
+
+static int
+ble_nvs_write_sec_order(int obj_type)
+{
+    struct ble_store_value_sec *secs;
+    nvs_handle_t nimble_handle;
+    const char *key;
+    esp_err_t err;
+    int *num;
+    int i;
+
+    key = ble_nvs_sec_order_key(obj_type, &secs, &num);
+    for (i = 0; i < *num; i++) {
+        ble_store_nvs_sec_order[i] = secs[i].peer_addr;
+    }
+
+    err = nvs_open(NIMBLE_NVS_NAMESPACE, NVS_READWRITE, &nimble_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(LOG_TAG, "NVS open operation failed !!");
+        return BLE_HS_ESTORE_FAIL;
+    }
+
+    if (*num == 0) {
+        err = nvs_erase_key(nimble_handle, key);
+        if (err == ESP_ERR_NVS_NOT_FOUND) {
+            err = ESP_OK;
+        }
+    } else {
+        err = nvs_set_blob(nimble_handle, key, ble_store_nvs_sec_order,
+                           *num * sizeof(ble_addr_t));
+    }
+
+    if (err == ESP_OK) {
+        err = nvs_commit(nimble_handle);
+    }
+
+    nvs_close(nimble_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(LOG_TAG, "NVS write operation failed !!");
+        return BLE_HS_ESTORE_FAIL;
+    }
+
+    return 0;
+}
+
+/* Reorders the security records loaded in bond_count order by the stored
+* connection order. Records missing from it were written after it was last
+* stored and are kept at the most recent end.
+*/
+static void
+ble_nvs_restore_sec_order(int obj_type)
+{
+    struct ble_store_value_sec *secs;
+    struct ble_store_value_sec sec;
+    nvs_handle_t nimble_handle;
+    size_t size;
+    const char *key;
+    esp_err_t err;
+    int placed;
+    int *num;
+    int i, j;
+
+    key = ble_nvs_sec_order_key(obj_type, &secs, &num);
+
+    err = nvs_open(NIMBLE_NVS_NAMESPACE, NVS_READONLY, &nimble_handle);
+    if (err != ESP_OK) {
+        return;
+    }
+
+    size = sizeof ble_store_nvs_sec_order;
+    err = nvs_get_blob(nimble_handle, key, ble_store_nvs_sec_order, &size);
+    nvs_close(nimble_handle);
+    if (err != ESP_OK) {
+        return;
+    }
+
+    placed = 0;
+    for (i = 0; i < (int)(size / sizeof(ble_addr_t)); i++) {
+        for (j = placed; j < *num; j++) {
+            if (ble_addr_cmp(&secs[j].peer_addr, &ble_store_nvs_sec_order[i]) == 0) {
+                break;
+            }
+        }
+
+        if (j == *num) {
+            continue;
+        }
+
+        sec = secs[j];
+        memmove(&secs[placed + 1], &secs[placed], (j - placed) * sizeof sec);
+        secs[placed++] = sec;
+    }
+}
+#endif
+
 static int
 populate_db_from_nvs(int obj_type, void *dst, int *db_num)
 {
+    struct ble_store_nvs_map *map = get_nvs_map(obj_type);
     uint8_t *db_item = (uint8_t *)dst;
+    uint8_t *prev_item;
     union ble_store_value cur = {0};
 #if MYNEWT_VAL(BLE_HOST_BASED_PRIVACY)
     struct ble_hs_dev_records p_dev_rec = {0};
@@ -486,8 +1160,13 @@ populate_db_from_nvs(int obj_type, void *dst, int *db_num)
     int i;
     char key_string[NIMBLE_NVS_STR_NAME_MAX_LEN];
 
+    if (map != NULL) {
+        memset(map->used, 0, (get_nvs_max_obj_value(obj_type) + 8) / 8);
+    }
+
     for (i = 1; i <= get_nvs_max_obj_value(obj_type); i++) {
         get_nvs_key_string(obj_type, i, key_string);
+        prev_item = db_item;
 
 #if MYNEWT_VAL(BLE_HOST_BASED_PRIVACY)
         if (obj_type != BLE_STORE_OBJ_TYPE_PEER_DEV_REC) {
@@ -554,6 +1233,16 @@ populate_db_from_nvs(int obj_type, void *dst, int *db_num)
                 (*db_num)++;
             }
         }
+
+        if (map != NULL && db_item != prev_item) {
+            map->hash[i] = get_nvs_item_hash(prev_item, db_item - prev_item);
+            map->key[i] = get_nvs_item_key_hash(obj_type, prev_item);
+            NIMBLE_NVS_MAP_SET(map->used, i);
+        }
+    }
+
+    if (map != NULL) {
+        map->loaded = 1;
     }
     return 0;
 }
@@ -565,12 +1254,36 @@ static int
 ble_nvs_restore_sec_keys(void)
 {
     esp_err_t err;
+#if MYNEWT_VAL(BLE_STORE_MAX_BONDS) && !BLE_STORE_CONFIG_LAZY
     int flag = 0;
+#endif
     extern uint16_t ble_store_config_our_bond_count;
     extern uint16_t ble_store_config_peer_bond_count;
     extern int ble_store_config_compare_bond_count(const void *a, const void *b);
 
-#if MYNEWT_VAL(BLE_STORE_MAX_BONDS)
+#if BLE_STORE_CONFIG_LAZY
+    err = ble_nvs_restore_sec_dir(BLE_STORE_OBJ_TYPE_OUR_SEC);
+    if (err != 0) {
+        ESP_LOGE(LOG_TAG, "NVS operation failed for 'our sec'");
+        return err;
+    }
+
+    err = ble_nvs_restore_sec_dir(BLE_STORE_OBJ_TYPE_PEER_SEC);
+    if (err != 0) {
+        ESP_LOGE(LOG_TAG, "NVS operation failed for 'peer sec'");
+        return err;
+    }
+
+    ble_store_config_our_bond_count = ble_store_config_num_our_secs ?
+        ble_store_config_our_sec_dirs[ble_store_config_num_our_secs - 1].bond_count : 0;
+    ble_store_config_peer_bond_count = ble_store_config_num_peer_secs ?
+        ble_store_config_peer_sec_dirs[ble_store_config_num_peer_secs - 1].bond_count : 0;
+
+    ESP_LOGD(LOG_TAG, "bond directory restored %d our, %d peer bonds",
+             ble_store_config_num_our_secs, ble_store_config_num_peer_secs);
+#elif MYNEWT_VAL(BLE_STORE_MAX_BONDS)
+    ble_nvs_drop_sec_dirs();
+
     err = populate_db_from_nvs(BLE_STORE_OBJ_TYPE_OUR_SEC, ble_store_config_our_secs,
                                &ble_store_config_num_our_secs);
     if (err != ESP_OK) {
@@ -606,6 +1319,9 @@ ble_nvs_restore_sec_keys(void)
     ble_store_config_our_bond_count = ble_store_config_our_secs[ble_store_config_num_our_secs - 1].bond_count;
     ble_store_config_peer_bond_count = ble_store_config_peer_secs[ble_store_config_num_peer_secs - 1].bond_count;
 
+    ble_nvs_restore_sec_order(BLE_STORE_OBJ_TYPE_OUR_SEC);
+    ble_nvs_restore_sec_order(BLE_STORE_OBJ_TYPE_PEER_SEC);
+
     ESP_LOGD(LOG_TAG, "ble_store_config_peer_secs restored %d bonds",
              ble_store_config_num_peer_secs);
 #endif
@@ -688,219 +1404,122 @@ ble_nvs_restore_peer_records(void)
 #if MYNEWT_VAL(BLE_STORE_MAX_CCCDS)
 int ble_store_config_persist_cccds(void)
 {
-    int nvs_count, nvs_idx;
-    union ble_store_value val;
-
-    nvs_count = get_nvs_db_attribute(BLE_STORE_OBJ_TYPE_CCCD, 0, NULL, 0);
-    if (nvs_count == -1) {
-        ESP_LOGE(LOG_TAG, "NVS operation failed while persisting CCCD");
-        return BLE_HS_ESTORE_FAIL;
-    }
-
-    if (nvs_count < ble_store_config_num_cccds) {
-
-        /* NVS db count less than RAM count, write operation */
-        ESP_LOGD(LOG_TAG, "Persisting CCCD value in NVS...");
-        val.cccd = ble_store_config_cccds[ble_store_config_num_cccds - 1];
-        return ble_store_nvs_write(BLE_STORE_OBJ_TYPE_CCCD, &val);
-    } else if (nvs_count > ble_store_config_num_cccds) {
-        /* NVS db count more than RAM count, delete operation */
-        nvs_idx = get_nvs_db_attribute(BLE_STORE_OBJ_TYPE_CCCD, 0,
-                                       ble_store_config_cccds, ble_store_config_num_cccds);
-        if (nvs_idx == -1) {
-            ESP_LOGE(LOG_TAG, "NVS delete operation failed for CCCD");
-            return BLE_HS_ESTORE_FAIL;
-        }
-        ESP_LOGD(LOG_TAG, "Deleting CCCD, nvs idx = %d", nvs_idx);
-        return ble_nvs_delete_value(BLE_STORE_OBJ_TYPE_CCCD, nvs_idx);
-    }
-    return 0;
+    return ble_store_nvs_sync(BLE_STORE_OBJ_TYPE_CCCD, ble_store_config_cccds,
+                              ble_store_config_num_cccds,
+                              sizeof(struct ble_store_value_cccd));
 }
 #endif
 
 #if MYNEWT_VAL(BLE_STORE_MAX_CSFCS)
 int ble_store_config_persist_csfcs(void)
 {
-    int nvs_count, nvs_idx;
-    union ble_store_value val;
-
-    nvs_count = get_nvs_db_attribute(BLE_STORE_OBJ_TYPE_CSFC, 0, NULL, 0);
-    if (nvs_count == -1) {
-        ESP_LOGE(LOG_TAG, "NVS operation failed while persisting CSFC");
-        return BLE_HS_ESTORE_FAIL;
-    }
-
-    if (nvs_count < ble_store_config_num_csfcs) {
-        /* NVS db count less than RAM count, write operation */
-        ESP_LOGD(LOG_TAG, "Persisting CSFC value in NVS...");
-        val.csfc = ble_store_config_csfcs[ble_store_config_num_csfcs - 1];
-        return ble_store_nvs_write(BLE_STORE_OBJ_TYPE_CSFC, &val);
-    } else if (nvs_count > ble_store_config_num_csfcs) {
-        /* NVS db count more than RAM count, delete operation */
-        nvs_idx = get_nvs_db_attribute(BLE_STORE_OBJ_TYPE_CSFC, 0,
-                                       ble_store_config_csfcs, ble_store_config_num_csfcs);
-        if (nvs_idx == -1) {
-            ESP_LOGE(LOG_TAG, "NVS delete operation failed for CSFC");
-            return BLE_HS_ESTORE_FAIL;
-        }
-        ESP_LOGD(LOG_TAG, "Deleting CSFC, nvs idx = %d", nvs_idx);
-        return ble_nvs_delete_value(BLE_STORE_OBJ_TYPE_CSFC, nvs_idx);
-    }
-    return 0;
+    return ble_store_nvs_sync(BLE_STORE_OBJ_TYPE_CSFC, ble_store_config_csfcs,
+                              ble_store_config_num_csfcs,
+                              sizeof(struct ble_store_value_csfc));
 }
 #endif
 
 #if MYNEWT_VAL(ENC_ADV_DATA)
 int ble_store_config_persist_eads(void)
 {
-    int nvs_count, nvs_idx;
-    union ble_store_value val;
-
-    nvs_count = get_nvs_db_attribute(BLE_STORE_OBJ_TYPE_ENC_ADV_DATA, 0, NULL, 0);
-    if (nvs_count == -1) {
-        ESP_LOGE(LOG_TAG, "NVS operation failed while persisting EAD");
-        return BLE_HS_ESTORE_FAIL;
-    }
-
-    if (nvs_count < ble_store_config_num_eads) {
-        /* NVS db count less than RAM count, write operation */
-        ESP_LOGD(LOG_TAG, "Persisting EAD value in NVS...");
-        val.ead = ble_store_config_eads[ble_store_config_num_eads - 1];
-        return ble_store_nvs_write(BLE_STORE_OBJ_TYPE_ENC_ADV_DATA, &val);
-    } else if (nvs_count > ble_store_config_num_eads) {
-        /* NVS db count more than RAM count, delete operation */
-        nvs_idx = get_nvs_db_attribute(BLE_STORE_OBJ_TYPE_ENC_ADV_DATA, 0,
-                                       ble_store_config_eads, ble_store_config_num_eads);
-        if (nvs_idx == -1) {
-            ESP_LOGE(LOG_TAG, "NVS delete operation failed for EAD");
-            return BLE_HS_ESTORE_FAIL;
-        }
-        ESP_LOGD(LOG_TAG, "Deleting EAD, nvs idx = %d", nvs_idx);
-        return ble_nvs_delete_value(BLE_STORE_OBJ_TYPE_ENC_ADV_DATA, nvs_idx);
-    }
-    return 0;
+    return ble_store_nvs_sync(BLE_STORE_OBJ_TYPE_ENC_ADV_DATA, ble_store_config_eads,
+                              ble_store_config_num_eads,
+                              sizeof(struct ble_store_value_ead));
 }
 #endif
 int ble_store_config_persist_local_irk(void)
 {
-    int nvs_count, nvs_idx;
-    union ble_store_value val;
-
-    nvs_count = get_nvs_db_attribute(BLE_STORE_OBJ_TYPE_LOCAL_IRK, 0, NULL, 0);
-    if (nvs_count == -1) {
-        ESP_LOGE(LOG_TAG, "NVS operation failed while persisting EAD");
-        return BLE_HS_ESTORE_FAIL;
-    }
-
-    if (nvs_count < ble_store_config_num_local_irks) {
-        /* NVS db count less than RAM count, write operation */
-        ESP_LOGD(LOG_TAG, "Persisting Local IRK value in NVS...");
-        val.local_irk = ble_store_config_local_irks[ble_store_config_num_local_irks-1];
-        return ble_store_nvs_write(BLE_STORE_OBJ_TYPE_LOCAL_IRK, &val);
-    } else if (nvs_count > ble_store_config_num_local_irks) {
-        /* NVS db count more than RAM count, delete operation */
-        nvs_idx = get_nvs_db_attribute(BLE_STORE_OBJ_TYPE_LOCAL_IRK, 0,
-                                       ble_store_config_local_irks, ble_store_config_num_local_irks);
-        if (nvs_idx == -1) {
-            ESP_LOGE(LOG_TAG, "NVS delete operation failed for Local IRK");
-            return BLE_HS_ESTORE_FAIL;
-        }
-        ESP_LOGD(LOG_TAG, "Deleting Local IRK, nvs idx = %d", nvs_idx);
-        return ble_nvs_delete_value(BLE_STORE_OBJ_TYPE_LOCAL_IRK, nvs_idx);
-    }
-    return 0;
+    return ble_store_nvs_sync(BLE_STORE_OBJ_TYPE_LOCAL_IRK, ble_store_config_local_irks,
+                              ble_store_config_num_local_irks,
+                              sizeof(struct ble_store_value_local_irk));
 }
 
 int ble_store_config_persist_rpa_recs(void)
 {
-    int nvs_count, nvs_idx;
-    union ble_store_value val;
-    nvs_count = get_nvs_db_attribute(BLE_STORE_OBJ_TYPE_PEER_ADDR, 0, NULL, 0);
-     if (nvs_count == -1) {
-        ESP_LOGE(LOG_TAG, "NVS operation failed while persisting RPA_RECS");
-        return BLE_HS_ESTORE_FAIL;
-    }
-    if (nvs_count < ble_store_config_num_rpa_recs) {
-        /* NVS db count less than RAM count, write operation */
-        ESP_LOGD(LOG_TAG, "Persisting RPA_RECS value in NVS...");
-        val.rpa_rec = ble_store_config_rpa_recs[ble_store_config_num_rpa_recs - 1];
-        return ble_store_nvs_write(BLE_STORE_OBJ_TYPE_PEER_ADDR, &val);
-    } else if (nvs_count > ble_store_config_num_rpa_recs) {
-        /* NVS db count more than RAM count, delete operation */
-        nvs_idx = get_nvs_db_attribute(BLE_STORE_OBJ_TYPE_PEER_ADDR, 0,
-                                       ble_store_config_rpa_recs, ble_store_config_num_rpa_recs);
-        if (nvs_idx == -1) {
-            ESP_LOGE(LOG_TAG, "NVS delete operation failed for RPA_REC");
-            return BLE_HS_ESTORE_FAIL;
-        }
-        ESP_LOGD(LOG_TAG, "Deleting RPA_REC, nvs idx = %d", nvs_idx);
-        return ble_nvs_delete_value(BLE_STORE_OBJ_TYPE_PEER_ADDR, nvs_idx);
-    }
-    return 0;
-
+    return ble_store_nvs_sync(BLE_STORE_OBJ_TYPE_PEER_ADDR, ble_store_config_rpa_recs,
+                              ble_store_config_num_rpa_recs,
+                              sizeof(struct ble_store_value_rpa_rec));
 }
 
+#if BLE_STORE_CONFIG_LAZY
+/* Security records are written through, only the directory can be pending */
 int ble_store_config_persist_peer_secs(void)
 {
-    int nvs_count, nvs_idx;
-    union ble_store_value val;
+    return ble_store_config_nvs_update_sec(BLE_STORE_OBJ_TYPE_PEER_SEC, 0, NULL);
+}
 
-    nvs_count = get_nvs_db_attribute(BLE_STORE_OBJ_TYPE_PEER_SEC, 0, NULL, 0);
-    if (nvs_count == -1) {
-        ESP_LOGE(LOG_TAG, "NVS operation failed while persisting peer sec");
-        return BLE_HS_ESTORE_FAIL;
+int ble_store_config_persist_our_secs(void)
+{
+    return ble_store_config_nvs_update_sec(BLE_STORE_OBJ_TYPE_OUR_SEC, 0, NULL);
+}
+#elif MYNEWT_VAL(BLE_STORE_MAX_BONDS)
+/* Writes a security record set and the connection order it is kept in */
+static int
+ble_store_nvs_persist_secs(int obj_type)
+{
+    struct ble_store_value_sec *secs;
+    int *num;
+    int rc;
+
+    ble_nvs_sec_order_key(obj_type, &secs, &num);
+
+    if (ble_store_nvs_mutex_ready) {
+        ble_npl_mutex_pend(&ble_store_nvs_mutex, BLE_NPL_TIME_FOREVER);
     }
 
-    if (nvs_count < ble_store_config_num_peer_secs) {
+    rc = ble_store_nvs_sync_locked(obj_type, secs, *num,
+                                   sizeof(struct ble_store_value_sec));
+    if (rc == 0) {
+        rc = ble_nvs_write_sec_order(obj_type);
+    }
 
-        /* NVS db count less than RAM count, write operation */
-        ESP_LOGD(LOG_TAG, "Persisting peer sec value in NVS...");
-        val.sec = ble_store_config_peer_secs[ble_store_config_num_peer_secs - 1];
-        return ble_store_nvs_write(BLE_STORE_OBJ_TYPE_PEER_SEC, &val);
-    } else if (nvs_count > ble_store_config_num_peer_secs) {
-        /* NVS db count more than RAM count, delete operation */
-        nvs_idx = get_nvs_db_attribute(BLE_STORE_OBJ_TYPE_PEER_SEC, 0,
-                                       ble_store_config_peer_secs, ble_store_config_num_peer_secs);
-        if (nvs_idx == -1) {
-            ESP_LOGE(LOG_TAG, "NVS delete operation failed for peer sec");
-            return BLE_HS_ESTORE_FAIL;
-        }
-        ESP_LOGD(LOG_TAG, "Deleting peer sec, nvs idx = %d", nvs_idx);
-        return ble_nvs_delete_value(BLE_STORE_OBJ_TYPE_PEER_SEC, nvs_idx);
+    if (ble_store_nvs_mutex_ready) {
+        ble_npl_mutex_release(&ble_store_nvs_mutex);
     }
-    return 0;
+
+    return rc;
+}
+
+int ble_store_config_persist_peer_secs(void)
+{
+    return ble_store_nvs_persist_secs(BLE_STORE_OBJ_TYPE_PEER_SEC);
 }
 
 int ble_store_config_persist_our_secs(void)
 {
-    int nvs_count, nvs_idx;
-    union ble_store_value val;
+    return ble_store_nvs_persist_secs(BLE_STORE_OBJ_TYPE_OUR_SEC);
+}
 
-    nvs_count = get_nvs_db_attribute(BLE_STORE_OBJ_TYPE_OUR_SEC, 0, NULL, 0);
-    if (nvs_count == -1) {
-        ESP_LOGE(LOG_TAG, "NVS operation failed while persisting our sec");
-        return BLE_HS_ESTORE_FAIL;
+int ble_store_config_persist_sec_order(void)
+{
+    int rc;
+
+    if (ble_store_nvs_mutex_ready) {
+        ble_npl_mutex_pend(&ble_store_nvs_mutex, BLE_NPL_TIME_FOREVER);
     }
 
-    if (nvs_count < ble_store_config_num_our_secs) {
+    rc = ble_nvs_write_sec_order(BLE_STORE_OBJ_TYPE_OUR_SEC);
+    if (rc == 0) {
+        rc = ble_nvs_write_sec_order(BLE_STORE_OBJ_TYPE_PEER_SEC);
+    }
 
-        /* NVS db count less than RAM count, write operation */
-        ESP_LOGD(LOG_TAG, "Persisting our sec value to NVS...");
-        val.sec = ble_store_config_our_secs[ble_store_config_num_our_secs - 1];
-        return ble_store_nvs_write(BLE_STORE_OBJ_TYPE_OUR_SEC, &val);
-    } else if (nvs_count > ble_store_config_num_our_secs) {
-        /* NVS db count more than RAM count, delete operation */
-        nvs_idx = get_nvs_db_attribute(BLE_STORE_OBJ_TYPE_OUR_SEC, 0,
-                                       ble_store_config_our_secs, ble_store_config_num_our_secs);
-        if (nvs_idx == -1) {
-            ESP_LOGE(LOG_TAG, "NVS delete operation failed for our sec");
-            return BLE_HS_ESTORE_FAIL;
-        }
-        ESP_LOGD(LOG_TAG, "Deleting our sec, nvs idx = %d", nvs_idx);
-        return ble_nvs_delete_value(BLE_STORE_OBJ_TYPE_OUR_SEC, nvs_idx);
+    if (ble_store_nvs_mutex_ready) {
+        ble_npl_mutex_release(&ble_store_nvs_mutex);
     }
+
+    return rc;
+}
+#else
+int ble_store_config_persist_peer_secs(void)
+{
+    return 0;
+}
+
+int ble_store_config_persist_our_secs(void)
+{
     return 0;
 }
+#endif
 
 #if MYNEWT_VAL(BLE_HOST_BASED_PRIVACY)
 int ble_store_persist_peer_records(void)
@@ -942,6 +1561,11 @@ void ble_store_config_conf_init(void)
 {
     int err;
 
+    if (!ble_store_nvs_mutex_ready) {
+        ble_npl_mutex_init(&ble_store_nvs_mutex);
+        ble_store_nvs_mutex_ready = true;
+    }
+
     err = ble_nvs_restore_sec_keys();
     if (err != 0) {
         ESP_LOGE(LOG_TAG, "NVS operation failed, can't retrieve the bonding info");
@@ -49,6 +49,9 @@ struct os_mbuf *ble_transport_alloc_iso_from_hs(void);
 struct os_mbuf *ble_transport_alloc_acl_from_ll(void);
 struct os_mbuf *ble_transport_alloc_iso_from_ll(void);
 
+/* Number of discardable events dropped because no buffer was available */
+uint32_t ble_transport_evt_discarded(void);
+
 /* Generic deallocator for cmd/evt buffers */
 void ble_transport_free(void *buf);
 
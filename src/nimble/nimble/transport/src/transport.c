@@ -124,10 +124,20 @@ static struct os_mbuf_pool mpool_iso;
 
 static os_mempool_put_fn *transport_put_acl_from_ll_cb;
 
+/* Number of discardable events dropped because no buffer was available */
+static uint32_t transport_evt_discarded;
+
 void *
 ble_transport_alloc_cmd(void)
 {
-    return os_memblock_get(&pool_cmd);
+    void *buf;
+
+    buf = os_memblock_get(&pool_cmd);
+    if (!buf) {
+        os_mempool_stats_alloc_fail(&pool_cmd);
+    }
+
+    return buf;
 }
 
 static void *
@@ -151,6 +161,9 @@ try_alloc_evt(struct os_mempool *mp)
 #endif
 
     buf = os_memblock_get(mp);
+    if (!buf) {
+        os_mempool_stats_alloc_fail(mp);
+    }
 
 #if BLE_TRANSPORT_IPC_ON_LL
     if (!buf) {
@@ -167,7 +180,20 @@ ble_transport_alloc_evt(int discardable)
     void *buf;
 
     if (discardable) {
-        buf = try_alloc_evt(&pool_evt_lo);
+        /* Leave the reserved part of the discardable pool to events that
+         * cannot be dropped.  The unlocked read may be off by one, which
+         * only makes the reservation approximate.
+         */
+        if (pool_evt_lo.mp_num_free >
+            MYNEWT_VAL(BLE_TRANSPORT_EVT_DISCARDABLE_RESERVED)) {
+            buf = try_alloc_evt(&pool_evt_lo);
+        } else {
+            buf = NULL;
+        }
+
+        if (!buf) {
+            transport_evt_discarded++;
+        }
     } else {
         buf = try_alloc_evt(&pool_evt);
         if (!buf) {
@@ -196,6 +222,8 @@ ble_transport_alloc_acl_from_hs(void)
     if (om) {
         pkthdr = OS_MBUF_PKTHDR(om);
         pkthdr->omp_flags = OMP_FLAG_FROM_HS;
+    } else {
+        os_mempool_stats_alloc_fail(&pool_acl.mpe_mp);
     }
 
     return om;
@@ -222,6 +250,8 @@ ble_transport_alloc_iso_from_hs(void)
     if (om) {
         pkthdr = OS_MBUF_PKTHDR(om);
         pkthdr->omp_flags = OMP_FLAG_FROM_HS;
+    } else {
+        os_mempool_stats_alloc_fail(&pool_iso.mpe_mp);
     }
 
     return om;
@@ -241,6 +271,8 @@ ble_transport_alloc_acl_from_ll(void)
     if (om) {
         pkthdr = OS_MBUF_PKTHDR(om);
         pkthdr->omp_flags = OMP_FLAG_FROM_LL;
+    } else {
+        os_mempool_stats_alloc_fail(&pool_acl.mpe_mp);
     }
 
     return om;
@@ -260,6 +292,8 @@ ble_transport_alloc_iso_from_ll(void)
     if (om) {
         pkthdr = OS_MBUF_PKTHDR(om);
         pkthdr->omp_flags = OMP_FLAG_FROM_LL;
+    } else {
+        os_mempool_stats_alloc_fail(&pool_iso.mpe_mp);
     }
 
     return om;
@@ -357,6 +391,10 @@ ble_transport_init(void)
                          pool_evt_lo_buf, "transport_pool_evt_lo");
     SYSINIT_PANIC_ASSERT(rc == 0);
 
+    os_mempool_stats_register(&pool_cmd, "transport_cmd");
+    os_mempool_stats_register(&pool_evt, "transport_evt");
+    os_mempool_stats_register(&pool_evt_lo, "transport_evt_lo");
+
 #if POOL_ACL_COUNT > 0
     rc = os_mempool_ext_init(&pool_acl, POOL_ACL_COUNT, POOL_ACL_SIZE,
                              pool_acl_buf, "transport_pool_acl");
@@ -367,6 +405,7 @@ ble_transport_init(void)
     SYSINIT_PANIC_ASSERT(rc == 0);
 
     pool_acl.mpe_put_cb = ble_transport_acl_put;
+    os_mempool_stats_register(&pool_acl.mpe_mp, "transport_acl");
 #endif
 
 #if POOL_ISO_COUNT > 0
@@ -377,6 +416,7 @@ ble_transport_init(void)
     rc = os_mbuf_pool_init(&mpool_iso, &pool_iso.mpe_mp,
                            POOL_ISO_SIZE, POOL_ISO_COUNT);
     SYSINIT_PANIC_ASSERT(rc == 0);
+    os_mempool_stats_register(&pool_iso.mpe_mp, "transport_iso");
 #endif
 }
 
@@ -412,6 +452,12 @@ ble_transport_register_put_acl_from_ll_cb(os_mempool_put_fn (*cb))
     return 0;
 }
 
+uint32_t
+ble_transport_evt_discarded(void)
+{
+    return transport_evt_discarded;
+}
+
 #if BLE_TRANSPORT_IPC
 uint8_t
 ble_transport_ipc_buf_evt_type_get(void *buf)
@@ -498,4 +544,14 @@ esp_err_t ble_buf_alloc(void)
 }
 
 #endif /* ESP_PLATFORM */
+
+#else /* !SOC_ESP_NIMBLE_CONTROLLER || !CONFIG_BT_CONTROLLER_ENABLED */
+
+/* Event buffers are allocated by the controller */
+uint32_t
+ble_transport_evt_discarded(void)
+{
+    return 0;
+}
+
 #endif /* !SOC_ESP_NIMBLE_CONTROLLER || !CONFIG_BT_CONTROLLER_ENABLED */
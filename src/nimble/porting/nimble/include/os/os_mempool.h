@@ -412,6 +412,82 @@ os_error_t os_memblock_put_from_cb(struct os_mempool *mp, void *block_addr);
 os_error_t os_memblock_put(struct os_mempool *mp, void *block_addr);
 #endif
 
+#if MYNEWT_VAL(OS_MEMPOOL_STATS)
+struct ble_npl_eventq;
+
+/**
+ * Usage statistics of a memory pool registered with
+ * os_mempool_stats_register().
+ */
+struct os_mempool_stats {
+    /** Name the pool was registered with */
+    const char *oms_name;
+    /** Size of the memory blocks in the pool */
+    uint32_t oms_block_size;
+    /** Number of memory blocks in the pool */
+    uint16_t oms_num_blocks;
+    /** Number of free memory blocks */
+    uint16_t oms_num_free;
+    /** Minimum number of free memory blocks since the last reset */
+    uint16_t oms_min_free;
+    /** Number of allocations that failed because the pool was empty */
+    uint32_t oms_alloc_fail;
+    /** Sum of the number of blocks in use over all occupancy samples */
+    uint64_t oms_used_sum;
+    /** Number of occupancy samples taken since the last reset */
+    uint32_t oms_samples;
+};
+
+/**
+ * Adds a memory pool to the set of pools statistics are kept for.
+ * Registering a pool again only updates its name.
+ *
+ * @param mp   The memory pool
+ * @param name Name reported with the statistics
+ */
+void os_mempool_stats_register(struct os_mempool *mp, const char *name);
+
+/**
+ * Records an allocation from the pool that failed because it was empty.
+ *
+ * @param mp The memory pool
+ */
+void os_mempool_stats_alloc_fail(struct os_mempool *mp);
+
+/**
+ * Retrieves the statistics of a registered memory pool.
+ *
+ * @param idx   Index of the pool, in registration order
+ * @param stats Filled with the statistics of the pool
+ *
+ * @return 0 on success, OS_ENOENT if idx is past the last pool
+ */
+int os_mempool_stats_get(int idx, struct os_mempool_stats *stats);
+
+/**
+ * Clears the failure counts and occupancy samples of all registered pools and
+ * restarts the minimum free block count from the current number of free
+ * blocks.
+ */
+void os_mempool_stats_reset(void);
+
+/**
+ * Starts sampling the occupancy of the registered pools every
+ * OS_MEMPOOL_STATS_SAMPLE_MS milliseconds.
+ *
+ * @param evq The event queue the sampling timer runs on
+ */
+void os_mempool_stats_start(struct ble_npl_eventq *evq);
+
+/** Stops sampling the occupancy of the registered pools. */
+void os_mempool_stats_stop(void);
+#else
+#define os_mempool_stats_register(mp, name)
+#define os_mempool_stats_alloc_fail(mp)
+#define os_mempool_stats_start(evq)
+#define os_mempool_stats_stop()
+#endif
+
 #ifdef __cplusplus
 }
 #endif
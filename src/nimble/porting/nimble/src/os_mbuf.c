@@ -190,6 +190,9 @@ os_msys_get(uint16_t dsize, uint16_t leadingspace)
     }
 
     m = os_mbuf_get(pool, leadingspace);
+    if (!m) {
+        os_mempool_stats_alloc_fail(pool->omp_pool);
+    }
     return (m);
 err:
     log_count ++;
@@ -214,6 +217,9 @@ os_msys_get_pkthdr(uint16_t dsize, uint16_t user_hdr_len)
     }
 
     m = os_mbuf_get_pkthdr(pool, user_hdr_len);
+    if (!m) {
+        os_mempool_stats_alloc_fail(pool->omp_pool);
+    }
     return (m);
 err:
     log_count ++;
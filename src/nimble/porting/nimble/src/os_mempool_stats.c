@@ -0,0 +1,176 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "syscfg/syscfg.h"
+
+#if MYNEWT_VAL(OS_MEMPOOL_STATS)
+
+#include <string.h>
+#include "nimble/porting/nimble/include/os/os.h"
+
+/* msys 1 and 2, the five transport pools and the two L2CAP pools, plus spares */
+#define OS_MEMPOOL_STATS_MAX_POOLS  (12)
+
+struct os_mempool_stats_entry {
+    struct os_mempool *mp;
+    const char *name;
+    uint32_t alloc_fail;
+    uint64_t used_sum;
+    uint32_t samples;
+};
+
+static struct os_mempool_stats_entry os_mempool_stats_tbl[OS_MEMPOOL_STATS_MAX_POOLS];
+static int os_mempool_stats_cnt;
+static struct ble_npl_callout os_mempool_stats_timer;
+static bool os_mempool_stats_timer_init;
+
+static struct os_mempool_stats_entry *
+os_mempool_stats_find(const struct os_mempool *mp)
+{
+    int i;
+
+    for (i = 0; i < os_mempool_stats_cnt; i++) {
+        if (os_mempool_stats_tbl[i].mp == mp) {
+            return &os_mempool_stats_tbl[i];
+        }
+    }
+
+    return NULL;
+}
+
+void
+os_mempool_stats_register(struct os_mempool *mp, const char *name)
+{
+    struct os_mempool_stats_entry *entry;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    entry = os_mempool_stats_find(mp);
+    if (entry == NULL && os_mempool_stats_cnt < OS_MEMPOOL_STATS_MAX_POOLS) {
+        entry = &os_mempool_stats_tbl[os_mempool_stats_cnt++];
+        memset(entry, 0, sizeof(*entry));
+        entry->mp = mp;
+    }
+
+    if (entry != NULL) {
+        entry->name = name;
+    }
+    OS_EXIT_CRITICAL(sr);
+}
+
+void
+os_mempool_stats_alloc_fail(struct os_mempool *mp)
+{
+    struct os_mempool_stats_entry *entry;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    entry = os_mempool_stats_find(mp);
+    if (entry != NULL) {
+        entry->alloc_fail++;
+    }
+    OS_EXIT_CRITICAL(sr);
+}
+
+int
+os_mempool_stats_get(int idx, struct os_mempool_stats *stats)
+{
+    const struct os_mempool_stats_entry *entry;
+    os_sr_t sr;
+
+    if (idx < 0 || idx >= os_mempool_stats_cnt) {
+        return OS_ENOENT;
+    }
+
+    entry = &os_mempool_stats_tbl[idx];
+
+    OS_ENTER_CRITICAL(sr);
+    stats->oms_name = entry->name;
+    stats->oms_block_size = entry->mp->mp_block_size;
+    stats->oms_num_blocks = entry->mp->mp_num_blocks;
+    stats->oms_num_free = entry->mp->mp_num_free;
+    stats->oms_min_free = entry->mp->mp_min_free;
+    stats->oms_alloc_fail = entry->alloc_fail;
+    stats->oms_used_sum = entry->used_sum;
+    stats->oms_samples = entry->samples;
+    OS_EXIT_CRITICAL(sr);
+
+    return 0;
+}
+
+void
+os_mempool_stats_reset(void)
+{
+    struct os_mempool_stats_entry *entry;
+    os_sr_t sr;
+    int i;
+
+    OS_ENTER_CRITICAL(sr);
+    for (i = 0; i < os_mempool_stats_cnt; i++) {
+        entry = &os_mempool_stats_tbl[i];
+        entry->alloc_fail = 0;
+        entry->used_sum = 0;
+        entry->samples = 0;
+        entry->mp->mp_min_free = entry->mp->mp_num_free;
+    }
+    OS_EXIT_CRITICAL(sr);
+}
+
+static void
+os_mempool_stats_sample(struct ble_npl_event *ev)
+{
+    struct os_mempool_stats_entry *entry;
+    os_sr_t sr;
+    int i;
+
+    OS_ENTER_CRITICAL(sr);
+    for (i = 0; i < os_mempool_stats_cnt; i++) {
+        entry = &os_mempool_stats_tbl[i];
+        entry->used_sum += entry->mp->mp_num_blocks - entry->mp->mp_num_free;
+        entry->samples++;
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    ble_npl_callout_reset(&os_mempool_stats_timer,
+                          ble_npl_time_ms_to_ticks32(MYNEWT_VAL(OS_MEMPOOL_STATS_SAMPLE_MS)));
+}
+
+void
+os_mempool_stats_start(struct ble_npl_eventq *evq)
+{
+    os_mempool_stats_stop();
+
+    ble_npl_callout_init(&os_mempool_stats_timer, evq, os_mempool_stats_sample, NULL);
+    os_mempool_stats_timer_init = true;
+
+    ble_npl_callout_reset(&os_mempool_stats_timer,
+                          ble_npl_time_ms_to_ticks32(MYNEWT_VAL(OS_MEMPOOL_STATS_SAMPLE_MS)));
+}
+
+void
+os_mempool_stats_stop(void)
+{
+    if (os_mempool_stats_timer_init) {
+        ble_npl_callout_stop(&os_mempool_stats_timer);
+        ble_npl_callout_deinit(&os_mempool_stats_timer);
+        os_mempool_stats_timer_init = false;
+    }
+}
+
+#endif
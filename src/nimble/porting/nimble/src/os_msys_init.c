@@ -147,6 +147,8 @@ os_msys_init_once(void *data, struct os_mempool *mempool,
 
     rc = os_msys_register(mbuf_pool);
     SYSINIT_PANIC_ASSERT(rc == 0);
+
+    os_mempool_stats_register(mempool, name);
 }
 
 #ifdef ESP_PLATFORM
@@ -18,9 +18,12 @@
  */
 
 #include <stddef.h>
+#include <stdbool.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "nimble/porting/nimble/include/nimble/nimble_port.h"
+#include "nimble/nimble/include/nimble/nimble_opt.h"
+#include "nimble/nimble/host/include/host/ble_sm.h"
 
 static TaskHandle_t host_task_h = NULL;
 
@@ -31,6 +34,73 @@ UBaseType_t nimble_port_freertos_get_hs_hwm(void) {
     return uxTaskGetStackHighWaterMark(host_task_h);
 }
 
+#if NIMBLE_BLE_CONNECT && NIMBLE_BLE_SM && MYNEWT_VAL(BLE_SM_SC) && \
+    (MYNEWT_VAL(BLE_SM_SC_KEY_POOL_SIZE) > 0)
+#define NIMBLE_SM_KEY_POOL_TASK 1
+
+#ifdef ESP_PLATFORM
+# define NIMBLE_SM_KEY_STACK_SIZE (MYNEWT_VAL(BLE_SM_SC_KEY_POOL_TASK_STACK_SIZE))
+#else
+# define NIMBLE_SM_KEY_STACK_SIZE (MYNEWT_VAL(BLE_SM_SC_KEY_POOL_TASK_STACK_SIZE) / 4)
+static StackType_t sm_key_stack[ NIMBLE_SM_KEY_STACK_SIZE ];
+static StaticTask_t sm_key_task_buffer;
+#endif
+
+/* How often the key pool task checks whether a key pair was taken */
+#define NIMBLE_SM_KEY_POLL_MS 100
+
+static TaskHandle_t volatile sm_key_task_h = NULL;
+static volatile bool sm_key_task_stop;
+
+/**
+ * @brief Keeps the Secure Connections key pool full so that pairing does not
+ * have to wait for P-256 key generation in the host task.
+ */
+static void
+sm_key_task(void *arg)
+{
+    (void)arg;
+
+    while (!sm_key_task_stop) {
+        if (ble_sm_sc_key_pool_refill() != 0) {
+            vTaskDelay(pdMS_TO_TICKS(NIMBLE_SM_KEY_POLL_MS));
+        }
+    }
+
+    sm_key_task_h = NULL;
+    vTaskDelete(NULL);
+}
+
+static void
+sm_key_task_start(void)
+{
+    if (sm_key_task_h != NULL) {
+        return;
+    }
+
+    sm_key_task_stop = false;
+#ifdef ESP_PLATFORM
+    xTaskCreate(sm_key_task, "nimble_sm_keys", NIMBLE_SM_KEY_STACK_SIZE,
+                NULL, MYNEWT_VAL(BLE_SM_SC_KEY_POOL_TASK_PRIORITY),
+                (TaskHandle_t *)&sm_key_task_h);
+#else
+    sm_key_task_h = xTaskCreateStatic(sm_key_task, "sm_keys", NIMBLE_SM_KEY_STACK_SIZE,
+                                      NULL, MYNEWT_VAL(BLE_SM_SC_KEY_POOL_TASK_PRIORITY),
+                                      sm_key_stack, &sm_key_task_buffer);
+#endif
+}
+
+/* Lets a key generation in progress finish so its allocations are released */
+static void
+sm_key_task_stop_wait(void)
+{
+    sm_key_task_stop = true;
+    while (sm_key_task_h != NULL) {
+        vTaskDelay(1);
+    }
+}
+#endif // NIMBLE_BLE_CONNECT && NIMBLE_BLE_SM && MYNEWT_VAL(BLE_SM_SC) ...
+
 #ifdef ESP_PLATFORM
 #include "esp_bt.h"
 
@@ -55,6 +125,9 @@ esp_err_t esp_nimble_enable(void *host_task)
     */
     xTaskCreatePinnedToCore(host_task, "nimble_host", NIMBLE_HS_STACK_SIZE,
                             NULL, NIMBLE_HOST_TASK_PRIORITY, &host_task_h, NIMBLE_CORE);
+#if NIMBLE_SM_KEY_POOL_TASK
+    sm_key_task_start();
+#endif
     return ESP_OK;
 
 }
@@ -66,6 +139,9 @@ esp_err_t esp_nimble_enable(void *host_task)
  */
 esp_err_t esp_nimble_disable(void)
 {
+#if NIMBLE_SM_KEY_POOL_TASK
+    sm_key_task_stop_wait();
+#endif
     if (host_task_h) {
         vTaskDelete(host_task_h);
         host_task_h = NULL;
@@ -146,11 +222,17 @@ nimble_port_freertos_init(TaskFunction_t host_task_fn)
     */
     host_task_h = xTaskCreateStatic(host_task_fn, "host", NIMBLE_HS_STACK_SIZE,
                                     NULL, NIMBLE_HOST_TASK_PRIORITY, hs_stack, &hs_task_buffer);
+#if NIMBLE_SM_KEY_POOL_TASK
+    sm_key_task_start();
+#endif
 }
 
 void
 nimble_port_freertos_deinit(void)
 {
+#if NIMBLE_SM_KEY_POOL_TASK
+    sm_key_task_stop_wait();
+#endif
     if (host_task_h) {
         vTaskDelete(host_task_h);
     }
@@ -49,9 +49,51 @@
 /** @brief Un-comment to change the maximum number of CCCD subscriptions to store */
 // #define MYNEWT_VAL_BLE_STORE_MAX_CCCDS 8
 
+/**
+ * @brief Un-comment to change the time (in milliseconds) CCCD and client feature writes are held
+ * before being committed to flash, writes within this window are batched into a single commit.
+ * Pending writes are also committed when a peer disconnects. Set to 0 to write through immediately.
+ */
+// #define MYNEWT_VAL_BLE_STORE_CONFIG_FLUSH_DELAY_MS 1000
+
+/**
+ * @brief Un-comment to load bonds on demand instead of at startup (ESP32 only).
+ * @details Only the peer address and recency of each bond are kept in RAM, the keys are read
+ * from NVS when the peer connects and held in a cache of MYNEWT_VAL_BLE_STORE_CONFIG_LAZY_CACHE_SIZE entries.
+ * Recommended when MYNEWT_VAL_BLE_STORE_MAX_BONDS is large.
+ */
+// #define MYNEWT_VAL_BLE_STORE_CONFIG_LAZY_LOAD 1
+
+/** @brief Un-comment to change the number of bonds held in RAM when lazy loading is enabled */
+// #define MYNEWT_VAL_BLE_STORE_CONFIG_LAZY_CACHE_SIZE 4
+
 /** @brief Un-comment to change the random address refresh time (in seconds) */
 // #define MYNEWT_VAL_BLE_RPA_TIMEOUT 900
 
+/**
+ * @brief Un-comment to change the number of resolved and unresolvable peer random addresses remembered
+ * by host based privacy (ESP32), entries expire after the RPA timeout. Set to 0 to disable.
+ */
+// #define MYNEWT_VAL_BLE_HOST_RPA_CACHE_SIZE 8
+
+/**
+ * @brief Un-comment to precompute this many Secure Connections key pairs in a low priority background task
+ * so that pairing does not wait for P-256 key generation. Set to 0 to disable.
+ */
+// #define MYNEWT_VAL_BLE_SM_SC_KEY_POOL_SIZE 2
+
+/** @brief Un-comment to change the priority of the Secure Connections key pool task */
+// #define MYNEWT_VAL_BLE_SM_SC_KEY_POOL_TASK_PRIORITY 1
+
+/** @brief Un-comment to change the stack size of the Secure Connections key pool task */
+// #define MYNEWT_VAL_BLE_SM_SC_KEY_POOL_TASK_STACK_SIZE 4096
+
+/**
+ * @brief Un-comment to set the number of pairings a Secure Connections key pair is used for before it is
+ * replaced, 1 uses a new key pair for every pairing. 0 keeps the key pair until the host is reset.
+ */
+// #define MYNEWT_VAL_BLE_SM_SC_KEY_MAX_USES 1
+
 /**
  * @brief Un-comment to change the number of MSYS buffers available.
  * @details MSYS is a system level mbuf registry. For prepare write & prepare \n
@@ -60,6 +102,64 @@
  */
 // #define MYNEWT_VAL_MSYS_1_BLOCK_COUNT 12
 
+/**
+ * @brief Un-comment to keep usage statistics of the mbuf, transport and L2CAP memory pools,
+ * see NimBLEDevice::getMemPoolStats().
+ */
+// #define MYNEWT_VAL_OS_MEMPOOL_STATS 1
+
+/** @brief Un-comment to change the interval in milliseconds the memory pool occupancy is sampled at */
+// #define MYNEWT_VAL_OS_MEMPOOL_STATS_SAMPLE_MS 100
+
+/**
+ * @brief Un-comment to reserve this many buffers of the discardable HCI event pool for events
+ * that cannot be dropped, advertising reports are dropped instead when only the reserve is left.
+ */
+// #define MYNEWT_VAL_BLE_TRANSPORT_EVT_DISCARDABLE_RESERVED 4
+
+/**
+ * @brief Un-comment to limit the number of advertising reports accepted from each advertiser
+ * per BLE_HS_ADV_RPT_RATE_WINDOW_MS, excess reports are dropped. Scan responses and chained
+ * extended advertising reports are not limited. 0 disables the limit.
+ */
+// #define MYNEWT_VAL_BLE_HS_ADV_RPT_RATE_LIMIT 10
+
+/** @brief Un-comment to change the window in milliseconds the advertising report rate limit applies to */
+// #define MYNEWT_VAL_BLE_HS_ADV_RPT_RATE_WINDOW_MS 1000
+
+/** @brief Un-comment to change the number of advertisers the advertising report rate limit tracks */
+// #define MYNEWT_VAL_BLE_HS_ADV_RPT_RATE_SOURCES 8
+
+/**
+ * @brief Un-comment to record GAP, ATT, L2CAP credit and mbuf events in a binary trace ring,
+ * see ble_hs_trace_dump() and extras/nimble_trace_decode.py.
+ */
+// #define MYNEWT_VAL_BLE_HS_TRACE 1
+
+/** @brief Un-comment to change the number of 16 byte records kept by the binary trace ring */
+// #define MYNEWT_VAL_BLE_HS_TRACE_SIZE 256
+
+/**
+ * @brief Un-comment to keep traffic and latency counters for each connection,
+ * see NimBLEConnInfo::getStats().
+ */
+// #define MYNEWT_VAL_BLE_HS_CONN_STATS 1
+
+/**
+ * @brief Un-comment to change the number of advertisers the controller scan duplicate filter remembers,
+ * the least recently seen advertiser is forgotten when full. Only applies to the nRF controller.
+ */
+// #define MYNEWT_VAL_BLE_LL_NUM_SCAN_DUP_ADVS 32
+
+/** @brief Un-comment to change the number of hash buckets of the scan duplicate filter, must be a power of two */
+// #define MYNEWT_VAL_BLE_LL_SCAN_DUP_HASH_SIZE 16
+
+/**
+ * @brief Un-comment to have the controller scan duplicate filter report an advertiser again
+ * after this many milliseconds. 0 reports each advertiser once per scan.
+ */
+// #define MYNEWT_VAL_BLE_LL_SCAN_DUP_REFRESH_MS 10000
+
 /** @brief Un-comment to use external PSRAM for the NimBLE host */
 // #define MYNEWT_VAL_NIMBLE_MEM_ALLOC_MODE_EXTERNAL 1
 
@@ -86,6 +186,23 @@
  */
 // #define MYNEWT_VAL_NIMBLE_CPP_ADDR_FMT_UPPERCASE 1
 
+/** @brief Un-comment to enable NimBLEDevice::setAirtimeBudget(), which derives scan, advertising and\n
+ *  connection parameters from a share of radio time for each role and retunes the connection intervals\n
+ *  from the measured throughput when BLE_HS_CONN_STATS is enabled.\n
+ *  1 = Enabled, 0 = Disabled; Default = Disabled
+ */
+// #define MYNEWT_VAL_NIMBLE_CPP_AIRTIME_BUDGET 1
+
+/** @brief Un-comment to change the period in milliseconds at which the airtime budget is re-evaluated. */
+// #define MYNEWT_VAL_NIMBLE_CPP_AIRTIME_PERIOD_MS 2000
+
+/** @brief Un-comment to index services, characteristics and descriptors by UUID with a hash table\n
+ *  in containers holding at least this many of them, local and remote. Speeds up getServiceByUUID,\n
+ *  getCharacteristic and getDescriptorByUUID with many attributes at a cost of 4-8 bytes per attribute.\n
+ *  0 = Disabled; Default = Disabled
+ */
+// #define MYNEWT_VAL_NIMBLE_CPP_ATT_HASH_INDEX 8
+
 /** @brief Un-comment to enable storing the timestamp when an attribute value is updated\n
  *  This allows for checking the last update time using getTimeStamp() or getValue(time_t*)\n
  *  If disabled, the timestamp returned from these functions will be 0.\n
@@ -102,12 +219,51 @@
  */
 // #define MYNEWT_VAL_NIMBLE_CPP_ATT_VALUE_INIT_LENGTH 20
 
+/** @brief Uncomment to set the largest input report (bytes) that can be sent through\n
+ *  the NimBLEHIDDevice report pipeline. Each input report reserves this much memory\n
+ *  when the pipeline is started. Default value is 64.
+ */
+// #define MYNEWT_VAL_NIMBLE_CPP_HID_REPORT_MAX_LEN 64
+
+/** @brief Un-comment to change the size of the buffer used to reassemble chained periodic advertising\n
+ *  reports. One buffer is held by each established NimBLEPeriodicSync.\n
+ *  Default value is MYNEWT_VAL_BLE_EXT_ADV_MAX_SIZE (1650).
+ */
+// #define MYNEWT_VAL_NIMBLE_CPP_PERIODIC_REPORT_MAX_LEN 1650
+
 /** @brief Un-comment to set the debug log messages level from the NimBLE CPP Wrapper.\n
  *  Values: 0 = NONE, 1 = ERROR, 2 = WARNING, 3 = INFO, 4+ = DEBUG\n
  *  Uses approx. 32kB of flash memory.
  */
 // #define MYNEWT_VAL_NIMBLE_CPP_LOG_LEVEL 0
 
+/**
+ * @brief Un-comment to store NimBLE CPP log messages in a ring buffer and format them later in a low priority task
+ * instead of at the call site, see NimBLELog::flush().
+ */
+// #define MYNEWT_VAL_NIMBLE_CPP_LOG_DEFERRED 1
+
+/** @brief Un-comment to change the number of log messages the deferred log ring buffer holds */
+// #define MYNEWT_VAL_NIMBLE_CPP_LOG_DEFERRED_ENTRIES 32
+
+/** @brief Un-comment to change the number of 32 bit argument slots per deferred log message, 64 bit values use two */
+// #define MYNEWT_VAL_NIMBLE_CPP_LOG_DEFERRED_ARG_SLOTS 8
+
+/** @brief Un-comment to change the bytes reserved per deferred log message for copies of string arguments */
+// #define MYNEWT_VAL_NIMBLE_CPP_LOG_DEFERRED_STR_SIZE 48
+
+/**
+ * @brief Un-comment to change the priority of the task printing deferred log messages,
+ * 0 disables the task and NimBLELog::flush() must be called by the application.
+ */
+// #define MYNEWT_VAL_NIMBLE_CPP_LOG_DEFERRED_TASK_PRIORITY 1
+
+/** @brief Un-comment to change how often in milliseconds the deferred log task prints the stored messages */
+// #define MYNEWT_VAL_NIMBLE_CPP_LOG_DEFERRED_FLUSH_MS 100
+
+/** @brief Un-comment to change the stack size in bytes of the deferred log task */
+// #define MYNEWT_VAL_NIMBLE_CPP_LOG_DEFERRED_TASK_STACK_SIZE 3072
+
 /** @brief Un-comment to enable the debug asserts in NimBLE CPP wrapper.*/
 // #define MYNEWT_VAL_NIMBLE_CPP_DEBUG_ASSERT_ENABLED 1
 
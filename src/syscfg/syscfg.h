@@ -223,6 +223,14 @@
 #define MYNEWT_VAL_OS_MEMPOOL_POISON (0)
 #endif
 
+#ifndef MYNEWT_VAL_OS_MEMPOOL_STATS
+#define MYNEWT_VAL_OS_MEMPOOL_STATS (0)
+#endif
+
+#ifndef MYNEWT_VAL_OS_MEMPOOL_STATS_SAMPLE_MS
+#define MYNEWT_VAL_OS_MEMPOOL_STATS_SAMPLE_MS (100)
+#endif
+
 #ifndef MYNEWT_VAL_OS_SCHEDULING
 #define MYNEWT_VAL_OS_SCHEDULING (1)
 #endif
@@ -454,6 +462,14 @@
 #define MYNEWT_VAL_BLE_ISO (0)
 #endif
 
+#ifndef MYNEWT_VAL_BLE_ISO_BROADCAST_SOURCE
+#define MYNEWT_VAL_BLE_ISO_BROADCAST_SOURCE (0)
+#endif
+
+#ifndef MYNEWT_VAL_BLE_ISO_BROADCAST_SINK
+#define MYNEWT_VAL_BLE_ISO_BROADCAST_SINK (0)
+#endif
+
 #ifndef MYNEWT_VAL_BLE_ISO_TEST
 #define MYNEWT_VAL_BLE_ISO_TEST (0)
 #endif
@@ -695,10 +711,26 @@
 #define MYNEWT_VAL_BLE_HOST (1)
 #endif
 
+#ifndef MYNEWT_VAL_BLE_HS_ADV_RPT_RATE_LIMIT
+#define MYNEWT_VAL_BLE_HS_ADV_RPT_RATE_LIMIT (0)
+#endif
+
+#ifndef MYNEWT_VAL_BLE_HS_ADV_RPT_RATE_SOURCES
+#define MYNEWT_VAL_BLE_HS_ADV_RPT_RATE_SOURCES (8)
+#endif
+
+#ifndef MYNEWT_VAL_BLE_HS_ADV_RPT_RATE_WINDOW_MS
+#define MYNEWT_VAL_BLE_HS_ADV_RPT_RATE_WINDOW_MS (1000)
+#endif
+
 #ifndef MYNEWT_VAL_BLE_HS_AUTO_START
 #define MYNEWT_VAL_BLE_HS_AUTO_START (1)
 #endif
 
+#ifndef MYNEWT_VAL_BLE_HS_CONN_STATS
+#define MYNEWT_VAL_BLE_HS_CONN_STATS (0)
+#endif
+
 #ifndef MYNEWT_VAL_BLE_HS_DEBUG
 #define MYNEWT_VAL_BLE_HS_DEBUG (0)
 #endif
@@ -751,6 +783,14 @@
 #define MYNEWT_VAL_BLE_HS_SYSINIT_STAGE (200)
 #endif
 
+#ifndef MYNEWT_VAL_BLE_HS_TRACE
+#define MYNEWT_VAL_BLE_HS_TRACE (0)
+#endif
+
+#ifndef MYNEWT_VAL_BLE_HS_TRACE_SIZE
+#define MYNEWT_VAL_BLE_HS_TRACE_SIZE (256)
+#endif
+
 #ifndef MYNEWT_VAL_BLE_L2CAP_COC_MAX_NUM
 #define MYNEWT_VAL_BLE_L2CAP_COC_MAX_NUM (0)
 #endif
@@ -835,6 +875,22 @@
 #define MYNEWT_VAL_BLE_SM_SC_DEBUG_KEYS (0)
 #endif
 
+#ifndef MYNEWT_VAL_BLE_SM_SC_KEY_POOL_SIZE
+#define MYNEWT_VAL_BLE_SM_SC_KEY_POOL_SIZE (0)
+#endif
+
+#ifndef MYNEWT_VAL_BLE_SM_SC_KEY_POOL_TASK_PRIORITY
+#define MYNEWT_VAL_BLE_SM_SC_KEY_POOL_TASK_PRIORITY (1)
+#endif
+
+#ifndef MYNEWT_VAL_BLE_SM_SC_KEY_POOL_TASK_STACK_SIZE
+#define MYNEWT_VAL_BLE_SM_SC_KEY_POOL_TASK_STACK_SIZE (4096)
+#endif
+
+#ifndef MYNEWT_VAL_BLE_SM_SC_KEY_MAX_USES
+#define MYNEWT_VAL_BLE_SM_SC_KEY_MAX_USES (0)
+#endif
+
 #ifndef MYNEWT_VAL_BLE_SM_SC_ONLY
 #define MYNEWT_VAL_BLE_SM_SC_ONLY (0)
 #endif
@@ -863,6 +919,18 @@
 #endif
 #endif
 
+#ifndef MYNEWT_VAL_BLE_STORE_CONFIG_FLUSH_DELAY_MS
+#define MYNEWT_VAL_BLE_STORE_CONFIG_FLUSH_DELAY_MS (1000)
+#endif
+
+#ifndef MYNEWT_VAL_BLE_STORE_CONFIG_LAZY_LOAD
+#define MYNEWT_VAL_BLE_STORE_CONFIG_LAZY_LOAD (0)
+#endif
+
+#ifndef MYNEWT_VAL_BLE_STORE_CONFIG_LAZY_CACHE_SIZE
+#define MYNEWT_VAL_BLE_STORE_CONFIG_LAZY_CACHE_SIZE (4)
+#endif
+
 /*** @apache-mynewt-nimble/nimble/host/services/ans */
 #ifndef MYNEWT_VAL_BLE_SVC_ANS_NEW_ALERT_CAT
 #define MYNEWT_VAL_BLE_SVC_ANS_NEW_ALERT_CAT (0)
@@ -1407,6 +1475,10 @@
 #define MYNEWT_VAL_BLE_TRANSPORT_EVT_DISCARDABLE_COUNT (16)
 #endif
 
+#ifndef MYNEWT_VAL_BLE_TRANSPORT_EVT_DISCARDABLE_RESERVED
+#define MYNEWT_VAL_BLE_TRANSPORT_EVT_DISCARDABLE_RESERVED (0)
+#endif
+
 #ifndef MYNEWT_VAL_BLE_TRANSPORT_EVT_SIZE
 #if MYNEWT_VAL_BLE_EXT_ADV
 #define MYNEWT_VAL_BLE_TRANSPORT_EVT_SIZE (257)
@@ -1668,6 +1740,14 @@
 #define MYNEWT_VAL_BLE_LL_NUM_SCAN_DUP_ADVS (32)
 #endif
 
+#ifndef MYNEWT_VAL_BLE_LL_SCAN_DUP_HASH_SIZE
+#define MYNEWT_VAL_BLE_LL_SCAN_DUP_HASH_SIZE (16)
+#endif
+
+#ifndef MYNEWT_VAL_BLE_LL_SCAN_DUP_REFRESH_MS
+#define MYNEWT_VAL_BLE_LL_SCAN_DUP_REFRESH_MS (0)
+#endif
+
 #ifndef MYNEWT_VAL_BLE_LL_NUM_SCAN_RSP_ADVS
 #define MYNEWT_VAL_BLE_LL_NUM_SCAN_RSP_ADVS (32)
 #endif
@@ -1986,6 +2066,10 @@
 #endif
 #endif
 
+#ifndef MYNEWT_VAL_BLE_HOST_RPA_CACHE_SIZE
+#define MYNEWT_VAL_BLE_HOST_RPA_CACHE_SIZE (8)
+#endif
+
 #define BLE_50_FEATURE_SUPPORT (MYNEWT_VAL_BLE_LL_CFG_FEAT_DATA_LEN_EXT)
 
 /* NimBLE-Arduino added configurations */
@@ -2005,6 +2089,18 @@
 #define MYNEWT_VAL_NIMBLE_CPP_ADDR_FMT_UPPERCASE (1)
 #endif
 
+#ifndef MYNEWT_VAL_NIMBLE_CPP_AIRTIME_BUDGET
+#define MYNEWT_VAL_NIMBLE_CPP_AIRTIME_BUDGET (0)
+#endif
+
+#ifndef MYNEWT_VAL_NIMBLE_CPP_AIRTIME_PERIOD_MS
+#define MYNEWT_VAL_NIMBLE_CPP_AIRTIME_PERIOD_MS (2000)
+#endif
+
+#ifndef MYNEWT_VAL_NIMBLE_CPP_ATT_HASH_INDEX
+#define MYNEWT_VAL_NIMBLE_CPP_ATT_HASH_INDEX (0)
+#endif
+
 #ifndef MYNEWT_VAL_NIMBLE_CPP_ATT_VALUE_TIMESTAMP_ENABLED
 #define MYNEWT_VAL_NIMBLE_CPP_ATT_VALUE_TIMESTAMP_ENABLED (0)
 #endif
@@ -2013,6 +2109,42 @@
 #define MYNEWT_VAL_NIMBLE_CPP_ATT_VALUE_INIT_LENGTH (20)
 #endif
 
+#ifndef MYNEWT_VAL_NIMBLE_CPP_HID_REPORT_MAX_LEN
+#define MYNEWT_VAL_NIMBLE_CPP_HID_REPORT_MAX_LEN (64)
+#endif
+
+#ifndef MYNEWT_VAL_NIMBLE_CPP_PERIODIC_REPORT_MAX_LEN
+#define MYNEWT_VAL_NIMBLE_CPP_PERIODIC_REPORT_MAX_LEN (MYNEWT_VAL_BLE_EXT_ADV_MAX_SIZE)
+#endif
+
+#ifndef MYNEWT_VAL_NIMBLE_CPP_LOG_DEFERRED
+#define MYNEWT_VAL_NIMBLE_CPP_LOG_DEFERRED (0)
+#endif
+
+#ifndef MYNEWT_VAL_NIMBLE_CPP_LOG_DEFERRED_ARG_SLOTS
+#define MYNEWT_VAL_NIMBLE_CPP_LOG_DEFERRED_ARG_SLOTS (8)
+#endif
+
+#ifndef MYNEWT_VAL_NIMBLE_CPP_LOG_DEFERRED_ENTRIES
+#define MYNEWT_VAL_NIMBLE_CPP_LOG_DEFERRED_ENTRIES (32)
+#endif
+
+#ifndef MYNEWT_VAL_NIMBLE_CPP_LOG_DEFERRED_FLUSH_MS
+#define MYNEWT_VAL_NIMBLE_CPP_LOG_DEFERRED_FLUSH_MS (100)
+#endif
+
+#ifndef MYNEWT_VAL_NIMBLE_CPP_LOG_DEFERRED_STR_SIZE
+#define MYNEWT_VAL_NIMBLE_CPP_LOG_DEFERRED_STR_SIZE (48)
+#endif
+
+#ifndef MYNEWT_VAL_NIMBLE_CPP_LOG_DEFERRED_TASK_PRIORITY
+#define MYNEWT_VAL_NIMBLE_CPP_LOG_DEFERRED_TASK_PRIORITY (1)
+#endif
+
+#ifndef MYNEWT_VAL_NIMBLE_CPP_LOG_DEFERRED_TASK_STACK_SIZE
+#define MYNEWT_VAL_NIMBLE_CPP_LOG_DEFERRED_TASK_STACK_SIZE (3072)
+#endif
+
 #ifndef MYNEWT_VAL_NIMBLE_CPP_LOG_LEVEL
 #define MYNEWT_VAL_NIMBLE_CPP_LOG_LEVEL (0)
 #endif